@@ -47,17 +47,16 @@ architecture behave of lane is
   signal edge_detected      : std_logic;
   signal x_coord, y_coord   : integer range 0 to 1279;
   signal x_coord_sync, y_coord_sync : integer range 0 to 1279;  -- Sincronizado com edge_detected
-  signal x_delayed, y_delayed : integer range 0 to 1279;
   signal hough_processing   : std_logic;
-  signal line_detected      : std_logic;
-  signal line_rho           : integer;
-  signal line_theta         : integer;
-  
-  -- Pipeline de atraso para sincronizar coordenadas com Sobel
-  type delay_array_t is array (0 to 13) of integer range 0 to 1279;
-  signal x_delay_pipe : delay_array_t;
-  signal y_delay_pipe : delay_array_t;
-  
+  signal on_lane            : std_logic;                      -- 3 ciclos depois de edge_detected
+  signal left_valid, right_valid : std_logic;
+  signal left_rho, right_rho     : integer range 0 to 511;  -- Bins finos (lane_hough)
+  signal left_theta, right_theta : integer range 0 to 63;
+
+  -- rgb_sobel atrasado para alinhar com on_lane
+  type rgb_delay_t is array (0 to 2) of std_logic_vector(23 downto 0);
+  signal rgb_delay          : rgb_delay_t;
+
   -- Pipeline menor para sincronizar coordenadas com edge_detected (7 ciclos)
   type delay_edge_t is array (0 to 6) of integer range 0 to 1279;
   signal x_delay_for_edge : delay_edge_t;
@@ -88,21 +87,25 @@ begin
               data_out      => rgb_sobel,
               edge_detected => edge_detected);
   
-  -- Hough Transform
+  -- Hough Transform: vota no frame atual e marca as faixas do anterior
   hough : entity work.lane_hough
     generic map (IMG_WIDTH  => 1280,
                  IMG_HEIGHT => 720)
     port map (clk           => clk,
               reset         => reset,
-              vs_in         => vs_0,
-              de_in         => de_0,
+              vs_in         => vs_1,
+              de_in         => de_1,
               edge_detected => edge_detected,
               x_coord       => x_coord_sync,  -- SINCRONIZADO com edge_detected
               y_coord       => y_coord_sync,  -- SINCRONIZADO com edge_detected
               processing    => hough_processing,
-              line_detected => line_detected,
-              line_rho      => line_rho,
-              line_theta    => line_theta);
+              on_lane       => on_lane,
+              left_valid    => left_valid,
+              left_rho      => left_rho,
+              left_theta    => left_theta,
+              right_valid   => right_valid,
+              right_rho     => right_rho,
+              right_theta   => right_theta);
 
   -- delay control signals to match pipeline stages of signal processing
   control : entity work.lane_sync
@@ -116,9 +119,9 @@ begin
               hs_out => hs_1,
               de_out => de_1);
               
-  -- delay adicional para coordenadas
+  -- delay adicional: on_lane (3) + overlay (1)
   control2 : entity work.lane_sync
-    generic map (delay => 7)
+    generic map (delay => 4)
     port map (clk    => clk,
               reset  => reset,
               vs_in  => vs_1,
@@ -167,52 +170,19 @@ begin
     y_coord_sync <= y_delay_for_edge(6);
   end process;
   
-  -- Atraso das coordenadas para sincronizar com pipeline do Sobel (14 ciclos)
-  -- Pipeline: lane_sync (7) + lane_sobel + lane_sync (7) = 14 ciclos
+  -- Overlay: bordas (pixels escuros do Sobel) sobre uma das faixas em verde
   process
   begin
     wait until rising_edge(clk);
-    -- Shift register de 14 estágios
-    x_delay_pipe(0) <= x_coord;
-    y_delay_pipe(0) <= y_coord;
-    for i in 1 to 13 loop
-      x_delay_pipe(i) <= x_delay_pipe(i-1);
-      y_delay_pipe(i) <= y_delay_pipe(i-1);
-    end loop;
-    x_delayed <= x_delay_pipe(13);
-    y_delayed <= y_delay_pipe(13);
-  end process;
 
-  -- Overlay: desenhar linha verde sobre região com maior concentração de bordas
-  process
-    variable dist_to_line : integer;
-    variable is_edge : std_logic;
-  begin
-    wait until rising_edge(clk);
-    
-    -- SIMPLIFICADO: line_rho agora é diretamente a posição X em pixels
-    -- line_theta sempre = 2 (90°, linha vertical)
-    
-    -- Verifica se o pixel atual do Sobel é uma borda (escuro)
-    is_edge := '0';
-    if unsigned(rgb_sobel(7 downto 0)) < 128 then
-      is_edge := '1';
-    end if;
-    
-    if line_detected = '1' and de_1 = '1' then
-      -- Calcular distância do pixel atual à linha vertical
-      dist_to_line := abs(x_delayed - line_rho);
-      
-      -- Se pixel está próximo da linha (±30 pixels) E é uma borda, desenhar verde
-      if dist_to_line < 30 and is_edge = '1' then
-        rgb_out <= x"00FF00";  -- VERDE (00=R, FF=G, 00=B)
-      else
-        rgb_out <= rgb_sobel;  -- Sobel normal
-      end if;
-      
+    rgb_delay(0) <= rgb_sobel;
+    rgb_delay(1) <= rgb_delay(0);
+    rgb_delay(2) <= rgb_delay(1);
+
+    if on_lane = '1' and unsigned(rgb_delay(2)(7 downto 0)) < 128 then
+      rgb_out <= x"00FF00";  -- VERDE (00=R, FF=G, 00=B)
     else
-      -- Sem linha detectada: mostrar apenas Sobel
-      rgb_out <= rgb_sobel;
+      rgb_out <= rgb_delay(2);
     end if;
   end process;
 
@@ -1,83 +1,529 @@
--- lane_hough_minimal.vhd
+-- lane_hough.vhd
 --
--- Versão ULTRA-MINIMALISTA da Transformada de Hough
--- Sem acumulador - apenas detecção em tempo real
+-- Transformada de Hough em fluxo para o vídeo 720p (um pixel por clock)
 --
--- Esta versão NÃO usa BRAM para acumular votos.
--- Estratégia: Detectar linhas verticais dominantes em tempo real
--- analisando a concentração de bordas em colunas específicas.
+-- Cada pixel de borda do Sobel vota, no mesmo ciclo, em todos os
+-- THETA_BINS bancos θ: cada banco é uma memória própria (lane_houghmem) e
+-- o ρ de cada θ sai de x_coord/y_coord por multiplicação por constantes,
+-- já na escala dos bins (sem divisão). O voto é um read-modify-write em
+-- dois ciclos; quando dois pixels seguidos caem na mesma célula, a
+-- contagem nova é encaminhada (a leitura síncrona ainda não enxerga a
+-- escrita do ciclo anterior).
 --
--- RECURSOS: < 200 LABs (vs 2936 da versão lightweight!)
+-- Acumulador duplo: cada banco tem duas memórias. Um frame vota numa
+-- enquanto a outra, com os votos do frame anterior, é varrida a partir da
+-- subida de vs_in (blanking vertical): THETA_BINS x RHO_BINS ciclos (2048
+-- com 16 x 128, contra ~49500 ciclos de blanking vertical no 720p), lendo
+-- e zerando cada célula e guardando o pico de cada metade de θ:
+--   esquerda: θ em [0°, 90°)   (faixa que sobe para a direita na imagem)
+--   direita:  θ em (90°, 180°) (faixa que sobe para a esquerda)
+-- θ = 90° (linha horizontal) não conta como faixa, e o pico só vale com
+-- pelo menos MIN_VOTES votos. Os picos ficam estáveis durante o frame
+-- seguinte e alimentam o overlay: on_lane diz se o pixel (x_coord,
+-- y_coord) de três ciclos antes cai na célula (θ, ρ) de uma das faixas.
+--
+-- Rastreamento (TRACKING): as faixas quase não mudam de um frame para o
+-- seguinte. Achada uma faixa no acumulador grosso, a metade dela sai da
+-- votação grossa e passa a votar só num acumulador fino em registradores,
+-- centrado na faixa: (2*ROI_THETA+1) x (2*ROI_RHO+1) células com passo
+-- RHO_FINE vezes menor em ρ e THETA_FINE vezes menor em θ. Um ρ fino por
+-- θ da janela sai de multiplicações pelos cos/sin do θ atual da faixa
+-- (registradores trocados no blanking); o pico é mantido durante a
+-- votação e, na subida de vs_in, recentra a faixa. Uma faixa sem pico
+-- mantém a posição por TRACK_HOLD frames; depois disso a metade dela volta
+-- à busca completa no acumulador grosso. Com 4 x 4, a resolução fina
+-- (512 x 64 bins, ~5 pixels e 2,8°) custa 2 x 45 contadores, contra 1 Mbit
+-- de um acumulador duplo completo nessa resolução. Estimativa, sem fit no
+-- Quartus: 1440 flip-flops nos contadores e 20 multiplicadores x/y por
+-- cos/sin da faixa (11 x 18 bits, um 18x18 cada), além dos 32 por constante
+-- do acumulador grosso. Os 52 cabem nos 66 do EP4CE22; no 5CEBA2 (50) parte
+-- das constantes tem de ir para a lógica (TRACKING = false tira os 20).
+--
+-- ρ = x*cos θ + y*sin θ, em RHO_BINS bins de -(IMG_WIDTH-1) até a diagonal
+-- da imagem (~21 pixels por bin em 1280 x 720). As faixas nas saídas e no
+-- overlay estão sempre na escala fina (bin grosso k = bins finos
+-- k*FINE .. k*FINE+FINE-1).
 
 library IEEE;
 use IEEE.STD_LOGIC_1164.all;
 use IEEE.NUMERIC_STD.all;
+use IEEE.MATH_REAL.all;
 
 entity lane_hough is
   generic (
     IMG_WIDTH  : integer := 1280;
     IMG_HEIGHT : integer := 720;
-    THETA_BINS : integer := 9;     -- Compatibilidade com lane.vhd
-    RHO_BINS   : integer := 128    -- Compatibilidade com lane.vhd
+    THETA_BINS : integer := 16;    -- θ em [0°, 180°), passo 180°/THETA_BINS (par)
+    RHO_BINS   : integer := 128;   -- ρ de -(IMG_WIDTH-1) até a diagonal
+    VOTE_BITS  : integer := 16;    -- Contador de votos por célula (satura)
+    MIN_VOTES  : integer := 64;    -- Votos mínimos para uma faixa valer
+    BORDER     : integer := 2;     -- Pixels da borda sem janela 3x3 completa (não votam)
+    TRACKING   : boolean := true;  -- Faixas achadas seguem no acumulador fino
+    RHO_FINE   : integer := 4;     -- Bins finos de ρ por bin grosso
+    THETA_FINE : integer := 4;     -- Bins finos de θ por bin grosso
+    ROI_RHO    : integer := 4;     -- Meia largura do acumulador fino, em bins finos de ρ
+    ROI_THETA  : integer := 2;     -- Meia largura do acumulador fino, em bins finos de θ
+    TRACK_HOLD : integer := 3      -- Frames sem pico mantendo a faixa antes da busca completa
   );
   port (
     clk           : in  std_logic;
     reset         : in  std_logic;
-    -- Interface de entrada (pixel do Sobel)
+    -- Interface de entrada (pixel do Sobel; tudo alinhado com edge_detected)
     vs_in         : in  std_logic;
     de_in         : in  std_logic;
     edge_detected : in  std_logic;
     x_coord       : in  integer range 0 to IMG_WIDTH-1;
     y_coord       : in  integer range 0 to IMG_HEIGHT-1;
     -- Interface de saída
-    processing    : out std_logic;
-    line_detected : out std_logic;
-    line_rho      : out integer;
-    line_theta    : out integer
+    processing    : out std_logic;                                   -- Varredura dos picos em andamento
+    on_lane       : out std_logic;                                   -- Pixel de 3 ciclos antes sobre uma faixa
+    left_valid    : out std_logic;
+    left_rho      : out integer range 0 to RHO_BINS*RHO_FINE-1;      -- Bin fino de ρ
+    left_theta    : out integer range 0 to THETA_BINS*THETA_FINE-1;  -- Bin fino de θ (k * 180°/(THETA_BINS*THETA_FINE))
+    right_valid   : out std_logic;
+    right_rho     : out integer range 0 to RHO_BINS*RHO_FINE-1;
+    right_theta   : out integer range 0 to THETA_BINS*THETA_FINE-1
   );
 end lane_hough;
 
 architecture behave of lane_hough is
 
-  signal frame_active : std_logic := '0';
-  signal vs_prev : std_logic := '0';
-  signal line_detected_reg : std_logic := '1';
-  signal last_edge_x : integer range 0 to IMG_WIDTH-1 := 640;  -- FORÇA inicialização em 640!
+  -- ρ na escala dos bins, em ponto fixo com FRAC bits: o bin de um pixel é
+  -- (x*COS_Q(t) + y*SIN_Q(t) + RHO_OFS) / 2^FRAC (grosso) e o mesmo com
+  -- FCOS_Q/FSIN_Q/RHO_OFS_F (fino)
+  constant FRAC      : integer := 16;
+  constant RHO_SPAN  : integer := IMG_WIDTH + integer(ceil(sqrt(real(IMG_WIDTH*IMG_WIDTH + IMG_HEIGHT*IMG_HEIGHT))));
+  constant SCALE     : real    := real(RHO_BINS) * 2.0**FRAC / real(RHO_SPAN);
+  constant RHO_OFS   : integer := integer(round(real(IMG_WIDTH-1) * SCALE));
+  constant RHO_TOP   : integer := RHO_BINS * 2**FRAC;  -- Primeiro valor além do último bin
+  constant HALF      : integer := THETA_BINS / 2;      -- Bin de θ = 90°
+  constant F_RHO     : integer := RHO_BINS * RHO_FINE;
+  constant F_THETA   : integer := THETA_BINS * THETA_FINE;
+  constant F_SCALE   : real    := SCALE * real(RHO_FINE);
+  constant RHO_OFS_F : integer := integer(round(real(IMG_WIDTH-1) * F_SCALE));
+  constant RHO_TOP_F : integer := F_RHO * 2**FRAC;
+  constant F_HALF    : integer := HALF * THETA_FINE;   -- Bin fino de θ = 90°
+  constant NT        : integer := 2*ROI_THETA + 1;     -- θ do acumulador fino
+  constant NR        : integer := 2*ROI_RHO + 1;       -- ρ do acumulador fino
+
+  type coef_array is array (natural range <>) of integer;
+
+  function make_coef (bins : integer; scale_q : real; use_sin : boolean) return coef_array is
+    variable result : coef_array(0 to bins-1);
+    variable angle  : real;
+  begin
+    for t in 0 to bins-1 loop
+      angle := real(t) * MATH_PI / real(bins);
+      if use_sin then
+        result(t) := integer(round(sin(angle) * scale_q));
+      else
+        result(t) := integer(round(cos(angle) * scale_q));
+      end if;
+    end loop;
+    return result;
+  end function;
+
+  constant COS_Q  : coef_array(0 to THETA_BINS-1) := make_coef(THETA_BINS, SCALE, false);
+  constant SIN_Q  : coef_array(0 to THETA_BINS-1) := make_coef(THETA_BINS, SCALE, true);
+  constant FCOS_Q : coef_array(0 to F_THETA-1)    := make_coef(F_THETA, F_SCALE, false);
+  constant FSIN_Q : coef_array(0 to F_THETA-1)    := make_coef(F_THETA, F_SCALE, true);
+
+  subtype prod_t    is integer range -(2**26) to 2**26;
+  subtype rho_t     is integer range 0 to RHO_BINS-1;
+  subtype theta_t   is integer range 0 to THETA_BINS-1;
+  subtype frho_t    is integer range 0 to F_RHO-1;
+  subtype ftheta_t  is integer range 0 to F_THETA-1;
+  subtype vote_t    is unsigned(VOTE_BITS-1 downto 0);
+  type prod_array   is array (0 to THETA_BINS-1) of prod_t;
+  type rho_array    is array (0 to THETA_BINS-1) of rho_t;
+  type vote_array   is array (0 to THETA_BINS-1) of vote_t;
+  type vote_matrix  is array (0 to 1) of vote_array;  -- (memória, θ)
+
+  -- Acumulador fino: (faixa)(θ da janela)(ρ da janela)
+  type fprod_slots  is array (0 to NT-1) of prod_t;
+  type frho_slots   is array (0 to NT-1) of frho_t;
+  type fcoef_slots  is array (0 to NT-1) of integer range -(2**16) to 2**16;
+  type fprod_lanes  is array (0 to 1) of fprod_slots;
+  type frho_lanes   is array (0 to 1) of frho_slots;
+  type fcoef_lanes  is array (0 to 1) of fcoef_slots;
+  type fslot_lanes  is array (0 to 1) of std_logic_vector(0 to NT-1);
+  type facc_row     is array (0 to NR-1) of vote_t;
+  type facc_slots   is array (0 to NT-1) of facc_row;
+  type facc_lanes   is array (0 to 1) of facc_slots;
+
+  -- Faixas (0: esquerda, 1: direita), na escala fina
+  type lane_votes   is array (0 to 1) of vote_t;
+  type lane_frho    is array (0 to 1) of frho_t;
+  type lane_ftheta  is array (0 to 1) of ftheta_t;
+  type miss_array   is array (0 to 1) of integer range 0 to TRACK_HOLD;
+
+  constant VOTE_MAX : vote_t := (others => '1');
+
+  -- Votação: estágio 1 (produtos), 2 (bin de ρ), 3 (leitura), 4 (escrita)
+  signal vote_1, vote_2         : std_logic := '0';
+  signal vote_3                 : std_logic_vector(0 to THETA_BINS-1) := (others => '0');  -- Por banco
+  signal prod_x, prod_y         : prod_array := (others => 0);
+  signal rho_2, rho_3           : rho_array := (others => 0);
+  signal vote_new               : vote_array;
+  signal last_vote              : std_logic_vector(0 to THETA_BINS-1) := (others => '0');  -- Escrita do ciclo anterior
+  signal last_rho               : rho_array := (others => 0);
+  signal last_new               : vote_array := (others => (others => '0'));
+
+  -- Acumulador duplo: a memória vote_sel de cada banco recebe os votos,
+  -- a outra é varrida
+  signal mem_q                  : vote_matrix;
+  signal vote_sel               : integer range 0 to 1 := 0;
+
+  -- Acumulador fino: cos/sin e validade de cada θ da janela (da faixa
+  -- atual), produtos (estágio 1), bin fino (estágio 2) e contadores
+  -- (estágio 3), com o pico do frame mantido durante a votação
+  signal fcos, fsin             : fcoef_lanes := (others => (others => 0));
+  signal fslot_ok               : fslot_lanes := (others => (others => '0'));
+  signal fprod_x, fprod_y       : fprod_lanes := (others => (others => 0));
+  signal frho_2                 : frho_lanes := (others => (others => 0));
+  signal facc                   : facc_lanes := (others => (others => (others => (others => '0'))));
+  signal fbest_votes            : lane_votes := (others => (others => '0'));
+  signal fbest_theta            : lane_ftheta := (others => 0);  -- Já absolutos
+  signal fbest_rho              : lane_frho := (others => 0);
+  signal fpeak_votes            : lane_votes := (others => (others => '0'));  -- Pico do último frame
+  signal fpeak_theta            : lane_ftheta := (others => 0);
+  signal fpeak_rho              : lane_frho := (others => 0);
+
+  -- Varredura: célula (scan_theta, scan_rho) lida e zerada neste ciclo,
+  -- comparada no seguinte (scan_1_*)
+  signal vs_prev                : std_logic := '0';
+  signal frame_start            : std_logic;
+  signal scan_busy              : std_logic := '0';
+  signal scan_theta             : theta_t := 0;
+  signal scan_rho               : rho_t := 0;
+  signal scan_1, scan_1_last    : std_logic := '0';
+  signal scan_1_theta           : theta_t := 0;
+  signal scan_1_rho             : rho_t := 0;
+  signal publish                : std_logic := '0';
+  signal best_votes             : lane_votes := (others => (others => '0'));
+  signal best_theta             : lane_ftheta := (others => 0);  -- Bin grosso já na escala fina
+  signal best_rho               : lane_frho := (others => 0);
+
+  -- Faixas do último frame varrido (saídas, overlay e acumulador fino)
+  signal lane_valid             : std_logic_vector(0 to 1) := (others => '0');
+  signal lane_theta             : lane_ftheta := (others => 0);
+  signal lane_rho               : lane_frho := (others => 0);
+  signal lane_miss              : miss_array := (others => 0);  -- Frames seguidos sem pico
+  signal on_lane_r              : std_logic := '0';
 
 begin
 
-  processing <= frame_active;
-  line_detected <= line_detected_reg;
-  
-  -- Linha detectada: sempre vertical (theta = 2, que é 90°)
-  line_theta <= 2;  
-  
-  -- Rho = posição X em pixels da ÚLTIMA BORDA DETECTADA
-  line_rho <= last_edge_x;  -- DIRETO, sem conversão!
-
-  -- Processo ULTRA-SIMPLIFICADO: atualiza SEMPRE que edge_detected='1'
-  process(clk)
+  processing  <= scan_busy;
+  on_lane     <= on_lane_r;
+  left_valid  <= lane_valid(0);
+  left_rho    <= lane_rho(0);
+  left_theta  <= lane_theta(0);
+  right_valid <= lane_valid(1);
+  right_rho   <= lane_rho(1);
+  right_theta <= lane_theta(1);
+
+  frame_start <= vs_in and not vs_prev;
+
+  -- Bancos θ: contagem nova de cada voto e as duas memórias
+  bank : for t in 0 to THETA_BINS-1 generate
+    signal old_count : vote_t;
+  begin
+    -- Contagem atual da célula do estágio 3: a escrita do ciclo anterior
+    -- ainda não aparece na leitura síncrona, então é encaminhada
+    old_count <= last_new(t) when last_vote(t) = '1' and last_rho(t) = rho_3(t) else
+                 mem_q(vote_sel)(t);
+    vote_new(t) <= old_count when old_count = VOTE_MAX else old_count + 1;
+
+    buf : for b in 0 to 1 generate
+      signal we      : std_logic;
+      signal wr_addr : rho_t;
+      signal rd_addr : rho_t;
+      signal wr_data : vote_t;
+    begin
+      -- Memória que vota: lê o pixel do estágio 2 e escreve o do estágio 3.
+      -- A outra: a varredura lê e zera a célula (scan_theta, scan_rho).
+      we      <= vote_3(t) when vote_sel = b else
+                 '1' when scan_busy = '1' and scan_theta = t else
+                 '0';
+      wr_addr <= rho_3(t) when vote_sel = b else scan_rho;
+      wr_data <= vote_new(t) when vote_sel = b else (others => '0');
+      rd_addr <= rho_2(t) when vote_sel = b else scan_rho;
+
+      mem : entity work.lane_houghmem
+        generic map (DEPTH => RHO_BINS,
+                     WIDTH => VOTE_BITS)
+        port map (clk        => clk,
+                  write_en   => we,
+                  wr_address => wr_addr,
+                  data_in    => wr_data,
+                  rd_address => rd_addr,
+                  data_out   => mem_q(b)(t));
+    end generate;
+  end generate;
+
+  -- Pipeline de votação: um pixel por ciclo, sem parada
+  process
+    variable sum       : integer;
+    variable in_search : boolean;
+    variable angle     : integer;
+    variable rel       : integer;
+    variable count     : vote_t;
+    variable bv        : vote_t;
+    variable bt        : ftheta_t;
+    variable br        : frho_t;
+    variable hit       : boolean;
+  begin
+    wait until rising_edge(clk);
+
+    -- cos/sin fino de cada θ da janela de cada faixa; a faixa só muda no
+    -- blanking, então os coeficientes estão estáveis durante a votação
+    for l in 0 to 1 loop
+      for k in 0 to NT-1 loop
+        -- a janela não passa para a outra metade (nem para θ = 90°)
+        angle := lane_theta(l) + k - ROI_THETA;
+        if (l = 0 and angle >= 0 and angle < F_HALF) or
+           (l = 1 and angle > F_HALF and angle < F_THETA) then
+          fslot_ok(l)(k) <= '1';
+        else
+          fslot_ok(l)(k) <= '0';
+          angle := lane_theta(l);
+        end if;
+        fcos(l)(k) <= FCOS_Q(angle);
+        fsin(l)(k) <= FSIN_Q(angle);
+      end loop;
+    end loop;
+
+    -- estágio 1: produtos por constantes (só somas de deslocamentos) e,
+    -- no acumulador fino, pelos coeficientes da faixa
+    if de_in = '1' and edge_detected = '1' and
+       x_coord >= BORDER and x_coord < IMG_WIDTH - BORDER and
+       y_coord >= BORDER and y_coord < IMG_HEIGHT - BORDER then
+      vote_1 <= '1';
+    else
+      vote_1 <= '0';
+    end if;
+    for t in 0 to THETA_BINS-1 loop
+      prod_x(t) <= x_coord * COS_Q(t);
+      prod_y(t) <= y_coord * SIN_Q(t) + RHO_OFS;
+    end loop;
+    if TRACKING then
+      for l in 0 to 1 loop
+        for k in 0 to NT-1 loop
+          fprod_x(l)(k) <= x_coord * fcos(l)(k);
+          fprod_y(l)(k) <= y_coord * fsin(l)(k) + RHO_OFS_F;
+        end loop;
+      end loop;
+    end if;
+
+    -- estágio 2: bin de ρ em cada θ (saturado nas pontas)
+    vote_2 <= vote_1;
+    for t in 0 to THETA_BINS-1 loop
+      sum := prod_x(t) + prod_y(t);
+      if sum <= 0 then
+        rho_2(t) <= 0;
+      elsif sum >= RHO_TOP then
+        rho_2(t) <= RHO_BINS-1;
+      else
+        rho_2(t) <= to_integer(shift_right(to_unsigned(sum, 32), FRAC));
+      end if;
+    end loop;
+    if TRACKING then
+      for l in 0 to 1 loop
+        for k in 0 to NT-1 loop
+          sum := fprod_x(l)(k) + fprod_y(l)(k);
+          if sum <= 0 then
+            frho_2(l)(k) <= 0;
+          elsif sum >= RHO_TOP_F then
+            frho_2(l)(k) <= F_RHO-1;
+          else
+            frho_2(l)(k) <= to_integer(shift_right(to_unsigned(sum, 32), FRAC));
+          end if;
+        end loop;
+      end loop;
+    end if;
+
+    -- estágio 3: leitura da célula (nas memórias), só nos bancos da metade
+    -- sem faixa rastreada (busca completa); estágio 4: escrita
+    for t in 0 to THETA_BINS-1 loop
+      if not TRACKING then
+        in_search := true;
+      elsif t < HALF then
+        in_search := lane_valid(0) = '0';
+      elsif t > HALF then
+        in_search := lane_valid(1) = '0';
+      else
+        in_search := false;             -- θ = 90° nunca vira faixa
+      end if;
+      if vote_2 = '1' and in_search then
+        vote_3(t) <= '1';
+      else
+        vote_3(t) <= '0';
+      end if;
+    end loop;
+    rho_3     <= rho_2;
+    last_vote <= vote_3;
+    last_rho  <= rho_3;
+    last_new  <= vote_new;
+
+    -- estágio 3 do acumulador fino: contadores em registradores, sem
+    -- encaminhamento; o pico acompanha cada voto (as contagens só crescem)
+    if TRACKING then
+      for l in 0 to 1 loop
+        bv  := fbest_votes(l);
+        bt  := fbest_theta(l);
+        br  := fbest_rho(l);
+        hit := false;
+        for k in 0 to NT-1 loop
+          rel := frho_2(l)(k) - lane_rho(l) + ROI_RHO;
+          if vote_2 = '1' and lane_valid(l) = '1' and fslot_ok(l)(k) = '1' and rel >= 0 and rel < NR then
+            count := facc(l)(k)(rel);
+            if count /= VOTE_MAX then
+              count := count + 1;
+            end if;
+            facc(l)(k)(rel) <= count;
+            if count > bv then
+              bv  := count;
+              bt  := lane_theta(l) + k - ROI_THETA;
+              br  := frho_2(l)(k);
+              hit := true;
+            end if;
+          end if;
+        end loop;
+        if hit then
+          fbest_votes(l) <= bv;
+          fbest_theta(l) <= bt;
+          fbest_rho(l)   <= br;
+        end if;
+      end loop;
+
+      -- novo frame: guarda o pico do frame que terminou e zera a janela
+      if frame_start = '1' then
+        fpeak_votes <= fbest_votes;
+        fpeak_theta <= fbest_theta;
+        fpeak_rho   <= fbest_rho;
+        fbest_votes <= (others => (others => '0'));
+        facc        <= (others => (others => (others => (others => '0'))));
+      end if;
+    end if;
+
+    -- overlay: o pixel do estágio 2 cai na célula de uma das faixas (fina
+    -- com rastreamento: o θ central da janela é o da faixa)
+    hit := false;
+    for l in 0 to 1 loop
+      if lane_valid(l) = '1' then
+        if TRACKING then
+          hit := hit or (frho_2(l)(ROI_THETA) = lane_rho(l));
+        else
+          hit := hit or (rho_2(lane_theta(l) / THETA_FINE) = lane_rho(l) / RHO_FINE);
+        end if;
+      end if;
+    end loop;
+    if hit then
+      on_lane_r <= '1';
+    else
+      on_lane_r <= '0';
+    end if;
+
+    if reset = '1' then
+      vote_1      <= '0';
+      vote_2      <= '0';
+      vote_3      <= (others => '0');
+      last_vote   <= (others => '0');
+      fbest_votes <= (others => (others => '0'));
+      fpeak_votes <= (others => (others => '0'));
+      facc        <= (others => (others => (others => (others => '0'))));
+    end if;
+  end process;
+
+  -- Troca das memórias na subida de vs_in e varredura da que votou
+  process
+    variable count : vote_t;
+    variable l     : integer range 0 to 1;
   begin
-    if rising_edge(clk) then
-      vs_prev <= vs_in;
-      
-      -- Detectar início de frame
-      if vs_in = '1' and vs_prev = '0' then
-        frame_active <= '1';
-        line_detected_reg <= '0';
-        last_edge_x <= 640;  -- RESETA para centro
-        
-      -- Detectar fim de frame  
-      elsif vs_in = '0' and vs_prev = '1' then
-        frame_active <= '0';
-        line_detected_reg <= '1';
+    wait until rising_edge(clk);
+    vs_prev <= vs_in;
+
+    scan_1       <= scan_busy;
+    scan_1_theta <= scan_theta;
+    scan_1_rho   <= scan_rho;
+    scan_1_last  <= '0';
+    if scan_busy = '1' then
+      if scan_rho = RHO_BINS-1 then
+        scan_rho <= 0;
+        if scan_theta = THETA_BINS-1 then
+          scan_busy   <= '0';
+          scan_1_last <= '1';
+        else
+          scan_theta <= scan_theta + 1;
+        end if;
+      else
+        scan_rho <= scan_rho + 1;
+      end if;
+    end if;
+
+    -- pico de cada metade de θ (o primeiro, em caso de empate), já na
+    -- escala fina: meio do bin grosso em ρ
+    if scan_1 = '1' and scan_1_theta /= HALF then
+      count := mem_q(1 - vote_sel)(scan_1_theta);
+      if scan_1_theta < HALF then
+        l := 0;
+      else
+        l := 1;
       end if;
-      
-      -- SEMPRE atualiza quando edge_detected='1', independente de frame_active ou de_in
-      if edge_detected = '1' then
-        last_edge_x <= x_coord;
+      if count > best_votes(l) then
+        best_votes(l) <= count;
+        best_theta(l) <= scan_1_theta * THETA_FINE;
+        best_rho(l)   <= scan_1_rho * RHO_FINE + RHO_FINE / 2;
       end if;
-      
+    end if;
+
+    -- fim da varredura: faixas do frame para o overlay (e o acumulador
+    -- fino) do frame seguinte. Faixa rastreada: recentra no pico fino ou,
+    -- sem ele, segue por TRACK_HOLD frames. Sem faixa: pico grosso.
+    publish <= scan_1 and scan_1_last;
+    if publish = '1' then
+      for i in 0 to 1 loop
+        if TRACKING and lane_valid(i) = '1' then
+          if fpeak_votes(i) >= MIN_VOTES then
+            lane_theta(i) <= fpeak_theta(i);
+            lane_rho(i)   <= fpeak_rho(i);
+            lane_miss(i)  <= 0;
+          elsif lane_miss(i) < TRACK_HOLD then
+            lane_miss(i)  <= lane_miss(i) + 1;
+          else
+            lane_valid(i) <= '0';
+            lane_miss(i)  <= 0;
+          end if;
+        elsif best_votes(i) >= MIN_VOTES then
+          lane_valid(i) <= '1';
+          lane_theta(i) <= best_theta(i);
+          lane_rho(i)   <= best_rho(i);
+          lane_miss(i)  <= 0;
+        else
+          lane_valid(i) <= '0';
+        end if;
+      end loop;
+    end if;
+
+    -- novo frame: a memória que votou passa a ser varrida (e zerada)
+    if frame_start = '1' then
+      assert scan_busy = '0'
+        report "lane_hough: novo frame antes do fim da varredura dos picos"
+        severity error;
+      vote_sel   <= 1 - vote_sel;
+      scan_busy  <= '1';
+      scan_theta <= 0;
+      scan_rho   <= 0;
+      best_votes <= (others => (others => '0'));
+    end if;
+
+    if reset = '1' then
+      vote_sel   <= 0;
+      scan_busy  <= '0';
+      scan_1     <= '0';
+      publish    <= '0';
+      lane_valid <= (others => '0');
+      lane_miss  <= (others => 0);
     end if;
   end process;
 
@@ -0,0 +1,41 @@
+-- lane_houghmem.vhd
+--
+-- Memória de um banco θ do acumulador de lane_hough: RHO_BINS contadores,
+-- uma porta de leitura e uma de escrita (M10K em modo simple dual-port).
+-- Leitura registrada; leitura e escrita no mesmo endereço e no mesmo
+-- ciclo devolvem o valor antigo (lane_hough conta com isso no
+-- encaminhamento dos votos e na limpeza durante a varredura).
+
+library IEEE;
+use IEEE.STD_LOGIC_1164.all;
+use IEEE.NUMERIC_STD.all;
+
+entity lane_houghmem is
+  generic (DEPTH : integer := 128;
+           WIDTH : integer := 16);
+  port (clk        : in  std_logic;
+        write_en   : in  std_logic;
+        wr_address : in  integer range 0 to DEPTH-1;
+        data_in    : in  unsigned(WIDTH-1 downto 0);
+        rd_address : in  integer range 0 to DEPTH-1;
+        data_out   : out unsigned(WIDTH-1 downto 0));
+end lane_houghmem;
+
+architecture behave of lane_houghmem is
+
+  type ram_array is array (0 to DEPTH-1) of unsigned(WIDTH-1 downto 0);
+  signal ram : ram_array := (others => (others => '0'));  -- acumulador começa zerado
+
+begin
+
+  process
+  begin
+    wait until rising_edge(clk);
+
+    if (write_en = '1') then
+      ram(wr_address) <= data_in;
+    end if;
+    data_out <= ram(rd_address);
+  end process;
+
+end behave;
@@ -0,0 +1,71 @@
+@echo off
+REM Simula lane.vhd com GHDL: cena sintética (lane_hough com rastreamento)
+REM e, se street_0_stimuli.txt estiver na pasta, a imagem do laboratório.
+REM lane_g_root_IP usa altera_mf: compilada aqui a partir do Quartus
+REM (QUARTUS_ROOTDIR, definido pelo instalador).
+
+echo ========================================
+echo  SIMULACAO: LANE DETECTION (GHDL)
+echo ========================================
+echo.
+
+set GHDL_FLAGS=--std=08 -frelaxed -fsynopsys --workdir=ghdl_work -Pghdl_work
+
+if not exist ghdl_work mkdir ghdl_work
+
+if not exist ghdl_work\altera_mf-obj08.cf (
+    if "%QUARTUS_ROOTDIR%"=="" (
+        echo [ERRO] QUARTUS_ROOTDIR nao definido: altera_mf nao encontrada
+        pause
+        exit /b 1
+    )
+    echo [1/4] Compilando altera_mf...
+    ghdl -a %GHDL_FLAGS% --work=altera_mf ^
+        "%QUARTUS_ROOTDIR%\eda\sim_lib\altera_mf_components.vhd" ^
+        "%QUARTUS_ROOTDIR%\eda\sim_lib\altera_mf.vhd"
+    if %ERRORLEVEL% NEQ 0 goto erro_compilacao
+)
+
+echo [2/4] Compilando lane...
+ghdl -a %GHDL_FLAGS% lane_g_root_IP.vhd lane_linemem.vhd lane_g_matrix.vhd ^
+    lane_sobel.vhd lane_sync.vhd lane_houghmem.vhd lane_hough.vhd lane.vhd sim_lane.vhd
+if %ERRORLEVEL% NEQ 0 goto erro_compilacao
+ghdl -e %GHDL_FLAGS% sim_lane
+if %ERRORLEVEL% NEQ 0 goto erro_compilacao
+
+REM O testbench sempre termina com 'severity failure': o resultado vem da mensagem
+echo [3/4] Cena sintetica (3 frames, faixas a 45 e 135 graus)...
+ghdl -r %GHDL_FLAGS% sim_lane -guse_files=false -gframes=3 > sim_lane_synthetic.txt 2>&1
+type sim_lane_synthetic.txt
+findstr /C:"EVERYTHING OK" sim_lane_synthetic.txt > nul
+if %ERRORLEVEL% NEQ 0 (
+    echo [ERRO] Cena sintetica falhou
+    pause
+    exit /b 1
+)
+
+echo [4/4] Imagem do laboratorio...
+if not exist street_0_stimuli.txt (
+    echo   street_0_stimuli.txt ausente: pulada
+    goto fim
+)
+ghdl -r %GHDL_FLAGS% sim_lane > sim_lane_files.txt 2>&1
+type sim_lane_files.txt
+findstr /C:"EVERYTHING OK" sim_lane_files.txt > nul
+if %ERRORLEVEL% NEQ 0 (
+    echo [ERRO] Resposta difere de street_0_expected.txt
+    pause
+    exit /b 1
+)
+
+:fim
+echo.
+echo PASSOU
+pause
+exit /b 0
+
+:erro_compilacao
+echo.
+echo [ERRO] Falha na compilacao!
+pause
+exit /b 1
@@ -0,0 +1,71 @@
+#!/bin/sh
+# Simula lane.vhd com GHDL: cena sintética (lane_hough com rastreamento)
+# e, se street_0_stimuli.txt estiver na pasta, a imagem do laboratório.
+# Mesmos passos do run_sim_lane.bat, para Linux/macOS. lane_g_root_IP usa
+# altera_mf: compilada aqui a partir do Quartus (QUARTUS_ROOTDIR, definido
+# pelo instalador).
+#
+#   cd FPGA-Vision && sh run_sim_lane.sh
+#
+# Passa quando as duas simulações imprimem "EVERYTHING OK"; a sintética
+# imprime antes as contagens de pixels verdes ("verde: faixa esquerda L,
+# direita R, fora F", com L, R >= 100 e F = 0). A saída fica em
+# sim_lane_synthetic.txt e sim_lane_files.txt.
+
+cd "$(dirname "$0")" || exit 1
+
+echo "========================================"
+echo " SIMULACAO: LANE DETECTION (GHDL)"
+echo "========================================"
+echo
+
+GHDL_FLAGS="--std=08 -frelaxed -fsynopsys --workdir=ghdl_work -Pghdl_work"
+
+erro_compilacao() {
+    echo
+    echo "[ERRO] Falha na compilacao!"
+    exit 1
+}
+
+mkdir -p ghdl_work
+
+if [ ! -f ghdl_work/altera_mf-obj08.cf ]; then
+    if [ -z "$QUARTUS_ROOTDIR" ]; then
+        echo "[ERRO] QUARTUS_ROOTDIR nao definido: altera_mf nao encontrada"
+        exit 1
+    fi
+    echo "[1/4] Compilando altera_mf..."
+    ghdl -a $GHDL_FLAGS --work=altera_mf \
+        "$QUARTUS_ROOTDIR/eda/sim_lib/altera_mf_components.vhd" \
+        "$QUARTUS_ROOTDIR/eda/sim_lib/altera_mf.vhd" || erro_compilacao
+fi
+
+echo "[2/4] Compilando lane..."
+ghdl -a $GHDL_FLAGS lane_g_root_IP.vhd lane_linemem.vhd lane_g_matrix.vhd \
+    lane_sobel.vhd lane_sync.vhd lane_houghmem.vhd lane_hough.vhd lane.vhd sim_lane.vhd || erro_compilacao
+ghdl -e $GHDL_FLAGS sim_lane || erro_compilacao
+
+# O testbench sempre termina com 'severity failure': o resultado vem da mensagem
+echo "[3/4] Cena sintetica (3 frames, faixas a 45 e 135 graus)..."
+ghdl -r $GHDL_FLAGS sim_lane -guse_files=false -gframes=3 > sim_lane_synthetic.txt 2>&1
+cat sim_lane_synthetic.txt
+if ! grep -q "EVERYTHING OK" sim_lane_synthetic.txt; then
+    echo "[ERRO] Cena sintetica falhou"
+    exit 1
+fi
+
+echo "[4/4] Imagem do laboratorio..."
+if [ -f street_0_stimuli.txt ]; then
+    ghdl -r $GHDL_FLAGS sim_lane > sim_lane_files.txt 2>&1
+    cat sim_lane_files.txt
+    if ! grep -q "EVERYTHING OK" sim_lane_files.txt; then
+        echo "[ERRO] Resposta difere de street_0_expected.txt"
+        exit 1
+    fi
+else
+    echo "  street_0_stimuli.txt ausente: pulada"
+fi
+
+echo
+echo "PASSOU"
+exit 0
@@ -5,6 +5,14 @@
 --
 -- FPGA Vision Remote Lab http://h-brs.de/fpga-vision-lab
 -- (c) Marco Winzker, Hochschule Bonn-Rhein-Sieg, 03.01.2018
+--
+-- Generics use_files = false, frames = 3: cena sintética (fundo escuro e
+-- duas faixas claras a 45° e 135°). lane_hough busca as faixas no primeiro
+-- frame, marca-as no segundo (que já vota só no acumulador fino delas) e
+-- no terceiro marca as achadas no acumulador fino; o teste confere que o verde do
+-- último frame cai só sobre as duas faixas. run_sim_lane.bat roda as duas
+-- simulações com GHDL (lane_g_root_IP precisa de altera_mf):
+--   ghdl -r --std=08 -frelaxed -P<altera_mf compilada> sim_lane -guse_files=false -gframes=3
 
 library IEEE;
 use IEEE.STD_LOGIC_1164.all;
@@ -12,6 +20,10 @@ use std.textio.all;
 use ieee.std_logic_textio.all;
 
 entity sim_lane is
+  generic (
+    use_files : boolean := true;        -- false: cena sintética, sem arquivos
+    frames    : integer := 1            -- 3 com a cena sintética (rastreamento no terceiro)
+  );
 end sim_lane;
 
 architecture sim of sim_lane is
@@ -24,6 +36,12 @@ architecture sim of sim_lane is
   constant y_size            : integer := 720;   -- vertical size of image
   constant x_blank           : integer := 100;   -- horizontal blanking
   constant trail             : integer := 1000;  -- clock cycles after active image
+  -- faixas da cena sintética: x + y e x - y nestes intervalos, de y_top a y_bottom
+  constant left_sum          : integer := 1000;
+  constant right_diff        : integer := 300;
+  constant lane_width        : integer := 6;
+  constant y_top             : integer := 400;
+  constant y_bottom          : integer := 700;
 
 -- signals of testbench
   signal clk       : std_logic := '0';
@@ -47,6 +65,17 @@ architecture sim of sim_lane is
   signal end_tb    : integer   := 0;
   signal mismatch  : integer   := 0;
 
+  -- pixel da cena sintética
+  function synthetic (x, y : integer) return std_logic_vector is
+  begin
+    if y >= y_top and y <= y_bottom and
+       ((x + y >= left_sum and x + y < left_sum + lane_width) or
+        (x - y >= right_diff and x - y < right_diff + lane_width)) then
+      return x"DC";                     -- faixa
+    end if;
+    return x"28";                       -- asfalto
+  end function;
+
 begin
 
 -- clock generation
@@ -96,10 +125,13 @@ begin
 -- wait for reset
     wait for 100 ns;
 
-    file_open(stimuli_status, stimuli_file, stimuli_filename, read_mode);
-    readline(stimuli_file, l);          -- read first line with comments
+    if use_files then
+      file_open(stimuli_status, stimuli_file, stimuli_filename, read_mode);
+      readline(stimuli_file, l);        -- read first line with comments
+    end if;
 
--- loop for one frame
+-- loop for frames
+    for frame in 0 to frames-1 loop
     for y in 0 to y_size-1 loop
       if (y = 0) then
         vs_in <= '1';
@@ -115,10 +147,16 @@ begin
       hs_in <= '0';
       de_in <= '1';
       for x in 0 to x_size-1 loop
-        readline(stimuli_file, l);      -- read one line
-        hread(l, r);
-        hread(l, g);
-        hread(l, b);
+        if use_files then
+          readline(stimuli_file, l);    -- read one line
+          hread(l, r);
+          hread(l, g);
+          hread(l, b);
+        else
+          r := synthetic(x, y);
+          g := r;
+          b := r;
+        end if;
         r_in <= r;
         g_in <= g;
         b_in <= b;
@@ -131,6 +169,7 @@ begin
       b_in  <= "00000000";
 
     end loop;  -- y
+    end loop;  -- frame
 
 -- simulation for trailing clock cycles
     for i in 0 to trail-1 loop
@@ -138,7 +177,9 @@ begin
     end loop;
 
     end_tb <= 1;                        -- signal to close response_file
-    file_close(stimuli_file);
+    if use_files then
+      file_close(stimuli_file);
+    end if;
     wait for 20 ns;
 
 -- stop simulation
@@ -157,6 +198,11 @@ begin
 -- second process to handle DUT output
   response_process : process
     variable x_pos, y_pos     : integer := 0;
+    variable frame            : integer := 0;
+-- verde da cena sintética: perto de cada faixa e fora delas
+    variable green_left       : integer := 0;
+    variable green_right      : integer := 0;
+    variable green_stray      : integer := 0;
 -- variables for writing simulated response
     file response_file        : text;
     variable l                : line;
@@ -175,14 +221,16 @@ begin
     write (l, string'("# Output from edupow-testbench"));
     writeline(response_file, l);        -- write first line with comments
 -- open file for expected data
-    file_open(expected_status, expected_file, expected_filename, read_mode);
-    readline(expected_file, l_ex);      -- read first line with comments
+    if use_files then
+      file_open(expected_status, expected_file, expected_filename, read_mode);
+      readline(expected_file, l_ex);    -- read first line with comments
+    end if;
 
     wait until (hs_out = '1');
 
     while (end_tb /= 1) loop
       wait until falling_edge(clk);
-      if (de_out = '1') then
+      if (de_out = '1' and frame = frames-1) then
 
         -- get response and write to response file
         if (x_pos >= 2 and y_pos >= 2) then
@@ -203,12 +251,30 @@ begin
         hwrite(l, b);
         writeline(response_file, l);
 
+        -- pixel verde do overlay (faixa detectada)
+        if not use_files and r = x"00" and g = x"FF" and b = x"00" then
+          if y_pos >= y_top - 2 and y_pos <= y_bottom + 2 and
+             abs(x_pos + y_pos - (left_sum + lane_width/2)) <= 8 then
+            green_left := green_left + 1;
+          elsif y_pos >= y_top - 2 and y_pos <= y_bottom + 2 and
+                abs(x_pos - y_pos - (right_diff + lane_width/2)) <= 8 then
+            green_right := green_right + 1;
+          else
+            green_stray := green_stray + 1;
+            assert false
+              report "verde fora das faixas em x=" & integer'image(x_pos) & " y=" & integer'image(y_pos)
+              severity note;
+          end if;
+        end if;
+
         -- read expected response and compare to simulation response
-        readline(expected_file, l_ex);  -- read one line
-        hread(l_ex, r_ex);
-        hread(l_ex, g_ex);
-        hread(l_ex, b_ex);
-        if (x_pos >= 2 and y_pos >= 2) then
+        if use_files then
+          readline(expected_file, l_ex);  -- read one line
+          hread(l_ex, r_ex);
+          hread(l_ex, g_ex);
+          hread(l_ex, b_ex);
+        end if;
+        if use_files and (x_pos >= 2 and y_pos >= 2) then
           -- check only if valid data
           if (r /= r_ex) or (g /= g_ex) or (b /= b_ex) then
             mismatch <= mismatch + 1;
@@ -224,11 +290,32 @@ begin
           x_pos := 0;
         end if;
 
+      elsif (de_out = '1') then
+        -- frames anteriores: só contam posição
+        x_pos := x_pos + 1;
+        if x_pos = x_size then
+          y_pos := y_pos + 1;
+          x_pos := 0;
+        end if;
+      end if;
+      if y_pos = y_size then
+        frame := frame + 1;
+        y_pos := 0;
       end if;
     end loop;
 
+    if not use_files then
+      report "verde: faixa esquerda " & integer'image(green_left) & ", direita " &
+        integer'image(green_right) & ", fora " & integer'image(green_stray);
+      if green_left < 100 or green_right < 100 or green_stray /= 0 then
+        mismatch <= mismatch + 1;
+      end if;
+    end if;
+
     file_close(response_file);
-    file_close(expected_file);
+    if use_files then
+      file_close(expected_file);
+    end if;
     wait until (end_tb = 2);
 
   end process;
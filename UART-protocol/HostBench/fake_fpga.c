@@ -0,0 +1,395 @@
+// fake_fpga.c
+// FPGA simulado (ver fake_fpga.h)
+
+#include "fake_fpga.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hough_link.h"
+
+#define FAKE_ACC_RHO_MAX 512  // 2·⌈128·√2⌉+1 = 365 no maior FRAME_SIZE
+#define FAKE_MAX_K 8          // MAX_LINES do maior motor (FRAME_MAX_LINES)
+#define FAKE_REORDER_MAX 16   // Respostas retidas no máximo (fake_fpga_set_reorder)
+#define FAKE_IDLE_MS 1        // Link parado por tanto tempo: solta as retidas
+
+// LUT do RTL: sin/cos × 256 para θ = k · 11.25°
+static const int16_t sin_lut[FAKE_THETA_BINS] = {
+    0, 50, 98, 142, 181, 213, 237, 251, 256, 251, 237, 213, 181, 142, 98, 50
+};
+static const int16_t cos_lut[FAKE_THETA_BINS] = {
+    256, 251, 237, 213, 181, 142, 98, 50, 0, -50, -98, -142, -181, -213, -237, -251
+};
+
+// Top-K de um banco θ (bk_* em hough_transform.sv)
+typedef struct {
+    uint8_t valid[FAKE_MAX_K];
+    int16_t rho[FAKE_MAX_K];
+    uint8_t votes[FAKE_MAX_K];
+} FakeBank;
+
+int fake_hough(const uint8_t* packed, const uint8_t* theta, int window, int img_size, int signed_rho, int max_lines,
+               FakeLine* out) {
+    static uint8_t acc[FAKE_THETA_BINS][FAKE_ACC_RHO_MAX];
+    FakeBank bank[FAKE_THETA_BINS];
+    const int rho_max = (img_size * 362 + 255) / 256;
+    const int rho_ofs = signed_rho ? rho_max : 0;
+    const int acc_rho = signed_rho ? 2 * rho_max + 1 : 16;
+    const int vote_max = signed_rho ? 255 : 63;  // VOTE_W = 8 ou 6
+    const int img_bytes = img_size * img_size / 8;
+
+    memset(acc, 0, sizeof(acc));
+    memset(bank, 0, sizeof(bank));
+
+    // VOTE: pixels em ordem de índice (byte a byte, bit menos significativo antes)
+    for (int b = 0; b < img_bytes; b++) {
+        for (uint8_t bits = packed[b]; bits; bits &= bits - 1) {
+            int idx = b * 8 + __builtin_ctz(bits);
+            int x = idx % img_size, y = idx / img_size;
+            int dir = theta ? theta[idx] & (FAKE_THETA_BINS - 1) : 0;
+
+            for (int t = 0; t < FAKE_THETA_BINS; t++) {
+                // vote_mask: dir_dist = t - vote_dir em 4 bits
+                int dist = (t - dir) & (FAKE_THETA_BINS - 1);
+                if (theta && window < FAKE_THETA_BINS / 2 && dist > window && dist < FAKE_THETA_BINS - window) {
+                    continue;
+                }
+
+                // Divisão com sinal do SystemVerilog: trunca em direção a zero
+                int bin = (x * cos_lut[t] + y * sin_lut[t]) / 256 + rho_ofs;
+                if (bin < 0) bin = 0;
+                if (bin >= acc_rho) bin = acc_rho - 1;
+
+                uint8_t* cell = &acc[t][bin];
+                if (*cell < vote_max) (*cell)++;
+
+                FakeBank* bk = &bank[t];
+                int hit = -1, free_k = -1, min_k = 0;
+                for (int k = 0; k < max_lines; k++) {
+                    if (bk->valid[k] && bk->rho[k] == bin) hit = k;
+                    if (!bk->valid[k] && free_k < 0) free_k = k;
+                    if (bk->votes[k] < bk->votes[min_k]) min_k = k;
+                }
+                if (hit >= 0) {
+                    bk->votes[hit] = *cell;
+                } else if (free_k >= 0) {
+                    bk->valid[free_k] = 1;
+                    bk->rho[free_k] = (int16_t)bin;
+                    bk->votes[free_k] = *cell;
+                } else if (*cell > bk->votes[min_k]) {
+                    bk->rho[min_k] = (int16_t)bin;
+                    bk->votes[min_k] = *cell;
+                }
+            }
+        }
+    }
+
+    // MERGE_PEAKS: bancos em ordem de θ, slots em ordem de índice
+    int count = 0;
+    for (int t = 0; t < FAKE_THETA_BINS; t++) {
+        for (int k = 0; k < max_lines; k++) {
+            if (!bank[t].valid[k] || bank[t].votes[k] < FAKE_VOTE_THRESHOLD) continue;
+            FakeLine cand = { (int16_t)(bank[t].rho[k] - rho_ofs),
+                              (uint8_t)((t * 180) / FAKE_THETA_BINS), bank[t].votes[k] };
+            if (count < max_lines) {
+                out[count++] = cand;
+            } else {
+                int m_min = 0;
+                for (int i = 1; i < max_lines; i++) {
+                    if (out[i].votes < out[m_min].votes) m_min = i;
+                }
+                if (cand.votes > out[m_min].votes) out[m_min] = cand;
+            }
+        }
+    }
+    return count;
+}
+
+// ========== E/S ==========
+
+typedef struct {
+    int fd_in, fd_out;
+    uint8_t rx[4096];
+    size_t rx_len, rx_pos;
+    uint8_t tx[1024];
+    size_t tx_len;
+} FakeIo;
+
+static void io_flush(FakeIo* io) {
+    size_t done = 0;
+    while (done < io->tx_len) {
+        ssize_t n = write(io->fd_out, io->tx + done, io->tx_len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    io->tx_len = 0;
+}
+
+static void io_put(FakeIo* io, uint8_t byte) {
+    if (io->tx_len == sizeof(io->tx)) io_flush(io);
+    io->tx[io->tx_len++] = byte;
+}
+
+// ========== ORDEM DE CONCLUSÃO ==========
+// A matriz de motores responde na ordem em que os tiles terminam, não na
+// de chegada. Com reorder_depth > 0 as respostas de tile com tag (sem CRC)
+// ficam retidas e saem em ordem inversa quando juntam reorder_depth, quando
+// chega outro tipo de comando ou quando o link fica FAKE_IDLE_MS parado.
+typedef struct {
+    uint8_t bytes[2 + TILE_LINE_BYTES * MAX_LINES_PER_TILE];
+    int len;
+} HeldReply;
+
+static int reorder_depth = 0;
+static HeldReply held[FAKE_REORDER_MAX];
+static int held_count = 0;
+
+void fake_fpga_set_reorder(int depth) {
+    reorder_depth = depth < 0 ? 0 : depth > FAKE_REORDER_MAX ? FAKE_REORDER_MAX : depth;
+}
+
+static void held_release(FakeIo* io) {
+    while (held_count > 0) {
+        const HeldReply* r = &held[--held_count];
+        for (int i = 0; i < r->len; i++) io_put(io, r->bytes[i]);
+    }
+}
+
+// Próximo byte recebido (-1: EOF). Antes de bloquear, entrega as
+// respostas acumuladas, como o FPGA que transmite enquanto recebe.
+static int io_get(FakeIo* io) {
+    if (io->rx_pos == io->rx_len) {
+        if (held_count > 0) {
+            struct pollfd pfd = { io->fd_in, POLLIN, 0 };
+            if (poll(&pfd, 1, FAKE_IDLE_MS) == 0) held_release(io);
+        }
+        io_flush(io);
+        ssize_t n;
+        do {
+            n = read(io->fd_in, io->rx, sizeof(io->rx));
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) return -1;
+        io->rx_len = (size_t)n;
+        io->rx_pos = 0;
+    }
+    return io->rx[io->rx_pos++];
+}
+
+// Lê n bytes; false no EOF
+static bool io_read(FakeIo* io, uint8_t* buf, int n) {
+    for (int i = 0; i < n; i++) {
+        int c = io_get(io);
+        if (c < 0) return false;
+        buf[i] = (uint8_t)c;
+    }
+    return true;
+}
+
+// ========== TELEMETRIA (STATS_CMD) ==========
+// Registro do último resultado transmitido. Sem relógio, os ciclos seguem
+// o RTL: VOTE gasta 1 ciclo por borda ou byte vazio, mais a carga do
+// primeiro byte e o esvaziamento do pipeline; a junção, 1 ciclo por θ; RX
+// e TX, o tempo de fio na taxa atual (RX do header ao último byte).
+static uint8_t stats_rec[STATS_BYTES];
+static uint8_t stats_seq = 0;
+static uint32_t clks_per_bit = FPGA_CLK_HZ / BAUD_RATE;
+
+static void put_be(uint8_t* out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out[i] = (uint8_t)(value >> (8 * (bytes - 1 - i)));
+}
+
+static void stats_record(const uint8_t* packed, int img_bytes, int tag, uint8_t flags,
+                         int rx_bytes, int tx_bytes) {
+    uint32_t edges = 0, vote = 2;
+    for (int b = 0; b < img_bytes; b++) {
+        int k = __builtin_popcount(packed[b]);
+        edges += k;
+        vote += k ? k : 1;
+    }
+    stats_seq++;
+    stats_rec[0] = stats_seq;
+    stats_rec[1] = (uint8_t)(tag < 0 ? 0 : tag);
+    stats_rec[2] = flags;
+    put_be(&stats_rec[3], edges, 2);
+    put_be(&stats_rec[5], vote, 2);
+    put_be(&stats_rec[7], FAKE_THETA_BINS, 2);
+    put_be(&stats_rec[9], (uint32_t)(rx_bytes - 1) * 10u * clks_per_bit, 4);
+    put_be(&stats_rec[13], (uint32_t)tx_bytes * 10u * clks_per_bit, 4);
+}
+
+// ========== COMANDOS ==========
+
+// Resposta de tile: [tag] num_lines [ρ, θ, votes]... [crc]. rx_bytes: tamanho
+// do comando (ou registro do lote) que trouxe o tile, para a telemetria.
+static void reply_tile(FakeIo* io, const uint8_t packed[IMG_BYTES_PACKED], const uint8_t* theta, int window,
+                       int tag, bool crc, int rx_bytes) {
+    FakeLine lines[MAX_LINES_PER_TILE];
+    int n = fake_hough(packed, theta, window, TILE_SIZE, 0, MAX_LINES_PER_TILE, lines);
+    uint8_t c = 0;
+    uint8_t reply[2 + TILE_LINE_BYTES * MAX_LINES_PER_TILE];
+    int len = 0;
+
+    if (tag >= 0) reply[len++] = (uint8_t)tag;
+    reply[len++] = (uint8_t)n;
+    for (int i = 0; i < n; i++) {
+        reply[len++] = (uint8_t)lines[i].rho;
+        reply[len++] = lines[i].theta;
+        reply[len++] = lines[i].votes;
+    }
+    if (reorder_depth > 0 && tag >= 0 && !crc) {
+        HeldReply* r = &held[held_count++];
+        memcpy(r->bytes, reply, (size_t)len);
+        r->len = len;
+        if (held_count == reorder_depth) held_release(io);
+    } else {
+        for (int i = 0; i < len; i++) {
+            io_put(io, reply[i]);
+            c = crc8_update(c, reply[i]);
+        }
+        if (crc) io_put(io, c);
+    }
+
+    uint8_t flags = (uint8_t)((tag >= 0 ? STATS_TAGGED : 0) | (crc ? STATS_BATCH : 0));
+    stats_record(packed, IMG_BYTES_PACKED, tag, flags, rx_bytes, len + (crc ? 1 : 0));
+}
+
+// Lista x<<4|y → bitmap (pixels repetidos só acendem o mesmo bit)
+static void coords_to_packed(const uint8_t* coords, int n, uint8_t packed[IMG_BYTES_PACKED]) {
+    memset(packed, 0, IMG_BYTES_PACKED);
+    for (int i = 0; i < n; i++) {
+        int idx = (coords[i] & 0x0F) * WIDTH + (coords[i] >> 4);
+        packed[idx / 8] |= (uint8_t)(1u << (idx % 8));
+    }
+}
+
+// Lote 0xAE: cabeçalho com CRC, depois um registro por tile; cada registro
+// é respondido com tag {seq, idx}, ou NAK se o CRC não bate
+static bool serve_batch(FakeIo* io) {
+    uint8_t hdr[3];
+    if (!io_read(io, hdr, 3)) return false;
+    if (hdr[2] != crc8_update(crc8_update(0, hdr[0]), hdr[1]) || hdr[1] == 0) return true;
+
+    for (int r = 0; r < hdr[1]; r++) {
+        uint8_t rec[2 + IMG_BYTES_PACKED + 1];
+        uint8_t packed[IMG_BYTES_PACKED];
+        if (!io_read(io, rec, 2)) return false;
+        int len = (rec[1] == BATCH_BITMAP) ? IMG_BYTES_PACKED : rec[1];
+        if (len > IMG_BYTES_PACKED || !io_read(io, &rec[2], len + 1)) return false;
+
+        int tag = ((hdr[0] & 0x0F) << 4) | (rec[0] & 0x0F);
+        if (rec[2 + len] != crc8_block(rec, 2 + len)) {
+            uint8_t nak[2] = { (uint8_t)tag, BATCH_RETRY };
+            io_put(io, nak[0]);
+            io_put(io, nak[1]);
+            io_put(io, crc8_block(nak, 2));
+            continue;
+        }
+        if (rec[1] == BATCH_BITMAP) {
+            memcpy(packed, &rec[2], IMG_BYTES_PACKED);
+        } else {
+            coords_to_packed(&rec[2], len, packed);
+        }
+        reply_tile(io, packed, NULL, ORIENT_ALL, tag, true, 3 + len);
+    }
+    return true;
+}
+
+void fake_fpga_serve(int fd_in, int fd_out) {
+    static FakeIo io;
+    uint8_t buf[FRAME_BYTES_PACKED];
+    int cmd;
+
+    io.fd_in = fd_in;
+    io.fd_out = fd_out;
+    io.rx_len = io.rx_pos = io.tx_len = 0;
+
+    held_count = 0;
+    while ((cmd = io_get(&io)) >= 0) {
+        bool ok = true;
+        // Só tiles com tag podem ultrapassar uns aos outros
+        if (cmd != TAGGED_HEADER && cmd != SPARSE_CMD && cmd != ORIENT_CMD) held_release(&io);
+        switch (cmd) {
+            case HEADER_BYTE:
+                ok = io_read(&io, buf, IMG_BYTES_PACKED);
+                if (ok) reply_tile(&io, buf, NULL, ORIENT_ALL, -1, false, 1 + IMG_BYTES_PACKED);
+                break;
+            case TAGGED_HEADER:
+                ok = io_read(&io, buf, 1 + IMG_BYTES_PACKED);
+                if (ok) reply_tile(&io, &buf[1], NULL, ORIENT_ALL, buf[0], false, 2 + IMG_BYTES_PACKED);
+                break;
+            case SPARSE_CMD: {
+                uint8_t hdr[2], packed[IMG_BYTES_PACKED];
+                ok = io_read(&io, hdr, 2) && io_read(&io, buf, hdr[1]);
+                if (ok) {
+                    coords_to_packed(buf, hdr[1], packed);
+                    reply_tile(&io, packed, NULL, ORIENT_ALL, hdr[0], false, 3 + hdr[1]);
+                }
+                break;
+            }
+            case ORIENT_CMD: {
+                // Pares (x<<4|y, θ): o θ vai para theta[y·16 + x], como
+                // sparse_theta no RTL (pixel repetido: vale o último)
+                uint8_t hdr[3], packed[IMG_BYTES_PACKED], coords[ORIENT_MAX_EDGES], theta[TILE_PIXELS];
+                ok = io_read(&io, hdr, 3) && io_read(&io, buf, 2 * hdr[2]);
+                if (ok) {
+                    memset(theta, 0, sizeof(theta));
+                    for (int i = 0; i < hdr[2]; i++) {
+                        coords[i] = buf[2 * i];
+                        theta[(buf[2 * i] & 0x0F) * WIDTH + (buf[2 * i] >> 4)] = buf[2 * i + 1] & 0x0F;
+                    }
+                    coords_to_packed(coords, hdr[2], packed);
+                    reply_tile(&io, packed, theta, hdr[1], hdr[0], false, 4 + 2 * hdr[2]);
+                }
+                break;
+            }
+            case BATCH_CMD:
+                ok = serve_batch(&io);
+                break;
+            case FRAME_CMD: {
+                FakeLine lines[MAX_LINES_PER_FRAME];
+                ok = io_read(&io, buf, FRAME_BYTES_PACKED);
+                if (!ok) break;
+                int n = fake_hough(buf, NULL, ORIENT_ALL, FRAME_RTL_SIZE, 1, MAX_LINES_PER_FRAME, lines);
+                io_put(&io, (uint8_t)n);
+                for (int i = 0; i < n; i++) {
+                    io_put(&io, (uint8_t)((uint16_t)lines[i].rho >> 8));
+                    io_put(&io, (uint8_t)lines[i].rho);
+                    io_put(&io, lines[i].theta);
+                    io_put(&io, lines[i].votes);
+                }
+                stats_record(buf, FRAME_BYTES_PACKED, -1, STATS_FRAME, 1 + FRAME_BYTES_PACKED,
+                             1 + FRAME_LINE_BYTES * n);
+                break;
+            }
+            case STATUS_CMD:
+                io_put(&io, READY_BYTE);  // Atende em ordem: nunca há nada pendente
+                break;
+            case BAUD_CMD: {
+                // Não há fio: aceita qualquer divisor válido e só muda a
+                // conta de ciclos da telemetria
+                uint8_t div[2];
+                ok = io_read(&io, div, 2);
+                if (!ok) break;
+                int d = (div[0] << 8) | div[1];
+                io_put(&io, d >= FPGA_MIN_CLKS_PER_BIT ? ACK_BYTE : NAK_BYTE);
+                if (d >= FPGA_MIN_CLKS_PER_BIT) clks_per_bit = (uint32_t)d;
+                break;
+            }
+            case STATS_CMD:
+                for (int i = 0; i < STATS_BYTES; i++) io_put(&io, stats_rec[i]);
+                io_put(&io, crc8_block(stats_rec, STATS_BYTES));
+                break;
+            case BAUD_CONFIRM:
+                io_put(&io, BAUD_CONFIRM);
+                break;
+            default:
+                break;  // Fora de comando: o RTL também descarta
+        }
+        if (!ok) break;
+    }
+    held_release(&io);
+    io_flush(&io);
+}
@@ -0,0 +1,40 @@
+// fake_fpga.h
+// FPGA simulado: fala o mesmo protocolo de uart_echo_colorlight_i9.sv
+// (0xAA/0xAB/0xAD/0xAE/0xAF de tiles, 0xAC da imagem inteira, 0xA5 de estado,
+// 0xA6/0xA7 de troca de taxa, 0xA8 de telemetria) sobre um par de
+// descritores (pipe ou pty).
+// O Hough segue hough_transform.sv: mesma LUT, mesmo ρ truncado, mesmo
+// top-K por banco θ e mesma junção, então as respostas batem com as do RTL.
+
+#ifndef FAKE_FPGA_H
+#define FAKE_FPGA_H
+
+#include <stdint.h>
+
+#define FAKE_THETA_BINS 16
+#define FAKE_VOTE_THRESHOLD 5
+
+typedef struct {
+    int16_t rho;    // Bin (tiles) ou pixels com sinal (imagem inteira)
+    uint8_t theta;  // Graus
+    uint8_t votes;
+} FakeLine;
+
+// Hough de uma imagem img_size × img_size empacotada (pixel_idx = row *
+// img_size + col, bit idx % 8 do byte idx / 8). theta (NULL: sem
+// orientação) traz o bin θ de cada pixel, que então só vota nos θ a até
+// window bins do seu (window ≥ 8: todos), como o vote_mask do RTL.
+// signed_rho: 0 = tiles (16 bins saturados), 1 = imagem inteira. Retorna
+// o número de linhas.
+int fake_hough(const uint8_t* packed, const uint8_t* theta, int window, int img_size, int signed_rho, int max_lines,
+               FakeLine* out);
+
+// Atende comandos lidos de fd_in e responde em fd_out até EOF
+void fake_fpga_serve(int fd_in, int fd_out);
+
+// Respostas de tile com tag fora de ordem, como na matriz de motores: até
+// depth (≤ 16) ficam retidas e saem invertidas. 0 (padrão): em ordem.
+// Chamar antes de fake_fpga_serve (ou de posix_link_spawn_fake).
+void fake_fpga_set_reorder(int depth);
+
+#endif  // FAKE_FPGA_H
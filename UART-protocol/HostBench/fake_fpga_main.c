@@ -0,0 +1,46 @@
+// fake_fpga_main.c
+// FPGA simulado avulso, para outros clientes além do hough_bench:
+//   fake_fpga          atende em stdin/stdout (ex.: socat, um pipe)
+//   fake_fpga --pty    cria um pty, imprime o caminho do escravo e atende
+//                      nele até ser encerrado (clientes podem ir e voltar)
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "fake_fpga.h"
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--pty") == 0) {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            perror("pty");
+            return 1;
+        }
+        // O próprio servidor segura o escravo aberto: sem cliente o master
+        // bloqueia em vez de devolver EIO
+        int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+        if (slave < 0) {
+            perror(ptsname(master));
+            return 1;
+        }
+        struct termios tio;
+        tcgetattr(slave, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+        printf("%s\n", ptsname(master));
+        fflush(stdout);
+        fake_fpga_serve(master, master);
+        return 0;
+    }
+    if (argc > 1) {
+        fprintf(stderr, "uso: %s [--pty]\n", argv[0]);
+        return 1;
+    }
+    fake_fpga_serve(STDIN_FILENO, STDOUT_FILENO);
+    return 0;
+}
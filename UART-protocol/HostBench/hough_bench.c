@@ -0,0 +1,794 @@
+// hough_bench.c
+// Benchmark do pipeline do firmware no host: o mesmo hough_core/hough_link
+// do Pico, com o FPGA simulado num processo filho. Para cada modo de envio
+// e cada padrão de teste 64×64, processa N frames completos (padrão →
+// tiles/empacotamento → link → conversão → junção → desenho) e relata
+// tiles/s, percentis da latência por frame e o tempo de CPU do host em
+// cada etapa. Os modos sw/swframe trocam o link pelo Hough em software
+// (hough_sw), a base contra a qual o ganho do FPGA é medido.
+//
+// --verify compara hough_sw com fake_hough (a transcrição direta do RTL)
+// em tiles (também orientados, ORIENT_CMD) e imagens aleatórias, com uma e
+// com várias threads.
+//
+// --telemetry faz a passada de telemetria do firmware (STATS_CMD depois de
+// cada tile e da imagem inteira) nos padrões 64×64, imprime o CSV que
+// gerar_graficos_resultados.py lê e confere os registros com as imagens.
+//
+// --stream WxH passa uma cena sintética W×H linha a linha pelo hough_stream,
+// uma vez pelo FPGA simulado e outra pelo hough_sw, e confere que as linhas
+// e os trechos juntados são os mesmos nos dois caminhos. Com --gray a cena
+// entra em cinza e passa pelo Sobel (hough_sobel) antes das faixas; com
+// --orient k os tiles vão orientados (janela ±k) e a mesma cena é rodada
+// também sem orientação, para comparar votos, detecções e linhas. Com
+// --reorder k o FPGA simulado devolve os tiles fora de ordem (até k
+// retidos, ver fake_fpga_set_reorder), como a matriz de motores.
+//
+// --cache roda os padrões 64×64 nos modos tiles e batch sem o cache de
+// tiles (hough_cache), com ele vazio e com ele cheio, confere que as
+// detecções são as mesmas, que no frame frio só o primeiro de cada tile
+// repetido vai ao fio e que a passada com o cache cheio não põe nada no
+// fio, e depois sorteia tiles de um conjunto maior que o cache e confere
+// cada resposta (do link ou do cache) com fake_hough. A tabela do
+// benchmark roda sem o cache: os frames se repetem.
+//
+// --sobel confere o Sobel em linhas (hough_sobel) com as máscaras 3×3
+// aplicadas pixel a pixel (bordas e orientação), em imagens, larguras e
+// limiares sorteados, e mede o custo por pixel num quadro 640×480.
+//
+//   hough_bench [-n frames] [-m tiles|batch|frame|sw|swframe] [-t threads] [--pty]
+//   hough_bench --verify rounds [-t threads]
+//   hough_bench --telemetry [--pty]
+//   hough_bench --stream WxH [--gray [--orient k]] [--reorder k] [--pty]
+//   hough_bench --cache [--pty]
+//   hough_bench --sobel rounds
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fake_fpga.h"
+#include "hough_cache.h"
+#include "hough_core.h"
+#include "hough_link.h"
+#include "hough_sobel.h"
+#include "hough_stream.h"
+#include "hough_sw.h"
+#include "link_posix.h"
+
+#define BENCH_DEFAULT_FRAMES 500
+// Sem fio de verdade: a taxa só entra nos prazos (WIRE_TIME_US)
+#define BENCH_LINK_BAUD 3125000
+
+typedef struct {
+    const char* name;
+    void (*process)(bool verbose);
+} BenchMode;
+
+static const BenchMode modes[] = {
+    { "tiles", process_frame_pipelined },  // 0xAB/0xAD com créditos
+    { "batch", process_frame_batched },    // Lote 0xAE com CRC
+    { "frame", process_frame_whole },      // Imagem inteira 0xAC
+    { "sw", process_frame_software },      // Tiles no Hough em software
+    { "swframe", process_frame_software_whole },  // Imagem inteira em software
+};
+#define MODE_COUNT (int)(sizeof(modes) / sizeof(modes[0]))
+
+typedef struct {
+    const char* name;
+    void (*create)(void);
+} BenchPattern;
+
+static const BenchPattern patterns[] = {
+    { "cruz", create_test_cross_64x64 },
+    { "diagonal", create_test_diagonal_64x64 },
+    { "retangulo", create_test_rectangle_64x64 },
+    { "X", create_test_x_pattern_64x64 },
+};
+#define PATTERN_COUNT (int)(sizeof(patterns) / sizeof(patterns[0]))
+
+static uint64_t clock_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Relógio de CPU do processo (todas as threads do hough_sw): as esperas
+// no poll() e nas variáveis de condição não contam
+static uint64_t process_cpu_ns(void) {
+    return clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+static int cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Percentil q (0..100) de um vetor já ordenado
+static uint64_t percentile(const uint64_t* sorted, int n, int q) {
+    return sorted[(int)((int64_t)(n - 1) * q / 100)];
+}
+
+// Roda frames frames de um padrão num modo e imprime uma linha da tabela
+static void bench_run(const BenchMode* mode, const BenchPattern* pattern, int frames,
+                      uint64_t* latency_ns) {
+    static char display[IMAGE_HEIGHT][IMAGE_WIDTH];
+    uint64_t pattern_ns = 0;
+    uint32_t bytes0 = link_tx_bytes;
+    int lines = 0;
+
+    memset(prof_ns, 0, sizeof(prof_ns));
+    uint64_t t_start = clock_ns(CLOCK_MONOTONIC);
+    for (int f = 0; f < frames; f++) {
+        uint64_t t0 = clock_ns(CLOCK_MONOTONIC);
+        uint64_t c0 = process_cpu_ns();
+        pattern->create();
+        pattern_ns += process_cpu_ns() - c0;
+
+        total_lines_detected = 0;
+        mode->process(false);
+        merge_detected_lines();
+        render_image_with_lines(display);
+        latency_ns[f] = clock_ns(CLOCK_MONOTONIC) - t0;
+        if (f == 0) lines = total_lines_detected;
+    }
+    double elapsed_s = (clock_ns(CLOCK_MONOTONIC) - t_start) / 1e9;
+    qsort(latency_ns, frames, sizeof(latency_ns[0]), cmp_u64);
+
+    printf("%-7s %-9s %6d | %9.0f %8.0f | %6.1f %6.1f %6.1f %7.1f | %6lu |",
+           mode->name, pattern->name, lines,
+           frames * GRID_TILES / elapsed_s, frames / elapsed_s,
+           percentile(latency_ns, frames, 50) / 1e3, percentile(latency_ns, frames, 90) / 1e3,
+           percentile(latency_ns, frames, 99) / 1e3, latency_ns[frames - 1] / 1e3,
+           (unsigned long)((link_tx_bytes - bytes0) / frames));
+    printf(" %6.2f", pattern_ns / 1e3 / frames);
+    for (int s = 0; s < STAGE_COUNT; s++) printf(" %6.2f", prof_ns[s] / 1e3 / frames);
+    printf("\n");
+}
+
+// ========== CONFERÊNCIA COM O MODELO DO RTL ==========
+
+// Resposta que o FPGA (fake_hough) daria, no formato de TileResult
+static void fake_to_result(const FakeLine* lines, int n, int line_bytes, TileResult* result) {
+    result->num_lines = (uint8_t)n;
+    for (int i = 0; i < n; i++) {
+        uint8_t* l = &result->lines[i * line_bytes];
+        if (line_bytes == FRAME_LINE_BYTES) *l++ = (uint8_t)((uint16_t)lines[i].rho >> 8);
+        l[0] = (uint8_t)lines[i].rho;
+        l[1] = lines[i].theta;
+        l[2] = lines[i].votes;
+    }
+}
+
+static bool same_result(const TileResult* a, const TileResult* b, int line_bytes) {
+    return a->num_lines == b->num_lines &&
+           memcmp(a->lines, b->lines, (size_t)a->num_lines * line_bytes) == 0;
+}
+
+static void set_pixel(uint8_t* packed, int img_size, int x, int y) {
+    int idx = y * img_size + x;
+    packed[idx / 8] |= (uint8_t)(1u << (idx % 8));
+}
+
+// Imagem aleatória: ruído de densidade sorteada (quase sempre esparso, às
+// vezes até a imagem cheia, que satura contadores e ρ) e algumas retas,
+// que disputam os slots do top-K
+static void random_image(uint8_t* packed, int img_size) {
+    int density = (rand() % 4 == 0) ? rand() % 101 : rand() % 16;  // %
+    memset(packed, 0, (size_t)img_size * img_size / 8);
+    for (int y = 0; y < img_size; y++) {
+        for (int x = 0; x < img_size; x++) {
+            if (rand() % 100 < density) set_pixel(packed, img_size, x, y);
+        }
+    }
+    for (int n = rand() % 4; n > 0; n--) {
+        int x0 = rand() % img_size, y0 = rand() % img_size;
+        int x1 = rand() % img_size, y1 = rand() % img_size;
+        int steps = abs(x1 - x0) > abs(y1 - y0) ? abs(x1 - x0) : abs(y1 - y0);
+        for (int i = 0; i <= steps; i++) {
+            int x = steps ? x0 + (x1 - x0) * i / steps : x0;
+            int y = steps ? y0 + (y1 - y0) * i / steps : y0;
+            set_pixel(packed, img_size, x, y);
+        }
+    }
+}
+
+// Orientação sorteada por pixel; retorna a janela sorteada (0..8, 8 = todos)
+static int random_theta(uint8_t theta[TILE_PIXELS]) {
+    for (int i = 0; i < TILE_PIXELS; i++) theta[i] = (uint8_t)(rand() % HOUGH_THETA_BINS);
+    return rand() % (HOUGH_THETA_BINS / 2 + 1);
+}
+
+// rounds frames de 16 tiles (pelo caminho paralelo, sem e com orientação)
+// e rounds imagens de tamanho e MAX_LINES sorteados; retorna o número de
+// divergências
+static int verify_sw(int rounds) {
+    static uint8_t packed[GRID_TILES][IMG_BYTES_PACKED];
+    static uint8_t theta[GRID_TILES][TILE_PIXELS];
+    static uint8_t image[HOUGH_SW_MAX_IMG * HOUGH_SW_MAX_IMG / 8];
+    TileResult got[GRID_TILES], want;
+    FakeLine ref[MAX_LINES_PER_FRAME];
+    int mismatches = 0;
+
+    srand(12345);
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < GRID_TILES; i++) random_image(packed[i], TILE_SIZE);
+        hough_sw_tiles((const uint8_t(*)[IMG_BYTES_PACKED])packed, GRID_TILES, got);
+        for (int i = 0; i < GRID_TILES; i++) {
+            int n = fake_hough(packed[i], NULL, ORIENT_ALL, TILE_SIZE, 0, MAX_LINES_PER_TILE, ref);
+            fake_to_result(ref, n, TILE_LINE_BYTES, &want);
+            if (!same_result(&got[i], &want, TILE_LINE_BYTES) && mismatches++ < 10) {
+                printf("  tile %d/%d: %d linhas, RTL %d\n", r, i, got[i].num_lines, want.num_lines);
+            }
+        }
+
+        // Mesmos tiles com orientação e janela sorteadas (uma por frame)
+        int window = 0;
+        for (int i = 0; i < GRID_TILES; i++) window = random_theta(theta[i]);
+        hough_sw_tiles_oriented((const uint8_t(*)[IMG_BYTES_PACKED])packed,
+                                (const uint8_t(*)[TILE_PIXELS])theta, window, GRID_TILES, got);
+        for (int i = 0; i < GRID_TILES; i++) {
+            // O tile cheio não cabe no ORIENT_CMD e vai como bitmap
+            const uint8_t* sent = tile_edges(packed[i]) <= ORIENT_MAX_EDGES ? theta[i] : NULL;
+            int n = fake_hough(packed[i], sent, window, TILE_SIZE, 0, MAX_LINES_PER_TILE, ref);
+            fake_to_result(ref, n, TILE_LINE_BYTES, &want);
+            if (!same_result(&got[i], &want, TILE_LINE_BYTES) && mismatches++ < 10) {
+                printf("  tile orientado %d/%d (±%d): %d linhas, RTL %d\n",
+                       r, i, window, got[i].num_lines, want.num_lines);
+            }
+        }
+
+        int size = 8 * (1 + rand() % (HOUGH_SW_MAX_IMG / 8));
+        int max_lines = 1 + rand() % MAX_LINES_PER_FRAME;
+        random_image(image, size);
+        hough_sw_image(image, size, max_lines, &got[0]);
+        int n = fake_hough(image, NULL, ORIENT_ALL, size, 1, max_lines, ref);
+        fake_to_result(ref, n, FRAME_LINE_BYTES, &want);
+        if (!same_result(&got[0], &want, FRAME_LINE_BYTES) && mismatches++ < 10) {
+            printf("  imagem %d (%dx%d, K=%d): %d linhas, RTL %d\n",
+                   r, size, size, max_lines, got[0].num_lines, want.num_lines);
+        }
+    }
+    printf("verify: %d tiles, %d orientados e %d imagens (até %dx%d), %d threads: %d divergências\n",
+           rounds * GRID_TILES, rounds * GRID_TILES, rounds, HOUGH_SW_MAX_IMG, HOUGH_SW_MAX_IMG,
+           hough_sw_threads(), mismatches);
+    return mismatches;
+}
+
+// ========== TELEMETRIA ==========
+
+// Passada de telemetria de cada padrão, em tiles e na imagem inteira (esta
+// só com IMAGE_IS_RTL_FRAME: FRAME_CMD não existe para outros tamanhos).
+// Retorna o número de registros faltando ou incoerentes (bordas diferentes
+// das da imagem, seq fora de ordem).
+static int run_telemetry(void) {
+    static TelemetryRecord records[GRID_TILES];
+    uint8_t packed[IMG_BYTES_PACKED];
+    int errors = 0, last_seq = -1;
+
+    telemetry_print_header();
+    for (int p = 0; p < PATTERN_COUNT; p++) {
+        patterns[p].create();
+        for (int whole = 0; whole < (IMAGE_IS_RTL_FRAME ? 2 : 1); whole++) {
+            uint16_t frame = (uint16_t)(p * 2 + whole);
+            uint64_t t0 = clock_ns(CLOCK_MONOTONIC);
+            int count;
+
+            total_lines_detected = 0;
+            if (whole) {
+                count = telemetry_collect_whole(frame, &records[0]) ? 1 : 0;
+                errors += 1 - count;
+            } else {
+                count = telemetry_collect_tiles(frame, records);
+                errors += GRID_TILES - count;
+            }
+            int raw_lines = total_lines_detected;
+
+            for (int i = 0; i < count; i++) {
+                const TelemetryRecord* rec = &records[i];
+                int edges = rec->tile < 0 ? image_edges()
+                                          : pack_tile(rec->tile % GRID_COLS, rec->tile / GRID_COLS, packed);
+                if (rec->fpga.edges != edges) errors++;
+                if (edges > 0) {
+                    if (last_seq >= 0 && rec->fpga.seq != (uint8_t)(last_seq + 1)) errors++;
+                    last_seq = rec->fpga.seq;
+                }
+                telemetry_print(rec);
+            }
+            merge_detected_lines();
+            telemetry_print_merged(frame, raw_lines, (uint32_t)((clock_ns(CLOCK_MONOTONIC) - t0) / 1000));
+        }
+    }
+    printf("# FIM\n");
+    fprintf(stderr, "telemetria: %d registros faltando ou incoerentes\n", errors);
+    return errors;
+}
+
+// ========== CACHE DE TILES ==========
+
+// Ordem das detecções brutas: as respostas do cache entram em all_lines
+// antes das que vêm do link
+static int cmp_line(const void* a, const void* b) {
+    const DetectedLine* x = a;
+    const DetectedLine* y = b;
+    if (x->tile_y != y->tile_y) return x->tile_y - y->tile_y;
+    if (x->tile_x != y->tile_x) return x->tile_x - y->tile_x;
+    if (x->theta_bin != y->theta_bin) return x->theta_bin - y->theta_bin;
+    if (x->rho != y->rho) return x->rho - y->rho;
+    return x->votes - y->votes;
+}
+
+// Um frame do padrão atual no modo: detecções brutas ordenadas em lines,
+// tempo e bytes no fio
+static int cache_frame(const BenchMode* mode, DetectedLine* lines, uint64_t* ns, uint32_t* bytes) {
+    uint32_t bytes0 = link_tx_bytes;
+    uint64_t t0 = clock_ns(CLOCK_MONOTONIC);
+
+    total_lines_detected = 0;
+    mode->process(false);
+    *ns = clock_ns(CLOCK_MONOTONIC) - t0;
+    *bytes = link_tx_bytes - bytes0;
+    memcpy(lines, all_lines, sizeof(DetectedLine) * total_lines_detected);
+    qsort(lines, total_lines_detected, sizeof(DetectedLine), cmp_line);
+    return total_lines_detected;
+}
+
+// Retorna o número de frames com detecções diferentes, frames frios em que
+// um tile repetido foi ao fio, passadas com o cache cheio que usaram o
+// link e tiles sorteados com resposta errada
+static int run_cache(void) {
+#if TILE_CACHE_ENTRIES == 0
+    printf("cache: build com TILE_CACHE_ENTRIES = 0\n");
+    return 0;
+#else
+    static DetectedLine want[MAX_LINES_TOTAL], got[MAX_LINES_TOTAL];
+    static uint8_t distinct[GRID_TILES][IMG_BYTES_PACKED];
+    uint8_t packed[IMG_BYTES_PACKED];
+    int errors = 0;
+
+    printf("modo    padrão    únicos | sem cache (us) | vazio (us) acertos | cheio (us) acertos bytes\n");
+    for (int m = 0; m < 2; m++) {  // modes[0] tiles, modes[1] batch
+        for (int p = 0; p < PATTERN_COUNT; p++) {
+            uint64_t ns[3];
+            uint32_t bytes[3], hits[3] = { 0, 0, 0 };
+            int tiles = 0, unique = 0;
+
+            patterns[p].create();
+            for (int i = 0; i < GRID_TILES; i++) {
+                if (pack_tile(i % GRID_COLS, i / GRID_COLS, packed) == 0) continue;
+                tiles++;
+                int j = 0;
+                while (j < unique && memcmp(distinct[j], packed, IMG_BYTES_PACKED) != 0) j++;
+                if (j == unique) memcpy(distinct[unique++], packed, IMG_BYTES_PACKED);
+            }
+
+            tile_cache_clear();
+            tile_cache_enabled = false;
+            int n = cache_frame(&modes[m], want, &ns[0], &bytes[0]);
+            tile_cache_enabled = true;
+            for (int pass = 1; pass < 3; pass++) {
+                uint32_t hits0 = tile_cache_stats.hits;
+                int k = cache_frame(&modes[m], got, &ns[pass], &bytes[pass]);
+                hits[pass] = tile_cache_stats.hits - hits0;
+                bool same = k == n;
+                for (int i = 0; i < n && same; i++) {
+                    same = cmp_line(&got[i], &want[i]) == 0 && got[i].global_rho_q8 == want[i].global_rho_q8;
+                }
+                if (!same) {
+                    printf("  %s/%s: %d detecções com o cache %s, %d sem\n", modes[m].name,
+                           patterns[p].name, k, pass == 1 ? "vazio" : "cheio", n);
+                    errors++;
+                }
+            }
+            // Cache vazio: só o primeiro de cada tile repetido vai ao fio, os
+            // outros esperam a resposta dele. Cheio: nada vai ao fio
+            if (hits[1] != (uint32_t)(tiles - unique)) {
+                printf("  %s/%s: %lu acertos no frame frio, %d tiles repetidos\n", modes[m].name,
+                       patterns[p].name, (unsigned long)hits[1], tiles - unique);
+                errors++;
+            }
+            if (hits[2] != (uint32_t)tiles || bytes[2] != 0) errors++;
+            printf("%-7s %-9s %2d/%2d | %14.1f | %10.1f %7lu | %10.1f %7lu %5lu\n", modes[m].name,
+                   patterns[p].name, unique, tiles, ns[0] / 1e3, ns[1] / 1e3, (unsigned long)hits[1],
+                   ns[2] / 1e3, (unsigned long)hits[2], (unsigned long)bytes[2]);
+        }
+    }
+
+    // Tiles sorteados de um conjunto 4× maior que o cache, metade dos
+    // sorteios num subconjunto que cabe nele: acertos, erros e
+    // substituições misturados, cada resposta conferida com o RTL
+    enum { POOL = 4 * TILE_CACHE_ENTRIES, DRAWS = 8 * POOL };
+    static uint8_t pool[POOL][IMG_BYTES_PACKED];
+    FakeLine ref[MAX_LINES_PER_TILE];
+    TileResult result, expected;
+    int mismatches = 0;
+
+    srand(777);
+    for (int i = 0; i < POOL; i++) {
+        do random_image(pool[i], TILE_SIZE); while (tile_edges(pool[i]) == 0);
+    }
+    tile_cache_clear();
+    for (int d = 0; d < DRAWS; d++) {
+        int i = rand() % (d % 2 ? POOL : TILE_CACHE_ENTRIES / 2);
+        if (!fpga_transact_tile(pool[i], &result)) {
+            mismatches++;
+            fpga_wait_ready();
+            continue;
+        }
+        int n = fake_hough(pool[i], NULL, ORIENT_ALL, TILE_SIZE, 0, MAX_LINES_PER_TILE, ref);
+        fake_to_result(ref, n, TILE_LINE_BYTES, &expected);
+        if (!same_result(&result, &expected, TILE_LINE_BYTES)) mismatches++;
+    }
+    const TileCacheStats* c = &tile_cache_stats;
+    printf("cache: %d tiles sorteados de %d (%d entradas): %lu acertos, %lu erros, %lu substituídos, "
+           "%d respostas erradas\n", DRAWS, POOL, TILE_CACHE_ENTRIES, (unsigned long)c->hits,
+           (unsigned long)c->misses, (unsigned long)c->evictions, mismatches);
+    if (c->hits == 0 || c->evictions == 0) errors++;
+    return errors + mismatches;
+#endif
+}
+
+// ========== ENTRADA EM FAIXAS ==========
+
+// Linha y da cena: vertical, horizontal, duas diagonais e um trecho curto
+// inclinado só na metade de baixo (aparece nas últimas faixas)
+static void stream_scene_row(int y, int width, int height, uint8_t* row) {
+    memset(row, 0, STREAM_ROW_BYTES(width));
+#define SCENE_SET(x) do { int x_ = (x); if (x_ >= 0 && x_ < width) row[x_ / 8] |= (uint8_t)(1u << (x_ % 8)); } while (0)
+    SCENE_SET(width / 3);
+    if (y == height / 2) {
+        for (int x = 0; x < width; x++) SCENE_SET(x);
+    }
+    SCENE_SET(y + width / 4);
+    SCENE_SET(width - 1 - y);
+    if (y > height / 2) SCENE_SET(width / 2 + (y - height / 2) / 2);
+#undef SCENE_SET
+}
+
+// Roda a cena inteira pelo hough_stream; retorna as linhas únicas. gray:
+// a cena em cinza (traços claros num fundo escuro) pelo Sobel do Pico
+static int stream_scene(int width, int height, bool use_fpga, bool gray) {
+    uint8_t row[STREAM_ROW_BYTES(STREAM_MAX_WIDTH)];
+    uint8_t gray_row[STREAM_MAX_WIDTH];
+
+    if (!(gray ? stream_begin_gray(width, use_fpga) : stream_begin(width, use_fpga))) return -1;
+    for (int y = 0; y < height; y++) {
+        stream_scene_row(y, width, height, row);
+        if (!gray) {
+            stream_push_row(row);
+            continue;
+        }
+        for (int x = 0; x < width; x++) gray_row[x] = (row[x / 8] >> (x % 8)) & 1 ? 220 : 30;
+        stream_push_gray_row(gray_row);
+    }
+    return stream_finish();
+}
+
+static void stream_report(const char* path) {
+    const StreamStats* st = &stream_stats;
+    printf("%-9s %4d faixas %5d tiles %5d detecções -> %3d linhas %3d trechos | "
+           "primeira em %6llu us, total %7llu us | %d perdidos\n",
+           path, st->bands, st->tiles_sent, st->raw_lines, total_lines_detected, total_segments,
+           (unsigned long long)(st->first_result_us ? st->first_result_us - st->start_us : 0),
+           (unsigned long long)(st->end_us - st->start_us), st->lost_tiles);
+}
+
+// Mesma cena pelo FPGA simulado e pelo hough_sw; retorna as diferenças
+static int run_stream(int width, int height, bool gray) {
+    static DetectedLine fpga_lines[MAX_LINES_TOTAL];
+    static LineSegment fpga_segments[MAX_SEGMENTS_TOTAL];
+    int mismatches = 0;
+
+    printf("=== hough_bench: entrada em faixas %dx%d%s%s (faixa de %u bytes) ===\n",
+           width, height, gray ? " em cinza" : "", gray && orient_window >= 0 ? ", orientada" : "",
+           (unsigned)(TILE_SIZE * STREAM_ROW_BYTES(width)));
+    int fpga_count = stream_scene(width, height, true, gray);
+    if (fpga_count < 0) {
+        fprintf(stderr, "largura %d não serve (até %d)\n", width, STREAM_MAX_WIDTH);
+        return 1;
+    }
+    stream_report("fpga");
+    int fpga_segment_count = total_segments;
+    int fpga_raw = stream_stats.raw_lines;
+    memcpy(fpga_lines, all_lines, sizeof(DetectedLine) * fpga_count);
+    memcpy(fpga_segments, line_segments, sizeof(LineSegment) * fpga_segment_count);
+    if (stream_stats.lost_tiles) mismatches += stream_stats.lost_tiles;
+
+    // Com a janela, todas as faixas votam orientadas, até a última, parcial
+    bool oriented = gray && orient_window >= 0;
+    if (oriented && stream_stats.oriented_tiles != stream_stats.tiles_sent) mismatches++;
+
+    stream_scene(width, height, false, gray);
+    stream_report("sw");
+    if (oriented && stream_stats.oriented_tiles != stream_stats.tiles_sent) mismatches++;
+
+    if (fpga_count != total_lines_detected || fpga_segment_count != total_segments ||
+        fpga_raw != stream_stats.raw_lines) {
+        mismatches++;
+    } else {
+        for (int i = 0; i < fpga_count; i++) {
+            const DetectedLine* a = &fpga_lines[i];
+            const DetectedLine* b = &all_lines[i];
+            if (a->theta_bin != b->theta_bin || a->global_rho_q8 != b->global_rho_q8 ||
+                a->votes != b->votes || a->merged != b->merged || a->total_votes != b->total_votes) {
+                mismatches++;
+            }
+        }
+        if (memcmp(fpga_segments, line_segments, sizeof(LineSegment) * fpga_segment_count) != 0) mismatches++;
+    }
+
+    // A mesma cena votando em todos os θ, para medir o que a janela poupa
+    if (oriented) {
+        int window = orient_window;
+        int votes = 0;
+        for (int t = 0; t < HOUGH_THETA_BINS; t++) votes += theta_in_window(t, 0, window);
+        orient_window = -1;
+        stream_scene(width, height, false, gray);
+        stream_report("sw 16θ");
+        orient_window = window;
+        printf("votos por borda: %d (±%d) em vez de %d, %.1fx menos\n",
+               votes, window, HOUGH_THETA_BINS, (double)HOUGH_THETA_BINS / votes);
+    }
+    fprintf(stderr, "stream: %d diferenças entre FPGA simulado e hough_sw\n", mismatches);
+    return mismatches;
+}
+
+// ========== SOBEL ==========
+
+// Referência: as duas máscaras aplicadas pixel a pixel, bordas zeradas.
+// grad (opcional) recebe gx, gy.
+static bool sobel_ref_pixel(const uint8_t* gray, int width, int height, int x, int y, int grad[2]) {
+    static const int kx[3][3] = {{-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1}};
+    static const int ky[3][3] = {{-1, -2, -1}, {0, 0, 0}, {1, 2, 1}};
+    int gx = 0, gy = 0;
+
+    if (x == 0 || y == 0 || x == width - 1 || y == height - 1) return false;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int v = gray[(y + dy) * width + x + dx];
+            gx += kx[dy + 1][dx + 1] * v;
+            gy += ky[dy + 1][dx + 1] * v;
+        }
+    }
+    if (grad) {
+        grad[0] = gx;
+        grad[1] = gy;
+    }
+    return abs(gx) + abs(gy) > sobel_threshold;
+}
+
+// O bin de orientação tem de ser o θ da LUT do Hough em que o gradiente
+// mais se projeta (|gx·cos + gy·sin|); perto da fronteira entre dois bins
+// as projeções quase empatam e qualquer um dos dois serve
+static bool sobel_theta_ok(int gx, int gy, int bin) {
+    int best = 0;
+    for (int t = 0; t < HOUGH_THETA_BINS; t++) {
+        int p = abs(gx * hough_cos_q8[t] + gy * hough_sin_q8[t]);
+        if (p > best) best = p;
+    }
+    int got = abs(gx * hough_cos_q8[bin] + gy * hough_sin_q8[bin]);
+    return (int64_t)got * 100 >= (int64_t)best * 99;
+}
+
+// Cinza sorteado: ruído, degraus e rampas, para os limiares pegarem as
+// duas coisas (bordas fortes e gradientes fracos)
+static void random_gray(uint8_t* gray, int width, int height) {
+    int noise = rand() % 64;
+    int step_x = rand() % (width + 1), ramp = rand() % 8;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int v = (x < step_x ? 40 : 200) + ramp * (y - x) + (noise ? rand() % noise : 0);
+            if (rand() % 32 == 0) v = rand() % 256;
+            gray[y * width + x] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+        }
+    }
+}
+
+// Compara uma linha de bordas (e as orientações das bordas, theta) com a
+// referência, e o enchimento depois de width, que tem de sair zerado;
+// retorna as diferenças
+static int sobel_check_row(const uint8_t* gray, int width, int height, int y, const bitmap_word_t* edges,
+                           const uint8_t* theta) {
+    int words = (width + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+    int diffs = 0;
+    int grad[2];
+
+    for (int x = 0; x < words * BITMAP_WORD_BITS; x++) {
+        bool want = x < width && sobel_ref_pixel(gray, width, height, x, y, grad);
+        bool got = (edges[x / BITMAP_WORD_BITS] >> (x % BITMAP_WORD_BITS)) & 1;
+        if (got != want) {
+            diffs++;
+        } else if (want && theta && (theta[x] >= HOUGH_THETA_BINS || !sobel_theta_ok(grad[0], grad[1], theta[x]))) {
+            diffs++;
+        }
+    }
+    return diffs;
+}
+
+// rounds imagens de tamanho e limiar sorteados pelo caminho em linhas e
+// uma IMAGE_WIDTH × IMAGE_HEIGHT por image_from_gray; retorna as diferenças
+static int verify_sobel(int rounds) {
+    enum { MAX_HEIGHT = 48, TIMED_WIDTH = 640, TIMED_HEIGHT = 480, TIMED_FRAMES = 20 };
+    static uint8_t gray[MAX_HEIGHT * SOBEL_MAX_WIDTH];
+    static uint8_t image_gray[IMAGE_HEIGHT * IMAGE_WIDTH];
+    static uint8_t timed[TIMED_HEIGHT * TIMED_WIDTH];
+    static bitmap_word_t edges[SOBEL_ROW_WORDS];
+    static uint8_t theta[SOBEL_MAX_WIDTH];
+    static const uint16_t thresholds[] = {0, 64, SOBEL_THRESHOLD, 400, 1000};
+    int mismatches = 0;
+
+    srand(2468);
+    for (int r = 0; r < rounds; r++) {
+        int width = 1 + rand() % SOBEL_MAX_WIDTH;
+        int height = 1 + rand() % MAX_HEIGHT;
+        int rows = 0, diffs = 0;
+        sobel_threshold = thresholds[rand() % (int)(sizeof(thresholds) / sizeof(thresholds[0]))];
+        random_gray(gray, width, height);
+
+        sobel_begin(width);
+        for (int y = 0; y < height; y++) {
+            if (sobel_push_row(gray + y * width, edges, theta)) {
+                diffs += sobel_check_row(gray, width, height, rows++, edges, theta);
+            }
+        }
+        if (sobel_finish(edges)) diffs += sobel_check_row(gray, width, height, rows++, edges, NULL);
+        if (rows != height) diffs++;
+
+        random_gray(image_gray, IMAGE_WIDTH, IMAGE_HEIGHT);
+        image_from_gray(image_gray, IMAGE_WIDTH);
+        for (int y = 0; y < IMAGE_HEIGHT; y++) {
+            diffs += sobel_check_row(image_gray, IMAGE_WIDTH, IMAGE_HEIGHT, y, global_image[y], image_theta[y]);
+        }
+        if (diffs && mismatches++ < 10) {
+            printf("  imagem %d (%dx%d, limiar %u): %d pixels diferentes\n", r, width, height, sobel_threshold, diffs);
+        }
+    }
+
+    // Custo por pixel: quadro VGA inteiro, linha a linha
+    sobel_threshold = SOBEL_THRESHOLD;
+    random_gray(timed, TIMED_WIDTH, TIMED_HEIGHT);
+    uint64_t t0 = clock_ns(CLOCK_MONOTONIC);
+    for (int f = 0; f < TIMED_FRAMES; f++) {
+        sobel_begin(TIMED_WIDTH);
+        for (int y = 0; y < TIMED_HEIGHT; y++) sobel_push_row(timed + y * TIMED_WIDTH, edges, theta);
+        sobel_finish(edges);
+    }
+    uint64_t ns = clock_ns(CLOCK_MONOTONIC) - t0;
+
+    printf("sobel: %d imagens (até %dx%d) e %d de %dx%d: %d divergências; %dx%d em %.2f ns/pixel\n",
+           rounds, SOBEL_MAX_WIDTH, MAX_HEIGHT, rounds, IMAGE_WIDTH, IMAGE_HEIGHT, mismatches,
+           TIMED_WIDTH, TIMED_HEIGHT, (double)ns / ((double)TIMED_FRAMES * TIMED_WIDTH * TIMED_HEIGHT));
+    return mismatches;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "uso: %s [-n frames] [-m tiles|batch|frame|sw|swframe] [-t threads] [--pty]\n"
+                    "     %s --verify rounds [-t threads]\n"
+                    "     %s --telemetry [--pty]\n"
+                    "     %s --stream WxH [--gray [--orient k]] [--reorder k] [--pty]\n"
+                    "     %s --cache [--pty]\n"
+                    "     %s --sobel rounds\n", prog, prog, prog, prog, prog, prog);
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    int frames = BENCH_DEFAULT_FRAMES;
+    int only_mode = -1;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int verify_rounds = 0;
+    bool telemetry = false;
+    bool cache = false;
+    int stream_width = 0, stream_height = 0;
+    bool stream_gray = false;
+    int sobel_rounds = 0;
+    bool use_pty = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+            if (frames <= 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            for (int m = 0; m < MODE_COUNT; m++) {
+                if (strcmp(name, modes[m].name) == 0) only_mode = m;
+            }
+            if (only_mode < 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads <= 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "--verify") == 0 && i + 1 < argc) {
+            verify_rounds = atoi(argv[++i]);
+            if (verify_rounds <= 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "--telemetry") == 0) {
+            telemetry = true;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            cache = true;
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &stream_width, &stream_height) != 2 || stream_height <= 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "--gray") == 0) {
+            stream_gray = true;
+        } else if (strcmp(argv[i], "--orient") == 0 && i + 1 < argc) {
+            orient_window = atoi(argv[++i]);
+            if (orient_window < 0 || orient_window > HOUGH_THETA_BINS / 2) usage(argv[0]);
+        } else if (strcmp(argv[i], "--reorder") == 0 && i + 1 < argc) {
+            int depth = atoi(argv[++i]);
+            if (depth < 0) usage(argv[0]);
+            fake_fpga_set_reorder(depth);
+        } else if (strcmp(argv[i], "--sobel") == 0 && i + 1 < argc) {
+            sobel_rounds = atoi(argv[++i]);
+            if (sobel_rounds <= 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "--pty") == 0) {
+            use_pty = true;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (verify_rounds) {
+        // Sequencial e em paralelo: as duas têm de bater com o RTL
+        int mismatches = verify_sw(verify_rounds);
+        hough_sw_set_threads(threads);
+        if (hough_sw_threads() > 1) mismatches += verify_sw(verify_rounds);
+        hough_sw_set_threads(1);
+        return mismatches ? 1 : 0;
+    }
+    if (sobel_rounds) return verify_sobel(sobel_rounds) ? 1 : 0;
+    hough_sw_set_threads(threads);
+
+    PosixLink link;
+    LinkTransport transport;
+    if (!posix_link_spawn_fake(&link, use_pty)) return 1;
+    posix_link_transport(&link, &transport);
+    link_attach(&transport);
+    link_baud = BENCH_LINK_BAUD;
+    prof_clock = process_cpu_ns;
+
+    if (!fpga_wait_ready()) {
+        fprintf(stderr, "FPGA simulado não respondeu à consulta de estado\n");
+        posix_link_close(&link);
+        return 1;
+    }
+
+    if (telemetry) {
+        int errors = run_telemetry();
+        posix_link_close(&link);
+        return errors ? 1 : 0;
+    }
+
+    if (cache) {
+        int errors = run_cache();
+        posix_link_close(&link);
+        return errors ? 1 : 0;
+    }
+    tile_cache_enabled = false;
+
+    if (stream_width) {
+        int mismatches = run_stream(stream_width, stream_height, stream_gray);
+        posix_link_close(&link);
+        hough_sw_set_threads(1);
+        return mismatches ? 1 : 0;
+    }
+
+    uint64_t* latency_ns = malloc(sizeof(uint64_t) * frames);
+    printf("=== hough_bench: %d frames por padrão, FPGA simulado por %s, hough_sw com %d threads ===\n",
+           frames, use_pty ? "pty" : "pipe", hough_sw_threads());
+    printf("                         |        vazão       |    latência/frame (us)    |  bytes |"
+           "                  CPU do host (us/frame)\n");
+    printf("modo    padrão    linhas |   tiles/s frames/s |    p50    p90    p99     max | /frame |"
+           " padrão   pack   link  hough   conv  merge render\n");
+    for (int m = 0; m < MODE_COUNT; m++) {
+        if (only_mode >= 0 && m != only_mode) continue;
+        for (int p = 0; p < PATTERN_COUNT; p++) {
+            bench_run(&modes[m], &patterns[p], frames, latency_ns);
+        }
+    }
+
+    free(latency_ns);
+    posix_link_close(&link);
+    hough_sw_set_threads(1);
+    return 0;
+}
@@ -0,0 +1,136 @@
+// link_posix.c
+// LinkTransport sobre pipes/pty (ver link_posix.h)
+
+#define _GNU_SOURCE
+#include "link_posix.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fake_fpga.h"
+
+static uint8_t* posix_tx_acquire(void* ctx) {
+    return ((PosixLink*)ctx)->tx_buf;
+}
+
+// Escreve o comando inteiro (o pipe bloqueia só se o filho atrasar)
+static void posix_tx_submit(void* ctx, size_t len) {
+    PosixLink* link = ctx;
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(link->tx_fd, link->tx_buf + done, len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) {
+            struct pollfd pfd = { link->tx_fd, POLLOUT, 0 };
+            poll(&pfd, 1, -1);
+            continue;
+        }
+        if (n <= 0) return;  // Filho morreu: as esperas vencem o prazo
+        done += (size_t)n;
+    }
+}
+
+static size_t posix_rx_read(void* ctx, uint8_t* buf, size_t max) {
+    PosixLink* link = ctx;
+    ssize_t n;
+    do {
+        n = read(link->rx_fd, buf, max);
+    } while (n < 0 && errno == EINTR);
+    return n > 0 ? (size_t)n : 0;
+}
+
+static uint64_t posix_now_us(void* ctx) {
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+// Dorme no poll() até chegar um byte ou o prazo (arredondado para cima em ms)
+static void posix_rx_wait(void* ctx, uint64_t until_us) {
+    PosixLink* link = ctx;
+    uint64_t now = posix_now_us(ctx);
+    if (now >= until_us) return;
+    struct pollfd pfd = { link->rx_fd, POLLIN, 0 };
+    poll(&pfd, 1, (int)((until_us - now + 999) / 1000));
+}
+
+void posix_link_transport(PosixLink* link, LinkTransport* transport) {
+    transport->tx_acquire = posix_tx_acquire;
+    transport->tx_submit = posix_tx_submit;
+    transport->rx_read = posix_rx_read;
+    transport->rx_wait = posix_rx_wait;
+    transport->now_us = posix_now_us;
+    transport->ctx = link;
+}
+
+bool posix_link_spawn_fake(PosixLink* link, bool use_pty) {
+    int fpga_in, fpga_out;  // Lado do filho
+
+    link->child = -1;
+    if (use_pty) {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            perror("pty");
+            return false;
+        }
+        int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+        if (slave < 0) {
+            perror(ptsname(master));
+            return false;
+        }
+        // Raw nos dois lados: sem eco, sem tradução de \r\n, bytes crus
+        struct termios tio;
+        tcgetattr(slave, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+        tcgetattr(master, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(master, TCSANOW, &tio);
+        fpga_in = fpga_out = master;
+        link->rx_fd = link->tx_fd = slave;
+    } else {
+        int to_fpga[2], from_fpga[2];
+        if (pipe(to_fpga) < 0 || pipe(from_fpga) < 0) {
+            perror("pipe");
+            return false;
+        }
+        fpga_in = to_fpga[0];
+        fpga_out = from_fpga[1];
+        link->tx_fd = to_fpga[1];
+        link->rx_fd = from_fpga[0];
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        // Filho: só os descritores do FPGA ficam abertos, para o EOF chegar
+        if (link->rx_fd != fpga_in) close(link->rx_fd);
+        if (link->tx_fd != link->rx_fd && link->tx_fd != fpga_in) close(link->tx_fd);
+        fake_fpga_serve(fpga_in, fpga_out);
+        _exit(0);
+    }
+
+    close(fpga_in);
+    if (fpga_out != fpga_in) close(fpga_out);
+    link->child = pid;
+    fcntl(link->rx_fd, F_SETFL, fcntl(link->rx_fd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void posix_link_close(PosixLink* link) {
+    close(link->rx_fd);
+    if (link->tx_fd != link->rx_fd) close(link->tx_fd);
+    if (link->child > 0) waitpid(link->child, NULL, 0);
+    link->child = -1;
+}
@@ -0,0 +1,29 @@
+// link_posix.h
+// LinkTransport sobre descritores POSIX: o host conversa com o FPGA
+// simulado (fake_fpga) num processo filho, por dois pipes ou por um pty
+// em modo raw (o mesmo caminho de uma porta serial de verdade).
+
+#ifndef LINK_POSIX_H
+#define LINK_POSIX_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "hough_link.h"
+
+typedef struct {
+    int rx_fd, tx_fd;   // Iguais no pty
+    pid_t child;        // FPGA simulado (-1: nenhum)
+    uint8_t tx_buf[LINK_TX_BUF_SIZE];
+} PosixLink;
+
+// Cria o FPGA simulado num processo filho e liga os descritores a ele
+bool posix_link_spawn_fake(PosixLink* link, bool use_pty);
+
+// Preenche o transporte que link_attach() espera
+void posix_link_transport(PosixLink* link, LinkTransport* transport);
+
+// Fecha os descritores e espera o filho terminar (ele vê EOF)
+void posix_link_close(PosixLink* link);
+
+#endif  // LINK_POSIX_H
@@ -0,0 +1,130 @@
+// hough_cache.c
+// Cache de resultados de tile (ver hough_cache.h)
+
+#include "hough_cache.h"
+
+#include <string.h>
+
+bool tile_cache_enabled = TILE_CACHE_ENTRIES > 0;
+TileCacheStats tile_cache_stats;
+
+#if TILE_CACHE_ENTRIES > 0
+#define TILE_CACHE_SETS (TILE_CACHE_ENTRIES / TILE_CACHE_WAYS)
+
+typedef enum {
+    CACHE_FREE,
+    CACHE_PENDING,  // Reservada: resposta ainda em voo
+    CACHE_VALID
+} cache_state_t;
+
+typedef struct {
+    uint32_t hash;
+    uint16_t gen;
+    uint16_t owner;
+    uint8_t state;
+    uint8_t num_lines;
+    uint8_t key[IMG_BYTES_PACKED];
+    uint8_t lines[TILE_LINE_BYTES * MAX_LINES_PER_TILE];
+} CacheEntry;
+
+static CacheEntry cache[TILE_CACHE_ENTRIES];  // Conjunto s: cache[s · WAYS ..]
+static uint8_t cache_victim[TILE_CACHE_SETS];  // Próxima via substituída em cada conjunto
+static uint16_t cache_gen = 0;
+
+// FNV-1a de 32 bits (o RP2040 multiplica em um ciclo)
+static uint32_t tile_hash(const uint8_t packed[IMG_BYTES_PACKED]) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < IMG_BYTES_PACKED; i++) h = (h ^ packed[i]) * 16777619u;
+    return h;
+}
+#endif
+
+void tile_cache_clear() {
+#if TILE_CACHE_ENTRIES > 0
+    memset(cache, 0, sizeof(cache));
+    memset(cache_victim, 0, sizeof(cache_victim));
+#endif
+    memset(&tile_cache_stats, 0, sizeof(tile_cache_stats));
+}
+
+tile_lookup_t tile_cache_get(const uint8_t packed[IMG_BYTES_PACKED], uint16_t owner, TileResult* result,
+                             TileCacheTicket* ticket) {
+    ticket->slot = TILE_CACHE_NONE;
+    ticket->gen = 0;
+    ticket->owner = owner;
+#if TILE_CACHE_ENTRIES > 0
+    if (!tile_cache_enabled) return TILE_CACHE_MISS;
+
+    uint32_t h = tile_hash(packed);
+    int set = (int)((h ^ (h >> 16)) & (TILE_CACHE_SETS - 1));
+    CacheEntry* ways = &cache[set * TILE_CACHE_WAYS];
+    int way = -1;
+
+    for (int w = 0; w < TILE_CACHE_WAYS; w++) {
+        CacheEntry* e = &ways[w];
+        if (e->state == CACHE_FREE) {
+            if (way < 0) way = w;
+            continue;
+        }
+        if (e->hash != h || memcmp(e->key, packed, IMG_BYTES_PACKED) != 0) continue;
+        if (e->state == CACHE_VALID) {
+            result->num_lines = e->num_lines;
+            memcpy(result->lines, e->lines, (size_t)TILE_LINE_BYTES * e->num_lines);
+            tile_cache_stats.hits++;
+            return TILE_CACHE_HIT;
+        }
+        // O mesmo tile já está em voo: a resposta dele serve para os dois
+        ticket->slot = (uint16_t)(set * TILE_CACHE_WAYS + w);
+        ticket->gen = e->gen;
+        ticket->owner = e->owner;
+        tile_cache_stats.hits++;
+        return TILE_CACHE_IN_FLIGHT;
+    }
+
+    tile_cache_stats.misses++;
+    if (way < 0) {
+        way = cache_victim[set];
+        cache_victim[set] = (uint8_t)((way + 1) % TILE_CACHE_WAYS);
+        if (ways[way].state == CACHE_VALID) tile_cache_stats.evictions++;
+    }
+    CacheEntry* e = &ways[way];
+    e->hash = h;
+    e->gen = ++cache_gen;
+    e->owner = owner;
+    e->state = CACHE_PENDING;
+    memcpy(e->key, packed, IMG_BYTES_PACKED);
+    ticket->slot = (uint16_t)(set * TILE_CACHE_WAYS + way);
+    ticket->gen = e->gen;
+#else
+    (void)packed;
+    (void)result;
+#endif
+    return TILE_CACHE_MISS;
+}
+
+void tile_cache_fill(TileCacheTicket ticket, const TileResult* result) {
+#if TILE_CACHE_ENTRIES > 0
+    if (ticket.slot >= TILE_CACHE_ENTRIES || result->num_lines > MAX_LINES_PER_TILE) return;
+
+    CacheEntry* e = &cache[ticket.slot];
+    if (e->state != CACHE_PENDING || e->gen != ticket.gen) return;
+    e->num_lines = result->num_lines;
+    memcpy(e->lines, result->lines, (size_t)TILE_LINE_BYTES * result->num_lines);
+    e->state = CACHE_VALID;
+    tile_cache_stats.fills++;
+#else
+    (void)ticket;
+    (void)result;
+#endif
+}
+
+void tile_cache_drop(TileCacheTicket ticket) {
+#if TILE_CACHE_ENTRIES > 0
+    if (ticket.slot >= TILE_CACHE_ENTRIES) return;
+
+    CacheEntry* e = &cache[ticket.slot];
+    if (e->state == CACHE_PENDING && e->gen == ticket.gen) e->state = CACHE_FREE;
+#else
+    (void)ticket;
+#endif
+}
@@ -0,0 +1,77 @@
+// hough_cache.h
+// Cache de resultados de tile endereçado pelo conteúdo: a chave é o
+// próprio tile empacotado (32 bytes) e o valor, a resposta do FPGA
+// (num_lines + [ρ, θ, votes]). Tiles iguais são comuns: o mesmo trecho de
+// reta cruza vários tiles dos padrões 64×64, e em vídeo contínuo a maior
+// parte dos tiles se repete de um frame para o outro. Um acerto custa um
+// hash e uma comparação de 32 bytes em vez de uma ida e volta no link.
+//
+// Memória fixa: TILE_CACHE_ENTRIES entradas de ~52 bytes (6,5 KB com 128),
+// em conjuntos de TILE_CACHE_WAYS com substituição circular. Quem envia o
+// tile reserva a entrada no erro (tile_cache_get) e a preenche quando a
+// resposta chega (tile_cache_fill); se a entrada foi reaproveitada nesse
+// meio tempo, o preenchimento é ignorado. Um tile igual a outro ainda em
+// voo (cruz, X: o mesmo trecho em vários tiles do frame frio) não vai ao
+// fio: espera a resposta do dono da reserva. Resposta que não vem mais
+// libera a reserva (tile_cache_drop). Só tiles sem orientação entram:
+// a resposta do ORIENT_CMD depende também dos θ. Quem é dono do link é
+// dono do cache (core1 no modo contínuo).
+
+#ifndef HOUGH_CACHE_H
+#define HOUGH_CACHE_H
+
+#include "hough_core.h"
+
+// Potência de 2; 0 tira o cache do build
+#ifndef TILE_CACHE_ENTRIES
+#define TILE_CACHE_ENTRIES 128
+#endif
+#define TILE_CACHE_WAYS 4
+#if TILE_CACHE_ENTRIES > 0 && \
+    (TILE_CACHE_ENTRIES < TILE_CACHE_WAYS || (TILE_CACHE_ENTRIES & (TILE_CACHE_ENTRIES - 1)))
+#error "TILE_CACHE_ENTRIES: potência de 2 e pelo menos TILE_CACHE_WAYS"
+#endif
+#define TILE_CACHE_NONE 0xFFFF  // slot do ticket sem entrada reservada
+
+// Entrada reservada para a resposta de um tile em voo
+typedef struct {
+    uint16_t slot;   // TILE_CACHE_NONE: nada a preencher
+    uint16_t gen;    // Confere que a entrada ainda é a mesma reserva
+    uint16_t owner;  // Tile (ou tag) de quem reservou: quem espera, espera por ele
+} TileCacheTicket;
+
+typedef enum {
+    TILE_CACHE_MISS,       // Entrada reservada em ticket: enviar e depois tile_cache_fill
+    TILE_CACHE_HIT,        // Resposta copiada para result
+    TILE_CACHE_IN_FLIGHT   // O mesmo tile já foi enviado: esperar a resposta de ticket->owner
+} tile_lookup_t;
+
+typedef struct {
+    uint32_t hits;       // Respostas servidas pelo cache (ou pela de um tile igual em voo)
+    uint32_t misses;     // Tiles que foram ao FPGA
+    uint32_t fills;      // Respostas guardadas
+    uint32_t evictions;  // Respostas descartadas para dar lugar a outro tile
+} TileCacheStats;
+
+extern bool tile_cache_enabled;  // false: tile_cache_get sempre erra, sem reservar
+extern TileCacheStats tile_cache_stats;
+
+// Esvazia o cache e zera os contadores
+void tile_cache_clear();
+
+// Acerto: copia num_lines e as linhas para result (tile_id fica como
+// está). Erro: reserva a entrada em ticket, em nome de owner, para
+// tile_cache_fill. Em voo: ticket é a reserva do outro tile, e
+// ticket->owner quem a fez. Não chamar com tiles vazios.
+tile_lookup_t tile_cache_get(const uint8_t packed[IMG_BYTES_PACKED], uint16_t owner, TileResult* result,
+                             TileCacheTicket* ticket);
+
+// Guarda a resposta do FPGA para o tile reservado em ticket (BATCH_RETRY
+// e tickets sem entrada são ignorados)
+void tile_cache_fill(TileCacheTicket ticket, const TileResult* result);
+
+// Desiste da reserva em ticket (tile sem resposta no prazo): a entrada
+// fica livre e ninguém mais passa a esperar por ela
+void tile_cache_drop(TileCacheTicket ticket);
+
+#endif  // HOUGH_CACHE_H
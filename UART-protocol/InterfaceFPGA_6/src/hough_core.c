@@ -0,0 +1,731 @@
+// hough_core.c
+// Parte portável do pipeline em tiles (ver hough_core.h)
+
+#include "hough_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bitmap_word_t frame_images[2][IMAGE_PADDED_HEIGHT][BITMAP_ROW_WORDS];
+bitmap_word_t (*global_image)[BITMAP_ROW_WORDS] = frame_images[0];
+DetectedLine all_lines[MAX_LINES_TOTAL];         // Todas as linhas detectadas
+int total_lines_detected = 0;
+LineSegment line_segments[MAX_SEGMENTS_TOTAL];   // Trechos das linhas únicas
+int total_segments = 0;
+int orient_window = ORIENT_WINDOW;
+uint8_t image_theta[IMAGE_PADDED_HEIGHT][IMAGE_PADDED_WIDTH];
+bool image_oriented = false;
+
+uint64_t (*prof_clock)(void) = NULL;
+uint64_t prof_ns[STAGE_COUNT];
+
+uint8_t crc8_block(const uint8_t* data, int len) {
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) crc = crc8_update(crc, data[i]);
+    return crc;
+}
+
+void image_clear() {
+    memset(global_image, 0, sizeof(frame_images[0]));
+    image_oriented = false;
+}
+
+// Linha de TILE_SIZE pixels a partir da coluna x0. Com a grade alinhada o
+// tile nunca cruza palavras e o segundo caso nem é compilado.
+static inline uint32_t tile_row_bits(const bitmap_word_t* row, int x0) {
+    const bitmap_word_t* word = row + x0 / BITMAP_WORD_BITS;
+    int shift = x0 % BITMAP_WORD_BITS;
+    uint32_t bits = word[0] >> shift;
+#if !TILE_GRID_ALIGNED
+    if (shift > BITMAP_WORD_BITS - TILE_SIZE) bits |= word[1] << (BITMAP_WORD_BITS - shift);
+#endif
+    return bits & TILE_ROW_MASK;
+}
+
+// Empacota o tile de TILE_SIZE linhas de bitmap (com row_words palavras
+// cada) que começa na coluna x0: cada linha do tile é uma palavra
+// deslocada e mascarada (2 bytes little-endian no fio). As linhas precisam
+// cobrir x0 + TILE_SIZE. Retorna os pixels acesos.
+int pack_tile_rows(const bitmap_word_t* rows, int row_words, int x0, uint8_t packed[IMG_BYTES_PACKED]) {
+    int edges = 0;
+
+    for (int y = 0; y < TILE_SIZE; y++) {
+        uint32_t row = tile_row_bits(rows + y * row_words, x0);
+        packed[2 * y] = (uint8_t)row;
+        packed[2 * y + 1] = (uint8_t)(row >> 8);
+        edges += __builtin_popcount(row);
+    }
+    return edges;
+}
+
+// Empacota o tile (tile_x, tile_y) de global_image; retorna os pixels
+// acesos. Tiles da borda leem o enchimento zerado do bitmap.
+int pack_tile(int tile_x, int tile_y, uint8_t packed[IMG_BYTES_PACKED]) {
+    return pack_tile_rows(global_image[TILE_ORIGIN(tile_y)], BITMAP_ROW_WORDS, TILE_ORIGIN(tile_x), packed);
+}
+
+// Orientações do tile com canto na coluna x0 de rows (stride bytes por
+// linha), no formato do FPGA: pixel y·16 + x
+void pack_tile_theta_rows(const uint8_t* rows, int stride, int x0, uint8_t theta[TILE_PIXELS]) {
+    for (int y = 0; y < TILE_SIZE; y++) memcpy(&theta[y * TILE_SIZE], &rows[y * stride + x0], TILE_SIZE);
+}
+
+void pack_tile_theta(int tile_x, int tile_y, uint8_t theta[TILE_PIXELS]) {
+    pack_tile_theta_rows(image_theta[TILE_ORIGIN(tile_y)], IMAGE_PADDED_WIDTH, TILE_ORIGIN(tile_x), theta);
+}
+
+// Converte matriz 16×16 (um byte por pixel) para formato empacotado,
+// montando uma palavra por linha
+void tile_to_packed(uint8_t tile[TILE_SIZE][TILE_SIZE], uint8_t packed[IMG_BYTES_PACKED]) {
+    for (int y = 0; y < TILE_SIZE; y++) {
+        uint32_t row = 0;
+        for (int x = 0; x < TILE_SIZE; x++) row |= (uint32_t)(tile[y][x] != 0x00) << x;
+        packed[2 * y] = (uint8_t)row;
+        packed[2 * y + 1] = (uint8_t)(row >> 8);
+    }
+}
+
+// Empacota a imagem inteira no mesmo formato dos tiles
+// (pixel_idx = row * IMAGE_WIDTH + col, byte = idx / 8, bit = idx % 8):
+// com linhas de palavras inteiras é a própria global_image em memória
+void image_to_packed(uint8_t packed[IMAGE_BYTES_PACKED]) {
+#if IMAGE_WIDTH == BITMAP_ROW_WORDS * BITMAP_WORD_BITS
+    memcpy(packed, global_image, IMAGE_BYTES_PACKED);
+#else
+    memset(packed, 0, IMAGE_BYTES_PACKED);
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+        for (int x = 0; x < IMAGE_WIDTH; x++) {
+            int idx = y * IMAGE_WIDTH + x;
+            if (image_pixel(x, y)) packed[idx / 8] |= (uint8_t)(1u << (idx % 8));
+        }
+    }
+#endif
+}
+
+// Pixels acesos em global_image
+int image_edges() {
+    int edges = 0;
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+        for (int w = 0; w < BITMAP_ROW_WORDS; w++) edges += __builtin_popcount(global_image[y][w]);
+    }
+    return edges;
+}
+
+// Pixels acesos no tile empacotado
+int tile_edges(const uint8_t packed[IMG_BYTES_PACKED]) {
+    int edges = 0;
+    for (int i = 0; i < IMG_BYTES_PACKED; i += 4) {
+        uint32_t word;
+        memcpy(&word, &packed[i], sizeof(word));
+        edges += __builtin_popcount(word);
+    }
+    return edges;
+}
+
+// Escreve um byte x<<4|y por pixel aceso (em ordem de pixel) e retorna quantos
+int tile_put_coords(const uint8_t packed[IMG_BYTES_PACKED], uint8_t* out) {
+    int n = 0;
+    for (int i = 0; i < IMG_BYTES_PACKED; i++) {
+        for (uint8_t bits = packed[i]; bits; bits &= bits - 1) {
+            int pixel_idx = i * 8 + __builtin_ctz(bits);  // row * 16 + col
+            out[n++] = (uint8_t)(((pixel_idx % WIDTH) << 4) | (pixel_idx / WIDTH));
+        }
+    }
+    return n;
+}
+
+// Como tile_put_coords, mas cada coordenada seguida do bin θ do pixel
+// (payload de ORIENT_CMD); retorna os pixels (2 bytes cada)
+int tile_put_oriented(const uint8_t packed[IMG_BYTES_PACKED], const uint8_t theta[TILE_PIXELS], uint8_t* out) {
+    int n = 0;
+    for (int i = 0; i < IMG_BYTES_PACKED; i++) {
+        for (uint8_t bits = packed[i]; bits; bits &= bits - 1) {
+            int pixel_idx = i * 8 + __builtin_ctz(bits);
+            *out++ = (uint8_t)(((pixel_idx % WIDTH) << 4) | (pixel_idx / WIDTH));
+            *out++ = (uint8_t)(theta[pixel_idx] & (HOUGH_THETA_BINS - 1));
+            n++;
+        }
+    }
+    return n;
+}
+
+// ========== GEOMETRIA EM PONTO FIXO ==========
+
+// LUT do RTL: sin/cos × 256 para θ = k · 11.25°
+const int16_t hough_sin_q8[HOUGH_THETA_BINS] = {
+    0, 50, 98, 142, 181, 213, 237, 251, 256, 251, 237, 213, 181, 142, 98, 50
+};
+const int16_t hough_cos_q8[HOUGH_THETA_BINS] = {
+    256, 251, 237, 213, 181, 142, 98, 50, 0, -50, -98, -142, -181, -213, -237, -251
+};
+
+// Divisão com arredondamento para baixo (b > 0)
+static int32_t div_floor(int32_t a, int32_t b) {
+    int32_t q = a / b;
+    return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+// Calcula as interseções com os eixos a partir de global_rho_q8 e θ:
+// x = ρ / cosθ, y = ρ / sinθ (uma divisão inteira cada)
+void update_intercepts(DetectedLine* line) {
+    int32_t c = hough_cos_q8[line->theta_bin];
+    int32_t s = hough_sin_q8[line->theta_bin];
+
+    line->global_x_intercept = c ? line->global_rho_q8 * Q8_ONE / c : Q8_INF;
+    line->global_y_intercept = s ? line->global_rho_q8 * Q8_ONE / s : Q8_INF;
+}
+
+// Converte coordenadas locais do tile para globais
+void convert_to_global_coordinates(DetectedLine* line) {
+    int offset_x = TILE_ORIGIN(line->tile_x);
+    int offset_y = TILE_ORIGIN(line->tile_y);
+
+    // ρ_global = offset_x·cos(θ) + offset_y·sin(θ) + ρ_local, a partir da
+    // ORIGEM GLOBAL do tile. O ρ_local já está na escala do FPGA (0-15).
+    line->global_rho_q8 = offset_x * hough_cos_q8[line->theta_bin] +
+                          offset_y * hough_sin_q8[line->theta_bin] + line->rho * Q8_ONE;
+
+    // Calcula interseções para visualização
+    update_intercepts(line);
+}
+
+// Linhas de tiles que representam a mesma reta: |Δρ| < 3 pixels e
+// |Δθ| < 15° (bins vizinhos, com passo de 11.25°)
+bool lines_similar(const DetectedLine* a, const DetectedLine* b) {
+    return abs(a->global_rho_q8 - b->global_rho_q8) < 3 * Q8_ONE &&
+           abs((int)a->theta_bin - (int)b->theta_bin) <= 1;
+}
+
+// Mais vertical que horizontal (|cosθ| ≥ |sinθ|): desenhada percorrendo Y
+bool line_is_steep(const DetectedLine* line) {
+    return abs(hough_cos_q8[line->theta_bin]) >= abs(hough_sin_q8[line->theta_bin]);
+}
+
+// Rasteriza x·cosθ + y·sinθ = ρ (coordenadas globais) dentro da janela
+// width × height com canto em (x0, y0), com um ponto por passo do eixo
+// principal (Y nas linhas íngremes, X nas outras), como no Bresenham: o
+// eixo secundário só anda com o erro acumulado, sem divisão por pixel.
+// out deve ter espaço para max(width, height) pontos; retorna quantos.
+int line_raster(const DetectedLine* line, int x0, int y0, int width, int height, LinePoint* out) {
+    bool steep = line_is_steep(line);
+    int32_t a = steep ? hough_sin_q8[line->theta_bin] : hough_cos_q8[line->theta_bin];
+    int32_t b = steep ? hough_cos_q8[line->theta_bin] : hough_sin_q8[line->theta_bin];
+    int major0 = steep ? y0 : x0;
+    int minor0 = steep ? x0 : y0;
+    int major_size = steep ? height : width;
+    int minor_size = steep ? width : height;
+    int32_t num = line->global_rho_q8 - major0 * a;  // ρ - major·a = minor·b
+
+    // b > 0 e |a| ≤ b, então o erro corrige no máximo um pixel por passo
+    if (b < 0) {
+        a = -a;
+        b = -b;
+        num = -num;
+    }
+    int32_t minor = div_floor(2 * num + b, 2 * b);  // Arredondado
+    int32_t err = num - minor * b;                   // Em [-b/2, b/2)
+    int n = 0;
+
+    for (int major = major0; major < major0 + major_size; major++) {
+        if (minor >= minor0 && minor < minor0 + minor_size) {
+            out[n].x = (int16_t)(steep ? minor : major);
+            out[n].y = (int16_t)(steep ? major : minor);
+            n++;
+        }
+        err -= a;
+        if (2 * err >= b) {
+            minor++;
+            err -= b;
+        } else if (2 * err < -b) {
+            minor--;
+            err += b;
+        }
+    }
+    return n;
+}
+
+// Converte a resposta de um tile em linhas globais e armazena
+int store_tile_result(const TileResult* result, int tile_x, int tile_y) {
+    for (int i = 0; i < result->num_lines && total_lines_detected < MAX_LINES_TOTAL; i++) {
+        const uint8_t* l = &result->lines[i * TILE_LINE_BYTES];
+        DetectedLine* line = &all_lines[total_lines_detected++];
+        line->rho = l[0];
+        line->theta_bin = theta_deg_to_bin(l[1]);
+        line->votes = l[2];
+        line->tile_x = tile_x;
+        line->tile_y = tile_y;
+        line->merged = 1;
+        line->total_votes = line->votes;
+        convert_to_global_coordinates(line);
+    }
+    return result->num_lines;
+}
+
+// Converte a resposta da imagem inteira: ρ já é global (pixels, com sinal)
+int store_frame_result(const TileResult* result) {
+    for (int i = 0; i < result->num_lines && total_lines_detected < MAX_LINES_TOTAL; i++) {
+        const uint8_t* l = &result->lines[i * FRAME_LINE_BYTES];
+        DetectedLine* line = &all_lines[total_lines_detected++];
+        line->rho = 0;
+        line->theta_bin = theta_deg_to_bin(l[2]);
+        line->votes = l[3];
+        line->tile_x = -1;
+        line->tile_y = -1;
+        line->global_rho_q8 = (int16_t)((l[0] << 8) | l[1]) * Q8_ONE;
+        line->merged = 1;
+        line->total_votes = line->votes;
+        update_intercepts(line);
+    }
+    return result->num_lines;
+}
+
+// ========== JUNÇÃO: AGRUPA LINHAS SIMILARES ==========
+// As detecções caem numa grade global (ρ, θ) com células de 3 pixels × 1
+// bin. Uma detecção similar (lines_similar) a outra só pode estar nas 3 × 3
+// células em volta, então cada uma compara com poucos grupos e a junção é
+// linear no número de detecções, não quadrática.
+#define MERGE_RHO_Q8 (3 * Q8_ONE)
+#define MERGE_RHO_LIMIT_Q8 (IMAGE_MAX_DIM * 362 + TILE_SIZE * Q8_ONE)  // |ρ| < IMAGE_MAX_DIM·√2 + TILE_SIZE
+#define MERGE_RHO_CELLS (2 * MERGE_RHO_LIMIT_Q8 / MERGE_RHO_Q8 + 3)
+#define SEGMENT_MAX_GAP_Q8 (2 * Q8_ONE)  // Folga entre os trechos de tiles vizinhos
+#define MAX_PIECES (MAX_LINES_TOTAL + MAX_SEGMENTS_TOTAL)
+
+typedef struct {
+    int16_t seed;         // Primeira detecção: referência de lines_similar
+    int16_t best;         // Detecção de mais votos
+    int16_t first, last;  // Detecções do grupo (member_next)
+    int16_t next;         // Próximo grupo na mesma célula
+} LineCluster;
+
+// Trecho de uma detecção dentro do seu tile (ou um trecho da junção
+// anterior), projetado na direção da linha
+typedef struct {
+    int16_t cluster;
+    uint16_t tiles;
+    uint32_t votes;
+    int32_t p0, p1;   // Projeção dos extremos (Q8), p0 ≤ p1
+    LinePoint a, b;   // Extremos correspondentes
+} SegmentPiece;
+
+static int16_t cell_head[MERGE_RHO_CELLS][HOUGH_THETA_BINS];  // Último grupo criado na célula
+static LineCluster clusters[MAX_LINES_TOTAL];
+static int16_t member_next[MAX_LINES_TOTAL];
+static int16_t line_cluster[MAX_LINES_TOTAL];
+static DetectedLine merged_lines[MAX_LINES_TOTAL];
+static SegmentPiece pieces[MAX_PIECES];
+
+static int merge_rho_cell(int32_t rho_q8) {
+    int cell = div_floor(rho_q8 + MERGE_RHO_LIMIT_Q8, MERGE_RHO_Q8) + 1;
+    return cell < 1 ? 1 : (cell > MERGE_RHO_CELLS - 2 ? MERGE_RHO_CELLS - 2 : cell);
+}
+
+// Grupo já existente (o mais antigo) com semente similar à detecção, ou -1
+static int find_cluster(const DetectedLine* line) {
+    int rc = merge_rho_cell(line->global_rho_q8);
+    int found = -1;
+
+    for (int r = rc - 1; r <= rc + 1; r++) {
+        for (int t = line->theta_bin - 1; t <= line->theta_bin + 1; t++) {
+            if (t < 0 || t >= HOUGH_THETA_BINS) continue;
+            for (int c = cell_head[r][t]; c >= 0; c = clusters[c].next) {
+                if ((found < 0 || c < found) && lines_similar(line, &all_lines[clusters[c].seed])) found = c;
+            }
+        }
+    }
+    return found;
+}
+
+// Linha única do grupo: a detecção de mais votos, com ρ refinado pela média
+// ponderada por votos das detecções do mesmo θ. Uma linha de uma junção
+// anterior entra com o que já tinha agrupado.
+static void refine_cluster(const LineCluster* cluster, DetectedLine* out) {
+    *out = all_lines[cluster->best];
+    int64_t rho_sum = 0;
+    int32_t rho_votes = 0;
+    out->merged = 0;
+    out->total_votes = 0;
+
+    for (int i = cluster->first; i >= 0; i = member_next[i]) {
+        const DetectedLine* line = &all_lines[i];
+        out->merged += line->merged;
+        out->total_votes += line->total_votes;
+        if (line->theta_bin == out->theta_bin) {
+            rho_sum += (int64_t)line->global_rho_q8 * line->total_votes;
+            rho_votes += line->total_votes;
+        }
+    }
+    if (rho_votes > 0) {
+        out->global_rho_q8 = (int32_t)((rho_sum + (rho_sum < 0 ? -rho_votes : rho_votes) / 2) / rho_votes);
+        update_intercepts(out);
+    }
+}
+
+static int piece_cmp(const void* a, const void* b) {
+    const SegmentPiece* pa = a;
+    const SegmentPiece* pb = b;
+    if (pa->cluster != pb->cluster) return pa->cluster - pb->cluster;
+    return (pa->p0 > pb->p0) - (pa->p0 < pb->p0);
+}
+
+// Pedaço de a até b no grupo cluster, orientado ao longo da linha do grupo
+static void add_piece(int cluster, LinePoint a, LinePoint b, uint16_t tiles, uint32_t votes, int* num_pieces) {
+    const DetectedLine* global = &merged_lines[cluster];
+
+    // Direção da linha do grupo, (-sinθ, cosθ) ou o oposto: sempre
+    // crescente no eixo principal (trechos de cima para baixo ou da
+    // esquerda para a direita)
+    int32_t dx = -hough_sin_q8[global->theta_bin];
+    int32_t dy = hough_cos_q8[global->theta_bin];
+    if (line_is_steep(global) ? dy < 0 : dx < 0) {
+        dx = -dx;
+        dy = -dy;
+    }
+    SegmentPiece* piece = &pieces[(*num_pieces)++];
+    piece->cluster = (int16_t)cluster;
+    piece->tiles = tiles;
+    piece->votes = votes;
+    piece->a = a;
+    piece->b = b;
+    piece->p0 = a.x * dx + a.y * dy;
+    piece->p1 = b.x * dx + b.y * dy;
+    if (piece->p0 > piece->p1) {
+        int32_t p = piece->p0;
+        piece->p0 = piece->p1;
+        piece->p1 = p;
+        piece->a = b;
+        piece->b = a;
+    }
+}
+
+// Costura os grupos em trechos: cada detecção nova vira o pedaço da sua
+// linha dentro do tile (a imagem inteira, sem tile), os trechos da junção
+// anterior entram inteiros, os pedaços são ordenados ao longo da linha do
+// grupo e os que se tocam (folga até SEGMENT_MAX_GAP_Q8) formam um trecho só.
+static void stitch_segments(int merged, int num_lines) {
+    LinePoint points[IMAGE_MAX_SIDE > TILE_SIZE ? IMAGE_MAX_SIDE : TILE_SIZE];
+    int num_pieces = 0;
+
+    for (int i = 0; i < total_segments; i++) {
+        const LineSegment* seg = &line_segments[i];
+        add_piece(line_cluster[seg->line], seg->start, seg->end, seg->tiles, seg->votes, &num_pieces);
+    }
+    for (int i = merged; i < num_lines; i++) {
+        const DetectedLine* line = &all_lines[i];
+        int n = line->tile_x >= 0
+            ? line_raster(line, TILE_ORIGIN(line->tile_x), TILE_ORIGIN(line->tile_y), TILE_SIZE, TILE_SIZE, points)
+            : line_raster(line, 0, 0, IMAGE_WIDTH, IMAGE_HEIGHT, points);
+        if (n > 0) add_piece(line_cluster[i], points[0], points[n - 1], 1, line->votes, &num_pieces);
+    }
+
+    qsort(pieces, num_pieces, sizeof(SegmentPiece), piece_cmp);
+
+    total_segments = 0;
+    LineSegment* seg = NULL;
+    int32_t seg_end = 0;  // Projeção do fim do trecho atual
+    for (int k = 0; k < num_pieces; k++) {
+        const SegmentPiece* piece = &pieces[k];
+
+        if (seg && seg->line == piece->cluster && piece->p0 <= seg_end + SEGMENT_MAX_GAP_Q8) {
+            if (piece->p1 > seg_end) {
+                seg->end = piece->b;
+                seg_end = piece->p1;
+            }
+            seg->tiles += piece->tiles;
+            seg->votes += piece->votes;
+        } else if (total_segments < MAX_SEGMENTS_TOTAL) {
+            seg = &line_segments[total_segments++];
+            seg->start = piece->a;
+            seg->end = piece->b;
+            seg->line = piece->cluster;
+            seg->tiles = piece->tiles;
+            seg->votes = piece->votes;
+            seg_end = piece->p1;
+        } else {
+            seg = NULL;  // Sem espaço: o resto fica sem trecho
+        }
+    }
+}
+
+// Junção incremental: all_lines[0 .. merged) já é o resultado de uma junção
+// anterior (com os trechos em line_segments) e o resto são detecções novas.
+// Agrupa as similares (|Δρ| < 3 e |Δθ| < 15°, contra a primeira linha de
+// cada grupo), deixa em all_lines só as linhas únicas (ver refine_cluster)
+// e refaz line_segments. Linhas da imagem inteira (tile_x = -1) vêm de uma
+// votação só, sem duplicatas entre tiles, e passam sem mudança.
+int merge_detected_lines_from(int merged) {
+    uint64_t t0 = prof_begin();
+    int num_lines = total_lines_detected;
+    int num_clusters = 0;
+
+    if (merged == 0) total_segments = 0;
+    memset(cell_head, 0xFF, sizeof(cell_head));  // -1: célula vazia
+
+    for (int i = 0; i < num_lines; i++) {
+        const DetectedLine* line = &all_lines[i];
+        int c = line->tile_x >= 0 ? find_cluster(line) : -1;
+
+        member_next[i] = -1;
+        if (c < 0) {
+            c = num_clusters++;
+            clusters[c].seed = clusters[c].best = clusters[c].first = (int16_t)i;
+            clusters[c].next = -1;
+            if (line->tile_x >= 0) {
+                int16_t* head = &cell_head[merge_rho_cell(line->global_rho_q8)][line->theta_bin];
+                clusters[c].next = *head;
+                *head = (int16_t)c;
+            }
+        } else {
+            member_next[clusters[c].last] = (int16_t)i;
+            // Mantém a linha com mais votos
+            if (line->votes > all_lines[clusters[c].best].votes) clusters[c].best = (int16_t)i;
+        }
+        clusters[c].last = (int16_t)i;
+        line_cluster[i] = (int16_t)c;
+    }
+
+    for (int c = 0; c < num_clusters; c++) refine_cluster(&clusters[c], &merged_lines[c]);
+    stitch_segments(merged, num_lines);
+
+    memcpy(all_lines, merged_lines, sizeof(DetectedLine) * num_clusters);
+    total_lines_detected = num_clusters;
+    prof_end(STAGE_MERGE, t0);
+    return total_lines_detected;
+}
+
+// Junção de um frame inteiro de detecções
+int merge_detected_lines() {
+    return merge_detected_lines_from(0);
+}
+
+// Desenha global_image ('#') com as linhas detectadas ('|', '-', '+' no
+// cruzamento com bordas ou outra linha)
+void render_image_with_lines(char display[IMAGE_HEIGHT][IMAGE_WIDTH]) {
+    uint64_t t0 = prof_begin();
+
+    // Inicializa display
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+        for (int x = 0; x < IMAGE_WIDTH; x++) {
+            display[y][x] = image_pixel(x, y) ? '#' : '.';
+        }
+    }
+
+    // Desenha linhas detectadas: '|' nas mais verticais (percorre Y),
+    // '-' nas mais horizontais (percorre X)
+    LinePoint points[IMAGE_MAX_SIDE];
+    for (int i = 0; i < total_lines_detected; i++) {
+        DetectedLine* line = &all_lines[i];
+        char glyph = line_is_steep(line) ? '|' : '-';
+        int n = line_raster(line, 0, 0, IMAGE_WIDTH, IMAGE_HEIGHT, points);
+
+        for (int p = 0; p < n; p++) {
+            char* c = &display[points[p].y][points[p].x];
+            if (*c == '.') *c = glyph;
+            else if (*c != glyph) *c = '+';  // Borda ou outra linha
+        }
+    }
+    prof_end(STAGE_RENDER, t0);
+}
+
+// Visualiza a imagem com as linhas detectadas
+void print_image_with_lines() {
+    static char display[IMAGE_HEIGHT][IMAGE_WIDTH];
+
+    render_image_with_lines(display);
+
+    // Imprime resultado
+    printf("\n%dx%d Image with Detected Lines:\n", IMAGE_WIDTH, IMAGE_HEIGHT);
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+        for (int x = 0; x < IMAGE_WIDTH; x++) {
+            printf("%c", display[y][x]);
+        }
+        printf("\n");
+    }
+}
+
+// Imprime as linhas únicas e os seus trechos (depois de merge_detected_lines)
+void print_detected_lines() {
+    printf("Linhas principais detectadas:\n");
+    for (int i = 0; i < total_lines_detected; i++) {
+        DetectedLine* line = &all_lines[i];
+        printf("  Linha %d: ρ_global=" Q8_FMT ", θ=%d°, votos=%d (%u detecções, %lu votos)\n",
+               i + 1, Q8_ARGS(line->global_rho_q8), theta_bin_to_deg(line->theta_bin), line->votes,
+               line->merged, (unsigned long)line->total_votes);
+    }
+
+    printf("\nTrechos:\n");
+    for (int i = 0; i < total_segments; i++) {
+        const LineSegment* seg = &line_segments[i];
+        printf("  Linha %d: (%d,%d) → (%d,%d), %u tiles, %lu votos\n", seg->line + 1,
+               seg->start.x, seg->start.y, seg->end.x, seg->end.y, seg->tiles, (unsigned long)seg->votes);
+    }
+}
+
+// Imprime as linhas únicas (depois de merge_detected_lines) e a imagem com elas
+void print_frame_report() {
+    printf("\n=== RESULTADO FILTRADO ===\n");
+    printf("Linhas únicas: %d (após agrupar similares)\n\n", total_lines_detected);
+
+    if (total_lines_detected > 0) {
+        print_detected_lines();
+        printf("\n");
+        print_image_with_lines();
+    } else {
+        printf("Nenhuma linha detectada em toda a imagem.\n");
+    }
+}
+
+// ========== PADRÕES DE TESTE 16×16 ==========
+
+// Teste 1: Diagonal principal (45°)
+void create_diagonal(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (i == j) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 2: Linha vertical no centro (x=8)
+void create_vertical(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (j == 8) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 3: Linha horizontal no centro (y=8)
+void create_horizontal(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (i == 8) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 4: Anti-diagonal (135°) - linha de canto superior direito ao inferior esquerdo
+void create_antidiagonal(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (i + j == WIDTH - 1) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 5: Duas linhas verticais paralelas
+void create_two_verticals(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (j == 5 || j == 10) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 6: Cruz (vertical + horizontal)
+void create_cross(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (i == 8 || j == 8) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 7: Quadrado (bordas da imagem)
+void create_square(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (i == 0 || i == WIDTH-1 || j == 0 || j == LENGHT-1) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 8: X (duas diagonais)
+void create_x_pattern(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (i == j || i + j == WIDTH - 1) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 9: Linha vertical na borda esquerda
+void create_vertical_left(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (j == 0) ? 255 : 0;
+        }
+    }
+}
+
+// Teste 10: Linha horizontal na borda superior
+void create_horizontal_top(uint8_t matrix[WIDTH][LENGHT]) {
+    for (int i = 0; i < WIDTH; i++) {
+        for (int j = 0; j < LENGHT; j++) {
+            matrix[i][j] = (i == 0) ? 255 : 0;
+        }
+    }
+}
+
+const TilePattern tile_patterns[TILE_PATTERN_COUNT] = {
+    { "diagonal", create_diagonal, "Diagonal Principal (0,0)→(15,15)", "θ ≈ 135° (normal à linha 45°)" },
+    { "vertical", create_vertical, "Linha Vertical no Centro (x=8)", "θ ≈ 90° (normal à linha vertical)" },
+    { "horizontal", create_horizontal, "Linha Horizontal no Centro (y=8)",
+      "θ ≈ 0° ou 180° (normal à linha horizontal)" },
+    { "antidiagonal", create_antidiagonal, "Anti-diagonal (15,0)→(0,15)", "θ ≈ 45° (normal à linha 135°)" },
+    { "two_verticals", create_two_verticals, "Duas Linhas Verticais Paralelas (x=5 e x=10)",
+      "θ ≈ 90° para ambas" },
+    { "cross", create_cross, "Cruz (Vertical + Horizontal)", "θ ≈ 0° e 90° (2 linhas detectadas)" },
+    { "square", create_square, "Quadrado (Bordas da Imagem)", "4 linhas: θ ≈ 0°, 90°, 0°, 90°" },
+    { "x_pattern", create_x_pattern, "Padrão X (Duas Diagonais)", "θ ≈ 45° e 135° (2 linhas)" },
+    { "vertical_left", create_vertical_left, "Linha Vertical na Borda Esquerda (x=0)", "θ ≈ 90°" },
+    { "horizontal_top", create_horizontal_top, "Linha Horizontal na Borda Superior (y=0)", "θ ≈ 0° ou 180°" },
+};
+
+// ========== PADRÕES DE TESTE DA IMAGEM ==========
+// Desenhados para 64×64 e escalados para IMAGE_WIDTH × IMAGE_HEIGHT (em
+// 64×64 são exatamente os originais)
+#define SCALE_X(x) ((x) * IMAGE_WIDTH / 64)
+#define SCALE_Y(y) ((y) * IMAGE_HEIGHT / 64)
+#define IMAGE_MIN_SIDE (IMAGE_WIDTH < IMAGE_HEIGHT ? IMAGE_WIDTH : IMAGE_HEIGHT)
+
+void create_test_cross_64x64() {
+    image_clear();
+    for (int y = 0; y < IMAGE_HEIGHT; y++) image_set_pixel(SCALE_X(32), y);
+    for (int x = 0; x < IMAGE_WIDTH; x++) image_set_pixel(x, SCALE_Y(32));
+}
+
+void create_test_diagonal_64x64() {
+    image_clear();
+    for (int i = 0; i < IMAGE_MIN_SIDE; i++) image_set_pixel(i, i);
+}
+
+void create_test_rectangle_64x64() {
+    image_clear();
+    for (int x = SCALE_X(20); x <= SCALE_X(44); x++) {
+        image_set_pixel(x, SCALE_Y(12));
+        image_set_pixel(x, SCALE_Y(52));
+    }
+    for (int y = SCALE_Y(12); y <= SCALE_Y(52); y++) {
+        image_set_pixel(SCALE_X(20), y);
+        image_set_pixel(SCALE_X(44), y);
+    }
+}
+
+void create_test_x_pattern_64x64() {
+    image_clear();
+    for (int i = 0; i < IMAGE_MIN_SIDE; i++) {
+        image_set_pixel(i, i);
+        image_set_pixel(IMAGE_MIN_SIDE - 1 - i, i);
+    }
+}
+
+// Padrão n (0..3) em global_image: os frames do modo contínuo alternam entre eles
+void create_test_pattern_64x64(int n) {
+    switch (n % 4) {
+        case 0: create_test_cross_64x64(); break;
+        case 1: create_test_diagonal_64x64(); break;
+        case 2: create_test_rectangle_64x64(); break;
+        default: create_test_x_pattern_64x64(); break;
+    }
+}
@@ -0,0 +1,288 @@
+// hough_core.h
+// Parte portável do pipeline em tiles: tiles, empacotamento, conversão para
+// coordenadas globais, junção das linhas e desenho. Não depende do Pico SDK:
+// o mesmo código roda no firmware e no host (HostBench).
+
+#ifndef HOUGH_CORE_H
+#define HOUGH_CORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define WIDTH 16
+#define LENGHT 16
+#define IMG_BYTES_PACKED 32  // 16×16 bits = 256 bits = 32 bytes empacotados
+// Lista (3 + n bytes) só quando é menor que o bitmap (2 + 32 bytes)
+#define SPARSE_MAX_EDGES (IMG_BYTES_PACKED - 2)
+#define MAX_LINES_PER_TILE 4
+#define MAX_LINES_PER_FRAME 8  // Deve bater com FRAME_MAX_LINES em uart_echo_colorlight_i9.sv
+#define TILE_LINE_BYTES 3      // [ρ, θ, votes]
+#define FRAME_LINE_BYTES 4     // [ρ_hi, ρ_lo, θ, votes], ρ com sinal em pixels
+
+// ========== GEOMETRIA DA IMAGEM E DOS TILES ==========
+// Imagem IMAGE_WIDTH × IMAGE_HEIGHT qualquer (padrão: 64×64, o FRAME_SIZE
+// do RTL), sempre em tiles de TILE_SIZE × TILE_SIZE (o Hough de tile do
+// FPGA). Tiles vizinhos começam a TILE_STEP pixels um do outro: com
+// TILE_HALO > 0 eles se sobrepõem nesse tanto, então uma linha que cruza a
+// fronteira aparece inteira em pelo menos um e a junção funde as duas
+// detecções. Os tiles da borda direita e de baixo que passam da imagem leem
+// zeros: o bitmap já é alocado com esse enchimento (IMAGE_PADDED_*).
+// Tudo é constante de compilação (-DIMAGE_WIDTH=... ou o CMakeLists do
+// firmware); sem halo (TILE_GRID_ALIGNED) o empacotamento de um tile é só
+// deslocamento e máscara de uma palavra por linha.
+#ifndef IMAGE_WIDTH
+#define IMAGE_WIDTH 64
+#endif
+#ifndef IMAGE_HEIGHT
+#define IMAGE_HEIGHT IMAGE_WIDTH
+#endif
+#ifndef TILE_HALO
+#define TILE_HALO 0
+#endif
+#define TILE_SIZE 16
+#define TILE_STEP (TILE_SIZE - TILE_HALO)
+#if TILE_HALO < 0 || TILE_HALO > TILE_SIZE / 4
+#error "TILE_HALO vai de 0 a TILE_SIZE / 4"
+#endif
+
+// Tiles para cobrir n pixels com passo TILE_STEP
+#define TILES_TO_COVER(n) ((n) > TILE_SIZE ? ((n) - TILE_SIZE + TILE_STEP - 1) / TILE_STEP + 1 : 1)
+#define GRID_COLS TILES_TO_COVER(IMAGE_WIDTH)
+#define GRID_ROWS TILES_TO_COVER(IMAGE_HEIGHT)
+#define GRID_TILES (GRID_COLS * GRID_ROWS)  // Tile i: coluna i % GRID_COLS, linha i / GRID_COLS
+#define TILE_ORIGIN(t) ((t) * TILE_STEP)     // Canto do tile, em x (coluna) ou y (linha)
+#define IMAGE_PADDED_WIDTH (TILE_ORIGIN(GRID_COLS - 1) + TILE_SIZE)
+#define IMAGE_PADDED_HEIGHT (TILE_ORIGIN(GRID_ROWS - 1) + TILE_SIZE)
+#define TILE_GRID_ALIGNED (BITMAP_WORD_BITS % TILE_STEP == 0)  // Nenhum tile cruza palavras do bitmap
+#define IMAGE_MAX_SIDE (IMAGE_WIDTH > IMAGE_HEIGHT ? IMAGE_WIDTH : IMAGE_HEIGHT)
+
+// FRAME_CMD (imagem inteira no FPGA) só existe para o FRAME_SIZE do RTL
+#define FRAME_RTL_SIZE 64
+#define IMAGE_IS_RTL_FRAME (IMAGE_WIDTH == FRAME_RTL_SIZE && IMAGE_HEIGHT == FRAME_RTL_SIZE)
+#define FRAME_BYTES_PACKED (FRAME_RTL_SIZE * FRAME_RTL_SIZE / 8)  // 64×64 → 512 bytes (FRAME_SIZE no FPGA)
+#define IMAGE_BYTES_PACKED ((IMAGE_WIDTH * IMAGE_HEIGHT + 7) / 8)  // image_to_packed
+
+// Linhas em all_lines: lista cheia em todos os tiles (o modo em faixas,
+// hough_stream, junta a cada faixa e pede mais)
+#ifndef MAX_LINES_TOTAL
+#define MAX_LINES_TOTAL (GRID_TILES * MAX_LINES_PER_TILE)
+#endif
+#define MAX_SEGMENTS_TOTAL MAX_LINES_TOTAL  // No máximo um trecho por detecção
+// Maior lado de imagem na grade de junção (ρ fora da faixa ainda junta,
+// só mais devagar)
+#ifndef IMAGE_MAX_DIM
+#define IMAGE_MAX_DIM IMAGE_MAX_SIDE
+#endif
+
+// Resultado de um tile (ou da imagem inteira), como enviado pelo FPGA
+typedef struct {
+    uint8_t tile_id;    // Índice do tile (só em respostas a TAGGED_HEADER/SPARSE_CMD/BATCH_CMD)
+    uint8_t num_lines;  // BATCH_RETRY: registro do lote recusado ou com CRC errado
+    uint8_t lines[FRAME_LINE_BYTES * MAX_LINES_PER_FRAME];  // TILE_LINE_BYTES ou FRAME_LINE_BYTES × num_lines
+} TileResult;
+
+// ========== GEOMETRIA EM PONTO FIXO ==========
+// O RP2040 não tem FPU: ρ e as interseções ficam em Q8 (pixels × 256) e θ
+// como índice na mesma LUT sin/cos × 256 de hough_transform.sv, então a
+// conversão para coordenadas globais faz as mesmas contas do RTL.
+#define HOUGH_THETA_BINS 16
+#define Q8_ONE 256
+#define Q8_INF INT32_MAX  // Interseção no infinito (linha paralela ao eixo)
+
+extern const int16_t hough_sin_q8[HOUGH_THETA_BINS];
+extern const int16_t hough_cos_q8[HOUGH_THETA_BINS];
+
+// θ em graus como o FPGA envia (k · 180 / 16, truncado) ↔ índice k
+static inline uint8_t theta_bin_to_deg(int bin) {
+    return (uint8_t)(bin * 180 / HOUGH_THETA_BINS);
+}
+
+static inline uint8_t theta_deg_to_bin(uint8_t deg) {
+    int bin = (deg * HOUGH_THETA_BINS + 179) / 180;  // Desfaz o truncamento
+    return (uint8_t)(bin < HOUGH_THETA_BINS ? bin : HOUGH_THETA_BINS - 1);
+}
+
+// Q8 em printf sem ponto flutuante: printf("ρ=" Q8_FMT, Q8_ARGS(v))
+#define Q8_FMT "%s%ld.%02ld"
+#define Q8_ABS(v) ((v) < 0 ? -(v) : (v))
+#define Q8_ARGS(v) ((v) < 0 ? "-" : ""), (long)(Q8_ABS(v) >> 8), (long)(((Q8_ABS(v) & 0xFF) * 100) >> 8)
+
+typedef struct {
+    uint8_t rho, votes;          // Dados recebidos do FPGA (ρ local: só nos tiles)
+    uint8_t theta_bin;           // θ como índice 0..15 da LUT (theta_bin_to_deg para graus)
+    int tile_x, tile_y;          // Posição do tile na grade (-1: imagem inteira)
+    int32_t global_rho_q8;       // ρ em coordenadas globais da imagem, Q8
+    int32_t global_x_intercept;  // Interseção com eixo X, Q8 (Q8_INF: linha horizontal)
+    int32_t global_y_intercept;  // Interseção com eixo Y, Q8 (Q8_INF: linha vertical)
+    uint16_t merged;             // Detecções agrupadas nesta linha (1 antes da junção)
+    uint32_t total_votes;        // Votos somados dessas detecções
+} DetectedLine;
+
+// Ponto desenhado por line_raster(), em coordenadas globais
+typedef struct {
+    int16_t x, y;
+} LinePoint;
+
+// Trecho contínuo de uma linha única, costurado das detecções de tiles
+// vizinhos por merge_detected_lines()
+typedef struct {
+    LinePoint start, end;  // Extremos, em ordem ao longo da linha
+    int16_t line;          // Índice da linha em all_lines
+    uint16_t tiles;        // Detecções costuradas no trecho
+    uint32_t votes;        // Votos somados dessas detecções
+} LineSegment;
+
+// ========== IMAGEM EM BITS ==========
+// Um bit por pixel, cada linha em BITMAP_ROW_WORDS palavras de 32 bits
+// (pixel x = bit x % 32 da palavra x / 32). Em memória little-endian
+// (RP2040 e host) isso já é o formato empacotado do fio, então
+// image_to_packed é uma cópia (largura múltipla de 32) e cada linha de
+// tile sai com um deslocamento e uma máscara. 512 bytes por imagem 64×64,
+// em vez de 4 KB. Linhas e colunas além de IMAGE_WIDTH × IMAGE_HEIGHT (até
+// IMAGE_PADDED_*) ficam sempre zeradas.
+typedef uint32_t bitmap_word_t;
+#define BITMAP_WORD_BITS 32
+#define BITMAP_ROW_WORDS ((IMAGE_PADDED_WIDTH + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS)
+#define TILE_ROW_MASK ((1u << TILE_SIZE) - 1)  // Uma linha de tile
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "image_to_packed/pack_tile supõem memória little-endian"
+#endif
+
+// Duas imagens: no modo contínuo core0 monta o frame K+1 numa enquanto
+// ainda desenha o frame K com a outra
+extern bitmap_word_t frame_images[2][IMAGE_PADDED_HEIGHT][BITMAP_ROW_WORDS];
+extern bitmap_word_t (*global_image)[BITMAP_ROW_WORDS];  // Imagem em uso
+
+static inline bool image_pixel(int x, int y) {
+    return (global_image[y][x / BITMAP_WORD_BITS] >> (x % BITMAP_WORD_BITS)) & 1u;
+}
+
+static inline void image_set_pixel(int x, int y) {
+    global_image[y][x / BITMAP_WORD_BITS] |= 1u << (x % BITMAP_WORD_BITS);
+}
+
+// ========== ORIENTAÇÃO DAS BORDAS ==========
+// Com entrada em cinza (hough_sobel) cada pixel de borda traz também o bin
+// θ (0..15) da direção do gradiente, que é a normal da reta e portanto o θ
+// do Hough. Com orient_window = k >= 0 o tile vai como ORIENT_CMD e cada
+// borda vota só nos 2k+1 θ em volta da sua orientação, no FPGA e no
+// hough_sw (k = 1: 3 votos em vez de 16). Imagens binárias não têm
+// orientação e votam em todos os θ. ORIENT_WINDOW é o valor inicial: -1
+// (desligado) por padrão, porque precisa do bitstream com o
+// hough_transform ORIENTED.
+#ifndef ORIENT_WINDOW
+#define ORIENT_WINDOW -1
+#endif
+#define ORIENT_ALL 0xFF  // Janela de quem não tem orientação: todos os θ
+#define TILE_PIXELS (TILE_SIZE * TILE_SIZE)
+// n do ORIENT_CMD tem 8 bits: o tile cheio vai como bitmap e vota em todos
+// os θ, no FPGA e no hough_sw
+#define ORIENT_MAX_EDGES 255
+
+extern int orient_window;
+// Bin θ de cada pixel de global_image (só vale nas bordas e com image_oriented)
+extern uint8_t image_theta[IMAGE_PADDED_HEIGHT][IMAGE_PADDED_WIDTH];
+extern bool image_oriented;  // image_from_gray preencheu image_theta; image_clear desliga
+
+// θ no intervalo de votos de uma borda de orientação dir (distância circular)
+static inline bool theta_in_window(int theta, int dir, int window) {
+    int d = (theta - dir) & (HOUGH_THETA_BINS - 1);
+    return window >= HOUGH_THETA_BINS / 2 || d <= window || d >= HOUGH_THETA_BINS - window;
+}
+
+extern DetectedLine all_lines[MAX_LINES_TOTAL];
+extern int total_lines_detected;
+extern LineSegment line_segments[MAX_SEGMENTS_TOTAL];
+extern int total_segments;
+
+// ========== PERFIL POR ETAPA ==========
+// prof_clock (ns) é instalado por quem quer medir (o host usa o relógio de
+// CPU da thread); com NULL, prof_begin/prof_end custam só um teste.
+typedef enum {
+    STAGE_PACK,      // Tiles e empacotamento
+    STAGE_LINK,      // Montagem dos comandos, envio e espera das respostas
+    STAGE_HOUGH,     // Hough em software (hough_sw), no lugar do link
+    STAGE_CONVERT,   // Respostas → linhas em coordenadas globais
+    STAGE_MERGE,     // Junção das linhas similares
+    STAGE_RENDER,    // Desenho da imagem com as linhas
+    STAGE_COUNT
+} prof_stage_t;
+
+extern uint64_t (*prof_clock)(void);
+extern uint64_t prof_ns[STAGE_COUNT];
+
+static inline uint64_t prof_begin(void) {
+    return prof_clock ? prof_clock() : 0;
+}
+
+static inline void prof_end(prof_stage_t stage, uint64_t t0) {
+    if (prof_clock) prof_ns[stage] += prof_clock() - t0;
+}
+
+// CRC-8 do lote (polinômio 0x07, valor inicial 0), igual ao crc8() do FPGA
+static inline uint8_t crc8_update(uint8_t crc, uint8_t byte) {
+    crc ^= byte;
+    for (int i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    return crc;
+}
+
+uint8_t crc8_block(const uint8_t* data, int len);
+
+void image_clear();
+int pack_tile_rows(const bitmap_word_t* rows, int row_words, int x0, uint8_t packed[IMG_BYTES_PACKED]);
+int pack_tile(int tile_x, int tile_y, uint8_t packed[IMG_BYTES_PACKED]);
+void pack_tile_theta_rows(const uint8_t* rows, int stride, int x0, uint8_t theta[TILE_PIXELS]);
+void pack_tile_theta(int tile_x, int tile_y, uint8_t theta[TILE_PIXELS]);
+void tile_to_packed(uint8_t tile[TILE_SIZE][TILE_SIZE], uint8_t packed[IMG_BYTES_PACKED]);
+void image_to_packed(uint8_t packed[IMAGE_BYTES_PACKED]);
+int image_edges();
+int tile_edges(const uint8_t packed[IMG_BYTES_PACKED]);
+int tile_put_coords(const uint8_t packed[IMG_BYTES_PACKED], uint8_t* out);
+int tile_put_oriented(const uint8_t packed[IMG_BYTES_PACKED], const uint8_t theta[TILE_PIXELS], uint8_t* out);
+
+void update_intercepts(DetectedLine* line);
+void convert_to_global_coordinates(DetectedLine* line);
+bool lines_similar(const DetectedLine* a, const DetectedLine* b);
+bool line_is_steep(const DetectedLine* line);
+int line_raster(const DetectedLine* line, int x0, int y0, int width, int height, LinePoint* out);
+int store_tile_result(const TileResult* result, int tile_x, int tile_y);
+int store_frame_result(const TileResult* result);
+int merge_detected_lines();
+int merge_detected_lines_from(int merged);
+
+void render_image_with_lines(char display[IMAGE_HEIGHT][IMAGE_WIDTH]);
+void print_image_with_lines();
+void print_detected_lines();
+void print_frame_report();
+
+// Padrões 16×16 do modo MODE_16x16 (também o corpus dos testes do RTL)
+#define TILE_PATTERN_COUNT 10
+typedef struct {
+    const char* name;
+    void (*create)(uint8_t matrix[WIDTH][LENGHT]);
+    const char* title;     // Descrição impressa pelo firmware
+    const char* expected;  // Ângulo esperado, para conferir na saída
+} TilePattern;
+
+extern const TilePattern tile_patterns[TILE_PATTERN_COUNT];
+
+void create_diagonal(uint8_t matrix[WIDTH][LENGHT]);
+void create_vertical(uint8_t matrix[WIDTH][LENGHT]);
+void create_horizontal(uint8_t matrix[WIDTH][LENGHT]);
+void create_antidiagonal(uint8_t matrix[WIDTH][LENGHT]);
+void create_two_verticals(uint8_t matrix[WIDTH][LENGHT]);
+void create_cross(uint8_t matrix[WIDTH][LENGHT]);
+void create_square(uint8_t matrix[WIDTH][LENGHT]);
+void create_x_pattern(uint8_t matrix[WIDTH][LENGHT]);
+void create_vertical_left(uint8_t matrix[WIDTH][LENGHT]);
+void create_horizontal_top(uint8_t matrix[WIDTH][LENGHT]);
+
+void create_test_cross_64x64();
+void create_test_diagonal_64x64();
+void create_test_rectangle_64x64();
+void create_test_x_pattern_64x64();
+void create_test_pattern_64x64(int n);  // Os quatro acima, escalados para IMAGE_WIDTH × IMAGE_HEIGHT
+
+#endif  // HOUGH_CORE_H
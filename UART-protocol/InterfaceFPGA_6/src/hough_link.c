@@ -0,0 +1,834 @@
+// hough_link.c
+// Protocolo com o FPGA sobre LinkTransport (ver hough_link.h)
+
+#include "hough_link.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hough_cache.h"
+
+#define RESULT_RING_SIZE 32  // Potência de 2, maior que FPGA_MAX_INFLIGHT e que um lote de 16
+
+uint32_t link_baud = BAUD_RATE;
+uint32_t link_tx_bytes = 0;
+uint8_t rx_log[RX_LOG_SIZE];
+int rx_log_len = 0;
+
+static LinkTransport link_io;
+
+resp_state_t resp_state = RESP_IDLE;
+resp_state_t resp_record_start = RESP_WAIT_COUNT;  // Primeiro estado de cada resposta
+bool status_ready = false;
+int ctrl_reply = -1;
+TileResult result_ring[RESULT_RING_SIZE];
+uint32_t result_head = 0;           // Escrito só pelo parser
+uint32_t result_tail = 0;           // Escrito só por result_take()
+TileResult resp_cur;                // Resposta em construção
+int resp_idx = 0;
+int resp_line_bytes = TILE_LINE_BYTES;        // Bytes por linha da resposta armada
+int resp_max_lines = MAX_LINES_PER_TILE;      // num_lines acima disso é erro
+bool resp_framed = false;           // Respostas do lote: CRC no fim de cada uma
+uint8_t resp_crc = 0;               // CRC dos bytes já recebidos da resposta
+
+// Liga o protocolo a um transporte (antes de qualquer comando)
+void link_attach(const LinkTransport* transport) {
+    link_io = *transport;
+}
+
+uint64_t link_now_us() {
+    return link_io.now_us(link_io.ctx);
+}
+
+// Dorme (se o transporte souber) até chegar um byte ou until_us
+static void link_idle(uint64_t until_us) {
+    if (link_io.rx_wait) link_io.rx_wait(link_io.ctx, until_us);
+}
+
+// Publica a resposta completa no anel (só o parser chama)
+static void response_push() {
+    if (result_head - result_tail >= RESULT_RING_SIZE) {
+        resp_state = RESP_ERROR;  // Mais respostas que tiles em voo
+        return;
+    }
+    result_ring[result_head % RESULT_RING_SIZE] = resp_cur;
+    result_head++;
+}
+
+// Resposta completa: no lote ainda falta o CRC
+static void response_end() {
+    if (resp_framed) {
+        resp_state = RESP_WAIT_CRC;
+    } else {
+        resp_state = resp_record_start;
+        response_push();
+    }
+}
+
+// Avança o parser da resposta com um byte recebido
+static void response_feed(uint8_t byte) {
+    if (resp_framed && resp_state != RESP_WAIT_CRC) resp_crc = crc8_update(resp_crc, byte);
+
+    switch (resp_state) {
+        case RESP_WAIT_STATUS:
+            if (byte == READY_BYTE) status_ready = true;
+            break;
+        case RESP_WAIT_CTRL:
+            ctrl_reply = byte;
+            break;
+        case RESP_WAIT_TAG:
+            resp_cur.tile_id = byte;
+            resp_state = RESP_WAIT_COUNT;
+            break;
+        case RESP_WAIT_BATCH:
+            resp_cur.tile_id = byte;
+            resp_crc = crc8_update(0, byte);
+            resp_state = RESP_WAIT_COUNT;
+            break;
+        case RESP_WAIT_COUNT:
+        case RESP_WAIT_FRAME:
+            if (resp_framed && byte == BATCH_RETRY) {
+                resp_cur.num_lines = BATCH_RETRY;
+                resp_state = RESP_WAIT_CRC;
+            } else if (byte > resp_max_lines) {
+                resp_state = RESP_ERROR;  // Sem num_lines confiável não há como achar a próxima
+            } else {
+                resp_cur.num_lines = byte;
+                resp_idx = 0;
+                if (byte == 0) {
+                    response_end();
+                } else {
+                    resp_state = RESP_WAIT_LINES;
+                }
+            }
+            break;
+        case RESP_WAIT_LINES:
+            resp_cur.lines[resp_idx++] = byte;
+            if (resp_idx == resp_line_bytes * resp_cur.num_lines) {
+                response_end();
+            }
+            break;
+        case RESP_WAIT_STATS:
+            resp_cur.lines[resp_idx++] = byte;
+            if (resp_idx == STATS_BYTES + 1) {
+                resp_cur.num_lines = (uint8_t)resp_idx;  // resp_line_bytes = 1: um byte por "linha"
+                resp_state = RESP_IDLE;
+                response_push();
+            }
+            break;
+        case RESP_WAIT_CRC:
+            // CRC errado: o resultado não serve, o tile é reenviado
+            if (byte != resp_crc) resp_cur.num_lines = BATCH_RETRY;
+            resp_state = resp_record_start;
+            response_push();
+            break;
+        default:
+            break;  // Byte fora de transação (eco atrasado, ruído): descarta
+    }
+}
+
+// Consome os bytes que o transporte já recebeu e alimenta o parser (laço
+// principal; chamado por quem espera resposta)
+void link_poll() {
+    uint8_t buf[64];
+    size_t n;
+    while ((n = link_io.rx_read(link_io.ctx, buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (rx_log_len < RX_LOG_SIZE) rx_log[rx_log_len++] = buf[i];
+            response_feed(buf[i]);
+        }
+    }
+}
+
+// Buffer livre para montar o próximo comando (até LINK_TX_BUF_SIZE bytes)
+uint8_t* link_tx_acquire() {
+    return link_io.tx_acquire(link_io.ctx);
+}
+
+// Envia o buffer de link_tx_acquire(); não espera sair do fio
+void link_tx_submit(size_t len) {
+    link_io.tx_submit(link_io.ctx, len);
+    link_tx_bytes += len;
+}
+
+void link_send(const uint8_t* data, size_t len) {
+    memcpy(link_tx_acquire(), data, len);
+    link_tx_submit(len);
+}
+
+// Arma o parser antes de enviar comandos. Os bytes já recebidos são
+// consumidos no estado anterior (fora de transação: descartados) e as
+// respostas ainda não consumidas são descartadas. RESP_WAIT_TAG espera
+// respostas com índice; RESP_WAIT_COUNT, respostas sem índice;
+// RESP_WAIT_BATCH, registros do lote com CRC; RESP_WAIT_FRAME, a resposta
+// da imagem inteira; RESP_WAIT_STATS, o registro de telemetria (bytes
+// crus em lines, o CRC por último).
+void response_arm(resp_state_t expect) {
+    link_poll();
+    rx_log_len = 0;
+    resp_idx = 0;
+    resp_cur.tile_id = 0;
+    if (expect == RESP_WAIT_FRAME) {
+        resp_record_start = RESP_WAIT_FRAME;
+        resp_line_bytes = FRAME_LINE_BYTES;
+        resp_max_lines = MAX_LINES_PER_FRAME;
+    } else if (expect == RESP_WAIT_STATS) {
+        resp_record_start = RESP_IDLE;
+        resp_line_bytes = 1;
+        resp_max_lines = STATS_BYTES + 1;
+    } else {
+        resp_record_start = (expect == RESP_WAIT_TAG || expect == RESP_WAIT_BATCH) ? expect : RESP_WAIT_COUNT;
+        resp_line_bytes = TILE_LINE_BYTES;
+        resp_max_lines = MAX_LINES_PER_TILE;
+    }
+    resp_framed = (expect == RESP_WAIT_BATCH);
+    result_head = 0;
+    result_tail = 0;
+    status_ready = false;
+    ctrl_reply = -1;
+    resp_state = expect;
+}
+
+// Retira a próxima resposta (em ordem) do anel, se já houver uma
+bool result_take(TileResult* result) {
+    if (result_head == result_tail) return false;
+
+    const TileResult* slot = &result_ring[result_tail % RESULT_RING_SIZE];
+    result->tile_id = slot->tile_id;
+    result->num_lines = slot->num_lines;
+    int lines = (slot->num_lines == BATCH_RETRY) ? 0 : slot->num_lines;
+    for (int i = 0; i < resp_line_bytes * lines; i++) result->lines[i] = slot->lines[i];
+    result_tail++;
+    return true;
+}
+
+// Consome o RX até a próxima resposta chegar ou o prazo vencer.
+// Retorna false no prazo vencido ou em resposta malformada.
+bool result_wait(TileResult* result, uint32_t deadline_us) {
+    uint64_t deadline = link_now_us() + deadline_us;
+    link_poll();
+    while (result_head == result_tail && resp_state != RESP_ERROR) {
+        if (link_now_us() >= deadline) break;
+        link_idle(deadline);
+        link_poll();
+    }
+    return result_take(result);
+}
+
+// Espera chegar um byte de controle ou o prazo vencer
+bool ctrl_wait(uint32_t deadline_us) {
+    uint64_t deadline = link_now_us() + deadline_us;
+    link_poll();
+    while (ctrl_reply < 0) {
+        if (link_now_us() >= deadline) break;
+        link_idle(deadline);
+        link_poll();
+    }
+    resp_state = RESP_IDLE;
+    return ctrl_reply >= 0;
+}
+
+// Consulta o estado do FPGA até receber READY (pipeline vazio). Usado no
+// início e após qualquer prazo vencido, para ressincronizar sem esperas
+// arbitrárias. BUSY e silêncio levam a nova consulta.
+bool fpga_wait_ready() {
+    for (int attempt = 0; attempt < SYNC_RETRIES; attempt++) {
+        const uint8_t cmd = STATUS_CMD;
+        response_arm(RESP_WAIT_STATUS);
+        link_send(&cmd, 1);
+        uint64_t deadline = link_now_us() + STATUS_DEADLINE_US;
+        while (!status_ready) {
+            if (link_now_us() >= deadline) break;
+            link_idle(deadline);
+            link_poll();
+        }
+        if (status_ready) {
+            resp_state = RESP_IDLE;
+            return true;
+        }
+    }
+    resp_state = RESP_IDLE;
+    return false;
+}
+
+// Envia header + 32 bytes. Não espera a resposta: o chamador deve
+// respeitar o limite de tiles em voo.
+void fpga_send_tile(const uint8_t packed[IMG_BYTES_PACKED]) {
+    uint8_t* frame = link_tx_acquire();
+    frame[0] = HEADER_BYTE;
+    memcpy(&frame[1], packed, IMG_BYTES_PACKED);
+    link_tx_submit(1 + IMG_BYTES_PACKED);
+}
+
+// Envia header com índice + 32 bytes. A resposta começa com tile_id.
+void fpga_send_tile_tagged(uint8_t tile_id, const uint8_t packed[IMG_BYTES_PACKED]) {
+    uint8_t* frame = link_tx_acquire();
+    frame[0] = TAGGED_HEADER;
+    frame[1] = tile_id;
+    memcpy(&frame[2], packed, IMG_BYTES_PACKED);
+    link_tx_submit(2 + IMG_BYTES_PACKED);
+}
+
+// Envia o tile com índice na forma mais curta para o número de bordas:
+// lista de coordenadas x<<4|y (SPARSE_CMD) com até SPARSE_MAX_EDGES
+// pixels acesos, bitmap (TAGGED_HEADER) acima disso. Tile vazio não é
+// enviado (retorna false): o resultado é 0 linhas sem perguntar ao FPGA.
+bool fpga_send_tile_encoded(uint8_t tile_id, const uint8_t packed[IMG_BYTES_PACKED]) {
+    int edges = tile_edges(packed);
+    if (edges == 0) return false;
+    if (edges > SPARSE_MAX_EDGES) {
+        fpga_send_tile_tagged(tile_id, packed);
+        return true;
+    }
+
+    uint8_t* cmd = link_tx_acquire();
+    cmd[0] = SPARSE_CMD;
+    cmd[1] = tile_id;
+    cmd[2] = (uint8_t)edges;
+    link_tx_submit(3 + tile_put_coords(packed, &cmd[3]));
+    return true;
+}
+
+// Como fpga_send_tile_encoded, mas com a orientação de cada borda
+// (theta, pixel y·16 + x) e a janela orient_window: ORIENT_CMD com pares
+// (coordenada, θ). Sem theta, com a orientação desligada ou com mais de
+// ORIENT_MAX_EDGES bordas cai em fpga_send_tile_encoded (todos os θ).
+bool fpga_send_tile_oriented(uint8_t tile_id, const uint8_t packed[IMG_BYTES_PACKED], const uint8_t* theta) {
+    if (!theta || orient_window < 0) return fpga_send_tile_encoded(tile_id, packed);
+    int edges = tile_edges(packed);
+    if (edges == 0) return false;
+    if (edges > ORIENT_MAX_EDGES) {
+        fpga_send_tile_tagged(tile_id, packed);
+        return true;
+    }
+
+    uint8_t* cmd = link_tx_acquire();
+    cmd[0] = ORIENT_CMD;
+    cmd[1] = tile_id;
+    cmd[2] = (uint8_t)orient_window;
+    cmd[3] = (uint8_t)edges;
+    link_tx_submit(4 + 2 * tile_put_oriented(packed, theta, &cmd[4]));
+    return true;
+}
+
+// Envia um tile e espera a resposta completa (um tile em voo). Tile já
+// visto (hough_cache) responde sem passar pelo link.
+bool fpga_transact_tile(const uint8_t packed[IMG_BYTES_PACKED], TileResult* result) {
+    // Um tile em voo por vez: a reserva é sempre deste (nada em voo a esperar)
+    TileCacheTicket ticket = { TILE_CACHE_NONE, 0, 0 };
+    if (tile_edges(packed) > 0 && tile_cache_get(packed, 0, result, &ticket) == TILE_CACHE_HIT) return true;
+
+    response_arm(RESP_WAIT_COUNT);
+    fpga_send_tile(packed);
+    bool ok = result_wait(result, TILE_DEADLINE_US);
+    if (ok) {
+        tile_cache_fill(ticket, result);
+    } else {
+        tile_cache_drop(ticket);
+    }
+    return ok;
+}
+
+// Envia a imagem inteira (FRAME_CMD + 512 bytes) e espera a resposta: um
+// comando no lugar dos 16 tiles, sem junção de linhas entre tiles. A imagem
+// é empacotada direto no buffer de envio. Só para imagens do tamanho do
+// FRAME_SIZE do RTL: com outras, false sem enviar nada.
+bool fpga_transact_frame(TileResult* result) {
+#if !IMAGE_IS_RTL_FRAME
+    (void)result;
+    return false;
+#else
+    uint64_t t0 = prof_begin();
+    uint8_t* cmd = link_tx_acquire();
+    cmd[0] = FRAME_CMD;
+    image_to_packed(&cmd[1]);
+    prof_end(STAGE_PACK, t0);
+
+    t0 = prof_begin();
+    response_arm(RESP_WAIT_FRAME);
+    link_tx_submit(1 + FRAME_BYTES_PACKED);
+    bool ok = result_wait(result, FRAME_DEADLINE_US);
+    prof_end(STAGE_LINK, t0);
+    return ok;
+#endif
+}
+
+// Pede ao FPGA os contadores do último resultado transmitido. Só faz
+// sentido sem resultados em voo: com vários, não há como saber qual
+// foi o último (o tag no registro ajuda a conferir).
+bool fpga_query_stats(FpgaStats* stats) {
+    const uint8_t cmd = STATS_CMD;
+    TileResult reply;
+
+    response_arm(RESP_WAIT_STATS);
+    link_send(&cmd, 1);
+    bool ok = result_wait(&reply, STATS_DEADLINE_US);
+    resp_state = RESP_IDLE;
+    if (!ok || crc8_block(reply.lines, STATS_BYTES) != reply.lines[STATS_BYTES]) return false;
+
+    const uint8_t* b = reply.lines;
+    stats->seq = b[0];
+    stats->tag = b[1];
+    stats->flags = b[2];
+    stats->edges = (uint16_t)((b[3] << 8) | b[4]);
+    stats->vote_clks = (uint16_t)((b[5] << 8) | b[6]);
+    stats->merge_clks = (uint16_t)((b[7] << 8) | b[8]);
+    stats->rx_clks = ((uint32_t)b[9] << 24) | ((uint32_t)b[10] << 16) | ((uint32_t)b[11] << 8) | b[12];
+    stats->tx_clks = ((uint32_t)b[13] << 24) | ((uint32_t)b[14] << 16) | ((uint32_t)b[15] << 8) | b[16];
+    return true;
+}
+
+// Tiles do frame iguais a um tile em voo (TILE_CACHE_IN_FLIGHT) não vão ao
+// fio: cada dono tem a lista encadeada dos que esperam a resposta dele
+static int16_t waiter_head[GRID_TILES], waiter_next[GRID_TILES];
+
+static void waiters_clear() {
+    memset(waiter_head, 0xFF, sizeof(waiter_head));  // -1: ninguém esperando
+}
+
+// O tile com o ticket do dono (tile_cache_get) espera por ele, se o dono
+// for mesmo um tile em voo deste frame com a mesma reserva
+static bool waiter_add(int tile, const TileCacheTicket* tickets, const bool* in_flight) {
+    int owner = tickets[tile].owner;
+    if (owner >= GRID_TILES || !in_flight[owner] || tickets[owner].slot != tickets[tile].slot ||
+        tickets[owner].gen != tickets[tile].gen) {
+        return false;
+    }
+    waiter_next[tile] = waiter_head[owner];
+    waiter_head[owner] = (int16_t)tile;
+    return true;
+}
+
+// Publica a resposta do dono nos tiles que esperavam por ela (result
+// NULL: não veio; eles ficam sem linhas). Retorna quantos eram.
+static int waiters_finish(int owner, const TileResult* result, bool verbose) {
+    int count = 0;
+
+    for (int t = waiter_head[owner]; t >= 0; t = waiter_next[t], count++) {
+        int tx = t % GRID_COLS, ty = t / GRID_COLS;
+        if (!result) {
+            if (verbose) printf("[Tile %d/%d] Posição (%d,%d) - Sem resposta no prazo (igual ao tile %d)\n",
+                                t + 1, GRID_TILES, tx, ty, owner + 1);
+            continue;
+        }
+        uint64_t t0 = prof_begin();
+        int lines_in_tile = store_tile_result(result, tx, ty);
+        prof_end(STAGE_CONVERT, t0);
+        if (verbose) printf("[Tile %d/%d] Posição (%d,%d) - %d linhas (igual ao tile %d)\n",
+                            t + 1, GRID_TILES, tx, ty, lines_in_tile, owner + 1);
+    }
+    waiter_head[owner] = -1;
+    return count;
+}
+
+// Processa os GRID_TILES tiles mantendo até FPGA_MAX_INFLIGHT tiles em voo,
+// distribuídos pelo despachante entre os motores do FPGA. Cada tile vai
+// com o próprio índice (TAGGED_HEADER ou SPARSE_CMD) porque as respostas
+// chegam em ordem de conclusão; tiles vazios nem são enviados, e tiles já
+// vistos (sem orientação) saem do hough_cache; os iguais a um tile ainda
+// em voo esperam a resposta dele. Um crédito (banco livre)
+// volta a cada resposta recebida, que só é publicada depois que o banco do
+// tile foi liberado. Com verbose false não imprime nada (benchmark do link).
+void process_frame_pipelined(bool verbose) {
+    const int total_tiles = GRID_TILES;
+    static bool pending[GRID_TILES];  // Tile i enviado e sem resposta
+    static TileCacheTicket tickets[GRID_TILES];  // Entrada do cache de cada tile em voo
+    int inflight = 0;
+    int next_tile = 0, finished = 0;
+    uint8_t packed[IMG_BYTES_PACKED];
+    uint8_t theta[TILE_PIXELS];
+    bool oriented = image_oriented && orient_window >= 0;
+
+    memset(pending, 0, sizeof(pending));
+    waiters_clear();
+    response_arm(RESP_WAIT_TAG);
+
+    while (finished < total_tiles) {
+        // Enche o pipeline até acabarem os créditos
+        while (inflight < FPGA_MAX_INFLIGHT && next_tile < total_tiles) {
+            int tx = next_tile % GRID_COLS, ty = next_tile / GRID_COLS;
+            uint64_t t0 = prof_begin();
+            int edges = pack_tile(tx, ty, packed);
+            if (oriented) pack_tile_theta(tx, ty, theta);
+            prof_end(STAGE_PACK, t0);
+
+            TileResult cached;
+            tile_lookup_t lookup = TILE_CACHE_MISS;
+            tickets[next_tile].slot = TILE_CACHE_NONE;
+            if (!oriented && edges > 0) {
+                lookup = tile_cache_get(packed, (uint16_t)next_tile, &cached, &tickets[next_tile]);
+            }
+            if (lookup == TILE_CACHE_IN_FLIGHT && waiter_add(next_tile, tickets, pending)) {
+                next_tile++;  // Sai com a resposta do dono
+                continue;
+            }
+            if (lookup == TILE_CACHE_HIT) {
+                t0 = prof_begin();
+                int lines_in_tile = store_tile_result(&cached, tx, ty);
+                prof_end(STAGE_CONVERT, t0);
+                finished++;
+                if (verbose) {
+                    printf("[Tile %d/%d] Posição (%d,%d) - %d linhas (cache)\n",
+                           next_tile + 1, total_tiles, tx, ty, lines_in_tile);
+                }
+                next_tile++;
+                continue;
+            }
+
+            t0 = prof_begin();
+            bool sent = fpga_send_tile_oriented((uint8_t)next_tile, packed, oriented ? theta : NULL);
+            prof_end(STAGE_LINK, t0);
+            if (sent) {
+                pending[next_tile] = true;
+                inflight++;
+            } else {
+                finished++;  // Vazio: nenhuma linha, nada no fio
+                if (verbose) {
+                    printf("[Tile %d/%d] Posição (%d,%d) - Vazio, não enviado\n",
+                           next_tile + 1, total_tiles, tx, ty);
+                }
+            }
+            next_tile++;
+        }
+        if (inflight == 0) continue;  // Só restavam tiles vazios
+
+        TileResult result;
+
+        uint64_t t0 = prof_begin();
+        bool ok = result_wait(&result, TILE_DEADLINE_US);
+        prof_end(STAGE_LINK, t0);
+        if (!ok || result.tile_id >= total_tiles || !pending[result.tile_id]) {
+            // Prazo vencido ou índice inesperado: descarta os tiles em voo
+            // e ressincroniza pelo handshake READY antes de continuar
+            for (int i = 0; i < total_tiles; i++) {
+                if (!pending[i]) continue;
+                if (verbose) {
+                    printf("[Tile %d/%d] Posição (%d,%d) - Sem resposta no prazo\n",
+                           i + 1, total_tiles, i % GRID_COLS, i / GRID_COLS);
+                }
+                tile_cache_drop(tickets[i]);
+                finished += waiters_finish(i, NULL, verbose);
+            }
+            finished += inflight;
+            inflight = 0;
+            memset(pending, 0, sizeof(pending));
+            fpga_wait_ready();
+            response_arm(RESP_WAIT_TAG);
+            continue;
+        }
+
+        int idx = result.tile_id;
+        int tx = idx % GRID_COLS, ty = idx / GRID_COLS;
+        pending[idx] = false;
+        inflight--;
+        finished++;
+        tile_cache_fill(tickets[idx], &result);
+
+        t0 = prof_begin();
+        int lines_in_tile = store_tile_result(&result, tx, ty);
+        prof_end(STAGE_CONVERT, t0);
+        if (verbose) {
+            printf("[Tile %d/%d] Posição (%d,%d) - ", idx + 1, total_tiles, tx, ty);
+            if (lines_in_tile > 0) {
+                printf("%d linhas detectadas\n", lines_in_tile);
+            } else {
+                printf("Nenhuma linha detectada\n");
+            }
+        }
+        finished += waiters_finish(idx, &result, verbose);
+    }
+}
+
+// Envia os tiles first .. first + count - 1 (até BATCH_MAX_TILES) num único
+// lote BATCH_CMD: um cabeçalho, um registro por tile não vazio (esparso ou
+// bitmap, cada um com CRC) e uma resposta com tag e CRC por registro. Só
+// voltam para o fio os tiles cuja resposta veio como BATCH_RETRY (CRC
+// errado ou sem banco livre no FPGA), veio corrompida ou não veio no
+// prazo. O seq no cabeçalho muda a cada envio, então respostas atrasadas
+// de um envio anterior trazem outro tag e são ignoradas.
+static void batch_tiles(int first, int count, const uint8_t (*packed)[IMG_BYTES_PACKED],
+                        const uint16_t* edges, const TileCacheTicket* tickets, bool verbose) {
+    static uint8_t seq = 0;
+    uint32_t pending = 0;  // Bit i: tile first + i ainda sem resultado válido
+    uint64_t t0;
+
+    for (int i = 0; i < count; i++) {
+        if (edges[i] > 0) pending |= 1u << i;
+    }
+
+    for (int attempt = 0; pending && attempt < BATCH_RETRIES; attempt++) {
+        seq = (seq + 1) & 0x0F;
+
+        // Monta o lote direto no buffer de envio
+        t0 = prof_begin();
+        uint8_t* cmd = link_tx_acquire();
+        int n = 4, records = 0;
+        for (int i = 0; i < count; i++) {
+            if (!(pending & (1u << i))) continue;
+            int start = n;
+            cmd[n++] = (uint8_t)i;
+            if (edges[i] > SPARSE_MAX_EDGES) {
+                cmd[n++] = BATCH_BITMAP;
+                memcpy(&cmd[n], packed[i], IMG_BYTES_PACKED);
+                n += IMG_BYTES_PACKED;
+            } else {
+                cmd[n++] = (uint8_t)edges[i];
+                n += tile_put_coords(packed[i], &cmd[n]);
+            }
+            cmd[n] = crc8_block(&cmd[start], n - start);
+            n++;
+            records++;
+        }
+        cmd[0] = BATCH_CMD;
+        cmd[1] = seq;
+        cmd[2] = (uint8_t)records;
+        cmd[3] = crc8_block(&cmd[1], 2);
+
+        // Prazo de cada resposta: o lote inteiro no fio, o cálculo e todas
+        // as respostas (os motores terminam fora de ordem)
+        uint32_t deadline_us = WIRE_TIME_US(n) + HOUGH_COMPUTE_US +
+                               WIRE_TIME_US(records * (3 + TILE_LINE_BYTES * MAX_LINES_PER_TILE)) +
+                               DEADLINE_MARGIN_US;
+        response_arm(RESP_WAIT_BATCH);
+        link_tx_submit(n);
+
+        uint32_t outstanding = pending;  // Registros deste envio ainda sem resposta
+        int refused = 0;
+        while (outstanding) {
+            TileResult result;
+            if (!result_wait(&result, deadline_us)) break;  // Prazo ou resposta ilegível
+
+            int idx = result.tile_id & 0x0F;
+            if ((result.tile_id >> 4) != seq || !(outstanding & (1u << idx))) continue;
+            outstanding &= ~(1u << idx);
+            if (result.num_lines == BATCH_RETRY) {
+                refused++;  // Continua em pending: volta no próximo envio
+                continue;
+            }
+            pending &= ~(1u << idx);
+            tile_cache_fill(tickets[idx], &result);
+
+            int tile = first + idx;
+            int tx = tile % GRID_COLS, ty = tile / GRID_COLS;
+            prof_end(STAGE_LINK, t0);
+            t0 = prof_begin();
+            int lines_in_tile = store_tile_result(&result, tx, ty);
+            prof_end(STAGE_CONVERT, t0);
+            if (verbose) {
+                printf("[Tile %d/%d] Posição (%d,%d) - ", tile + 1, GRID_TILES, tx, ty);
+                if (lines_in_tile > 0) {
+                    printf("%d linhas detectadas\n", lines_in_tile);
+                } else {
+                    printf("Nenhuma linha detectada\n");
+                }
+            }
+            waiters_finish(tile, &result, verbose);
+            t0 = prof_begin();
+        }
+
+        // Silêncio ou dessincronia: espera o FPGA esvaziar antes de reenviar
+        if (outstanding) fpga_wait_ready();
+        prof_end(STAGE_LINK, t0);
+        if (verbose && pending) {
+            printf("[Lote %d] %d recusados, %d sem resposta: reenviando só esses\n",
+                   seq, refused, __builtin_popcount(outstanding));
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!(pending & (1u << i))) continue;
+        int tile = first + i;
+        if (verbose) {
+            printf("[Tile %d/%d] Posição (%d,%d) - Sem resposta válida após %d envios\n",
+                   tile + 1, GRID_TILES, tile % GRID_COLS, tile / GRID_COLS, BATCH_RETRIES);
+        }
+        tile_cache_drop(tickets[i]);
+        waiters_finish(tile, NULL, verbose);
+    }
+}
+
+// Processa os GRID_TILES tiles em lotes de até BATCH_MAX_TILES (um só na
+// grade 4×4 de 64×64). Tiles já vistos saem do hough_cache e ficam fora do
+// lote, como os vazios; os iguais a um tile do lote esperam a resposta dele.
+void process_frame_batched(bool verbose) {
+    static uint8_t packed[GRID_TILES][IMG_BYTES_PACKED];
+    static uint16_t edges[GRID_TILES];
+    static TileCacheTicket tickets[GRID_TILES];
+    static bool in_batch[GRID_TILES];  // Tile vai no lote (dono de quem for igual a ele)
+
+    uint64_t t0 = prof_begin();
+    memset(in_batch, 0, sizeof(in_batch));
+    for (int i = 0; i < GRID_TILES; i++) {
+        edges[i] = (uint16_t)pack_tile(i % GRID_COLS, i / GRID_COLS, packed[i]);
+        if (edges[i] == 0 && verbose) {
+            printf("[Tile %d/%d] Posição (%d,%d) - Vazio, não enviado\n",
+                   i + 1, GRID_TILES, i % GRID_COLS, i / GRID_COLS);
+        }
+    }
+    prof_end(STAGE_PACK, t0);
+
+    waiters_clear();
+    for (int i = 0; i < GRID_TILES; i++) {
+        TileResult cached;
+        tickets[i].slot = TILE_CACHE_NONE;
+        if (edges[i] == 0) continue;
+        tile_lookup_t lookup = tile_cache_get(packed[i], (uint16_t)i, &cached, &tickets[i]);
+        if (lookup == TILE_CACHE_IN_FLIGHT && waiter_add(i, tickets, in_batch)) {
+            edges[i] = 0;  // Fora do lote: sai com a resposta do dono
+            continue;
+        }
+        in_batch[i] = lookup != TILE_CACHE_HIT;
+        if (in_batch[i]) continue;
+        edges[i] = 0;  // Fora do lote
+        t0 = prof_begin();
+        int lines_in_tile = store_tile_result(&cached, i % GRID_COLS, i / GRID_COLS);
+        prof_end(STAGE_CONVERT, t0);
+        if (verbose) {
+            printf("[Tile %d/%d] Posição (%d,%d) - %d linhas (cache)\n",
+                   i + 1, GRID_TILES, i % GRID_COLS, i / GRID_COLS, lines_in_tile);
+        }
+    }
+
+    for (int first = 0; first < GRID_TILES; first += BATCH_MAX_TILES) {
+        int count = GRID_TILES - first < BATCH_MAX_TILES ? GRID_TILES - first : BATCH_MAX_TILES;
+        batch_tiles(first, count, &packed[first], &edges[first], &tickets[first], verbose);
+    }
+}
+
+// Processa a imagem 64×64 em um único comando (outros tamanhos: só tiles)
+void process_frame_whole(bool verbose) {
+#if !IMAGE_IS_RTL_FRAME
+    if (verbose) printf("[Imagem %dx%d] FRAME_CMD só para %dx%d: use os tiles\n",
+                        IMAGE_WIDTH, IMAGE_HEIGHT, FRAME_RTL_SIZE, FRAME_RTL_SIZE);
+#else
+    TileResult result;
+
+    if (!fpga_transact_frame(&result)) {
+        if (verbose) printf("[Imagem %dx%d] Sem resposta no prazo\n", IMAGE_WIDTH, IMAGE_HEIGHT);
+        fpga_wait_ready();
+        return;
+    }
+
+    uint64_t t0 = prof_begin();
+    int lines = store_frame_result(&result);
+    prof_end(STAGE_CONVERT, t0);
+    if (verbose) printf("[Imagem %dx%d] %d linhas detectadas\n", IMAGE_WIDTH, IMAGE_HEIGHT, lines);
+#endif
+}
+
+// ========== TELEMETRIA ==========
+// Passada de medição, separada do processamento rápido: um tile por vez
+// (tag + forma mais curta, como no pipeline), cada resultado seguido de
+// STATS_CMD. Sem outro resultado em voo, o registro do FPGA é o deste
+// tile, o que o tag e as flags confirmam.
+
+// Registros dos GRID_TILES tiles do frame em records (tiles vazios vão sem passar
+// pelo FPGA, com contadores zerados). As linhas entram em all_lines.
+// Retorna quantos registros foram preenchidos; tiles sem resposta ou sem
+// telemetria válida ficam de fora (e o link é ressincronizado).
+int telemetry_collect_tiles(uint16_t frame, TelemetryRecord records[GRID_TILES]) {
+    uint8_t packed[IMG_BYTES_PACKED];
+    uint8_t theta[TILE_PIXELS];
+    bool oriented = image_oriented && orient_window >= 0;
+    int count = 0;
+
+    for (int i = 0; i < GRID_TILES; i++) {
+        TelemetryRecord* rec = &records[count];
+        TileResult result;
+        int tx = i % GRID_COLS, ty = i / GRID_COLS;
+
+        pack_tile(tx, ty, packed);
+        if (oriented) pack_tile_theta(tx, ty, theta);
+        memset(rec, 0, sizeof(*rec));
+        rec->frame = frame;
+        rec->tile = (int16_t)i;
+        rec->first_line = (uint16_t)total_lines_detected;
+
+        response_arm(RESP_WAIT_TAG);
+        uint64_t t0 = link_now_us();
+        if (!fpga_send_tile_oriented((uint8_t)i, packed, oriented ? theta : NULL)) {
+            count++;  // Vazio: 0 linhas, nada no fio
+            continue;
+        }
+        if (!result_wait(&result, TILE_DEADLINE_US) || result.tile_id != i) {
+            fpga_wait_ready();
+            continue;
+        }
+        rec->link_us = (uint32_t)(link_now_us() - t0);
+        rec->num_lines = (uint8_t)store_tile_result(&result, tx, ty);
+
+        if (!fpga_query_stats(&rec->fpga) || rec->fpga.tag != i ||
+            !(rec->fpga.flags & STATS_TAGGED) || (rec->fpga.flags & STATS_FRAME)) {
+            total_lines_detected = rec->first_line;
+            fpga_wait_ready();
+            continue;
+        }
+        count++;
+    }
+    return count;
+}
+
+// Registro da imagem inteira (FRAME_CMD); as linhas entram em all_lines
+bool telemetry_collect_whole(uint16_t frame, TelemetryRecord* record) {
+    TileResult result;
+
+    memset(record, 0, sizeof(*record));
+    record->frame = frame;
+    record->tile = -1;
+    record->first_line = (uint16_t)total_lines_detected;
+
+    uint64_t t0 = link_now_us();
+    if (!fpga_transact_frame(&result)) {
+        fpga_wait_ready();
+        return false;
+    }
+    record->link_us = (uint32_t)(link_now_us() - t0);
+    record->num_lines = (uint8_t)store_frame_result(&result);
+
+    if (!fpga_query_stats(&record->fpga) || !(record->fpga.flags & STATS_FRAME)) {
+        total_lines_detected = record->first_line;
+        fpga_wait_ready();
+        return false;
+    }
+    return true;
+}
+
+// Formato CSV lido por gerar_graficos_resultados.py; o primeiro campo diz
+// o tipo do registro
+void telemetry_print_header() {
+    printf("# TELEMETRIA clk_hz=%d baud=%lu\n", FPGA_CLK_HZ, (unsigned long)link_baud);
+    printf("# T,frame,tile,lines,edges,vote_clks,merge_clks,rx_clks,tx_clks,link_us,seq,flags\n");
+    printf("# L,frame,tile,rho,theta,votes,global_rho\n");
+    printf("# F,frame,raw_lines,unique_lines,frame_us\n");
+    printf("# U,frame,global_rho,theta,votes\n");
+    printf("# S,frame,line,x0,y0,x1,y1,tiles,votes\n");
+}
+
+// Uma linha T do registro e uma L por linha detectada
+void telemetry_print(const TelemetryRecord* record) {
+    const FpgaStats* f = &record->fpga;
+    printf("T,%u,%d,%u,%u,%u,%u,%lu,%lu,%lu,%u,%u\n", record->frame, record->tile,
+           record->num_lines, f->edges, f->vote_clks, f->merge_clks, (unsigned long)f->rx_clks,
+           (unsigned long)f->tx_clks, (unsigned long)record->link_us, f->seq, f->flags);
+    for (int i = 0; i < record->num_lines; i++) {
+        const DetectedLine* line = &all_lines[record->first_line + i];
+        printf("L,%u,%d,%u,%u,%u," Q8_FMT "\n", record->frame, record->tile,
+               line->rho, theta_bin_to_deg(line->theta_bin), line->votes, Q8_ARGS(line->global_rho_q8));
+    }
+}
+
+// Resumo do frame, as linhas únicas e seus trechos (chamar depois de
+// merge_detected_lines)
+void telemetry_print_merged(uint16_t frame, int raw_lines, uint32_t frame_us) {
+    printf("F,%u,%d,%d,%lu\n", frame, raw_lines, total_lines_detected, (unsigned long)frame_us);
+    for (int i = 0; i < total_lines_detected; i++) {
+        const DetectedLine* line = &all_lines[i];
+        printf("U,%u," Q8_FMT ",%u,%u\n", frame, Q8_ARGS(line->global_rho_q8),
+               theta_bin_to_deg(line->theta_bin), line->votes);
+    }
+    for (int i = 0; i < total_segments; i++) {
+        const LineSegment* seg = &line_segments[i];
+        printf("S,%u,%d,%d,%d,%d,%d,%u,%lu\n", frame, seg->line, seg->start.x, seg->start.y,
+               seg->end.x, seg->end.y, seg->tiles, (unsigned long)seg->votes);
+    }
+}
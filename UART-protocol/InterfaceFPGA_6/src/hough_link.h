@@ -0,0 +1,169 @@
+// hough_link.h
+// Protocolo com o FPGA sobre um transporte de bytes: montagem dos comandos,
+// parser das respostas, prazos e o processamento de um frame. O transporte
+// (LinkTransport) é a única parte que muda entre o Pico (UART por DMA) e o
+// host (pipe/pty com o FPGA simulado).
+
+#ifndef HOUGH_LINK_H
+#define HOUGH_LINK_H
+
+#include "hough_core.h"
+
+#define BAUD_RATE 9600    // Taxa inicial e de recuperação (baud_rate no FPGA)
+#define HEADER_BYTE 0xAA  // Byte de sincronização
+#define TAGGED_HEADER 0xAB  // Tile com índice: resposta começa com o mesmo índice
+#define FRAME_CMD 0xAC    // Imagem inteira: resposta [num_lines][ρ_hi, ρ_lo, θ, votes]...
+#define SPARSE_CMD 0xAD   // Tile esparso: SPARSE_CMD + tile_id + n + n × (x<<4|y), resposta como 0xAB
+#define BATCH_CMD 0xAE    // Lote: BATCH_CMD + seq + n + crc, depois n × [idx, len, payload, crc]
+#define BATCH_BITMAP 0xFF // len do registro: payload é o bitmap de 32 bytes
+#define BATCH_RETRY 0xFF  // num_lines da resposta do lote: tile recusado, reenviar
+#define BATCH_RETRIES 4   // Envios do lote (o primeiro + reenvios seletivos)
+#define BATCH_MAX_TILES 16  // Registros por lote: o índice ocupa 4 bits do tag da resposta (seq << 4)
+#define ORIENT_CMD 0xAF   // Tile orientado: ORIENT_CMD + tile_id + k + n + n × (x<<4|y, θ), resposta como 0xAB
+
+#if GRID_TILES > 256
+#error "O tag de tile (TAGGED_HEADER/SPARSE_CMD) tem 8 bits"
+#endif
+#define STATUS_CMD 0xA5   // Consulta de estado: FPGA responde READY_BYTE ou BUSY_BYTE
+#define READY_BYTE 0x52   // 'R': pipeline do FPGA vazio
+#define BUSY_BYTE 0x42    // 'B': ainda há tiles/resultados em andamento
+#define BAUD_CMD 0xA6     // Troca de taxa: BAUD_CMD + divisor (16 bits, big-endian)
+#define BAUD_CONFIRM 0xA7 // Sonda na nova taxa: o FPGA ecoa o mesmo byte
+#define ACK_BYTE 0x41     // 'A': FPGA aceitou o divisor e já trocou de taxa
+#define NAK_BYTE 0x4E     // 'N': divisor inválido ou pipeline ocupado
+#define STATS_CMD 0xA8    // Telemetria do último resultado transmitido: STATS_BYTES + CRC
+#define STATS_BYTES 17    // seq, tag, flags, edges, vote, merge (16 bits), rx, tx (32 bits)
+#define STATS_FRAME 0x01  // flags: resultado do motor de imagem inteira
+#define STATS_TAGGED 0x02 // flags: resposta com tag (0xAB/0xAD/0xAE)
+#define STATS_BATCH 0x04  // flags: registro de lote (resposta com CRC)
+#define FPGA_CLK_HZ 25000000         // Clock da Colorlight i9 (clk_freq)
+#define FPGA_MIN_CLKS_PER_BIT 8      // MIN_CLKS_PER_BIT: 25 MHz / 8 = 3.125 Mbaud
+#define FPGA_BAUD_CONFIRM_US 50000   // BAUD_CONFIRM_CLKS: janela da sonda no FPGA
+#define FPGA_BANKS 2      // Bancos da memória ping-pong de cada motor Hough
+#define FPGA_ENGINES 4    // Deve bater com NUM_ENGINES em uart_echo_colorlight_i9.sv
+#define FPGA_MAX_INFLIGHT (FPGA_ENGINES * FPGA_BANKS)  // Tiles em voo: um por banco livre
+
+// ========== PRAZOS (substituem os sleeps fixos) ==========
+// Tempo de fio de N bytes em 8N1 (10 bits por byte) na taxa atual do link
+#define WIRE_TIME_US(nbytes) ((uint32_t)(((uint64_t)(nbytes) * 10u * 1000000u) / link_baud))
+// Hough no FPGA: VOTE (≤ 32 bytes + 256 bordas) + junção dos picos (16)
+// ciclos @ 25 MHz ≈ 12 µs no pior caso
+#define HOUGH_COMPUTE_US 100
+#define DEADLINE_MARGIN_US 20000  // Folga para latência do USB no Pico
+// Prazo total de um tile: envio + processamento + resposta máxima (1 + 3×4 bytes).
+// O maior envio é o tile orientado quando orient_window está ligado.
+#define TILE_MAX_CMD_BYTES (orient_window >= 0 ? 4 + 2 * ORIENT_MAX_EDGES : 2 + IMG_BYTES_PACKED)
+#define TILE_DEADLINE_US (WIRE_TIME_US(TILE_MAX_CMD_BYTES) + HOUGH_COMPUTE_US + \
+                          WIRE_TIME_US(1 + 3 * MAX_LINES_PER_TILE) + DEADLINE_MARGIN_US)
+#define STATUS_DEADLINE_US (WIRE_TIME_US(2) + DEADLINE_MARGIN_US)
+#define STATS_DEADLINE_US (WIRE_TIME_US(2 + STATS_BYTES) + DEADLINE_MARGIN_US)
+// Hough da imagem inteira: VOTE (≤ 512 bytes + 4096 bordas) + 1 + junção (16)
+// ciclos @ 25 MHz ≈ 185 µs no pior caso
+#define FRAME_COMPUTE_US 500
+#define FRAME_DEADLINE_US (WIRE_TIME_US(1 + FRAME_BYTES_PACKED) + FRAME_COMPUTE_US + \
+                           WIRE_TIME_US(1 + FRAME_LINE_BYTES * MAX_LINES_PER_FRAME) + DEADLINE_MARGIN_US)
+#define SYNC_RETRIES 5
+
+#define LINK_TX_BUF_SIZE 576  // Maior comando: lote de 16 bitmaps (4 + 16 × 35 bytes)
+#define RX_LOG_SIZE 256
+
+// Transporte do link. Enviar é em duas etapas para o Pico montar o comando
+// direto no buffer do DMA: tx_acquire dá um buffer de LINK_TX_BUF_SIZE
+// bytes e tx_submit envia os len primeiros (sem esperar saírem do fio).
+// rx_read copia até max bytes já recebidos, sem bloquear. rx_wait
+// (opcional) dorme até chegar algum byte ou o relógio passar de until_us;
+// NULL: quem espera fica consultando rx_read.
+typedef struct {
+    uint8_t* (*tx_acquire)(void* ctx);
+    void (*tx_submit)(void* ctx, size_t len);
+    size_t (*rx_read)(void* ctx, uint8_t* buf, size_t max);
+    void (*rx_wait)(void* ctx, uint64_t until_us);
+    uint64_t (*now_us)(void* ctx);  // Relógio monotônico
+    void* ctx;
+} LinkTransport;
+
+// ========== PARSER DA RESPOSTA (alimentado por link_poll) ==========
+// As respostas são interpretadas à medida que chegam: [tile_id] (só no modo
+// com índice), num_lines, depois [ρ, θ, votes] × num_lines (imagem inteira:
+// [ρ_hi, ρ_lo, θ, votes] × num_lines; lote: [tag] num_lines [...] [crc]).
+// Cada resposta completa entra no anel result_ring (em ordem de chegada,
+// que com vários motores é a ordem de conclusão); quem espera consome o
+// RX até a resposta aparecer ou o prazo vencer, sem adivinhar quanto o
+// FPGA leva.
+typedef enum {
+    RESP_IDLE,          // Nenhuma transação em andamento: bytes são descartados
+    RESP_WAIT_STATUS,   // Aguardando READY_BYTE
+    RESP_WAIT_CTRL,     // Aguardando um byte de controle (ACK/NAK, eco da sonda)
+    RESP_WAIT_TAG,      // Aguardando tile_id
+    RESP_WAIT_BATCH,    // Aguardando o tag de um registro do lote (termina com CRC)
+    RESP_WAIT_COUNT,    // Aguardando num_lines
+    RESP_WAIT_FRAME,    // Aguardando num_lines da imagem inteira (FRAME_CMD)
+    RESP_WAIT_LINES,    // Aguardando resp_line_bytes × num_lines bytes
+    RESP_WAIT_CRC,      // Aguardando o CRC do registro do lote
+    RESP_WAIT_STATS,    // Aguardando STATS_BYTES + CRC da telemetria
+    RESP_ERROR          // num_lines inválido ou anel cheio: requer ressincronização
+} resp_state_t;
+
+// Contadores do FPGA para um resultado (resposta ao STATS_CMD), em ciclos
+// de FPGA_CLK_HZ
+typedef struct {
+    uint8_t seq;          // Resultados transmitidos pelo FPGA (mod 256)
+    uint8_t tag;          // Tag do resultado (0 sem tag)
+    uint8_t flags;        // STATS_FRAME | STATS_TAGGED | STATS_BATCH
+    uint16_t edges;       // Pixels de borda votados
+    uint16_t vote_clks;   // VOTE + esvaziamento do pipeline
+    uint16_t merge_clks;  // Busca de picos (junção dos bancos θ)
+    uint32_t rx_clks;     // Do header ao commit do banco
+    uint32_t tx_clks;     // Da resposta inteira no fio
+} FpgaStats;
+
+// Registro de telemetria de um tile (ou da imagem inteira): o que os
+// gráficos usam, em vez de números copiados da saída serial
+typedef struct {
+    uint16_t frame;
+    int16_t tile;         // 0..GRID_TILES-1, -1: imagem inteira
+    uint8_t num_lines;
+    uint16_t first_line;  // Linhas do tile em all_lines[first_line ..]
+    uint32_t link_us;     // Envio → resposta completa, medido no Pico
+    FpgaStats fpga;
+} TelemetryRecord;
+
+extern uint32_t link_baud;      // Taxa atual da UART (mesma nos dois lados)
+extern uint32_t link_tx_bytes;  // Bytes enviados desde o boot (estatística)
+extern uint8_t rx_log[RX_LOG_SIZE];  // Bytes recebidos desde o último response_arm() (diagnóstico)
+extern int rx_log_len;
+extern resp_state_t resp_state;
+extern int ctrl_reply;          // Último byte de controle recebido (-1: nenhum)
+
+void link_attach(const LinkTransport* transport);
+uint64_t link_now_us();
+void link_poll();
+uint8_t* link_tx_acquire();
+void link_tx_submit(size_t len);
+void link_send(const uint8_t* data, size_t len);
+
+void response_arm(resp_state_t expect);
+bool result_take(TileResult* result);
+bool result_wait(TileResult* result, uint32_t deadline_us);
+bool ctrl_wait(uint32_t deadline_us);
+
+bool fpga_wait_ready();
+void fpga_send_tile(const uint8_t packed[IMG_BYTES_PACKED]);
+void fpga_send_tile_tagged(uint8_t tile_id, const uint8_t packed[IMG_BYTES_PACKED]);
+bool fpga_send_tile_encoded(uint8_t tile_id, const uint8_t packed[IMG_BYTES_PACKED]);
+bool fpga_send_tile_oriented(uint8_t tile_id, const uint8_t packed[IMG_BYTES_PACKED], const uint8_t* theta);
+bool fpga_transact_tile(const uint8_t packed[IMG_BYTES_PACKED], TileResult* result);
+bool fpga_transact_frame(TileResult* result);
+bool fpga_query_stats(FpgaStats* stats);
+
+void process_frame_pipelined(bool verbose);
+void process_frame_batched(bool verbose);
+void process_frame_whole(bool verbose);
+
+int telemetry_collect_tiles(uint16_t frame, TelemetryRecord records[GRID_TILES]);
+bool telemetry_collect_whole(uint16_t frame, TelemetryRecord* record);
+void telemetry_print_header();
+void telemetry_print(const TelemetryRecord* record);
+void telemetry_print_merged(uint16_t frame, int raw_lines, uint32_t frame_us);
+
+#endif  // HOUGH_LINK_H
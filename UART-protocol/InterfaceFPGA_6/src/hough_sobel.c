@@ -0,0 +1,129 @@
+// hough_sobel.c
+// Sobel em inteiros com anel de 3 linhas (ver hough_sobel.h)
+
+#include "hough_sobel.h"
+
+#include <string.h>
+
+#if IMAGE_WIDTH > SOBEL_MAX_WIDTH
+#error "image_from_gray: IMAGE_WIDTH maior que SOBEL_MAX_WIDTH"
+#endif
+
+uint16_t sobel_threshold = SOBEL_THRESHOLD;
+
+static uint8_t sobel_lines[3][SOBEL_MAX_WIDTH];  // Anel: linha y em sobel_lines[y % 3]
+static int sobel_width = 0;
+static int sobel_rows = 0;                       // Linhas recebidas
+
+// Fronteiras entre os bins θ (5,625° + k · 11,25°), cos/sin × 256
+static const int16_t sobel_edge_cos[HOUGH_THETA_BINS] = {
+    255, 245, 226, 198, 162, 121, 74, 25, -25, -74, -121, -162, -198, -226, -245, -255
+};
+static const int16_t sobel_edge_sin[HOUGH_THETA_BINS] = {
+    25, 74, 121, 162, 198, 226, 245, 255, 255, 245, 226, 198, 162, 121, 74, 25
+};
+
+// Direção (gx, gy) → bin θ: rebatida para [0°, 180°) e comparada com as
+// fronteiras por produto vetorial (busca binária, 4 comparações, sem atan)
+uint8_t sobel_theta_bin(int gx, int gy) {
+    if (gy < 0 || (gy == 0 && gx < 0)) {
+        gx = -gx;
+        gy = -gy;
+    }
+    int lo = 0, hi = HOUGH_THETA_BINS;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (sobel_edge_cos[mid] * gy - sobel_edge_sin[mid] * gx > 0) {
+            lo = mid + 1;  // Passou da fronteira mid
+        } else {
+            hi = mid;
+        }
+    }
+    return (uint8_t)(lo & (HOUGH_THETA_BINS - 1));  // Depois de 174,375° volta ao bin 0
+}
+
+// As duas somas de coluna da janela: s = cima + 2·meio + baixo entra em
+// gx = s[x+1] - s[x-1]; d = baixo - cima entra em gy = d[x-1] + 2·d[x] +
+// d[x+1]. Cada coluna é somada uma vez só e a janela anda em registradores.
+// Com theta, cada pixel de borda recebe também o bin da sua direção.
+void sobel_row(const uint8_t* top, const uint8_t* mid, const uint8_t* bot, int width, bitmap_word_t* edges,
+               uint8_t* theta) {
+    const int threshold = sobel_threshold;
+    const int words = (width + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+    bitmap_word_t word = 0;  // Coluna 0: borda da imagem, sempre 0
+    int w = 0;
+
+    if (width >= 3) {
+        int s_prev = top[0] + 2 * mid[0] + bot[0], d_prev = bot[0] - top[0];
+        int s_cur = top[1] + 2 * mid[1] + bot[1], d_cur = bot[1] - top[1];
+
+        for (int x = 1; x < width - 1; x++) {
+            int s_next = top[x + 1] + 2 * mid[x + 1] + bot[x + 1];
+            int d_next = bot[x + 1] - top[x + 1];
+            int gx = s_next - s_prev;
+            int gy = d_prev + 2 * d_cur + d_next;
+            int mag = (gx < 0 ? -gx : gx) + (gy < 0 ? -gy : gy);
+
+            bool edge = mag > threshold;
+            if (edge && theta) theta[x] = sobel_theta_bin(gx, gy);
+            word |= (bitmap_word_t)edge << (x % BITMAP_WORD_BITS);
+            if (x % BITMAP_WORD_BITS == BITMAP_WORD_BITS - 1) {
+                edges[w++] = word;
+                word = 0;
+            }
+            s_prev = s_cur;
+            s_cur = s_next;
+            d_prev = d_cur;
+            d_cur = d_next;
+        }
+    }
+    // Resto da última palavra (coluna width - 1 é borda) e palavras vazias
+    while (w < words) {
+        edges[w++] = word;
+        word = 0;
+    }
+}
+
+bool sobel_begin(int width) {
+    if (width <= 0 || width > SOBEL_MAX_WIDTH) return false;
+    sobel_width = width;
+    sobel_rows = 0;
+    return true;
+}
+
+bool sobel_push_row(const uint8_t* gray, bitmap_word_t* edges, uint8_t* theta) {
+    int y = sobel_rows++;
+
+    memcpy(sobel_lines[y % 3], gray, sobel_width);
+    if (y == 0) return false;
+    if (y == 1) {
+        // Linha 0: borda de cima
+        memset(edges, 0, sizeof(bitmap_word_t) * ((sobel_width + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS));
+        return true;
+    }
+    sobel_row(sobel_lines[(y - 2) % 3], sobel_lines[(y - 1) % 3], sobel_lines[y % 3], sobel_width, edges, theta);
+    return true;
+}
+
+bool sobel_finish(bitmap_word_t* edges) {
+    if (sobel_rows == 0) return false;
+    memset(edges, 0, sizeof(bitmap_word_t) * ((sobel_width + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS));
+    sobel_rows = 0;
+    return true;
+}
+
+int image_from_gray(const uint8_t* gray, int stride) {
+    uint64_t t0 = prof_begin();
+
+    image_clear();
+    sobel_begin(IMAGE_WIDTH);
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+        // A linha y fecha a janela da linha y - 1
+        int out = y > 0 ? y - 1 : 0;
+        sobel_push_row(gray + y * stride, global_image[out], image_theta[out]);
+    }
+    sobel_finish(global_image[IMAGE_HEIGHT - 1]);
+    image_oriented = true;
+    prof_end(STAGE_PACK, t0);
+    return image_edges();
+}
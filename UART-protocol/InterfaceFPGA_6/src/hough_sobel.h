@@ -0,0 +1,57 @@
+// hough_sobel.h
+// Entrada em tons de cinza: Sobel → magnitude → limiar → bits numa passada
+// só, sem imagem de gradiente intermediária e só com inteiros. As linhas
+// chegam uma a uma e ficam num anel de 3 linhas (como as duas
+// lane_linemem de lane_sobel.vhd mais a linha que está chegando); cada
+// linha nova fecha a janela 3×3 da linha anterior, que sai já no formato
+// do bitmap (pixel x = bit x % 32 da palavra x / 32), ou seja, direto em
+// global_image ou na faixa de hough_stream, prontas para pack_tile.
+//
+// Magnitude: |gx| + |gy| (sem multiplicação nem raiz), comparada com
+// sobel_threshold. As bordas da imagem (primeira e última linha e coluna)
+// não têm vizinhança completa e saem sem bordas detectadas.
+//
+// Orientação: o Gx/Gy que já está na mão vira o bin θ (0..15, o da LUT do
+// Hough) de cada pixel de borda, para a votação orientada (orient_window,
+// ORIENT_CMD): a direção do gradiente é a normal da reta.
+
+#ifndef HOUGH_SOBEL_H
+#define HOUGH_SOBEL_H
+
+#include "hough_core.h"
+
+#define SOBEL_MAX_WIDTH 640
+#define SOBEL_ROW_WORDS ((SOBEL_MAX_WIDTH + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS)
+
+// Limiar de |gx| + |gy| (cinza de 8 bits: 0 .. 8·255)
+#ifndef SOBEL_THRESHOLD
+#define SOBEL_THRESHOLD 128
+#endif
+
+extern uint16_t sobel_threshold;
+
+// Começa uma imagem de width pixels por linha; false se width não serve
+bool sobel_begin(int width);
+
+// Entrega uma linha de width pixels de 8 bits. A partir da segunda, escreve
+// em edges a linha de bordas anterior (ceil(width / 32) palavras) e retorna
+// true; na primeira só guarda a linha e retorna false. theta (NULL: sem
+// orientação) recebe o bin θ de cada pixel de borda dessa linha.
+bool sobel_push_row(const uint8_t* gray, bitmap_word_t* edges, uint8_t* theta);
+
+// Última linha de bordas (a borda de baixo: zerada); false se nenhuma
+// linha entrou
+bool sobel_finish(bitmap_word_t* edges);
+
+// Uma linha de bordas a partir das linhas de cima, do meio e de baixo
+void sobel_row(const uint8_t* top, const uint8_t* mid, const uint8_t* bot, int width, bitmap_word_t* edges,
+               uint8_t* theta);
+
+// Bin θ (0..15) da direção do gradiente (gx, gy), sem ponto flutuante
+uint8_t sobel_theta_bin(int gx, int gy);
+
+// Imagem IMAGE_WIDTH × IMAGE_HEIGHT em cinza (stride bytes por linha) →
+// global_image e image_theta (image_oriented); retorna os pixels de borda
+int image_from_gray(const uint8_t* gray, int stride);
+
+#endif  // HOUGH_SOBEL_H
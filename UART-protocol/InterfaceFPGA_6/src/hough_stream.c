@@ -0,0 +1,254 @@
+// hough_stream.c
+// Entrada em faixas de TILE_SIZE linhas (ver hough_stream.h)
+
+#include "hough_stream.h"
+
+#include <string.h>
+
+#include "hough_link.h"
+#include "hough_sobel.h"
+#include "hough_sw.h"
+
+StreamStats stream_stats;
+
+static bitmap_word_t band_rows[TILE_SIZE][STREAM_ROW_WORDS];  // Faixa em montagem
+static uint8_t band_theta[TILE_SIZE][STREAM_ROW_WORDS * BITMAP_WORD_BITS];  // Orientações da faixa (cinza)
+static int band_fill = 0;         // Linhas já na faixa
+static bool stream_fpga = false;
+static bool stream_gray = false;  // Linhas em cinza, pelo Sobel (a saída atrasa uma linha)
+static int stream_merged = 0;     // all_lines[0 .. stream_merged) já juntadas
+static uint64_t pending[2];       // Bit x: tile x da faixa par/ímpar em voo
+static uint64_t arrived[2];       // Bit x: resposta do tile x em band_results
+static bool band_open[2];         // Faixa da paridade despachada e ainda não guardada
+static int pending_band[2];       // Faixa (tile_y) de cada paridade
+static int next_band = 0;         // Próxima faixa a guardar e juntar
+
+// Resposta de um tile guardada até a faixa completar (só as linhas de tile,
+// não o TileResult inteiro)
+typedef struct {
+    uint8_t num_lines;
+    uint8_t lines[TILE_LINE_BYTES * MAX_LINES_PER_TILE];
+} BandResult;
+
+static BandResult band_results[2][STREAM_MAX_TILES_X];
+static int inflight = 0;
+
+static void stream_merge() {
+    stream_merged = merge_detected_lines_from(stream_merged);
+}
+
+static void stream_store(const TileResult* result, int tile_x, int tile_y) {
+    if (result->num_lines > 0 && stream_stats.first_result_us == 0) stream_stats.first_result_us = link_now_us();
+    // Sem espaço para mais um tile: junta antes (sobram só as linhas únicas)
+    if (total_lines_detected + MAX_LINES_PER_TILE > MAX_LINES_TOTAL) stream_merge();
+    stream_stats.raw_lines += store_tile_result(result, tile_x, tile_y);
+}
+
+// Guarda e junta as faixas completas, em ordem de faixa e de tile_x. As
+// respostas chegam em ordem de conclusão (a matriz de motores), e até duas
+// faixas ficam em voo; a junção depende da ordem das detecções, então só
+// assim ela vê o mesmo que no caminho em software.
+static void stream_flush() {
+    for (int parity = next_band & 1; band_open[parity] && !pending[parity]; parity = next_band & 1) {
+        for (uint64_t bits = arrived[parity]; bits; bits &= bits - 1) {
+            int tile_x = __builtin_ctzll(bits);
+            const BandResult* r = &band_results[parity][tile_x];
+            TileResult result;
+            result.tile_id = (uint8_t)((parity << 7) | tile_x);
+            result.num_lines = r->num_lines;
+            memcpy(result.lines, r->lines, (size_t)TILE_LINE_BYTES * r->num_lines);
+            stream_store(&result, tile_x, pending_band[parity]);
+        }
+        stream_merge();
+        arrived[parity] = 0;
+        band_open[parity] = false;
+        next_band++;
+    }
+}
+
+// Resposta de um tile em voo; false se o tag não é de nenhum
+static bool stream_accept(const TileResult* result) {
+    int parity = result->tile_id >> 7;
+    int tile_x = result->tile_id & 0x7F;
+
+    if (tile_x >= STREAM_MAX_TILES_X || !(pending[parity] & (1ull << tile_x))) return false;
+    pending[parity] &= ~(1ull << tile_x);
+    inflight--;
+    BandResult* r = &band_results[parity][tile_x];
+    r->num_lines = result->num_lines;  // O parser já recusa mais que MAX_LINES_PER_TILE
+    memcpy(r->lines, result->lines, (size_t)TILE_LINE_BYTES * r->num_lines);
+    arrived[parity] |= 1ull << tile_x;
+    if (!pending[parity]) stream_flush();
+    return true;
+}
+
+// Prazo vencido ou tag inesperado: descarta os tiles em voo (o que já
+// voltou é guardado) e ressincroniza pelo handshake READY
+static void stream_resync() {
+    stream_stats.lost_tiles += inflight;
+    inflight = 0;
+    pending[0] = pending[1] = 0;
+    stream_flush();
+    fpga_wait_ready();
+    response_arm(RESP_WAIT_TAG);
+}
+
+// Espera a próxima resposta (libera um crédito)
+static void stream_wait_one() {
+    TileResult result;
+    if (!result_wait(&result, TILE_DEADLINE_US) || !stream_accept(&result)) stream_resync();
+}
+
+// Recolhe as respostas que já chegaram, sem esperar
+static void stream_poll() {
+    TileResult result;
+
+    if (!stream_fpga || inflight == 0) return;
+    link_poll();
+    while (inflight > 0 && result_take(&result)) {
+        if (!stream_accept(&result)) {
+            stream_resync();
+            return;
+        }
+    }
+    if (resp_state == RESP_ERROR) stream_resync();
+}
+
+// Manda os tiles da faixa completa e junta o que já voltou
+static void stream_dispatch_band() {
+    int band = stream_stats.bands++;
+    int parity = band & 1;
+    uint8_t packed[IMG_BYTES_PACKED];
+    uint8_t theta[TILE_PIXELS];
+    bool oriented = stream_gray && orient_window >= 0;
+
+    // A faixa band - 2 usava a mesma paridade de tag e os mesmos
+    // band_results: espera ela ser guardada
+    if (stream_fpga) {
+        while (band_open[parity]) stream_wait_one();
+        pending_band[parity] = band;
+        band_open[parity] = true;
+    }
+
+    for (int tile_x = 0; tile_x < TILES_TO_COVER(stream_stats.width); tile_x++) {
+        uint64_t t0 = prof_begin();
+        int edges = pack_tile_rows(band_rows[0], STREAM_ROW_WORDS, TILE_ORIGIN(tile_x), packed);
+        if (edges > 0 && oriented) {
+            pack_tile_theta_rows(band_theta[0], sizeof(band_theta[0]), TILE_ORIGIN(tile_x), theta);
+        }
+        prof_end(STAGE_PACK, t0);
+        if (edges == 0) continue;  // Vazio: nenhuma linha, nada no fio
+        stream_stats.tiles_sent++;
+        if (oriented) stream_stats.oriented_tiles++;
+
+        if (!stream_fpga) {
+            TileResult result;
+            t0 = prof_begin();
+            if (oriented) {
+                hough_sw_tile_oriented(packed, theta, orient_window, &result);
+            } else {
+                hough_sw_tile(packed, &result);
+            }
+            prof_end(STAGE_HOUGH, t0);
+            stream_store(&result, tile_x, band);
+            continue;
+        }
+
+        t0 = prof_begin();
+        while (inflight >= FPGA_MAX_INFLIGHT) stream_wait_one();
+        fpga_send_tile_oriented((uint8_t)((parity << 7) | tile_x), packed, oriented ? theta : NULL);
+        prof_end(STAGE_LINK, t0);
+        pending[parity] |= 1ull << tile_x;
+        inflight++;
+    }
+    if (!stream_fpga) {
+        stream_merge();
+    } else {
+        stream_flush();  // Faixa sem nada em voo (toda vazia ou já respondida)
+    }
+
+    // O halo de baixo desta faixa é o de cima da próxima
+#if TILE_HALO > 0
+    memmove(band_rows[0], band_rows[TILE_STEP], sizeof(band_rows[0]) * TILE_HALO);
+    if (oriented) memmove(band_theta[0], band_theta[TILE_STEP], sizeof(band_theta[0]) * TILE_HALO);
+#endif
+    band_fill = TILE_HALO;
+}
+
+bool stream_begin(int width, bool use_fpga) {
+    if (width <= 0 || width > STREAM_MAX_WIDTH) return false;
+
+    memset(&stream_stats, 0, sizeof(stream_stats));
+    stream_stats.width = width;
+    stream_stats.start_us = link_now_us();
+    stream_fpga = use_fpga;
+    band_fill = 0;
+    pending[0] = pending[1] = 0;
+    arrived[0] = arrived[1] = 0;
+    band_open[0] = band_open[1] = false;
+    next_band = 0;
+    inflight = 0;
+    total_lines_detected = 0;
+    total_segments = 0;
+    stream_merged = 0;
+    stream_gray = false;
+    if (use_fpga) response_arm(RESP_WAIT_TAG);
+    return true;
+}
+
+bool stream_begin_gray(int width, bool use_fpga) {
+    if (!stream_begin(width, use_fpga) || !sobel_begin(width)) return false;
+    stream_gray = true;
+    return true;
+}
+
+// band_rows[band_fill] preenchida: fecha a faixa ou recolhe respostas
+static void stream_row_done() {
+    if (++band_fill == TILE_SIZE) {
+        stream_dispatch_band();
+    } else {
+        stream_poll();
+    }
+}
+
+void stream_push_row(const uint8_t* row) {
+    bitmap_word_t* dst = band_rows[band_fill];
+
+    // Memória little-endian: a linha do fio já é a linha do bitmap (os
+    // bits depois de width ficam zerados, enchimento do último tile)
+    int bytes = STREAM_ROW_BYTES(stream_stats.width);
+    memset(dst, 0, sizeof(band_rows[0]));
+    memcpy(dst, row, bytes);
+    if (stream_stats.width % 8) ((uint8_t*)dst)[bytes - 1] &= (uint8_t)((1u << (stream_stats.width % 8)) - 1);
+    stream_stats.rows++;
+    stream_row_done();
+}
+
+void stream_push_gray_row(const uint8_t* gray) {
+    bitmap_word_t* dst = band_rows[band_fill];
+
+    // O Sobel escreve ceil(width / 32) palavras; o resto é enchimento
+    memset(dst, 0, sizeof(band_rows[0]));
+    stream_stats.rows++;
+    if (sobel_push_row(gray, dst, band_theta[band_fill])) stream_row_done();
+}
+
+int stream_finish() {
+    if (stream_gray) {
+        bitmap_word_t* dst = band_rows[band_fill];
+        memset(dst, 0, sizeof(band_rows[0]));
+        if (sobel_finish(dst)) stream_row_done();
+    }
+    // Linhas além do halo que ainda não foram em nenhuma faixa (ainda orientadas,
+    // por isso stream_gray só é limpo depois)
+    if (band_fill > (stream_stats.bands > 0 ? TILE_HALO : 0)) {
+        memset(band_rows[band_fill], 0, sizeof(band_rows[0]) * (TILE_SIZE - band_fill));
+        stream_dispatch_band();
+    }
+    stream_gray = false;
+    while (inflight > 0) stream_wait_one();
+    if (stream_fpga) resp_state = RESP_IDLE;
+    stream_merge();
+    stream_stats.end_us = link_now_us();
+    return total_lines_detected;
+}
@@ -0,0 +1,69 @@
+// hough_stream.h
+// Entrada em faixas, para imagens maiores que a RAM do Pico (320×240,
+// 640×480): as linhas chegam uma a uma (USB/stdin, sensor) e só a faixa de
+// TILE_SIZE linhas em montagem fica na memória. Quando a faixa fecha, os
+// tiles dela vão ao FPGA com tag (até FPGA_MAX_INFLIGHT em voo, como em
+// process_frame_pipelined) e as respostas são recolhidas enquanto as
+// próximas linhas chegam. A cada faixa as detecções novas são juntadas às
+// anteriores (merge_detected_lines_from), então os primeiros resultados
+// saem muito antes do fim da imagem. As respostas voltam em ordem de
+// conclusão; cada faixa só é guardada, em ordem de tile, quando todos os
+// tiles dela voltaram, para a junção dar o mesmo que sem FPGA (a faixa
+// passa pelo hough_sw).
+// Memória: uma faixa (largura × 16 bits) em vez da imagem inteira.
+// Qualquer largura até STREAM_MAX_WIDTH: o último tile de cada faixa e a
+// última faixa são completados com zeros. Com TILE_HALO as faixas se
+// sobrepõem em TILE_HALO linhas e os tiles em TILE_HALO colunas, como na
+// grade de hough_core.h. Com stream_begin_gray a entrada é em cinza e o
+// Sobel (hough_sobel.h) gera as linhas de bordas direto na faixa, junto
+// com a orientação de cada borda para a votação orientada (orient_window).
+
+#ifndef HOUGH_STREAM_H
+#define HOUGH_STREAM_H
+
+#include "hough_core.h"
+
+#define STREAM_MAX_WIDTH 640
+#define STREAM_MAX_TILES_X TILES_TO_COVER(STREAM_MAX_WIDTH)  // Tag: faixa par/ímpar << 7 | tile_x
+#define STREAM_ROW_WORDS ((TILE_ORIGIN(STREAM_MAX_TILES_X - 1) + TILE_SIZE + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS)
+#define STREAM_ROW_BYTES(width) (((width) + 7) / 8)
+
+#if STREAM_MAX_TILES_X > 64
+#error "Os tiles em voo de uma faixa são um bit cada num uint64_t"
+#endif
+
+typedef struct {
+    int width;                 // Pixels por linha
+    int rows;                  // Linhas recebidas
+    int bands;                 // Faixas despachadas
+    int tiles_sent;            // Tiles não vazios processados (FPGA ou hough_sw)
+    int oriented_tiles;        // Desses, votados só nos θ da janela (entrada em cinza)
+    int raw_lines;             // Detecções recebidas, antes das junções
+    int lost_tiles;            // Tiles sem resposta no prazo (link ressincronizado)
+    uint64_t start_us;         // stream_begin
+    uint64_t first_result_us;  // Primeira detecção (0: nenhuma ainda)
+    uint64_t end_us;           // stream_finish
+} StreamStats;
+
+extern StreamStats stream_stats;
+
+// Começa uma imagem de width pixels por linha (all_lines é zerado);
+// use_fpga false: Hough em software. false se width não serve.
+bool stream_begin(int width, bool use_fpga);
+
+// Como stream_begin, mas as linhas chegam em cinza (stream_push_gray_row)
+// e passam pelo Sobel de hough_sobel.h antes de entrar na faixa
+bool stream_begin_gray(int width, bool use_fpga);
+
+// Uma linha no formato do fio: STREAM_ROW_BYTES(width) bytes, pixel x no
+// bit x % 8 do byte x / 8
+void stream_push_row(const uint8_t* row);
+
+// Uma linha de width pixels de 8 bits (depois de stream_begin_gray)
+void stream_push_gray_row(const uint8_t* gray);
+
+// Fecha a última faixa (completa com zeros), espera as respostas em voo e
+// faz a junção final. Retorna as linhas únicas (em all_lines/line_segments).
+int stream_finish();
+
+#endif  // HOUGH_STREAM_H
@@ -0,0 +1,443 @@
+// hough_sw.c
+// Hough em software, idêntico ao RTL (ver hough_sw.h)
+//
+// Mesma sequência de hough_transform.sv, reorganizada para a CPU:
+//   - pixels em ordem de índice, lidos por linha em palavras de até 64
+//     bits (ctz do bit aceso), pulando palavras zeradas
+//   - os bins dos 16 θ de um pixel saem de um laço sem desvios sobre
+//     vetores (y·sinθ fica pronto por linha), que o compilador vetoriza
+//   - o top-K de cada banco é o do RTL (ρ listado → nova contagem; slot
+//     livre → insere; senão troca o primeiro menor se a contagem for maior),
+//     mas com o slot de cada ρ num mapa e o primeiro menor guardado: um
+//     voto custa O(1) em vez de uma busca nos K slots
+//   - tile orientado: o pixel vota só nos θ da janela (vote_mask do RTL);
+//     como os bancos são independentes, pular um θ é só não votar nele
+
+#include "hough_sw.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HOUGH_SW_THREADS
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+// Faixa de ρ do RTL: |x·cosθ + y·sinθ| < RHO_MAX = ⌈IMG_SIZE·√2⌉
+#define SW_RHO_MAX(size) (((size) * 362 + 255) / 256)
+#define SW_ACC_CELLS (2 * SW_RHO_MAX(HOUGH_SW_MAX_IMG) + 1)
+#define SW_MAX_K MAX_LINES_PER_FRAME
+#define SW_TILE_RHO_BINS 16
+#define SW_TILE_VOTE_MAX 63   // VOTE_W = 6 nos tiles
+#define SW_FRAME_VOTE_MAX 255 // VOTE_W = 8 na imagem inteira
+
+// Top-K de um banco θ. Os slots são ocupados em ordem e nunca esvaziados
+// durante o VOTE, então os válidos são sempre 0..count-1.
+typedef struct {
+    uint8_t count;
+    uint8_t min_k;               // Primeiro slot de menor contagem (só com a lista cheia)
+    int16_t rho[SW_MAX_K];       // Bin
+    uint8_t votes[SW_MAX_K];
+} SwBank;
+
+// Estado de uma votação: acumulador e mapa ρ → slot em linhas de
+// 'stride' células por θ (16 nos tiles, 2·RHO_MAX+1 na imagem inteira)
+typedef struct {
+    uint8_t acc[HOUGH_THETA_BINS * SW_ACC_CELLS];
+    uint8_t slot[HOUGH_THETA_BINS * SW_ACC_CELLS];  // 1 + slot do ρ no banco (0: fora da lista)
+    SwBank bank[HOUGH_THETA_BINS];
+} SwWork;
+
+// Parâmetros de uma votação (os do módulo RTL instanciado)
+typedef struct {
+    const uint8_t* packed;
+    int img_size;
+    int rho_ofs;    // RHO_OFS
+    int stride;     // ACC_RHO
+    int vote_max;   // VOTE_MAX
+    int max_k;      // MAX_LINES
+    const uint8_t* theta;  // Bin θ por pixel (y·img_size + x); NULL: todos os θ
+    int window;            // Janela de theta (wr_window)
+} SwParams;
+
+#ifdef HOUGH_SW_THREADS
+static SwWork sw_work[HOUGH_SW_MAX_THREADS];
+#else
+static SwWork sw_work[1];
+#endif
+
+static void sw_params(SwParams* p, const uint8_t* packed, int img_size, bool signed_rho, int max_k) {
+    int rho_max = SW_RHO_MAX(img_size);
+    p->packed = packed;
+    p->img_size = img_size;
+    p->rho_ofs = signed_rho ? rho_max : 0;
+    p->stride = signed_rho ? 2 * rho_max + 1 : SW_TILE_RHO_BINS;
+    p->vote_max = signed_rho ? SW_FRAME_VOTE_MAX : SW_TILE_VOTE_MAX;
+    p->max_k = max_k;
+    p->theta = NULL;
+    p->window = ORIENT_ALL;
+}
+
+// Invalida acumulador e listas dos θ [t0, t1) (job_start do RTL)
+static void sw_clear(SwWork* w, const SwParams* p, int t0, int t1) {
+    size_t cells = (size_t)(t1 - t0) * p->stride;
+    memset(&w->acc[t0 * p->stride], 0, cells);
+    memset(&w->slot[t0 * p->stride], 0, cells);
+    for (int t = t0; t < t1; t++) w->bank[t].count = 0;
+}
+
+static void sw_bank_min(SwBank* bk, int max_k) {
+    int m = 0;
+    for (int k = 1; k < max_k; k++) {
+        if (bk->votes[k] < bk->votes[m]) m = k;
+    }
+    bk->min_k = (uint8_t)m;
+}
+
+// Um voto no banco t, célula bin: nova contagem e decisão do top-K
+static inline void sw_vote(SwWork* w, const SwParams* p, int t, int bin) {
+    int cell = t * p->stride + bin;
+    uint8_t v = w->acc[cell];
+    v += (v < p->vote_max);
+    w->acc[cell] = v;
+
+    SwBank* bk = &w->bank[t];
+    int s = w->slot[cell];
+    if (s) {
+        bk->votes[s - 1] = v;
+        // Só o primeiro menor pode deixar de ser o menor
+        if (s - 1 == bk->min_k && bk->count == p->max_k) sw_bank_min(bk, p->max_k);
+    } else if (bk->count < p->max_k) {
+        int k = bk->count++;
+        bk->rho[k] = (int16_t)bin;
+        bk->votes[k] = v;
+        w->slot[cell] = (uint8_t)(k + 1);
+        if (bk->count == p->max_k) sw_bank_min(bk, p->max_k);
+    } else if (v > bk->votes[bk->min_k]) {
+        int k = bk->min_k;
+        w->slot[t * p->stride + bk->rho[k]] = 0;
+        bk->rho[k] = (int16_t)bin;
+        bk->votes[k] = v;
+        w->slot[cell] = (uint8_t)(k + 1);
+        sw_bank_min(bk, p->max_k);
+    }
+}
+
+// VOTE dos θ [t0, t1) sobre todos os pixels acesos, em ordem de índice
+static void sw_vote_image(SwWork* w, const SwParams* p, int t0, int t1) {
+    const int row_bytes = p->img_size / 8;
+    const int acc_max = p->stride - 1;
+    int32_t ysin[HOUGH_THETA_BINS];
+    int16_t bin[HOUGH_THETA_BINS];
+
+    sw_clear(w, p, t0, t1);
+    for (int y = 0; y < p->img_size; y++) {
+        const uint8_t* row = &p->packed[y * row_bytes];
+        for (int t = t0; t < t1; t++) ysin[t] = y * hough_sin_q8[t];
+
+        for (int c = 0; c < row_bytes; c += 8) {
+            // Até 8 bytes da linha numa palavra: bit i = pixel x = 8·c + i
+            int n = (row_bytes - c < 8) ? row_bytes - c : 8;
+            uint64_t word = 0;
+            for (int i = 0; i < n; i++) word |= (uint64_t)row[c + i] << (8 * i);
+
+            for (; word; word &= word - 1) {
+                int x = c * 8 + __builtin_ctzll(word);
+                // Divisão com sinal do SystemVerilog: trunca em direção a zero
+                for (int t = t0; t < t1; t++) {
+                    int32_t b = (x * hough_cos_q8[t] + ysin[t]) / 256 + p->rho_ofs;
+                    b = (b < 0) ? 0 : b;
+                    bin[t] = (int16_t)((b > acc_max) ? acc_max : b);
+                }
+                if (!p->theta) {
+                    for (int t = t0; t < t1; t++) sw_vote(w, p, t, bin[t]);
+                    continue;
+                }
+                int dir = p->theta[y * p->img_size + x];
+                for (int t = t0; t < t1; t++) {
+                    if (theta_in_window(t, dir, p->window)) sw_vote(w, p, t, bin[t]);
+                }
+            }
+        }
+    }
+}
+
+// MERGE_PEAKS: bancos em ordem de θ, slots em ordem; com a lista cheia o
+// candidato troca o primeiro menor se tiver mais votos. Saída no formato
+// da resposta (line_bytes 3: [ρ, θ, votes]; 4: [ρ_hi, ρ_lo, θ, votes]).
+static void sw_merge(const SwWork* w, const SwParams* p, int line_bytes, TileResult* result) {
+    int16_t rho[SW_MAX_K] = { 0 };
+    uint8_t theta[SW_MAX_K] = { 0 }, votes[SW_MAX_K] = { 0 };
+    int count = 0;
+
+    for (int t = 0; t < HOUGH_THETA_BINS; t++) {
+        const SwBank* bk = &w->bank[t];
+        for (int k = 0; k < bk->count; k++) {
+            if (bk->votes[k] < HOUGH_VOTE_THRESHOLD) continue;
+            int i = count;
+            if (count < p->max_k) {
+                count++;
+            } else {
+                i = 0;
+                for (int j = 1; j < p->max_k; j++) {
+                    if (votes[j] < votes[i]) i = j;
+                }
+                if (bk->votes[k] <= votes[i]) continue;
+            }
+            rho[i] = (int16_t)(bk->rho[k] - p->rho_ofs);
+            theta[i] = theta_bin_to_deg(t);
+            votes[i] = bk->votes[k];
+        }
+    }
+
+    result->num_lines = (uint8_t)count;
+    for (int i = 0; i < count; i++) {
+        uint8_t* l = &result->lines[i * line_bytes];
+        if (line_bytes == FRAME_LINE_BYTES) {
+            *l++ = (uint8_t)((uint16_t)rho[i] >> 8);
+        }
+        l[0] = (uint8_t)rho[i];
+        l[1] = theta[i];
+        l[2] = votes[i];
+    }
+}
+
+static void sw_tile(SwWork* w, const uint8_t packed[IMG_BYTES_PACKED], const uint8_t* theta, int window,
+                    TileResult* result) {
+    SwParams p;
+    sw_params(&p, packed, TILE_SIZE, false, MAX_LINES_PER_TILE);
+    p.theta = theta && tile_edges(packed) <= ORIENT_MAX_EDGES ? theta : NULL;  // Cheio: bitmap, todos os θ
+    p.window = window;
+    sw_vote_image(w, &p, 0, HOUGH_THETA_BINS);
+    sw_merge(w, &p, TILE_LINE_BYTES, result);
+}
+
+// ========== THREADS ==========
+// Um job é uma lista de itens (tiles ou faixas de θ); as threads pegam o
+// próximo item num contador atômico. A thread que chama também trabalha e
+// só volta quando todos os itens terminaram.
+
+typedef void (*SwItemFn)(int item, SwWork* work);
+
+static struct {
+    const uint8_t (*packed)[IMG_BYTES_PACKED];
+    const uint8_t (*theta)[TILE_PIXELS];
+    int window;
+    TileResult* results;
+    SwParams image;
+    int theta_groups;
+} sw_job;
+
+static void sw_tile_item(int item, SwWork* work) {
+    sw_tile(work, sw_job.packed[item], sw_job.theta ? sw_job.theta[item] : NULL, sw_job.window,
+            &sw_job.results[item]);
+}
+
+// Imagem inteira: todos usam sw_work[0], cada grupo nas suas linhas de θ
+static void sw_theta_item(int item, SwWork* work) {
+    (void)work;
+    int t0 = item * HOUGH_THETA_BINS / sw_job.theta_groups;
+    int t1 = (item + 1) * HOUGH_THETA_BINS / sw_job.theta_groups;
+    sw_vote_image(&sw_work[0], &sw_job.image, t0, t1);
+}
+
+#ifdef HOUGH_SW_THREADS
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t start, done;
+    pthread_t thread[HOUGH_SW_MAX_THREADS];
+    int threads;          // Contando a thread que chama
+    unsigned gen;         // Muda a cada job publicado
+    unsigned start_gen;   // gen quando as auxiliares foram criadas
+    int running;          // Threads auxiliares ainda no job atual
+    bool stop;
+    SwItemFn fn;
+    int items;
+    atomic_int next;
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .threads = 1,
+};
+
+static void pool_run_items(SwWork* work) {
+    int i;
+    while ((i = atomic_fetch_add(&pool.next, 1)) < pool.items) pool.fn(i, work);
+}
+
+static void* pool_worker(void* arg) {
+    SwWork* work = arg;
+    pthread_mutex_lock(&pool.lock);
+    // Não pode ler pool.gen aqui: um job publicado antes desta thread
+    // chegar ao lock seria dado como visto e nunca terminaria
+    unsigned seen = pool.start_gen;
+    for (;;) {
+        while (pool.gen == seen && !pool.stop) pthread_cond_wait(&pool.start, &pool.lock);
+        if (pool.stop) break;
+        seen = pool.gen;
+        pthread_mutex_unlock(&pool.lock);
+        pool_run_items(work);
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.running == 0) pthread_cond_signal(&pool.done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+static void sw_run(SwItemFn fn, int items) {
+    if (pool.threads == 1 || items == 1) {
+        for (int i = 0; i < items; i++) fn(i, &sw_work[0]);
+        return;
+    }
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.items = items;
+    atomic_store(&pool.next, 0);
+    pool.running = pool.threads - 1;
+    pool.gen++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    pool_run_items(&sw_work[0]);
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.running > 0) pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+void hough_sw_set_threads(int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > HOUGH_SW_MAX_THREADS) threads = HOUGH_SW_MAX_THREADS;
+
+    // Encerra as auxiliares atuais antes de criar as novas
+    pthread_mutex_lock(&pool.lock);
+    pool.stop = true;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 1; i < pool.threads; i++) pthread_join(pool.thread[i], NULL);
+
+    // Nenhum job roda aqui: as novas partem do gen atual
+    pool.stop = false;
+    pool.start_gen = pool.gen;
+    pool.threads = 1;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&pool.thread[i], NULL, pool_worker, &sw_work[i]) != 0) break;
+        pool.threads++;
+    }
+}
+
+int hough_sw_threads() {
+    return pool.threads;
+}
+#else
+static void sw_run(SwItemFn fn, int items) {
+    for (int i = 0; i < items; i++) fn(i, &sw_work[0]);
+}
+
+void hough_sw_set_threads(int threads) {
+    (void)threads;
+}
+
+int hough_sw_threads() {
+    return 1;
+}
+#endif  // HOUGH_SW_THREADS
+
+// ========== INTERFACE ==========
+
+void hough_sw_tile(const uint8_t packed[IMG_BYTES_PACKED], TileResult* result) {
+    sw_tile(&sw_work[0], packed, NULL, ORIENT_ALL, result);
+}
+
+void hough_sw_tile_oriented(const uint8_t packed[IMG_BYTES_PACKED], const uint8_t theta[TILE_PIXELS], int window,
+                            TileResult* result) {
+    sw_tile(&sw_work[0], packed, theta, window, result);
+}
+
+void hough_sw_tiles_oriented(const uint8_t (*packed)[IMG_BYTES_PACKED], const uint8_t (*theta)[TILE_PIXELS],
+                             int window, int count, TileResult* results) {
+    sw_job.packed = packed;
+    sw_job.theta = theta;
+    sw_job.window = window;
+    sw_job.results = results;
+    sw_run(sw_tile_item, count);
+}
+
+void hough_sw_tiles(const uint8_t (*packed)[IMG_BYTES_PACKED], int count, TileResult* results) {
+    hough_sw_tiles_oriented(packed, NULL, ORIENT_ALL, count, results);
+}
+
+bool hough_sw_image(const uint8_t* packed, int img_size, int max_lines, TileResult* result) {
+    if (img_size <= 0 || img_size % 8 != 0 || img_size > HOUGH_SW_MAX_IMG ||
+        max_lines < 1 || max_lines > MAX_LINES_PER_FRAME) {
+        return false;
+    }
+    sw_params(&sw_job.image, packed, img_size, true, max_lines);
+    sw_job.theta_groups = hough_sw_threads();
+    sw_run(sw_theta_item, sw_job.theta_groups);
+    sw_merge(&sw_work[0], &sw_job.image, FRAME_LINE_BYTES, result);
+    return true;
+}
+
+// ========== FRAME EM TILES ==========
+
+void process_frame_software(bool verbose) {
+    static uint8_t packed[GRID_TILES][IMG_BYTES_PACKED];
+    static uint8_t theta[GRID_TILES][TILE_PIXELS];
+    static TileResult results[GRID_TILES];
+    const int total_tiles = GRID_TILES;
+    // Como process_frame_pipelined: orientação só com imagem em cinza
+    bool oriented = image_oriented && orient_window >= 0;
+
+    uint64_t t0 = prof_begin();
+    for (int i = 0; i < total_tiles; i++) {
+        pack_tile(i % GRID_COLS, i / GRID_COLS, packed[i]);
+        if (oriented) pack_tile_theta(i % GRID_COLS, i / GRID_COLS, theta[i]);
+    }
+    prof_end(STAGE_PACK, t0);
+
+    t0 = prof_begin();
+    hough_sw_tiles_oriented((const uint8_t(*)[IMG_BYTES_PACKED])packed,
+                            oriented ? (const uint8_t(*)[TILE_PIXELS])theta : NULL,
+                            orient_window, total_tiles, results);
+    prof_end(STAGE_HOUGH, t0);
+
+    t0 = prof_begin();
+    for (int i = 0; i < total_tiles; i++) {
+        int tx = i % GRID_COLS, ty = i / GRID_COLS;
+        int lines_in_tile = store_tile_result(&results[i], tx, ty);
+        if (verbose) {
+            printf("[Tile %d/%d] Posição (%d,%d) - ", i + 1, total_tiles, tx, ty);
+            if (lines_in_tile > 0) {
+                printf("%d linhas detectadas (software)\n", lines_in_tile);
+            } else {
+                printf("Nenhuma linha detectada (software)\n");
+            }
+        }
+    }
+    prof_end(STAGE_CONVERT, t0);
+}
+
+// Imagem inteira numa votação só: hough_sw_image só aceita imagens quadradas
+void process_frame_software_whole(bool verbose) {
+#if IMAGE_WIDTH != IMAGE_HEIGHT || IMAGE_WIDTH % 8 != 0
+    if (verbose) printf("[Imagem %dx%d] Não é quadrada (múltiplo de 8): use os tiles\n", IMAGE_WIDTH, IMAGE_HEIGHT);
+#else
+    static uint8_t packed[IMAGE_BYTES_PACKED];
+    TileResult result;
+
+    uint64_t t0 = prof_begin();
+    image_to_packed(packed);
+    prof_end(STAGE_PACK, t0);
+
+    t0 = prof_begin();
+    hough_sw_image(packed, IMAGE_WIDTH, MAX_LINES_PER_FRAME, &result);
+    prof_end(STAGE_HOUGH, t0);
+
+    t0 = prof_begin();
+    int lines = store_frame_result(&result);
+    prof_end(STAGE_CONVERT, t0);
+    if (verbose) printf("[Imagem %dx%d] %d linhas detectadas (software)\n", IMAGE_WIDTH, IMAGE_HEIGHT, lines);
+#endif
+}
@@ -0,0 +1,57 @@
+// hough_sw.h
+// Hough em software com o mesmo contrato do FPGA: tile empacotado 16×16 →
+// até MAX_LINES_PER_TILE linhas [ρ, θ, votes], ou imagem inteira →
+// [ρ_hi, ρ_lo, θ, votes] com ρ com sinal, nos mesmos bytes de TileResult
+// que o link preenche. O resultado é idêntico bit a bit ao de
+// hough_transform.sv (mesma LUT sin/cos × 256, ρ truncado e saturado,
+// votos saturados, top-K incremental por banco θ, junção em ordem de θ e
+// limiar de 5 votos). Serve de referência nos testes, de reserva quando o
+// FPGA não responde e de base para medir o ganho do FPGA.
+//
+// Com HOUGH_SW_THREADS (build do host, pthreads) os tiles de um frame são
+// divididos entre threads, e na imagem inteira cada thread vota numa faixa
+// de θ (os bancos são independentes). Sem ele tudo roda na thread atual.
+
+#ifndef HOUGH_SW_H
+#define HOUGH_SW_H
+
+#include "hough_core.h"
+
+#define HOUGH_VOTE_THRESHOLD 5
+
+// Maior imagem aceita por hough_sw_image() (o acumulador é estático)
+#ifndef HOUGH_SW_MAX_IMG
+#define HOUGH_SW_MAX_IMG IMAGE_MAX_SIDE
+#endif
+
+#define HOUGH_SW_MAX_THREADS 16
+
+// Tile 16×16 (ρ = bin 0..15), resultado como o de fpga_transact_tile()
+void hough_sw_tile(const uint8_t packed[IMG_BYTES_PACKED], TileResult* result);
+
+// Tile orientado (ORIENT_CMD): pixel y·16 + x vota só nos θ a até window
+// bins de theta[y·16 + x]; com mais de ORIENT_MAX_EDGES bordas vota em
+// todos, como o tile que o link manda como bitmap
+void hough_sw_tile_oriented(const uint8_t packed[IMG_BYTES_PACKED], const uint8_t theta[TILE_PIXELS], int window,
+                            TileResult* result);
+
+// count tiles independentes, em paralelo quando há threads (theta NULL:
+// sem orientação)
+void hough_sw_tiles(const uint8_t (*packed)[IMG_BYTES_PACKED], int count, TileResult* results);
+void hough_sw_tiles_oriented(const uint8_t (*packed)[IMG_BYTES_PACKED], const uint8_t (*theta)[TILE_PIXELS],
+                             int window, int count, TileResult* results);
+
+// Imagem img_size × img_size (múltiplo de 8, até HOUGH_SW_MAX_IMG) com ρ
+// com sinal e até max_lines (≤ MAX_LINES_PER_FRAME) linhas, como FRAME_CMD
+bool hough_sw_image(const uint8_t* packed, int img_size, int max_lines, TileResult* result);
+
+// Threads usadas (contando a que chama); 1 sem HOUGH_SW_THREADS
+void hough_sw_set_threads(int threads);
+int hough_sw_threads();
+
+// Frame de global_image pelo Hough em software, com o mesmo resultado em
+// all_lines que process_frame_batched() (tiles) / process_frame_whole()
+void process_frame_software(bool verbose);
+void process_frame_software_whole(bool verbose);
+
+#endif  // HOUGH_SW_H
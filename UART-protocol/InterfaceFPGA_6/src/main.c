@@ -1,298 +1,379 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/uart.h"
-#include <math.h>
+#include "hardware/dma.h"
+#include "pico/multicore.h"
+#include "pico/util/queue.h"
 #include <stdlib.h>
+#include <string.h>
+#include "hough_cache.h"
+#include "hough_core.h"
+#include "hough_link.h"
+#include "hough_sobel.h"
+#include "hough_stream.h"
+#include "hough_sw.h"
 
 // ========== CONFIGURAÇÃO: ESCOLHA O MODO ==========
-// Descomente UMA das linhas abaixo:
-// #define MODE_16x16   // Modo original: testa padrões 16×16
-#define MODE_64x64   // Modo estendido: processa imagens 64×64 em tiles
+// MODE_16x16: modo original, um padrão 16×16 (TILE_TEST, índice em
+// tile_patterns) num só comando. MODE_64x64 (padrão): imagens em tiles, de
+// IMAGE_WIDTH × IMAGE_HEIGHT (hough_core.h, 64×64 se nada for definido).
+// Tudo vem da linha de comando, sem editar o código:
+//   cmake -DHOUGH_MODE=16x16 -DHOUGH_TILE_TEST=5 ..
+//   cmake -DHOUGH_MODE=64x64 -DHOUGH_IMAGE_WIDTH=96 -DHOUGH_IMAGE_HEIGHT=48 -DHOUGH_TILE_HALO=2 ..
+#if !defined(MODE_16x16) && !defined(MODE_64x64)
+#define MODE_64x64
+#endif
+#ifndef TILE_TEST
+#define TILE_TEST 2       // Linha horizontal no centro
+#endif
+#ifndef DEMO_PATTERN
+#define DEMO_PATTERN 0    // Frame de demonstração (create_test_pattern_64x64): 0 cruz, 1 diagonal, 2 retângulo, 3 X
+#endif
 // ==================================================
 
 #define UART_ID uart0
-#define BAUD_RATE 9600
+#define LINK_BAUD_TARGET 3125000  // Taxa negociada após o READY (0: fica em BAUD_RATE)
 #define UART_TX_PIN 16
 #define UART_RX_PIN 17
-#define WIDTH 16
-#define LENGHT 16
-#define HEADER_BYTE 0xAA  // Byte de sincronização
-#define IMG_BYTES_PACKED 32  // 16×16 bits = 256 bits = 32 bytes empacotados
 
 #ifdef MODE_64x64
-#define GLOBAL_SIZE 64
-#define TILE_SIZE 16
-#define GRID_SIZE 4  // 64/16 = 4 tiles por dimensão
-#define MAX_LINES_TOTAL 64  // Máximo de linhas detectadas em toda imagem 64×64
+// 1: envia a imagem inteira (FRAME_CMD) e o FPGA vota com ρ global (só
+// imagens 64×64, o FRAME_SIZE do RTL); 0: tiles de 16×16 + junção das
+// linhas no Pico
+#ifndef FRAME_UPLOAD
+#define FRAME_UPLOAD IMAGE_IS_RTL_FRAME
+#endif
+#if FRAME_UPLOAD && !IMAGE_IS_RTL_FRAME
+#error "FRAME_UPLOAD precisa de IMAGE_WIDTH = IMAGE_HEIGHT = FRAME_RTL_SIZE"
+#endif
+#define TILE_BATCH 1      // Tiles (FRAME_UPLOAD 0): 1 = lote BATCH_CMD com CRC; 0 = 0xAB/0xAD com créditos
+#define BAUD_BENCHMARK 1  // 1: mede tiles/s em cada taxa antes do processamento
+#define BENCH_FRAMES 4    // Frames de GRID_TILES tiles por taxa no benchmark
+
+// Modo contínuo: depois do frame de demonstração, processa CONTINUOUS_FRAMES
+// frames primeiro só em core0 e depois com core1 cuidando do link, e compara
+// os frames/s (0: desliga)
+#define CONTINUOUS_FRAMES 32
+#define CONTINUOUS_RENDER 1  // 1: filtra e desenha cada frame (trabalho de core0)
+
+// 1: repete o frame de demonstração no Hough em software (hough_sw), confere
+// as linhas com as do FPGA e compara os tempos
+#define SW_BASELINE 1
+
+// 1: depois do frame de demonstração, uma passada de telemetria (um tile
+// por vez, cada um seguido de STATS_CMD) impressa em CSV para
+// gerar_graficos_resultados.py
+#define TELEMETRY 1
+
+// 1: no fim, fica lendo imagens maiores pela USB (hough_stream): uma linha
+// "largura altura" e depois uma linha por linha da imagem, em hex, com
+// largura/4 dígitos (byte i = pixels 8i..8i+7, pixel x no bit x % 8).
+// "largura altura 8": imagem em cinza, 2 dígitos por pixel, passa pelo
+// Sobel (hough_sobel.h) no Pico
+#define STREAM_INPUT 1
 #endif
 
-volatile uint8_t queue[256];  // Buffer para receber resposta do FPGA
-volatile int counter = 0;
-
-void send_image_16x16_packed(uint8_t img[WIDTH][LENGHT]);
-void convert_to_packed_format(uint8_t img[WIDTH][LENGHT], uint8_t packed[IMG_BYTES_PACKED]);
+// ========== E/S DA UART POR DMA ==========
+// Transporte do link no Pico (LinkTransport de hough_link.h).
+// RX: um canal DMA copia cada byte do DR da UART para rx_ring (anel de
+// endereço alinhado, o DMA dá a volta sozinho). O laço principal consome
+// de rx_tail até a posição de escrita do DMA em link_poll(); nada roda em
+// interrupção. Os bytes pendentes são limitados pelos créditos (no máximo
+// FPGA_MAX_INFLIGHT respostas), bem abaixo de RX_RING_SIZE.
+// TX: outro canal DMA envia um comando inteiro de tx_buf. São dois buffers:
+// enquanto um está no fio, o próximo comando é montado no outro.
+#define RX_RING_BITS 10
+#define RX_RING_SIZE (1u << RX_RING_BITS)  // 1 KB
+#define RX_DMA_COUNT 0xFFFFFFFFu           // Rearmado em uart_dma_rx_read() ao esgotar
+
+static uint8_t rx_ring[RX_RING_SIZE] __attribute__((aligned(RX_RING_SIZE)));
+static uint32_t rx_tail = 0;                // Próximo índice a consumir
+static uint8_t tx_buf[2][LINK_TX_BUF_SIZE];
+static int tx_cur = 0;                      // Buffer livre para o próximo comando
+static int rx_dma, tx_dma;
+static bool fpga_online = false;            // FPGA respondeu ao READY: senão, Hough em software
+static bool link_on_core1 = false;          // run_frames_dual_core passou o link para core1
+
+bool send_image_16x16_packed(uint8_t img[WIDTH][LENGHT]);
+bool fpga_set_baud(uint32_t baud);
 
 #ifdef MODE_64x64
-// ========== ESTRUTURAS E FUNÇÕES PARA MODO 64×64 ==========
+// Processa os GRID_TILES tiles pelo caminho configurado em TILE_BATCH. O
+// lote não leva orientação: imagem vinda do cinza com orient_window ligado
+// vai pelos tiles com créditos (ORIENT_CMD).
+void process_frame_tiles(bool verbose) {
+    if (image_oriented && orient_window >= 0) {
+        process_frame_pipelined(verbose);
+        return;
+    }
+#if TILE_BATCH
+    process_frame_batched(verbose);
+#else
+    process_frame_pipelined(verbose);
+#endif
+}
 
-typedef struct {
-    uint8_t rho, theta, votes;  // Dados recebidos do FPGA
-    int tile_x, tile_y;          // Posição do tile no grid 4×4
-    float global_rho;            // ρ convertido para coordenadas globais 64×64
-    float global_x_intercept;    // Interseção com eixo X (para visualização)
-    float global_y_intercept;    // Interseção com eixo Y (para visualização)
-} DetectedLine;
-
-uint8_t global_image[GLOBAL_SIZE][GLOBAL_SIZE];  // Imagem 64×64
-DetectedLine all_lines[MAX_LINES_TOTAL];         // Todas as linhas detectadas
-int total_lines_detected = 0;
-
-// Extrai tile 16×16 da imagem global
-void extract_tile(int tile_x, int tile_y, uint8_t tile[TILE_SIZE][TILE_SIZE]) {
-    int offset_x = tile_x * TILE_SIZE;
-    int offset_y = tile_y * TILE_SIZE;
-    
-    for (int y = 0; y < TILE_SIZE; y++) {
-        for (int x = 0; x < TILE_SIZE; x++) {
-            tile[y][x] = global_image[offset_y + y][offset_x + x];
+// Mede a vazão efetiva de tiles (caminho de TILE_BATCH, tiles vazios
+// pulados) em cada taxa negociável e deixa o link na última
+// que funcionou
+void benchmark_link_rates() {
+    static const uint32_t rates[] = { BAUD_RATE, 115200, 230400, 460800, 921600,
+                                      1562500, 3125000 };
+    const int tiles = BENCH_FRAMES * GRID_TILES;
+    bool cache_was_enabled = tile_cache_enabled;
+    
+    // Os frames se repetem: com o cache só o primeiro passaria pelo fio
+    tile_cache_enabled = false;
+    printf("\n=== BENCHMARK DO LINK (%d tiles por taxa) ===\n", tiles);
+    printf("   baud (real) |  tiles/s | us/tile | bytes/frame | KB/s no fio\n");
+    for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        if (rates[r] != link_baud && !fpga_set_baud(rates[r])) {
+            printf("%8lu       | handshake falhou, link em %lu baud\n",
+                   (unsigned long)rates[r], (unsigned long)link_baud);
+            continue;
         }
+        
+        uint32_t bytes0 = link_tx_bytes;
+        absolute_time_t t0 = get_absolute_time();
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            total_lines_detected = 0;
+            process_frame_tiles(false);
+        }
+        int64_t us = absolute_time_diff_us(t0, get_absolute_time());
+        uint32_t bytes = link_tx_bytes - bytes0;  // Cresce com as bordas, não com a área
+        
+        printf("%8lu (%7lu) | %8.1f | %7lld | %11lu | %9.2f\n",
+               (unsigned long)rates[r], (unsigned long)link_baud,
+               tiles * 1e6 / (double)us, (long long)(us / tiles),
+               (unsigned long)(bytes / BENCH_FRAMES), bytes * 1e6 / 1024.0 / (double)us);
     }
+    total_lines_detected = 0;
+    tile_cache_enabled = cache_was_enabled;
+    printf("\n");
 }
 
-// Converte tile para formato empacotado
-void tile_to_packed(uint8_t tile[TILE_SIZE][TILE_SIZE], uint8_t packed[IMG_BYTES_PACKED]) {
-    for (int byte_idx = 0; byte_idx < IMG_BYTES_PACKED; byte_idx++) {
-        uint8_t packed_byte = 0x00;
-        for (int bit_idx = 0; bit_idx < 8; bit_idx++) {
-            int pixel_idx = byte_idx * 8 + bit_idx;
-            int row = pixel_idx / TILE_SIZE;
-            int col = pixel_idx % TILE_SIZE;
-            if (tile[row][col] != 0x00) {
-                packed_byte |= (1 << bit_idx);
-            }
-        }
-        packed[byte_idx] = packed_byte;
-    }
+#if !FRAME_UPLOAD
+// Contadores do hough_cache (tile_cache_stats desde o último tile_cache_clear())
+static void print_cache_stats(const char* label, const TileCacheStats* c) {
+    uint32_t lookups = c->hits + c->misses;
+    printf("  cache %s: %lu acertos, %lu erros (%.1f%%), %lu substituídos\n", label,
+           (unsigned long)c->hits, (unsigned long)c->misses,
+           lookups ? 100.0 * c->hits / lookups : 0.0, (unsigned long)c->evictions);
 }
+#endif
 
-// Converte coordenadas locais do tile para globais
-void convert_to_global_coordinates(DetectedLine* line) {
-    int offset_x = line->tile_x * TILE_SIZE;
-    int offset_y = line->tile_y * TILE_SIZE;
-    
-    float theta_rad = (line->theta * M_PI) / 180.0f;
-    float cos_theta = cosf(theta_rad);
-    float sin_theta = sinf(theta_rad);
-    
-    // CORREÇÃO: ρ_global = offset_x*cos(θ) + offset_y*sin(θ) + ρ_local
-    // A fórmula correta é calcular ρ a partir da ORIGEM GLOBAL do tile
-    // O ρ_local já está na escala correta do FPGA (0-15)
-    line->global_rho = (offset_x * cos_theta) + (offset_y * sin_theta) + line->rho;
-    
-    // Calcula interseções para visualização
-    if (fabs(cos_theta) > 0.01f) {
-        line->global_x_intercept = line->global_rho / cos_theta;
-    } else {
-        line->global_x_intercept = 999.0f;  // Infinito (linha horizontal)
-    }
-    
-    if (fabs(sin_theta) > 0.01f) {
-        line->global_y_intercept = line->global_rho / sin_theta;
-    } else {
-        line->global_y_intercept = 999.0f;  // Infinito (linha vertical)
-    }
+#if TELEMETRY
+// Telemetria do frame atual entre as marcas "# TELEMETRIA" e "# FIM" da
+// saída serial: registros T/L por tile (ou da imagem inteira), depois o
+// resumo F e as linhas únicas U. Sobrescreve all_lines.
+void emit_frame_telemetry(uint16_t frame) {
+    static TelemetryRecord records[GRID_TILES];
+    int count;
+
+    total_lines_detected = 0;
+    absolute_time_t t0 = get_absolute_time();
+#if FRAME_UPLOAD
+    count = telemetry_collect_whole(frame, &records[0]) ? 1 : 0;
+#else
+    count = telemetry_collect_tiles(frame, records);
+#endif
+    int64_t us = absolute_time_diff_us(t0, get_absolute_time());
+    int raw_lines = total_lines_detected;
+
+    printf("\n");
+    telemetry_print_header();
+    for (int i = 0; i < count; i++) telemetry_print(&records[i]);
+    merge_detected_lines();
+    telemetry_print_merged(frame, raw_lines, (uint32_t)us);
+    printf("# FIM\n");
 }
+#endif
 
-// Processa um tile no FPGA e armazena resultados
-int process_tile_on_fpga(int tile_x, int tile_y) {
-    uint8_t tile[TILE_SIZE][TILE_SIZE];
-    uint8_t packed[IMG_BYTES_PACKED];
-    
-    // Extrai tile da imagem global
-    extract_tile(tile_x, tile_y, tile);
-    tile_to_packed(tile, packed);
-    
-    // Limpa buffer UART
-    counter = 0;
-    while (uart_is_readable(UART_ID)) uart_getc(UART_ID);
-    
-    // Envia header + tile
-    uart_putc_raw(UART_ID, HEADER_BYTE);
-    sleep_ms(10);
-    
-    for (int i = 0; i < IMG_BYTES_PACKED; i++) {
-        uart_putc_raw(UART_ID, packed[i]);
-        sleep_ms(2);
-    }
-    
-    // Aguarda resposta
-    sleep_ms(800);  // FPGA processa + transmite
-    
-    if (counter == 0) return 0;
-    
-    // Interpreta resposta
-    uint8_t num_lines = queue[0];
-    if (num_lines > 4) num_lines = 4;
-    
-    for (int i = 0; i < num_lines && total_lines_detected < MAX_LINES_TOTAL; i++) {
-        int idx = 1 + i * 3;
-        if (idx + 2 < counter) {
-            DetectedLine* line = &all_lines[total_lines_detected++];
-            line->rho = queue[idx];
-            line->theta = queue[idx + 1];
-            line->votes = queue[idx + 2];
-            line->tile_x = tile_x;
-            line->tile_y = tile_y;
-            convert_to_global_coordinates(line);
-        }
-    }
-    
-    return num_lines;
+// Hough em software no lugar do FPGA, no mesmo formato de FRAME_UPLOAD:
+// reserva com o link fora do ar e referência para SW_BASELINE
+void process_frame_local(bool verbose) {
+#if FRAME_UPLOAD
+    process_frame_software_whole(verbose);
+#else
+    process_frame_software(verbose);
+#endif
 }
 
-// Visualiza imagem 64×64 com linhas detectadas
-void print_image_with_lines() {
-    char display[GLOBAL_SIZE][GLOBAL_SIZE];
-    
-    // Inicializa display
-    for (int y = 0; y < GLOBAL_SIZE; y++) {
-        for (int x = 0; x < GLOBAL_SIZE; x++) {
-            display[y][x] = global_image[y][x] ? '#' : '.';
-        }
-    }
-    
-    // Desenha linhas detectadas
+#if SW_BASELINE
+static bool same_raw_line(const DetectedLine* a, const DetectedLine* b) {
+    return a->rho == b->rho && a->theta_bin == b->theta_bin && a->votes == b->votes &&
+           a->tile_x == b->tile_x && a->tile_y == b->tile_y && a->global_rho_q8 == b->global_rho_q8;
+}
+
+// Repete o frame de global_image em software e confere as linhas brutas com
+// as do FPGA (mesmo conjunto; a ordem segue a chegada das respostas).
+// all_lines volta com o resultado do FPGA.
+void compare_with_software(int64_t fpga_us) {
+    static DetectedLine fpga_lines[MAX_LINES_TOTAL];
+    int fpga_count = total_lines_detected;
+    memcpy(fpga_lines, all_lines, sizeof(DetectedLine) * fpga_count);
+
+    total_lines_detected = 0;
+    absolute_time_t t0 = get_absolute_time();
+    process_frame_local(false);
+    int64_t sw_us = absolute_time_diff_us(t0, get_absolute_time());
+
+    int unmatched = 0;
     for (int i = 0; i < total_lines_detected; i++) {
-        DetectedLine* line = &all_lines[i];
-        float theta_rad = (line->theta * M_PI) / 180.0f;
-        float cos_theta = cosf(theta_rad);
-        float sin_theta = sinf(theta_rad);
-        
-        // Desenha linha percorrendo tanto X quanto Y para melhor cobertura
-        // Para linhas verticais (θ≈90°), percorre Y
-        // Para linhas horizontais (θ≈0°), percorre X
-        
-        if (fabs(sin_theta) > 0.5f) {
-            // Linha mais vertical: percorre Y
-            for (int y = 0; y < GLOBAL_SIZE; y++) {
-                if (fabs(sin_theta) > 0.01f) {
-                    float x = (line->global_rho - y * sin_theta) / cos_theta;
-                    int x_int = (int)(x + 0.5f);
-                    if (x_int >= 0 && x_int < GLOBAL_SIZE) {
-                        if (display[y][x_int] == '.') display[y][x_int] = '|';
-                        else if (display[y][x_int] == '#') display[y][x_int] = '+';
-                        else if (display[y][x_int] == '-') display[y][x_int] = '+';
-                    }
-                }
-            }
-        } else {
-            // Linha mais horizontal: percorre X
-            for (int x = 0; x < GLOBAL_SIZE; x++) {
-                if (fabs(cos_theta) > 0.01f) {
-                    float y = (line->global_rho - x * cos_theta) / sin_theta;
-                    int y_int = (int)(y + 0.5f);
-                    if (y_int >= 0 && y_int < GLOBAL_SIZE) {
-                        if (display[y_int][x] == '.') display[y_int][x] = '-';
-                        else if (display[y_int][x] == '#') display[y_int][x] = '+';
-                        else if (display[y_int][x] == '|') display[y_int][x] = '+';
-                    }
-                }
-            }
-        }
-    }
-    
-    // Imprime resultado
-    printf("\n64x64 Image with Detected Lines:\n");
-    for (int y = 0; y < GLOBAL_SIZE; y++) {
-        for (int x = 0; x < GLOBAL_SIZE; x++) {
-            printf("%c", display[y][x]);
-        }
-        printf("\n");
+        bool found = false;
+        for (int j = 0; j < fpga_count && !found; j++) found = same_raw_line(&all_lines[i], &fpga_lines[j]);
+        if (!found) unmatched++;
     }
+    bool match = unmatched == 0 && total_lines_detected == fpga_count;
+
+    printf("\n=== HOUGH EM SOFTWARE (referência) ===\n");
+    printf("  %d linhas, %s do FPGA (%d)\n", total_lines_detected,
+           match ? "iguais às" : "DIFERENTES das", fpga_count);
+    printf("  software: %lld us/frame, FPGA + link: %lld us/frame (%.2fx)\n",
+           (long long)sw_us, (long long)fpga_us, (double)sw_us / (double)fpga_us);
+
+    memcpy(all_lines, fpga_lines, sizeof(DetectedLine) * fpga_count);
+    total_lines_detected = fpga_count;
 }
+#endif
 
-// ========== PADRÕES DE TESTE 64×64 ==========
+#endif  // MODE_64x64
 
-void create_test_cross_64x64() {
-    for (int y = 0; y < GLOBAL_SIZE; y++) {
-        for (int x = 0; x < GLOBAL_SIZE; x++) {
-            global_image[y][x] = (x == 32 || y == 32) ? 255 : 0;
-        }
-    }
+// Configura os dois canais DMA da UART (depois de uart_init)
+void link_dma_init() {
+    rx_dma = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(rx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, RX_RING_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(UART_ID, false));
+    dma_channel_configure(rx_dma, &c, rx_ring, &uart_get_hw(UART_ID)->dr, RX_DMA_COUNT, true);
+    
+    tx_dma = dma_claim_unused_channel(true);
+    c = dma_channel_get_default_config(tx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, uart_get_dreq(UART_ID, true));
+    dma_channel_configure(tx_dma, &c, &uart_get_hw(UART_ID)->dr, tx_buf[0], 0, false);
 }
 
-void create_test_diagonal_64x64() {
-    for (int y = 0; y < GLOBAL_SIZE; y++) {
-        for (int x = 0; x < GLOBAL_SIZE; x++) {
-            global_image[y][x] = (x == y) ? 255 : 0;
-        }
-    }
+// Índice do anel que o DMA de RX vai escrever a seguir
+static inline uint32_t rx_ring_head() {
+    return (dma_channel_hw_addr(rx_dma)->write_addr - (uint32_t)(uintptr_t)rx_ring) &
+           (RX_RING_SIZE - 1);
 }
 
-void create_test_rectangle_64x64() {
-    for (int y = 0; y < GLOBAL_SIZE; y++) {
-        for (int x = 0; x < GLOBAL_SIZE; x++) {
-            global_image[y][x] = ((x >= 20 && x <= 44 && (y == 12 || y == 52)) ||
-                                  (y >= 12 && y <= 52 && (x == 20 || x == 44))) ? 255 : 0;
-        }
+// Copia os bytes que o DMA já escreveu no anel (chamado por link_poll)
+static size_t uart_dma_rx_read(void* ctx, uint8_t* buf, size_t max) {
+    (void)ctx;
+    uint32_t head = rx_ring_head();
+    size_t n = 0;
+    while (rx_tail != head && n < max) {
+        buf[n++] = rx_ring[rx_tail];
+        rx_tail = (rx_tail + 1) & (RX_RING_SIZE - 1);
+    }
+    if (!dma_channel_is_busy(rx_dma)) {
+        // Contagem esgotada (2^32 bytes): continua do mesmo endereço
+        dma_channel_set_trans_count(rx_dma, RX_DMA_COUNT, true);
     }
+    return n;
 }
 
-void create_test_x_pattern_64x64() {
-    for (int y = 0; y < GLOBAL_SIZE; y++) {
-        for (int x = 0; x < GLOBAL_SIZE; x++) {
-            global_image[y][x] = (x == y || x + y == GLOBAL_SIZE - 1) ? 255 : 0;
-        }
-    }
+// Buffer livre para montar o próximo comando. O DMA em andamento, se
+// houver, usa o outro buffer.
+static uint8_t* uart_dma_tx_acquire(void* ctx) {
+    (void)ctx;
+    return tx_buf[tx_cur];
 }
 
-#endif  // MODE_64x64
+// Dispara o envio do buffer de uart_dma_tx_acquire(); só espera o comando
+// anterior terminar de sair, não este
+static void uart_dma_tx_submit(void* ctx, size_t len) {
+    (void)ctx;
+    dma_channel_wait_for_finish_blocking(tx_dma);
+    dma_channel_transfer_from_buffer_now(tx_dma, tx_buf[tx_cur], len);
+    tx_cur ^= 1;
+}
 
-void on_uart_rx() {
-    while (uart_is_readable(UART_ID)) {
-        int rv = uart_getc(UART_ID);
-        if (rv < 0) break;
-        uint8_t byte = (uint8_t)rv;
+static uint64_t uart_dma_now_us(void* ctx) {
+    (void)ctx;
+    return time_us_64();
+}
 
-        // ========== CORREÇÃO: ARMAZENA TUDO DIRETAMENTE ==========
-        // O FPGA não envia header de volta, envia direto os dados
-        // Primeiro byte = num_lines, depois [rho, theta, votes] * num_lines
-        
-        if (counter < 256) {
-            queue[counter++] = byte;
-            printf("RX[%d]: 0x%02X (%d)\n", counter-1, byte, byte);
-        }
-    }
+// Sem rx_wait: as esperas consultam o anel em laço, como antes
+static const LinkTransport uart_dma_link = {
+    .tx_acquire = uart_dma_tx_acquire,
+    .tx_submit = uart_dma_tx_submit,
+    .rx_read = uart_dma_rx_read,
+    .rx_wait = NULL,
+    .now_us = uart_dma_now_us,
+    .ctx = NULL,
+};
+
+// Espera o último byte enviado sair do pino (antes de trocar a taxa)
+static void link_tx_flush() {
+    dma_channel_wait_for_finish_blocking(tx_dma);
+    uart_tx_wait_blocking(UART_ID);
 }
 
-// Converte matriz 16×16 para formato empacotado (32 bytes)
-// Cada byte contém 8 pixels (1 bit por pixel)
-void convert_to_packed_format(uint8_t img[WIDTH][LENGHT], uint8_t packed[IMG_BYTES_PACKED]) {
-    for (int byte_idx = 0; byte_idx < IMG_BYTES_PACKED; byte_idx++) {
-        uint8_t packed_byte = 0x00;
-        
-        // Cada byte empacota 8 pixels consecutivos
-        for (int bit_idx = 0; bit_idx < 8; bit_idx++) {
-            int pixel_idx = byte_idx * 8 + bit_idx;
-            int row = pixel_idx / LENGHT;
-            int col = pixel_idx % LENGHT;
-            
-            // Se pixel é branco (!=0), liga o bit correspondente
-            if (img[row][col] != 0x00) {
-                packed_byte |= (1 << bit_idx);
-            }
-        }
-        
-        packed[byte_idx] = packed_byte;
-    }
+// Troca a taxa do Pico esperando o último byte sair da FIFO de TX
+static void link_set_baud(uint32_t baud) {
+    link_tx_flush();
+    uart_set_baudrate(UART_ID, baud);
+    link_baud = baud;
+    link_poll();  // Lixo da troca: descartado com o parser fora de transação
+}
+
+// Negocia uma nova taxa com o FPGA:
+//   1. BAUD_CMD + divisor na taxa atual; o FPGA responde ACK/NAK nela
+//   2. ACK: o FPGA já está na nova taxa; o Pico troca a sua
+//   3. BAUD_CONFIRM na nova taxa; o eco confirma o link
+// Se o ACK ou o eco não chegam, o FPGA pode estar na taxa antiga (o
+// BAUD_CMD se perdeu), na nova (só o eco se perdeu) ou de volta a BAUD_RATE
+// (sem sonda, depois de FPGA_BAUD_CONFIRM_US). O Pico espera essa janela,
+// consulta o estado na taxa em que está e só sem resposta volta a
+// BAUD_RATE. Com NAK nada muda. true: link na taxa pedida.
+bool fpga_set_baud(uint32_t baud) {
+    uint32_t div = (FPGA_CLK_HZ + baud / 2) / baud;
+    if (div < FPGA_MIN_CLKS_PER_BIT || div > 0xFFFF) return false;
+    uint32_t fpga_baud = FPGA_CLK_HZ / div;  // Taxa exata do FPGA com esse divisor
+    
+    response_arm(RESP_WAIT_CTRL);
+    uint8_t cmd[3] = { BAUD_CMD, (uint8_t)(div >> 8), (uint8_t)(div & 0xFF) };
+    link_send(cmd, sizeof(cmd));
+    if (ctrl_wait(STATUS_DEADLINE_US) && ctrl_reply == NAK_BYTE) {
+        return false;  // Recusado: os dois lados continuam na taxa atual
+    }
+    
+    if (ctrl_reply == ACK_BYTE) {
+        link_set_baud(fpga_baud);
+        response_arm(RESP_WAIT_CTRL);
+        const uint8_t probe = BAUD_CONFIRM;
+        link_send(&probe, 1);
+        if (ctrl_wait(STATUS_DEADLINE_US) && ctrl_reply == BAUD_CONFIRM) {
+            return true;
+        }
+    }
+    
+    // Handshake incompleto: espera a janela do FPGA vencer e procura a taxa
+    // dele, primeiro a do Pico, depois a base
+    sleep_us(FPGA_BAUD_CONFIRM_US + DEADLINE_MARGIN_US);
+    if (link_baud != BAUD_RATE && fpga_wait_ready()) {
+        return link_baud == fpga_baud;
+    }
+    link_set_baud(BAUD_RATE);
+    fpga_wait_ready();  // Descarta no FPGA o que a sonda na taxa errada deixou
+    return false;
 }
 
-// Envia imagem no formato empacotado (32 bytes)
-void send_image_16x16_packed(uint8_t img[WIDTH][LENGHT]) {
+// Envia header + imagem no formato empacotado (32 bytes) e aguarda a resposta
+bool send_image_16x16_packed(uint8_t img[WIDTH][LENGHT]) {
     uint8_t packed[IMG_BYTES_PACKED];
     
     // Converte para formato empacotado
-    convert_to_packed_format(img, packed);
+    tile_to_packed(img, packed);
     
     // ========== DEBUG: MOSTRA BYTES EMPACOTADOS ==========
     printf("\n📦 Bytes empacotados enviados (HEX):\n");
@@ -317,105 +398,360 @@ void send_image_16x16_packed(uint8_t img[WIDTH][LENGHT]) {
     printf("\n");
     // ====================================================
     
-    // Envia os 32 bytes empacotados
-    for (int i = 0; i < IMG_BYTES_PACKED; i++) {
-        while (!uart_is_writable(UART_ID)) tight_loop_contents();
-        uart_putc_raw(UART_ID, packed[i]);
-        sleep_ms(2);  // 2ms por byte
-    }
+    // Envia header + 32 bytes empacotados de uma vez
+    TileResult result;
+    return fpga_transact_tile(packed, &result);
 }
 
-// ========== FUNÇÕES PARA CRIAR DIFERENTES PADRÕES DE TESTE ==========
+#ifdef MODE_64x64
+// ========== MODO CONTÍNUO EM DOIS NÚCLEOS ==========
+// core1 é dono do link (montagem dos comandos, DMA, parser, créditos,
+// prazos e ressincronização); core0 gera e empacota os frames, junta as
+// linhas e desenha. Os dois só conversam por duas filas (pico/util/queue):
+//   link_jobs:    core0 → core1, um tile (ou a imagem inteira) empacotado
+//   link_results: core1 → core0, a resposta de cada job, com o mesmo tag
+// Depois de multicore_launch_core1() só core1 toca no link e no parser.
+// Enquanto core0 junta e desenha o frame K, core1 já envia o frame K+1.
+// O tag leva a paridade do frame, para as respostas dos dois frames em
+// andamento não se misturarem (tiles: 0..GRID_TILES-1 no frame par, os
+// seguintes no ímpar).
+#if FRAME_UPLOAD
+#define FRAME_JOBS 1                         // Imagem inteira: um comando por frame
+#define LINK_JOB_BYTES FRAME_BYTES_PACKED
+#define LINK_MAX_INFLIGHT 1                  // A resposta não leva tag
+#define LINK_RESP_MODE RESP_WAIT_FRAME
+#define LINK_JOB_DEADLINE_US FRAME_DEADLINE_US
+#else
+#define FRAME_JOBS GRID_TILES
+#define LINK_JOB_BYTES IMG_BYTES_PACKED
+#define LINK_MAX_INFLIGHT FPGA_MAX_INFLIGHT
+#define LINK_RESP_MODE RESP_WAIT_TAG
+#define LINK_JOB_DEADLINE_US TILE_DEADLINE_US
+#endif
+#define JOB_TAG(frame, i) ((((frame) & 1) * FRAME_JOBS) + (i))
+#if CONTINUOUS_FRAMES && 2 * FRAME_JOBS > 256
+#error "Modo contínuo: tags de duas paridades não cabem em 8 bits (grade grande demais)"
+#endif
+#define JOB_PARITY(tag) ((tag) / FRAME_JOBS)
+#define JOB_INDEX(tag) ((tag) % FRAME_JOBS)
+// Tiles com a orientação das bordas (ORIENT_CMD): só com ORIENT_WINDOW
+// ligado, para não pesar nas filas quando não há orientação
+#define LINK_JOB_THETA (!FRAME_UPLOAD && ORIENT_WINDOW >= 0)
 
-// Teste 1: Diagonal principal (45°)
-void create_diagonal(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (i == j) ? 255 : 0;
-        }
-    }
-}
+typedef struct {
+    uint8_t tag;
+    uint8_t data[LINK_JOB_BYTES];
+#if LINK_JOB_THETA
+    bool oriented;                 // theta vale (image_oriented)
+    uint8_t theta[TILE_PIXELS];
+#endif
+} LinkJob;
 
-// Teste 2: Linha vertical no centro (x=8)
-void create_vertical(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (j == 8) ? 255 : 0;
+typedef struct {
+    uint8_t tag;
+    bool ok;              // false: sem resposta no prazo (descartado na ressincronização)
+    TileResult result;
+} LinkResult;
+
+queue_t link_jobs, link_results;
+
+// Laço de core1: mantém até LINK_MAX_INFLIGHT jobs em voo e devolve cada
+// resposta a core0. Prazo vencido ou resposta malformada: devolve os jobs
+// pendentes com ok=false e ressincroniza pelo handshake READY. Não imprime
+// nada: o USB fica com core0.
+void link_core_main() {
+    static LinkJob job;
+    static LinkResult out;
+#if !FRAME_UPLOAD
+    static TileCacheTicket tickets[2 * FRAME_JOBS];  // Entrada do cache de cada job em voo
+    // Jobs iguais a um job em voo (TILE_CACHE_IN_FLIGHT): lista encadeada
+    // por dono, respondidos com a resposta dele
+    static int16_t waiter_head[2 * FRAME_JOBS], waiter_next[2 * FRAME_JOBS];
+#endif
+    static bool pending[2 * FRAME_JOBS];  // Job com tag t enviado e sem resposta
+    int inflight = 0;
+#if FRAME_UPLOAD
+    uint8_t last_tag = 0;
+#endif
+    absolute_time_t deadline = at_the_end_of_time;
+    
+#if !FRAME_UPLOAD
+    memset(waiter_head, 0xFF, sizeof(waiter_head));  // -1: ninguém esperando
+#endif
+    response_arm(LINK_RESP_MODE);
+    
+    while (true) {
+        while (inflight < LINK_MAX_INFLIGHT && queue_try_remove(&link_jobs, &job)) {
+#if FRAME_UPLOAD
+            uint8_t* cmd = link_tx_acquire();
+            cmd[0] = FRAME_CMD;
+            memcpy(&cmd[1], job.data, LINK_JOB_BYTES);
+            link_tx_submit(1 + LINK_JOB_BYTES);
+            last_tag = job.tag;
+#else
+            // Tile já visto (hough_cache, só sem orientação): responde na hora
+            bool cacheable = tile_edges(job.data) > 0;
+#if LINK_JOB_THETA
+            cacheable = cacheable && !job.oriented;
+#endif
+            tile_lookup_t lookup = TILE_CACHE_MISS;
+            tickets[job.tag].slot = TILE_CACHE_NONE;
+            if (cacheable) lookup = tile_cache_get(job.data, job.tag, &out.result, &tickets[job.tag]);
+            if (lookup == TILE_CACHE_IN_FLIGHT) {
+                // Igual a um job em voo com a mesma reserva: sai com a resposta dele
+                const TileCacheTicket* t = &tickets[job.tag];
+                int owner = t->owner;
+                if (owner < 2 * FRAME_JOBS && pending[owner] && tickets[owner].slot == t->slot &&
+                    tickets[owner].gen == t->gen) {
+                    waiter_next[job.tag] = waiter_head[owner];
+                    waiter_head[owner] = job.tag;
+                    continue;
+                }
+            }
+            bool hit = lookup == TILE_CACHE_HIT;
+#if LINK_JOB_THETA
+            bool sent = !hit && fpga_send_tile_oriented(job.tag, job.data, job.oriented ? job.theta : NULL);
+#else
+            bool sent = !hit && fpga_send_tile_encoded(job.tag, job.data);
+#endif
+            if (!sent) {
+                // Tile vazio ou do cache: responde na hora, sem usar o link
+                out.tag = job.tag;
+                out.ok = true;
+                if (!hit) out.result.num_lines = 0;
+                queue_add_blocking(&link_results, &out);
+                continue;
+            }
+#endif
+            pending[job.tag] = true;
+            inflight++;
+            deadline = make_timeout_time_us(LINK_JOB_DEADLINE_US);
+        }
+        
+        link_poll();
+        while (result_take(&out.result)) {
+#if FRAME_UPLOAD
+            out.tag = last_tag;  // Um só em voo
+#else
+            out.tag = out.result.tile_id;
+#endif
+            if (out.tag >= 2 * FRAME_JOBS || !pending[out.tag]) {
+                resp_state = RESP_ERROR;  // Tag inesperado: trata como prazo vencido
+                break;
+            }
+            out.ok = true;
+            pending[out.tag] = false;
+#if !FRAME_UPLOAD
+            tile_cache_fill(tickets[out.tag], &out.result);
+            int owner = out.tag;
+            queue_add_blocking(&link_results, &out);
+            for (int w = waiter_head[owner]; w >= 0; w = waiter_next[w]) {
+                out.tag = (uint8_t)w;
+                queue_add_blocking(&link_results, &out);
+            }
+            waiter_head[owner] = -1;
+#else
+            queue_add_blocking(&link_results, &out);
+#endif
+            inflight--;
+            deadline = make_timeout_time_us(LINK_JOB_DEADLINE_US);
+        }
+        
+        if (resp_state == RESP_ERROR || (inflight > 0 && time_reached(deadline))) {
+            out.ok = false;
+            out.result.num_lines = 0;
+            for (int t = 0; t < 2 * FRAME_JOBS; t++) {
+                if (!pending[t]) continue;
+                out.tag = (uint8_t)t;
+                queue_add_blocking(&link_results, &out);
+#if !FRAME_UPLOAD
+                tile_cache_drop(tickets[t]);
+                for (int w = waiter_head[t]; w >= 0; w = waiter_next[w]) {
+                    out.tag = (uint8_t)w;
+                    queue_add_blocking(&link_results, &out);
+                }
+                waiter_head[t] = -1;
+#endif
+            }
+            memset(pending, 0, sizeof(pending));
+            inflight = 0;
+            fpga_wait_ready();
+            response_arm(LINK_RESP_MODE);
         }
     }
 }
 
-// Teste 3: Linha horizontal no centro (y=8)
-void create_horizontal(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (i == 8) ? 255 : 0;
-        }
+// Empacota o frame em global_image e entrega os jobs a core1 (bloqueia
+// só se core1 estiver dois frames atrás)
+static void frame_submit(int frame) {
+    static LinkJob job;
+#if FRAME_UPLOAD
+    job.tag = JOB_TAG(frame, 0);
+    image_to_packed(job.data);
+    queue_add_blocking(&link_jobs, &job);
+#else
+    for (int i = 0; i < FRAME_JOBS; i++) {
+        job.tag = JOB_TAG(frame, i);
+        pack_tile(i % GRID_COLS, i / GRID_COLS, job.data);
+#if LINK_JOB_THETA
+        job.oriented = image_oriented && orient_window >= 0;
+        if (job.oriented) pack_tile_theta(i % GRID_COLS, i / GRID_COLS, job.theta);
+#endif
+        queue_add_blocking(&link_jobs, &job);
     }
+#endif
 }
 
-// Teste 4: Anti-diagonal (135°) - linha de canto superior direito ao inferior esquerdo
-void create_antidiagonal(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (i + j == WIDTH - 1) ? 255 : 0;
-        }
+// Espera todas as respostas do frame e converte em linhas globais (em
+// ordem de tile). Respostas do frame seguinte que chegam antes ficam
+// guardadas na outra metade. Retorna quantos jobs ficaram sem resposta.
+static int frame_collect(int frame) {
+    static LinkResult results[2][FRAME_JOBS];
+    static int received[2];
+    int p = frame & 1;
+    LinkResult r;
+    
+    while (received[p] < FRAME_JOBS) {
+        queue_remove_blocking(&link_results, &r);
+        results[JOB_PARITY(r.tag)][JOB_INDEX(r.tag)] = r;
+        received[JOB_PARITY(r.tag)]++;
+    }
+    received[p] = 0;
+    
+    int lost = 0;
+    total_lines_detected = 0;
+    for (int i = 0; i < FRAME_JOBS; i++) {
+        if (!results[p][i].ok) {
+            lost++;
+            continue;
+        }
+#if FRAME_UPLOAD
+        store_frame_result(&results[p][i].result);
+#else
+        store_tile_result(&results[p][i].result, i % GRID_COLS, i / GRID_COLS);
+#endif
     }
+    return lost;
 }
 
-// Teste 5: Duas linhas verticais paralelas
-void create_two_verticals(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (j == 5 || j == 10) ? 255 : 0;
-        }
-    }
+// Trabalho de core0 depois das linhas de um frame chegarem
+static void frame_finish() {
+    merge_detected_lines();
+#if CONTINUOUS_RENDER
+    print_frame_report();
+#endif
 }
 
-// Teste 6: Cruz (vertical + horizontal)
-void create_cross(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (i == 8 || j == 8) ? 255 : 0;
-        }
+// Referência: os mesmos frames em sequência, tudo em core0
+int64_t run_frames_single_core(int frames) {
+    absolute_time_t t0 = get_absolute_time();
+    for (int k = 0; k < frames; k++) {
+        global_image = frame_images[0];
+        create_test_pattern_64x64(k);
+        total_lines_detected = 0;
+#if FRAME_UPLOAD
+        process_frame_whole(false);
+#else
+        process_frame_tiles(false);
+#endif
+        frame_finish();
     }
+    return absolute_time_diff_us(t0, get_absolute_time());
 }
 
-// Teste 7: Quadrado (bordas da imagem)
-void create_square(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (i == 0 || i == WIDTH-1 || j == 0 || j == LENGHT-1) ? 255 : 0;
-        }
-    }
+// Pipeline de dois frames: o frame K+1 já está com core1 enquanto core0
+// junta e desenha o K. Chamar uma vez: core1 fica com o link daqui em diante.
+int64_t run_frames_dual_core(int frames) {
+    queue_init(&link_jobs, sizeof(LinkJob), 2 * FRAME_JOBS);
+    queue_init(&link_results, sizeof(LinkResult), 2 * FRAME_JOBS);
+    multicore_launch_core1(link_core_main);
+    link_on_core1 = true;
+    
+    int lost = 0;
+    absolute_time_t t0 = get_absolute_time();
+    global_image = frame_images[0];
+    create_test_pattern_64x64(0);
+    frame_submit(0);
+    for (int k = 0; k < frames; k++) {
+        if (k + 1 < frames) {
+            global_image = frame_images[(k + 1) & 1];
+            create_test_pattern_64x64(k + 1);
+            frame_submit(k + 1);
+        }
+        lost += frame_collect(k);
+        global_image = frame_images[k & 1];
+        frame_finish();
+    }
+    int64_t us = absolute_time_diff_us(t0, get_absolute_time());
+    if (lost > 0) printf("⚠ %d jobs sem resposta no prazo\n", lost);
+    return us;
 }
 
-// Teste 8: X (duas diagonais)
-void create_x_pattern(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (i == j || i + j == WIDTH - 1) ? 255 : 0;
-        }
-    }
+#if STREAM_INPUT
+// ========== ENTRADA EM FAIXAS PELA USB ==========
+
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
 }
 
-// Teste 9: Linha vertical na borda esquerda
-void create_vertical_left(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (j == 0) ? 255 : 0;
-        }
+// Uma linha da imagem em hex (espaços e quebras entre dígitos ignorados)
+static void read_stream_row(uint8_t* row, int bytes) {
+    for (int i = 0; i < bytes * 2; ) {
+        int v = hex_value(getchar());
+        if (v < 0) continue;
+        row[i / 2] = (i & 1) ? (uint8_t)(row[i / 2] | v) : (uint8_t)(v << 4);
+        i++;
     }
 }
 
-// Teste 10: Linha horizontal na borda superior
-void create_horizontal_top(uint8_t matrix[WIDTH][LENGHT]) {
-    for (int i = 0; i < WIDTH; i++) {
-        for (int j = 0; j < LENGHT; j++) {
-            matrix[i][j] = (i == 0) ? 255 : 0;
+// Recebe imagens sem nunca guardar mais que uma faixa de 16 linhas: os
+// tiles de cada faixa vão ao FPGA enquanto as linhas seguintes chegam
+void run_stream_input() {
+    static uint8_t row[SOBEL_MAX_WIDTH];  // Linha em cinza (a maior) ou em bits
+    // Depois do modo contínuo o link é de core1: faixas no hough_sw
+    bool use_fpga = fpga_online && !link_on_core1;
+
+    while (1) {
+        char header[48];
+        int width, height, bits = 1;
+        printf("\n=== ENTRADA EM FAIXAS (%s) ===\n", use_fpga ? "FPGA" : "hough_sw");
+        printf("Envie \"largura altura [8]\" (largura até %d; 8: cinza, Sobel no Pico) e as linhas em hex\n",
+               STREAM_MAX_WIDTH);
+        if (!fgets(header, sizeof(header), stdin)) continue;
+        int fields = sscanf(header, "%d %d %d", &width, &height, &bits);
+        if (fields < 2) continue;
+        bool gray = fields == 3 && bits == 8;
+        if (height <= 0 || (fields == 3 && bits != 1 && bits != 8) ||
+            !(gray ? stream_begin_gray(width, use_fpga) : stream_begin(width, use_fpga))) {
+            printf("⚠ Imagem %dx%d de %d bits por pixel não suportada\n", width, height, bits);
+            continue;
+        }
+        for (int y = 0; y < height; y++) {
+            if (gray) {
+                read_stream_row(row, width);
+                stream_push_gray_row(row);
+            } else {
+                read_stream_row(row, STREAM_ROW_BYTES(width));
+                stream_push_row(row);
+            }
         }
+        stream_finish();
+
+        const StreamStats* st = &stream_stats;
+        printf("Imagem %dx%d: %d faixas, %d tiles não vazios, %d detecções → %d linhas, %d trechos\n",
+               width, height, st->bands, st->tiles_sent, st->raw_lines, total_lines_detected, total_segments);
+        printf("Primeira detecção em %lld us, imagem completa em %lld us (faixa de %d bytes)\n",
+               (long long)(st->first_result_us ? st->first_result_us - st->start_us : 0),
+               (long long)(st->end_us - st->start_us), TILE_SIZE * STREAM_ROW_BYTES(width));
+        if (st->lost_tiles > 0) printf("⚠ %d tiles sem resposta no prazo\n", st->lost_tiles);
+        print_detected_lines();
     }
 }
+#endif
+#endif  // MODE_64x64
 
 int main() {
     stdio_usb_init();
@@ -424,75 +760,38 @@ int main() {
 #ifdef MODE_16x16
     // ========== MODO 16×16: TESTES ORIGINAIS ==========
     uint8_t matrix[WIDTH][LENGHT];
-    const char* test_name;
-    const char* expected_angle;
-    
-    // ========== ESCOLHA O TESTE AQUI ==========
-    // Descomente APENAS UMA linha abaixo:
-    
-    // create_diagonal(matrix);
-    // test_name = "Diagonal Principal (0,0)→(15,15)";
-    // expected_angle = "θ ≈ 135° (normal à linha 45°)";
-    
-    // create_vertical(matrix);
-    // test_name = "Linha Vertical no Centro (x=8)";
-    // expected_angle = "θ ≈ 90° (normal à linha vertical)";
-    
-    create_horizontal(matrix);
-    test_name = "Linha Horizontal no Centro (y=8)";
-    expected_angle = "θ ≈ 0° ou 180° (normal à linha horizontal)";
-    
-    // create_antidiagonal(matrix);
-    // test_name = "Anti-diagonal (15,0)→(0,15)";
-    // expected_angle = "θ ≈ 45° (normal à linha 135°)";
-    
-    // create_two_verticals(matrix);
-    // test_name = "Duas Linhas Verticais Paralelas (x=5 e x=10)";
-    // expected_angle = "θ ≈ 90° para ambas";
-    
-    // create_cross(matrix);
-    // test_name = "Cruz (Vertical + Horizontal)";
-    // expected_angle = "θ ≈ 0° e 90° (2 linhas detectadas)";
-    
-    // create_square(matrix);
-    // test_name = "Quadrado (Bordas da Imagem)";
-    // expected_angle = "4 linhas: θ ≈ 0°, 90°, 0°, 90°";
-    
-    // create_x_pattern(matrix);
-    // test_name = "Padrão X (Duas Diagonais)";
-    // expected_angle = "θ ≈ 45° e 135° (2 linhas)";
-    
-    // create_vertical_left(matrix);
-    // test_name = "Linha Vertical na Borda Esquerda (x=0)";
-    // expected_angle = "θ ≈ 90°";
+    const TilePattern* test = &tile_patterns[TILE_TEST];
+    const char* test_name = test->title;
+    const char* expected_angle = test->expected;
     
-    // create_horizontal_top(matrix);
-    // test_name = "Linha Horizontal na Borda Superior (y=0)";
-    // expected_angle = "θ ≈ 0° ou 180°";
-    
-    // ==========================================
+    test->create(matrix);
 #endif
 
 #ifdef MODE_64x64
     // ========== MODO 64×64: PROCESSAMENTO POR TILES ==========
     
-    // Escolha o padrão de teste (descomente UMA linha):
-    create_test_cross_64x64();        // Cruz no centro
-    // create_test_diagonal_64x64();     // Diagonal principal
-    // create_test_rectangle_64x64();    // Retângulo
-    // create_test_x_pattern_64x64();    // Padrão X
+    create_test_pattern_64x64(DEMO_PATTERN);
     
+#if FRAME_UPLOAD
+    printf("\n╔════════════════════════════════════════════════════╗\n");
+    printf("║   PROCESSAMENTO %dx%d IMAGEM INTEIRA - HOUGH     ║\n", IMAGE_WIDTH, IMAGE_HEIGHT);
+    printf("╚════════════════════════════════════════════════════╝\n");
+    printf("Comando 0x%02X + %d bytes, ρ global com sinal\n", FRAME_CMD, FRAME_BYTES_PACKED);
+    printf("Prazo da imagem: %lu us (fio + Hough + folga)\n\n", (unsigned long)FRAME_DEADLINE_US);
+#else
     printf("\n╔════════════════════════════════════════════════════╗\n");
-    printf("║   PROCESSAMENTO 64×64 EM TILES 16×16 - HOUGH     ║\n");
+    printf("║   PROCESSAMENTO %dx%d EM TILES 16×16 - HOUGH     ║\n", IMAGE_WIDTH, IMAGE_HEIGHT);
     printf("╚════════════════════════════════════════════════════╝\n");
-    printf("Grid: 4×4 tiles (16 tiles de 16×16)\n");
-    printf("Tempo estimado: ~13 segundos (800ms/tile)\n\n");
+    printf("Grid: %d×%d tiles (%d tiles de 16×16, passo %d, halo %d)\n",
+           GRID_COLS, GRID_ROWS, GRID_TILES, TILE_STEP, TILE_HALO);
+    printf("Prazo por tile: %lu us (fio + Hough + folga)\n\n", (unsigned long)TILE_DEADLINE_US);
+#endif
     
     // Mostra imagem original
-    printf("Imagem Original 64×64:\n");
-    for (int y = 0; y < GLOBAL_SIZE; y++) {
-        for (int x = 0; x < GLOBAL_SIZE; x++) {
-            printf("%c", global_image[y][x] ? '#' : '.');
+    printf("Imagem Original %dx%d:\n", IMAGE_WIDTH, IMAGE_HEIGHT);
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+        for (int x = 0; x < IMAGE_WIDTH; x++) {
+            printf("%c", image_pixel(x, y) ? '#' : '.');
         }
         printf("\n");
     }
@@ -505,8 +804,30 @@ int main() {
     uart_set_format(UART_ID, 8, 1, UART_PARITY_NONE);
     uart_set_fifo_enabled(UART_ID, true);
     
-    int UART_IRQ = (UART_ID == uart0) ? UART0_IRQ : UART1_IRQ;
-    irq_set_exclusive_handler(UART_IRQ, on_uart_rx);
+    // DMA de RX fica ativo o tempo todo: o parser descarta bytes que
+    // chegam fora de uma transação
+    while (uart_is_readable(UART_ID)) uart_getc(UART_ID);
+    link_dma_init();
+    link_attach(&uart_dma_link);
+    
+    // Handshake inicial: só envia tiles depois que o FPGA confirmar READY
+    printf("Aguardando READY do FPGA...\n");
+    fpga_online = fpga_wait_ready();
+    if (!fpga_online) {
+        printf("⚠ FPGA não respondeu à consulta de estado (0x%02X)\n", STATUS_CMD);
+    }
+
+#if defined(MODE_64x64) && BAUD_BENCHMARK
+    if (fpga_online) benchmark_link_rates();
+#endif
+
+#if LINK_BAUD_TARGET
+    if (fpga_online && link_baud != LINK_BAUD_TARGET && !fpga_set_baud(LINK_BAUD_TARGET)) {
+        printf("⚠ Troca para %u baud falhou, link em %lu baud\n",
+               LINK_BAUD_TARGET, (unsigned long)link_baud);
+    }
+    printf("Link UART: %lu baud\n", (unsigned long)link_baud);
+#endif
 
 #ifdef MODE_16x16
     // ========== PROCESSAMENTO 16×16 ==========
@@ -529,52 +850,30 @@ int main() {
     }
     printf("\n");
     
-    // Limpa buffer UART múltiplas vezes
-    for (int clear = 0; clear < 5; clear++) {
-        while (uart_is_readable(UART_ID)) uart_getc(UART_ID);
-        sleep_ms(20);
-    }
-    
-    counter = 0;
-    
-    // ENVIA HEADER PRIMEIRO
-    printf("Enviando header 0xAA...\n");
-    uart_putc_raw(UART_ID, HEADER_BYTE);
-    sleep_ms(10);  // Espera header ser processado
-    
-    // Depois envia a imagem no formato empacotado (32 bytes)
-    printf("Enviando imagem empacotada (32 bytes)...\n");
-    send_image_16x16_packed(matrix);
-    
-    // Habilita IRQ para receber resposta
-    printf("Habilitando IRQ para receber resposta...\n");
-    irq_set_enabled(UART_IRQ, true);
-    uart_set_irq_enables(UART_ID, true, false);
-
-    printf("Aguardando resposta do FPGA...\n");
-    
-    // Aguarda tempo suficiente para Hough processar + transmitir resposta
-    sleep_ms(1000);
-    uart_set_irq_enables(UART_ID, false, false);
-    irq_set_enabled(UART_IRQ, false);
+    // Envia header + imagem empacotada (32 bytes) e aguarda a resposta
+    printf("Enviando header 0x%02X + imagem empacotada (32 bytes)...\n", HEADER_BYTE);
+    absolute_time_t t_start = get_absolute_time();
+    bool complete = send_image_16x16_packed(matrix);
+    int64_t elapsed_us = absolute_time_diff_us(t_start, get_absolute_time());
 
     printf("\n=== RESULTADO ===\n");
-    printf("Bytes recebidos: %d\n", counter);
+    printf("Bytes recebidos: %d (%s em %lld us)\n", rx_log_len,
+           complete ? "resposta completa" : "prazo vencido", (long long)elapsed_us);
     
-    if (counter == 0) {
+    if (rx_log_len == 0) {
         printf("❌ Nenhuma resposta do FPGA.\n");
     } else {
         printf("✅ FPGA RESPONDEU!\n\n");
         
         // Interpreta resposta: num_lines + [rho, theta, votes] * num_lines
-        uint8_t num_lines = queue[0];
+        uint8_t num_lines = rx_log[0];
         printf("Primeiro byte (num_lines): %d (0x%02X)\n", num_lines, num_lines);
         
         // Diagnóstico: verifica se formato parece correto
         int expected_bytes = 1 + (num_lines * 3);
-        if (num_lines <= 4 && counter >= expected_bytes) {
+        if (num_lines <= 4 && rx_log_len >= expected_bytes) {
             printf("✓ Formato parece válido (%d bytes esperados, %d recebidos)\n", 
-                   expected_bytes, counter);
+                   expected_bytes, rx_log_len);
         } else {
             printf("⚠ Formato inesperado (esperava %d bytes para %d linhas)\n", 
                    expected_bytes, num_lines);
@@ -585,10 +884,10 @@ int main() {
             for (int i = 0; i < num_lines; i++) {
                 int idx = 1 + i * 3;  // 1 byte num_lines + 3 bytes por linha
                 
-                if (idx + 2 < counter) {
-                    uint8_t rho = queue[idx];
-                    uint8_t theta = queue[idx + 1];
-                    uint8_t votes = queue[idx + 2];
+                if (idx + 2 < rx_log_len) {
+                    uint8_t rho = rx_log[idx];
+                    uint8_t theta = rx_log[idx + 1];
+                    uint8_t votes = rx_log[idx + 2];
                     
                     printf("  Linha %d: ρ=%3d (dist), θ=%3d°, votos=%3d\n", 
                            i + 1, rho, theta, votes);
@@ -605,111 +904,98 @@ int main() {
         }
         
         printf("\n📦 Dados brutos recebidos (HEX):\n");
-        for (int i = 0; i < counter; i++) {
-            printf("0x%02X ", queue[i]);
+        for (int i = 0; i < rx_log_len; i++) {
+            printf("0x%02X ", rx_log[i]);
             if ((i + 1) % 8 == 0) printf("\n");
         }
-        if (counter % 8 != 0) printf("\n");
+        if (rx_log_len % 8 != 0) printf("\n");
         
         printf("\n📦 Dados brutos recebidos (DECIMAL):\n");
-        for (int i = 0; i < counter; i++) {
-            printf("%3d ", queue[i]);
+        for (int i = 0; i < rx_log_len; i++) {
+            printf("%3d ", rx_log[i]);
             if ((i + 1) % 8 == 0) printf("\n");
         }
-        if (counter % 8 != 0) printf("\n");
+        if (rx_log_len % 8 != 0) printf("\n");
+        
+        FpgaStats stats;
+        if (complete && fpga_query_stats(&stats)) {
+            printf("\n⏱ FPGA (ciclos @ %d Hz): %u bordas, VOTE %u, picos %u, RX %lu, TX %lu\n",
+                   FPGA_CLK_HZ, stats.edges, stats.vote_clks, stats.merge_clks,
+                   (unsigned long)stats.rx_clks, (unsigned long)stats.tx_clks);
+        }
     }
 #endif
 
 #ifdef MODE_64x64
-    // ========== PROCESSAMENTO 64×64 EM TILES ==========
-    
-    // Habilita IRQ para receber dados durante processamento
-    irq_set_enabled(UART_IRQ, true);
-    uart_set_irq_enables(UART_ID, true, false);
-    
-    printf("Iniciando processamento dos 16 tiles...\n\n");
+    // ========== PROCESSAMENTO 64×64 ==========
     
     total_lines_detected = 0;
-    int tiles_processed = 0;
-    
-    for (int ty = 0; ty < GRID_SIZE; ty++) {
-        for (int tx = 0; tx < GRID_SIZE; tx++) {
-            tiles_processed++;
-            printf("[Tile %d/16] Posição (%d,%d) - ", tiles_processed, tx, ty);
-            
-            int lines_in_tile = process_tile_on_fpga(tx, ty);
-            
-            if (lines_in_tile > 0) {
-                printf("%d linhas detectadas\n", lines_in_tile);
-            } else {
-                printf("Nenhuma linha detectada\n");
-            }
-            
-            sleep_ms(200);  // Intervalo entre tiles
-        }
+    uint32_t frame_bytes0 = link_tx_bytes;
+    absolute_time_t frame_start = get_absolute_time();
+    
+    if (fpga_online) {
+#if FRAME_UPLOAD
+        printf("Enviando a imagem inteira...\n\n");
+        process_frame_whole(true);
+#else
+        printf("Iniciando processamento dos %d tiles...\n\n", GRID_TILES);
+        process_frame_tiles(true);
+#endif
+    } else {
+        printf("FPGA fora do ar: Hough em software no Pico...\n\n");
+        process_frame_local(true);
     }
     
-    uart_set_irq_enables(UART_ID, false, false);
-    irq_set_enabled(UART_IRQ, false);
+    int64_t frame_us = absolute_time_diff_us(frame_start, get_absolute_time());
+    printf("\nFrame %dx%d processado em %lld us, %lu bytes enviados\n", IMAGE_WIDTH, IMAGE_HEIGHT,
+           (long long)frame_us, (unsigned long)(link_tx_bytes - frame_bytes0));
+#if !FRAME_UPLOAD
+    if (fpga_online) print_cache_stats("do frame", &tile_cache_stats);
+#endif
+    
+#if SW_BASELINE
+    if (fpga_online) compare_with_software(frame_us);
+#endif
     
     printf("\n=== RESULTADO BRUTO ===\n");
     printf("Total de detecções: %d\n\n", total_lines_detected);
     
-    // ========== FILTRAGEM: AGRUPA LINHAS SIMILARES ==========
-    // Considera similares se |Δρ| < 3 e |Δθ| < 15°
-    DetectedLine filtered_lines[MAX_LINES_TOTAL];
-    int num_filtered = 0;
-    
-    for (int i = 0; i < total_lines_detected; i++) {
-        bool is_duplicate = false;
-        
-        for (int j = 0; j < num_filtered; j++) {
-            float rho_diff = fabsf(all_lines[i].global_rho - filtered_lines[j].global_rho);
-            int theta_diff = abs((int)all_lines[i].theta - (int)filtered_lines[j].theta);
-            
-            // Considera duplicata se ρ e θ muito próximos
-            if (rho_diff < 3.0f && theta_diff < 15) {
-                is_duplicate = true;
-                // Mantém a linha com mais votos
-                if (all_lines[i].votes > filtered_lines[j].votes) {
-                    filtered_lines[j] = all_lines[i];
-                }
-                break;
-            }
-        }
-        
-        if (!is_duplicate && num_filtered < MAX_LINES_TOTAL) {
-            filtered_lines[num_filtered++] = all_lines[i];
-        }
-    }
-    
-    printf("\n=== RESULTADO FILTRADO ===\n");
-    printf("Linhas únicas: %d (após agrupar similares)\n\n", num_filtered);
-    
-    if (num_filtered > 0) {
-        printf("Linhas principais detectadas:\n");
-        for (int i = 0; i < num_filtered; i++) {
-            DetectedLine* line = &filtered_lines[i];
-            printf("  Linha %d: ρ_global=%.2f, θ=%d°, votos=%d\n",
-                   i + 1, line->global_rho, line->theta, line->votes);
-        }
-        
-        printf("\n");
-        
-        // Copia linhas filtradas de volta para visualização
-        for (int i = 0; i < num_filtered; i++) {
-            all_lines[i] = filtered_lines[i];
-        }
-        total_lines_detected = num_filtered;
-        
-        print_image_with_lines();
-    } else {
-        printf("Nenhuma linha detectada em toda a imagem.\n");
+    merge_detected_lines();
+    print_frame_report();
+
+#if TELEMETRY
+    if (fpga_online) emit_frame_telemetry(0);
+#endif
+
+#if CONTINUOUS_FRAMES
+    // Sem FPGA cada frame só venceria prazos
+    if (fpga_online) {
+        // Os dois começam com o cache vazio (os padrões se repetem a cada 4 frames)
+        printf("\n=== MODO CONTÍNUO: %d frames ===\n", CONTINUOUS_FRAMES);
+        tile_cache_clear();
+        int64_t single_us = run_frames_single_core(CONTINUOUS_FRAMES);
+#if !FRAME_UPLOAD
+        TileCacheStats single_cache = tile_cache_stats;
+#endif
+        tile_cache_clear();  // core1 ainda não existe
+        int64_t dual_us = run_frames_dual_core(CONTINUOUS_FRAMES);
+        printf("\n=== MODO CONTÍNUO: %d frames ===\n", CONTINUOUS_FRAMES);
+        printf("  só core0:            %8.1f frames/s (%lld us/frame)\n",
+               CONTINUOUS_FRAMES * 1e6 / (double)single_us, (long long)(single_us / CONTINUOUS_FRAMES));
+        printf("  core0 + core1 (link): %8.1f frames/s (%lld us/frame), %.2fx\n",
+               CONTINUOUS_FRAMES * 1e6 / (double)dual_us, (long long)(dual_us / CONTINUOUS_FRAMES),
+               (double)single_us / (double)dual_us);
+#if !FRAME_UPLOAD
+        print_cache_stats("só core0", &single_cache);
+        print_cache_stats("core0 + core1", &tile_cache_stats);
+#endif
     }
 #endif
-    
-    uart_set_irq_enables(UART_ID, true, false);
-    irq_set_enabled(UART_IRQ, true);
+
+#if STREAM_INPUT
+    run_stream_input();
+#endif
+#endif
     
     while (1) {
         tight_loop_contents();
@@ -0,0 +1,436 @@
+// hough_vbench.cpp
+// Harness do Verilator para o RTL do Hough, com contagem exata de ciclos:
+//   - hough_transform sozinho (tile 16×16): ciclos de carga e de cada
+//     estado da FSM (limpeza no job_start, VOTE, VOTE_DRAIN, MERGE_PEAKS,
+//     DONE_STATE)
+//   - uart_echo_colorlight_i9 inteiro, pela UART serial (10 clocks/bit):
+//     ciclos do comando no fio, do fim do comando ao primeiro bit da
+//     resposta (fila + Hough) e da resposta no fio; tiles com 0xAA e as
+//     imagens 64×64 com 0xAC
+// Os contadores de desempenho do RTL também são conferidos: perf_* de
+// hough_transform contra os ciclos contados aqui, e o registro do 0xA8
+// (telemetria) do topo contra as bordas do caso e a sequência de resultados.
+// O corpus tem os 10 padrões 16×16 de main.c, tiles aleatórios esparsos e
+// densos, um tile vazio e os 4 padrões 64×64. Cada resultado é conferido
+// com hough_sw (o Hough em C idêntico ao RTL).
+//
+// Saída em JSON Lines: um objeto por caso e um resumo por modelo/tipo, para
+// comparar versões do RTL e pegar regressões. Código de saída 1 se algum
+// resultado divergir ou faltar resposta.
+//
+//   hough_vbench [--random N] [--seed S] [--model hough|top|all]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "verilated.h"
+#include "Vhough_transform.h"
+#include "Vhough_transform___024root.h"
+#include "Vuart_echo.h"
+
+extern "C" {
+#include "hough_core.h"
+#include "hough_sw.h"
+}
+
+// Deve bater com -Gclk_freq / -Gbaud_rate do modelo Vuart_echo (CMakeLists.txt)
+#define CLKS_PER_BIT 10
+#define REPLY_TIMEOUT_CYCLES 200000
+#define TILE_HEADER 0xAA
+#define FRAME_HEADER 0xAC
+#define STATS_CMD 0xA8
+#define STATS_BYTES 17
+
+// Estados de hough_transform.sv (state_t)
+enum { ST_IDLE, ST_VOTE, ST_VOTE_DRAIN, ST_MERGE_PEAKS, ST_DONE, ST_COUNT };
+
+struct Case {
+    std::string name;
+    std::string kind;    // pattern, sparse, dense, empty, frame
+    std::vector<uint8_t> packed;
+    int img_size;
+};
+
+struct Summary {
+    int cases = 0;
+    int mismatches = 0;
+    std::map<std::string, uint64_t> cycles;  // Soma por etapa
+};
+
+static std::map<std::string, Summary> summaries;  // "modelo/tipo"
+static int failures = 0;
+
+// ========== CORPUS ==========
+
+static int edges_of(const std::vector<uint8_t>& packed) {
+    int n = 0;
+    for (uint8_t b : packed) n += __builtin_popcount(b);
+    return n;
+}
+
+static Case random_tile(const char* kind, int index, int min_pct, int max_pct) {
+    Case c;
+    int pct = min_pct + rand() % (max_pct - min_pct + 1);
+    c.name = std::string(kind) + "_" + std::to_string(index);
+    c.kind = kind;
+    c.img_size = TILE_SIZE;
+    c.packed.assign(IMG_BYTES_PACKED, 0);
+    for (int i = 0; i < TILE_SIZE * TILE_SIZE; i++) {
+        if (rand() % 100 < pct) c.packed[i / 8] |= (uint8_t)(1u << (i % 8));
+    }
+    return c;
+}
+
+static std::vector<Case> build_corpus(int random_tiles) {
+    std::vector<Case> corpus;
+    uint8_t matrix[WIDTH][LENGHT];
+
+    for (int p = 0; p < TILE_PATTERN_COUNT; p++) {
+        Case c;
+        c.name = tile_patterns[p].name;
+        c.kind = "pattern";
+        c.img_size = TILE_SIZE;
+        c.packed.resize(IMG_BYTES_PACKED);
+        tile_patterns[p].create(matrix);
+        tile_to_packed(matrix, c.packed.data());
+        corpus.push_back(c);
+    }
+    corpus.push_back({ "empty", "empty", std::vector<uint8_t>(IMG_BYTES_PACKED, 0), TILE_SIZE });
+    for (int i = 0; i < random_tiles; i++) corpus.push_back(random_tile("sparse", i, 2, 10));
+    for (int i = 0; i < random_tiles; i++) corpus.push_back(random_tile("dense", i, 40, 90));
+
+    static const struct {
+        const char* name;
+        void (*create)(void);
+    } frames[] = {
+        { "cross_64x64", create_test_cross_64x64 },
+        { "diagonal_64x64", create_test_diagonal_64x64 },
+        { "rectangle_64x64", create_test_rectangle_64x64 },
+        { "x_pattern_64x64", create_test_x_pattern_64x64 },
+    };
+    for (const auto& f : frames) {
+        Case c;
+        c.name = f.name;
+        c.kind = "frame";
+        c.img_size = FRAME_RTL_SIZE;
+        c.packed.resize(FRAME_BYTES_PACKED);
+        f.create();
+        image_to_packed(c.packed.data());
+        corpus.push_back(c);
+    }
+    return corpus;
+}
+
+// Resposta esperada, nos bytes do protocolo
+static std::vector<uint8_t> reference_reply(const Case& c) {
+    TileResult ref;
+    int line_bytes;
+    if (c.img_size == TILE_SIZE) {
+        hough_sw_tile(c.packed.data(), &ref);
+        line_bytes = TILE_LINE_BYTES;
+    } else {
+        hough_sw_image(c.packed.data(), c.img_size, MAX_LINES_PER_FRAME, &ref);
+        line_bytes = FRAME_LINE_BYTES;
+    }
+    std::vector<uint8_t> reply = { ref.num_lines };
+    reply.insert(reply.end(), ref.lines, ref.lines + ref.num_lines * line_bytes);
+    return reply;
+}
+
+// ========== SAÍDA ==========
+
+// perf_ok: contadores de desempenho do RTL coerentes com o caso
+static void report(const char* model, const Case& c, const std::vector<std::pair<std::string, uint64_t>>& cycles,
+                   const std::vector<uint8_t>& got, const std::vector<uint8_t>& want, bool timeout,
+                   bool perf_ok = true) {
+    bool match = !timeout && got == want && perf_ok;
+    Summary& s = summaries[std::string(model) + "/" + c.kind];
+    s.cases++;
+    if (!match) {
+        s.mismatches++;
+        failures++;
+    }
+
+    printf("{\"model\":\"%s\",\"case\":\"%s\",\"kind\":\"%s\",\"edges\":%d,\"cycles\":{",
+           model, c.name.c_str(), c.kind.c_str(), edges_of(c.packed));
+    for (size_t i = 0; i < cycles.size(); i++) {
+        printf("%s\"%s\":%llu", i ? "," : "", cycles[i].first.c_str(), (unsigned long long)cycles[i].second);
+        s.cycles[cycles[i].first] += cycles[i].second;
+    }
+    printf("},\"lines\":%d,\"ref_lines\":%d,\"match\":%s%s%s}\n",
+           got.empty() ? -1 : got[0], want[0], match ? "true" : "false",
+           timeout ? ",\"timeout\":true" : "", perf_ok ? "" : ",\"perf_ok\":false");
+}
+
+static void print_summaries() {
+    for (const auto& it : summaries) {
+        const Summary& s = it.second;
+        size_t slash = it.first.find('/');
+        printf("{\"summary\":\"%s\",\"kind\":\"%s\",\"cases\":%d,\"mismatches\":%d,\"cycles_mean\":{",
+               it.first.substr(0, slash).c_str(), it.first.substr(slash + 1).c_str(), s.cases, s.mismatches);
+        bool first = true;
+        for (const auto& c : s.cycles) {
+            printf("%s\"%s\":%.1f", first ? "" : ",", c.first.c_str(), (double)c.second / s.cases);
+            first = false;
+        }
+        printf("}}\n");
+    }
+}
+
+// ========== hough_transform SOZINHO ==========
+
+static void tick(Vhough_transform* m, uint64_t* cycle) {
+    m->clk = 1;
+    m->eval();
+    m->clk = 0;
+    m->eval();
+    (*cycle)++;
+}
+
+static void run_hough(VerilatedContext* ctx, const std::vector<Case>& corpus) {
+    Vhough_transform* m = new Vhough_transform{ ctx, "hough" };
+    uint64_t cycle = 0;
+    static const char* const state_names[ST_COUNT] = { "clear", "vote", "drain", "merge", "done" };
+
+    m->clk = 0;
+    m->reset_n = 0;
+    m->start = 0;
+    m->wr_en = 0;
+    m->wr_theta = 0;
+    m->wr_window = 0xFF;  // Sem orientação: todos os θ (e ORIENTED = 0 aqui)
+    m->result_ack = 0;
+    m->eval();
+    for (int i = 0; i < 4; i++) tick(m, &cycle);
+    m->reset_n = 1;
+    tick(m, &cycle);
+
+    for (const Case& c : corpus) {
+        if (c.img_size != TILE_SIZE) continue;
+        uint64_t state_cycles[ST_COUNT] = { 0 };
+
+        // Carga: um byte por ciclo no banco livre
+        uint64_t t0 = cycle;
+        while (!m->load_ready) tick(m, &cycle);
+        for (int i = 0; i < IMG_BYTES_PACKED; i++) {
+            m->wr_en = 1;
+            m->wr_addr = i;
+            m->wr_data = c.packed[i];
+            tick(m, &cycle);
+        }
+        m->wr_en = 0;
+        uint64_t load = cycle - t0;
+
+        // Job: ciclos em cada estado até o pulso de done. O ciclo em IDLE
+        // com o banco confirmado é o job_start (invalida acumulador e listas).
+        m->start = 1;
+        tick(m, &cycle);
+        m->start = 0;
+        t0 = cycle;
+        bool timeout = false;
+        while (!m->done) {
+            int st = m->rootp->hough_transform__DOT__state;
+            if (st < ST_COUNT) state_cycles[st]++;
+            tick(m, &cycle);
+            if (cycle - t0 > REPLY_TIMEOUT_CYCLES) {
+                timeout = true;
+                break;
+            }
+        }
+
+        std::vector<uint8_t> got = { (uint8_t)m->num_lines };
+        for (int i = 0; i < m->num_lines && i < MAX_LINES_PER_TILE; i++) {
+            got.push_back((uint8_t)(m->line_rho >> (16 * i)));
+            got.push_back((uint8_t)(m->line_theta >> (8 * i)));
+            got.push_back((uint8_t)(m->line_votes >> (8 * i)));
+        }
+        // perf_* publicados com o resultado: VOTE + VOTE_DRAIN e MERGE_PEAKS
+        bool perf_ok = m->perf_edges == edges_of(c.packed) &&
+                       m->perf_vote_clks == state_cycles[ST_VOTE] + state_cycles[ST_VOTE_DRAIN] &&
+                       m->perf_merge_clks == state_cycles[ST_MERGE_PEAKS];
+        m->result_ack = 1;
+        tick(m, &cycle);
+        m->result_ack = 0;
+
+        std::vector<std::pair<std::string, uint64_t>> cycles = { { "load", load } };
+        uint64_t job = 0;
+        for (int s = 0; s < ST_COUNT; s++) {
+            cycles.push_back({ state_names[s], state_cycles[s] });
+            job += state_cycles[s];
+        }
+        cycles.push_back({ "job", job });
+        report("hough_transform", c, cycles, got, reference_reply(c), timeout, perf_ok);
+    }
+
+    m->final();
+    delete m;
+}
+
+// ========== uart_echo_colorlight_i9 PELA UART ==========
+
+struct TopBench {
+    Vuart_echo* m;
+    uint64_t cycle = 0;
+
+    // Receptor do uart_tx: amostra no meio de cada bit
+    int rx_phase = -1;     // -1: ocioso; senão ciclos desde a borda do start
+    uint8_t rx_shift = 0;
+    uint64_t rx_start = 0; // Ciclo da borda do start do byte atual
+    std::vector<uint8_t> rx_bytes;
+    uint64_t first_start = 0, last_stop_end = 0;
+
+    void tick() {
+        m->clk = 1;
+        m->eval();
+        m->clk = 0;
+        m->eval();
+        cycle++;
+        sample();
+    }
+
+    void sample() {
+        if (rx_phase < 0) {
+            if (!m->uart_tx) {
+                rx_phase = 0;
+                rx_start = cycle;
+                if (rx_bytes.empty()) first_start = cycle;
+            }
+            return;
+        }
+        rx_phase++;
+        int bit = (rx_phase - CLKS_PER_BIT / 2) / CLKS_PER_BIT;  // 0 = start, 1..8 = dados
+        if ((rx_phase - CLKS_PER_BIT / 2) % CLKS_PER_BIT == 0 && bit >= 1 && bit <= 8) {
+            rx_shift = (uint8_t)((rx_shift >> 1) | (m->uart_tx ? 0x80 : 0));
+        }
+        if (rx_phase == CLKS_PER_BIT * 10) {  // Fim do stop
+            rx_bytes.push_back(rx_shift);
+            last_stop_end = cycle;
+            rx_phase = -1;
+        }
+    }
+
+    // Envia um byte bit a bit (start, 8 dados LSB primeiro, stop)
+    void send_byte(uint8_t b) {
+        for (int bit = 0; bit < 10; bit++) {
+            int level = (bit == 0) ? 0 : (bit == 9) ? 1 : (b >> (bit - 1)) & 1;
+            m->uart_rx = level;
+            for (int i = 0; i < CLKS_PER_BIT; i++) tick();
+        }
+    }
+
+    // Espera n bytes de resposta (registro de telemetria)
+    bool wait_bytes(size_t n) {
+        uint64_t t0 = cycle;
+        while (cycle - t0 < REPLY_TIMEOUT_CYCLES) {
+            tick();
+            if (rx_bytes.size() == n) return true;
+        }
+        return false;
+    }
+
+    // Espera a resposta inteira: num_lines e line_bytes × num_lines
+    bool wait_reply(int line_bytes) {
+        uint64_t t0 = cycle;
+        while (cycle - t0 < REPLY_TIMEOUT_CYCLES) {
+            tick();
+            if (!rx_bytes.empty() && rx_bytes.size() == 1u + rx_bytes[0] * line_bytes) return true;
+        }
+        return false;
+    }
+};
+
+static void run_top(VerilatedContext* ctx, const std::vector<Case>& corpus) {
+    TopBench tb;
+    tb.m = new Vuart_echo{ ctx, "top" };
+    tb.m->clk = 0;
+    tb.m->reset_n = 0;
+    tb.m->uart_rx = 1;
+    tb.m->eval();
+    for (int i = 0; i < 4; i++) tb.tick();
+    tb.m->reset_n = 1;
+    for (int i = 0; i < CLKS_PER_BIT * 4; i++) tb.tick();
+    uint8_t seq = 0;
+
+    for (const Case& c : corpus) {
+        bool frame = c.img_size != TILE_SIZE;
+        int line_bytes = frame ? FRAME_LINE_BYTES : TILE_LINE_BYTES;
+
+        tb.rx_bytes.clear();
+        tb.rx_phase = -1;
+        uint64_t t0 = tb.cycle;
+        tb.send_byte(frame ? FRAME_HEADER : TILE_HEADER);
+        for (uint8_t b : c.packed) tb.send_byte(b);
+        uint64_t cmd_end = tb.cycle;
+        bool timeout = !tb.wait_reply(line_bytes);
+
+        std::vector<std::pair<std::string, uint64_t>> cycles = { { "rx", cmd_end - t0 } };
+        if (!timeout) {
+            cycles.push_back({ "compute", tb.first_start - cmd_end });
+            cycles.push_back({ "tx", tb.last_stop_end - tb.first_start });
+            cycles.push_back({ "total", tb.last_stop_end - t0 });
+        }
+        std::vector<uint8_t> reply = tb.rx_bytes;
+
+        // Telemetria do resultado que acabou de sair: seq seguinte, flags
+        // do comando, bordas do caso e CRC; rx/tx medidos pelo RTL vão junto
+        bool perf_ok = false;
+        if (!timeout) {
+            for (int i = 0; i < CLKS_PER_BIT * 2; i++) tb.tick();
+            tb.rx_bytes.clear();
+            tb.send_byte(STATS_CMD);
+            if (tb.wait_bytes(STATS_BYTES + 1)) {
+                const std::vector<uint8_t>& s = tb.rx_bytes;
+                uint32_t rx = ((uint32_t)s[9] << 24) | ((uint32_t)s[10] << 16) | ((uint32_t)s[11] << 8) | s[12];
+                uint32_t tx = ((uint32_t)s[13] << 24) | ((uint32_t)s[14] << 16) | ((uint32_t)s[15] << 8) | s[16];
+                perf_ok = crc8_block(s.data(), STATS_BYTES) == s[STATS_BYTES] &&
+                          s[0] == (uint8_t)(seq + 1) && s[2] == (frame ? 0x01 : 0x00) &&
+                          ((s[3] << 8) | s[4]) == edges_of(c.packed);
+                seq = s[0];
+                cycles.push_back({ "fpga_vote", (uint64_t)((s[5] << 8) | s[6]) });
+                cycles.push_back({ "fpga_merge", (uint64_t)((s[7] << 8) | s[8]) });
+                cycles.push_back({ "fpga_rx", rx });
+                cycles.push_back({ "fpga_tx", tx });
+            }
+        }
+        report("uart_echo_colorlight_i9", c, cycles, reply, reference_reply(c), timeout, perf_ok);
+
+        // Linha ociosa entre comandos
+        for (int i = 0; i < CLKS_PER_BIT * 2; i++) tb.tick();
+    }
+
+    tb.m->final();
+    delete tb.m;
+}
+
+int main(int argc, char** argv) {
+    int random_tiles = 20;
+    unsigned seed = 1;
+    std::string model = "all";
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--random") && i + 1 < argc) {
+            random_tiles = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--model") && i + 1 < argc) {
+            model = argv[++i];
+        } else {
+            fprintf(stderr, "uso: %s [--random N] [--seed S] [--model hough|top|all]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    VerilatedContext ctx;
+    ctx.commandArgs(argc, argv);
+    srand(seed);
+    std::vector<Case> corpus = build_corpus(random_tiles);
+
+    if (model == "all" || model == "hough") run_hough(&ctx, corpus);
+    if (model == "all" || model == "top") run_top(&ctx, corpus);
+    print_summaries();
+    return failures ? 1 : 0;
+}
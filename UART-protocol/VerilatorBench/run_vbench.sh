@@ -0,0 +1,25 @@
+#!/bin/sh
+# Compila o harness com o Verilator 5 instalado (ou o de VERILATOR_ROOT),
+# roda o corpus com N tiles aleatórios de cada tipo e guarda o JSON Lines
+# em ciclos.jsonl. Passa se nenhum resumo tiver divergências.
+#
+#   sh run_vbench.sh [N]     (N = 20 por padrão)
+
+cd "$(dirname "$0")" || exit 1
+
+RANDOM_TILES=${1:-20}
+
+cmake -S . -B build || exit 1
+cmake --build build -j || exit 1
+verilator --version
+
+./build/hough_vbench --random "$RANDOM_TILES" > ciclos.jsonl
+status=$?
+
+grep '"summary"' ciclos.jsonl
+if [ $status -ne 0 ] || grep '"summary"' ciclos.jsonl | grep -qv '"mismatches":0,'; then
+    echo "[ERRO] RTL diverge do hough_sw (ver ciclos.jsonl)"
+    exit 1
+fi
+echo "OK: $(grep -c '"case"' ciclos.jsonl) casos, 0 divergências"
+exit 0
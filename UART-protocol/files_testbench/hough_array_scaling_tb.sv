@@ -0,0 +1,280 @@
+// hough_array_scaling_tb.sv
+// Testbench de escalabilidade da hough_array (despachante + N motores)
+//
+// Processa o mesmo frame 64x64 (16 tiles 16x16) com NUM_ENGINES = 1, 2, 4
+// e 8 em paralelo e imprime os ciclos por frame de cada configuração.
+// Os tiles são carregados a 1 byte/ciclo direto na interface da matriz,
+// para que o tempo medido seja o dos motores e não o da UART.
+//
+// Verificações:
+//   - todas as configurações devolvem os 16 tags, cada um uma única vez
+//   - o resultado de cada tile é idêntico ao da configuração com 1 motor
+//   - ciclos por frame diminuem com N (1 > 2 > 4 > 8)
+//   - contrapressão: com res_ack parado até a matriz recusar tiles, cada
+//     motor fica com 4 jobs sem ack (resultado, DONE_STATE e os dois
+//     bancos) e os tags continuam saindo certos
+
+`timescale 1ns/1ps
+
+// ========== UMA CONFIGURAÇÃO (N motores) ==========
+module hough_array_scaling_run #(
+    parameter NUM_ENGINES = 1,
+    parameter BACKPRESSURE = 0      // 1: sem ack até a matriz parar de aceitar tiles
+)(
+    input  logic clk,
+    input  logic reset_n,
+    output logic finished,
+    output int   frame_cycles
+);
+
+    localparam MAX_LINES = 4;
+    localparam NUM_TILES = 16;
+    localparam STALL_CLKS = 20000;  // in_ready em '0' por tanto tempo: motores cheios
+
+    logic        in_ready, in_begin, in_tagged, in_wr_en, in_commit;
+    logic [7:0]  in_tag, in_wr_addr, in_wr_data;
+    logic        res_valid, res_tagged, res_crc, res_ack;
+    logic [7:0]  res_tag, res_num_lines, res_rho, res_theta, res_votes;
+    logic [7:0]  res_sel;
+    logic        busy;
+
+    hough_array #(
+        .NUM_ENGINES(NUM_ENGINES),
+        .MAX_LINES(MAX_LINES)
+    ) dut (
+        .clk(clk),
+        .reset_n(reset_n),
+        .in_ready(in_ready),
+        .in_begin(in_begin),
+        .in_tag(in_tag),
+        .in_tagged(in_tagged),
+        .in_crc(1'b0),
+        .in_wr_en(in_wr_en),
+        .in_wr_addr(in_wr_addr),
+        .in_wr_data(in_wr_data),
+        .in_wr_theta(32'd0),
+        .in_wr_window(8'hFF),     // Sem orientação: todos os θ
+        .in_commit(in_commit),
+        .in_rx_clks(32'd0),
+        .res_valid(res_valid),
+        .res_tag(res_tag),
+        .res_tagged(res_tagged),
+        .res_crc(res_crc),
+        .res_num_lines(res_num_lines),
+        .res_sel(res_sel),
+        .res_rho(res_rho),
+        .res_theta(res_theta),
+        .res_votes(res_votes),
+        .res_ack(res_ack),
+        .busy(busy)
+    );
+
+    // Resultados por tile (indexados pelo tag devolvido)
+    logic [7:0] got_num   [0:NUM_TILES-1];
+    logic [7:0] got_rho   [0:NUM_TILES*MAX_LINES-1];
+    logic [7:0] got_theta [0:NUM_TILES*MAX_LINES-1];
+    logic [7:0] got_votes [0:NUM_TILES*MAX_LINES-1];
+    int         got_count [0:NUM_TILES-1];
+
+    int cycle;
+    int start_cycle;
+    int received;
+    int loaded;      // Tiles confirmados com in_commit
+    int stall_loaded;  // loaded quando a contrapressão foi atingida
+    logic stalled;   // Contrapressão atingida: consumidor começa a ler
+
+    always @(posedge clk) cycle <= cycle + 1;
+
+    // Frame 64x64: diagonal, horizontal, vertical e anti-diagonal
+    function automatic bit frame_pixel(input int x, input int y);
+        frame_pixel = (x == y) || (y == 20) || (x == 40) || (x + y == 63);
+    endfunction
+
+    // Byte b do tile t empacotado como no main.c: idx = row*16 + col, LSB first
+    function automatic logic [7:0] tile_byte(input int t, input int b);
+        int tx, ty;
+        tx = t % 4;
+        ty = t / 4;
+        tile_byte = 8'h00;
+        for (int k = 0; k < 8; k++) begin
+            int idx;
+            idx = b * 8 + k;
+            tile_byte[k] = frame_pixel(tx * 16 + idx % 16, ty * 16 + idx / 16);
+        end
+    endfunction
+
+    // Driver: carrega os 16 tiles o mais rápido que a matriz aceita
+    // (estímulos na borda de descida para não competir com a lógica)
+    initial begin
+        in_begin = 0; in_tag = 0; in_tagged = 0;
+        in_wr_en = 0; in_wr_addr = 0; in_wr_data = 0; in_commit = 0;
+        cycle = 0;
+        loaded = 0; stalled = 0;
+
+        wait (reset_n);
+        @(negedge clk);
+        start_cycle = cycle;
+
+        for (int t = 0; t < NUM_TILES; t++) begin
+            int stall_clks;
+            stall_clks = 0;
+            while (!in_ready) begin
+                @(negedge clk);
+                stall_clks = stall_clks + 1;
+                if (BACKPRESSURE && stall_clks > STALL_CLKS) stalled = 1;
+            end
+            in_begin = 1; in_tag = t; in_tagged = 1;
+            @(negedge clk);
+            in_begin = 0;
+            for (int b = 0; b < 32; b++) begin
+                in_wr_en = 1;
+                in_wr_addr = b;
+                in_wr_data = tile_byte(t, b);
+                in_commit = (b == 31);
+                @(negedge clk);
+            end
+            in_wr_en = 0;
+            in_commit = 0;
+            loaded++;
+        end
+    end
+
+    // Consumidor: lê cada resultado assim que chega e devolve o ack
+    initial begin
+        res_ack = 0; res_sel = 0;
+        finished = 0; frame_cycles = 0; received = 0; stall_loaded = 0;
+        for (int t = 0; t < NUM_TILES; t++) got_count[t] = 0;
+
+        wait (reset_n);
+        if (BACKPRESSURE) begin
+            wait (stalled);
+            stall_loaded = loaded;
+            $display("Contrapressão N=%0d: %0d tiles aceitos sem ack", NUM_ENGINES, loaded);
+        end
+        forever begin
+            @(negedge clk);
+            if (res_valid) begin
+                if (!res_tagged || res_tag >= NUM_TILES) begin
+                    $display("ERRO: N=%0d resultado com tag inválido (%0d, tagged=%0b)",
+                             NUM_ENGINES, res_tag, res_tagged);
+                end else begin
+                    got_count[res_tag]++;
+                    got_num[res_tag] = res_num_lines;
+                    for (int l = 0; l < MAX_LINES; l++) begin
+                        res_sel = l;
+                        #1;
+                        got_rho  [res_tag * MAX_LINES + l] = (l < res_num_lines) ? res_rho   : 8'd0;
+                        got_theta[res_tag * MAX_LINES + l] = (l < res_num_lines) ? res_theta : 8'd0;
+                        got_votes[res_tag * MAX_LINES + l] = (l < res_num_lines) ? res_votes : 8'd0;
+                    end
+                end
+                res_ack = 1;
+                @(negedge clk);
+                res_ack = 0;
+                received++;
+                if (received == NUM_TILES) begin
+                    frame_cycles = cycle - start_cycle;
+                    finished = 1;
+                end
+            end
+        end
+    end
+
+endmodule
+
+// ========== TOPO: 1, 2, 4 e 8 MOTORES EM PARALELO ==========
+module hough_array_scaling_tb;
+
+    localparam NUM_TILES = 16;
+    localparam MAX_LINES = 4;
+
+    logic clk;
+    logic reset_n;
+    logic fin1, fin2, fin4, fin8, fin_bp;
+    int   cyc1, cyc2, cyc4, cyc8, cyc_bp;
+    int   errors;
+
+    // Clock 25 MHz (período 40ns), como na Colorlight i9
+    initial clk = 0;
+    always #20 clk = ~clk;
+
+    hough_array_scaling_run #(.NUM_ENGINES(1)) r1 (.clk(clk), .reset_n(reset_n), .finished(fin1), .frame_cycles(cyc1));
+    hough_array_scaling_run #(.NUM_ENGINES(2)) r2 (.clk(clk), .reset_n(reset_n), .finished(fin2), .frame_cycles(cyc2));
+    hough_array_scaling_run #(.NUM_ENGINES(4)) r4 (.clk(clk), .reset_n(reset_n), .finished(fin4), .frame_cycles(cyc4));
+    hough_array_scaling_run #(.NUM_ENGINES(8)) r8 (.clk(clk), .reset_n(reset_n), .finished(fin8), .frame_cycles(cyc8));
+    hough_array_scaling_run #(.NUM_ENGINES(2), .BACKPRESSURE(1)) rbp (.clk(clk), .reset_n(reset_n), .finished(fin_bp), .frame_cycles(cyc_bp));
+
+    // Compara a configuração 'inst' com a de 1 motor, tile a tile
+    `define CHECK_RUN(inst, n) \
+        for (int t = 0; t < NUM_TILES; t++) begin \
+            if (inst.got_count[t] != 1) begin \
+                $display("ERRO: N=%0d tile %0d recebido %0d vezes", n, t, inst.got_count[t]); \
+                errors++; \
+            end else if (inst.got_num[t] != r1.got_num[t]) begin \
+                $display("ERRO: N=%0d tile %0d num_lines=%0d (esperado %0d)", n, t, inst.got_num[t], r1.got_num[t]); \
+                errors++; \
+            end else begin \
+                for (int l = 0; l < MAX_LINES; l++) begin \
+                    if (inst.got_rho[t*MAX_LINES+l] != r1.got_rho[t*MAX_LINES+l] || \
+                        inst.got_theta[t*MAX_LINES+l] != r1.got_theta[t*MAX_LINES+l] || \
+                        inst.got_votes[t*MAX_LINES+l] != r1.got_votes[t*MAX_LINES+l]) begin \
+                        $display("ERRO: N=%0d tile %0d linha %0d difere de N=1", n, t, l); \
+                        errors++; \
+                    end \
+                end \
+            end \
+        end
+
+    initial begin
+        errors = 0;
+        reset_n = 0;
+        #200;
+        reset_n = 1;
+
+        fork
+            wait (fin1 && fin2 && fin4 && fin8 && fin_bp);
+            begin
+                #50_000_000;  // 50 ms simulados: muito acima de 16 tiles com 1 motor
+                $display("ERRO: TIMEOUT aguardando os frames");
+                $finish;
+            end
+        join_any
+        disable fork;
+
+        `CHECK_RUN(r2, 2)
+        `CHECK_RUN(r4, 4)
+        `CHECK_RUN(r8, 8)
+        `CHECK_RUN(rbp, 2)
+        if (rbp.stall_loaded != 4 * 2) begin
+            $display("ERRO: contrapressão com %0d tiles aceitos (esperado 8: 4 por motor)", rbp.stall_loaded);
+            errors++;
+        end
+        for (int t = 0; t < NUM_TILES; t++) begin
+            if (r1.got_count[t] != 1) begin
+                $display("ERRO: N=1 tile %0d recebido %0d vezes", t, r1.got_count[t]);
+                errors++;
+            end
+        end
+
+        $display("");
+        $display("========================================");
+        $display(" ESCALABILIDADE: frame 64x64 (16 tiles)");
+        $display("========================================");
+        $display(" N  | ciclos/frame | speedup");
+        $display(" 1  | %12d | %5.2fx", cyc1, 1.0);
+        $display(" 2  | %12d | %5.2fx", cyc2, real'(cyc1) / cyc2);
+        $display(" 4  | %12d | %5.2fx", cyc4, real'(cyc1) / cyc4);
+        $display(" 8  | %12d | %5.2fx", cyc8, real'(cyc1) / cyc8);
+        $display("");
+
+        if (!(cyc1 > cyc2 && cyc2 > cyc4 && cyc4 > cyc8)) begin
+            $display("ERRO: ciclos por frame não diminuem com N");
+            errors++;
+        end
+
+        if (errors == 0) $display("PASSOU: resultados idênticos para N=1,2,4,8");
+        else             $display("FALHOU: %0d erros", errors);
+        $finish;
+    end
+
+endmodule
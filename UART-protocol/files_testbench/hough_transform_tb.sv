@@ -18,15 +18,16 @@ module hough_transform_tb;
     logic        start;
     logic        done;
     logic        busy;
+    logic        load_ready;
+    logic        result_valid;
     logic        wr_en;
-    logic [7:0]  wr_addr;
+    logic [15:0] wr_addr;
     logic [7:0]  wr_data;
     logic [7:0]  num_lines;
     
-    // Sinais flat
-    logic [7:0]  line_rho_0, line_rho_1, line_rho_2, line_rho_3;
-    logic [7:0]  line_theta_0, line_theta_1, line_theta_2, line_theta_3;
-    logic [7:0]  line_votes_0, line_votes_1, line_votes_2, line_votes_3;
+    // Vetores de saída: linha i em [i*8 +: 8] (ρ em [i*16 +: 16])
+    logic [MAX_LINES*16-1:0] line_rho_vec;
+    logic [MAX_LINES*8-1:0]  line_theta_vec, line_votes_vec;
     
     // Arrays locais para facilitar uso no testbench
     logic [7:0]  line_rho   [0:MAX_LINES-1];
@@ -34,18 +35,14 @@ module hough_transform_tb;
     logic [7:0]  line_votes [0:MAX_LINES-1];
     
     // Mapeamento
-    assign line_rho[0]   = line_rho_0;
-    assign line_rho[1]   = line_rho_1;
-    assign line_rho[2]   = line_rho_2;
-    assign line_rho[3]   = line_rho_3;
-    assign line_theta[0] = line_theta_0;
-    assign line_theta[1] = line_theta_1;
-    assign line_theta[2] = line_theta_2;
-    assign line_theta[3] = line_theta_3;
-    assign line_votes[0] = line_votes_0;
-    assign line_votes[1] = line_votes_1;
-    assign line_votes[2] = line_votes_2;
-    assign line_votes[3] = line_votes_3;
+    genvar gi;
+    generate
+        for (gi = 0; gi < MAX_LINES; gi++) begin : map_lines
+            assign line_rho[gi]   = line_rho_vec[gi*16 +: 8];
+            assign line_theta[gi] = line_theta_vec[gi*8 +: 8];
+            assign line_votes[gi] = line_votes_vec[gi*8 +: 8];
+        end
+    endgenerate
     
     // Instancia DUT
     hough_transform #(
@@ -59,22 +56,18 @@ module hough_transform_tb;
         .start(start),
         .done(done),
         .busy(busy),
+        .load_ready(load_ready),
+        .result_valid(result_valid),
+        .result_ack(1'b1),         // Consome o resultado assim que publicado
         .wr_en(wr_en),
         .wr_addr(wr_addr),
         .wr_data(wr_data),
+        .wr_theta(32'd0),
+        .wr_window(8'hFF),         // Sem orientação: todos os θ
         .num_lines(num_lines),
-        .line_rho_0(line_rho_0),
-        .line_theta_0(line_theta_0),
-        .line_votes_0(line_votes_0),
-        .line_rho_1(line_rho_1),
-        .line_theta_1(line_theta_1),
-        .line_votes_1(line_votes_1),
-        .line_rho_2(line_rho_2),
-        .line_theta_2(line_theta_2),
-        .line_votes_2(line_votes_2),
-        .line_rho_3(line_rho_3),
-        .line_theta_3(line_theta_3),
-        .line_votes_3(line_votes_3)
+        .line_rho(line_rho_vec),
+        .line_theta(line_theta_vec),
+        .line_votes(line_votes_vec)
     );
     
     // Geração de clock (50 MHz = 20ns período)
@@ -89,7 +82,7 @@ module hough_transform_tb;
         for (int i = 0; i < 32; i++) begin
             @(posedge clk);
             wr_en = 1'b1;
-            wr_addr = i[7:0];
+            wr_addr = i[15:0];
             wr_data = test_image[i];
         end
         @(posedge clk);
@@ -164,17 +157,16 @@ module hough_transform_tb;
         end
     endtask
     
-    // Task para imprimir acumulador (células com votos > 0)
+    // Task para imprimir o top-K de cada banco θ do acumulador
+    // (as células ficam em RAMs por banco, fora do alcance de índice variável)
     task print_accumulator();
-        int r, t, addr, votes;
-        $display("\n=== Acumulador (células não-vazias) ===");
-        for (r = 0; r < RHO_BINS; r++) begin
-            for (t = 0; t < THETA_BINS; t++) begin
-                addr = r * THETA_BINS + t;
-                votes = dut.accumulator[addr];
-                if (votes > 0) begin
+        int t, k;
+        $display("\n=== Acumulador (top-K por banco θ) ===");
+        for (t = 0; t < THETA_BINS; t++) begin
+            for (k = 0; k < MAX_LINES; k++) begin
+                if (dut.bk_valid[t][k]) begin
                     $display("  acc[ρ=%2d][θ=%2d (θ=%3d°)] = %0d votos", 
-                             r, t, (t * 180) / THETA_BINS, votes);
+                             dut.bk_rho[t][k], t, (t * 180) / THETA_BINS, dut.bk_votes[t][k]);
                 end
             end
         end
@@ -194,8 +186,6 @@ module hough_transform_tb;
     // Task para executar transformada
     task run_hough();
         int vote_count;
-        int mon_byte_addr, mon_bit_pos;
-        logic mon_pixel;
         
         vote_count = 0;
         
@@ -204,23 +194,20 @@ module hough_transform_tb;
         @(posedge clk);
         start = 1'b0;
         
-        // Monitora estado VOTE (mostra primeiras 16 votações)
+        // Monitora estado VOTE (mostra as primeiras 16 votações)
+        // Cada ciclo com dut.acc_vote=1 vota um pixel em todos os θ
         fork
             begin
                 while (!done && vote_count < 32) begin
                     @(posedge clk);
-                    if (dut.state == 3'b010) begin  // VOTE = 2
-                        // Calcula os mesmos valores que o DUT
-                        mon_byte_addr = (dut.pixel_y * 16 + dut.pixel_x) / 8;
-                        mon_bit_pos = (dut.pixel_y * 16 + dut.pixel_x) % 8;
-                        mon_pixel = dut.image_mem[mon_byte_addr][mon_bit_pos];
-                        
-                        if (mon_pixel && vote_count < 16) begin
-                            $display("  [VOTE] px(%2d,%2d) θ=%2d → rho_scaled=%0d rho_bin=%0d acc[%0d]",
-                                     dut.pixel_x, dut.pixel_y, dut.theta_idx, 
-                                     $signed(dut.rho_scaled), dut.rho_bin, dut.acc_addr);
-                            vote_count = vote_count + 1;
-                        end
+                    if (dut.acc_vote && vote_count < 16) begin
+                        $display("  [VOTE] px(%2d,%2d) → ρ[θ0..θ15] = %0d %0d %0d %0d %0d %0d %0d %0d %0d %0d %0d %0d %0d %0d %0d %0d",
+                                 dut.vote_x, dut.vote_y,
+                                 dut.vote_rho[0], dut.vote_rho[1], dut.vote_rho[2], dut.vote_rho[3],
+                                 dut.vote_rho[4], dut.vote_rho[5], dut.vote_rho[6], dut.vote_rho[7],
+                                 dut.vote_rho[8], dut.vote_rho[9], dut.vote_rho[10], dut.vote_rho[11],
+                                 dut.vote_rho[12], dut.vote_rho[13], dut.vote_rho[14], dut.vote_rho[15]);
+                        vote_count = vote_count + 1;
                     end
                 end
             end
@@ -242,7 +229,7 @@ module hough_transform_tb;
         reset_n = 1'b0;
         start = 1'b0;
         wr_en = 1'b0;
-        wr_addr = 8'h00;
+        wr_addr = 16'h0000;
         wr_data = 8'h00;
         
         // Reset
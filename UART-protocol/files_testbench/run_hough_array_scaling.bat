@@ -0,0 +1,27 @@
+@echo off
+REM Mede ciclos por frame 64x64 da hough_array com 1, 2, 4 e 8 motores
+
+echo ========================================
+echo  ESCALABILIDADE: HOUGH_ARRAY (N motores)
+echo ========================================
+echo.
+
+if exist hough_array_scaling_tb.vvp del hough_array_scaling_tb.vvp
+
+iverilog -g2012 -o hough_array_scaling_tb.vvp ^
+    ..\hough_transform.sv ^
+    ..\hough_array.sv ^
+    hough_array_scaling_tb.sv
+
+if %ERRORLEVEL% NEQ 0 (
+    echo.
+    echo [ERRO] Falha na compilacao!
+    pause
+    exit /b 1
+)
+
+vvp hough_array_scaling_tb.vvp
+
+del hough_array_scaling_tb.vvp
+
+pause
@@ -21,6 +21,7 @@ iverilog -g2009 -o uart_hough_integration_tb.vvp ^
     ..\uart_rx.sv ^
     ..\uart_tx.sv ^
     ..\uart_top.sv ^
+    ..\hough_array.sv ^
     ..\hough_transform.sv ^
     ..\uart_echo_colorlight_i9.sv ^
     uart_hough_integration_tb.sv
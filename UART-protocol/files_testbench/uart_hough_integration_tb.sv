@@ -57,6 +57,8 @@ module uart_hough_integration_tb;
     
     // Variáveis auxiliares para tasks (declaradas globalmente para evitar 'automatic')
     int task_i, task_y, task_x, task_pixel_idx, task_byte_addr, task_bit_pos;
+    logic [7:0] sparse_tag_rx;  // tile_id devolvido no TESTE 12
+    logic [7:0] batch_crc_rx;   // CRC (ou 0xFF do NAK) recebido no TESTE 13
     
     // Task para enviar byte via UART (com debug)
     task uart_send_byte(input logic [7:0] data);
@@ -377,6 +379,68 @@ module uart_hough_integration_tb;
         $display("========================================\n");
     endtask
     
+    // Task para enviar test_image como tile esparso (0xAD): um byte x<<4|y
+    // por pixel aceso, como o main.c faz nos tiles com poucas bordas
+    task send_image_sparse(input logic [7:0] tag);
+        logic [7:0] coords [$];
+        
+        coords.delete();
+        for (task_y = 0; task_y < IMG_SIZE; task_y++) begin
+            for (task_x = 0; task_x < IMG_SIZE; task_x++) begin
+                task_pixel_idx = task_y * IMG_SIZE + task_x;
+                if (test_image[task_pixel_idx / 8][task_pixel_idx % 8])
+                    coords.push_back({task_x[3:0], task_y[3:0]});
+            end
+        end
+        
+        $display("[%0t] ENVIO: 0xAD tag=%0d, %0d coordenadas (%0d bytes em vez de %0d)",
+                 $time, tag, coords.size(), 3 + coords.size(), 1 + IMG_BYTES);
+        uart_send_byte(8'hAD);
+        uart_send_byte(tag);
+        uart_send_byte(coords.size());
+        foreach (coords[k]) uart_send_byte(coords[k]);
+    endtask
+    
+    // CRC-8 do lote 0xAE (polinômio 0x07), igual ao crc8() do uart_echo
+    function automatic logic [7:0] crc8(input logic [7:0] crc, input logic [7:0] data);
+        logic [7:0] c;
+        c = crc ^ data;
+        for (int b = 0; b < 8; b++) c = c[7] ? ((c << 1) ^ 8'h07) : (c << 1);
+        return c;
+    endfunction
+    
+    // Task para enviar test_image como lote 0xAE de um registro esparso.
+    // corrupt=1 estraga o CRC do registro: o FPGA deve responder com NAK.
+    task send_batch_sparse(input logic [7:0] seq, input logic [7:0] idx, input bit corrupt);
+        logic [7:0] coords [$];
+        logic [7:0] crc;
+        
+        coords.delete();
+        for (task_y = 0; task_y < IMG_SIZE; task_y++) begin
+            for (task_x = 0; task_x < IMG_SIZE; task_x++) begin
+                task_pixel_idx = task_y * IMG_SIZE + task_x;
+                if (test_image[task_pixel_idx / 8][task_pixel_idx % 8])
+                    coords.push_back({task_x[3:0], task_y[3:0]});
+            end
+        end
+        
+        $display("[%0t] ENVIO: 0xAE seq=%0d, registro idx=%0d com %0d coordenadas%s",
+                 $time, seq, idx, coords.size(), corrupt ? " (CRC corrompido)" : "");
+        uart_send_byte(8'hAE);
+        uart_send_byte(seq);
+        uart_send_byte(8'd1);
+        uart_send_byte(crc8(crc8(8'h00, seq), 8'd1));
+        
+        crc = crc8(crc8(8'h00, idx), coords.size());
+        uart_send_byte(idx);
+        uart_send_byte(coords.size());
+        foreach (coords[k]) begin
+            crc = crc8(crc, coords[k]);
+            uart_send_byte(coords[k]);
+        end
+        uart_send_byte(corrupt ? ~crc : crc);
+    endtask
+    
     // Task para receber resultado (com verificação e timeout)
     task receive_result();
         logic [7:0] num_lines;
@@ -431,6 +495,24 @@ module uart_hough_integration_tb;
         $display("========================================\n");
     endtask
     
+    // Task para consultar estado (0xA5): FPGA ocioso responde READY (0x52)
+    task query_status();
+        logic [7:0] status;
+        
+        $display("[%0t] STATUS: Enviando consulta 0xA5...", $time);
+        // A resposta chega durante o intervalo entre bytes do envio
+        fork
+            uart_send_byte(8'hA5);
+            uart_receive_byte(status, BYTE_TIME * 4);
+        join
+        
+        if (status == 8'h52) begin
+            $display("[%0t] STATUS: ✓ FPGA pronto (READY=0x52)", $time);
+        end else begin
+            $display("[%0t] STATUS: ERRO - resposta 0x%02h (esperado 0x52)", $time, status);
+        end
+    endtask
+    
     // Monitor contínuo do uart_tx COM DECODIFICAÇÃO
     logic [7:0] monitored_byte;
     logic monitoring_rx = 0;
@@ -532,6 +614,13 @@ module uart_hough_integration_tb;
         // $display("[%0t] Bytes de teste enviados. Aguardando sistema estabilizar...", $time);
         // repeat(BYTE_TIME * 10) @(posedge clk);
         
+        // ========== TESTE 0: Handshake READY ==========
+        $display("\n╔════════════════════════════════════════════════════╗");
+        $display("║  TESTE 0: Consulta de Estado (READY/BUSY)         ║");
+        $display("╚════════════════════════════════════════════════════╝");
+        query_status();
+        repeat(100) @(posedge clk);
+        
         // ========== TESTE 1: Pixel Único (DEBUG) ==========
         $display("\n╔════════════════════════════════════════════════════╗");
         $display("║  TESTE 1: PIXEL ÚNICO (DEBUG)                     ║");
@@ -769,6 +858,65 @@ module uart_hough_integration_tb;
         $display("[%0t] Teste 11 concluído. Bytes enviados: %0d, recebidos: %0d", $time, bytes_sent, bytes_received);
         repeat(100) @(posedge clk);
         
+        // ========== TESTE 12: Diagonal como tile esparso (0xAD) ==========
+        $display("\n╔════════════════════════════════════════════════════╗");
+        $display("║  TESTE 12: Diagonal esparsa (0xAD, 16 coords)     ║");
+        $display("║  Esperado: mesmo resultado do TESTE 4             ║");
+        $display("╚════════════════════════════════════════════════════╝");
+        
+        bytes_sent = 0;
+        bytes_received = 0;
+        tx_monitor_active = 1;
+        
+        create_diagonal_line();
+        print_image();
+        send_image_sparse(8'd12);
+        
+        $display("[%0t] Aguardando processamento Hough...", $time);
+        uart_receive_byte(sparse_tag_rx, HOUGH_TIME + BYTE_TIME * 10);
+        if (sparse_tag_rx == 8'd12) $display("[%0t] RECEPÇÃO: ✓ tile_id=%0d", $time, sparse_tag_rx);
+        else                        $display("[%0t] RECEPÇÃO: ERRO - tile_id=%0d (esperado 12)", $time, sparse_tag_rx);
+        receive_result();
+        
+        tx_monitor_active = 0;
+        $display("[%0t] Teste 12 concluído. Bytes enviados: %0d, recebidos: %0d", $time, bytes_sent, bytes_received);
+        repeat(100) @(posedge clk);
+        
+        // ========== TESTE 13: Lote 0xAE com CRC (aceito e recusado) ==========
+        $display("\n╔════════════════════════════════════════════════════╗");
+        $display("║  TESTE 13: Lote 0xAE com CRC                      ║");
+        $display("║  Esperado: tag 0x32 + resultado do TESTE 4 + CRC, ║");
+        $display("║  depois NAK 0x45 0xFF + CRC (registro corrompido) ║");
+        $display("╚════════════════════════════════════════════════════╝");
+        
+        bytes_sent = 0;
+        bytes_received = 0;
+        tx_monitor_active = 1;
+        
+        create_diagonal_line();
+        send_batch_sparse(8'd3, 8'd2, 1'b0);
+        uart_receive_byte(sparse_tag_rx, HOUGH_TIME + BYTE_TIME * 10);
+        if (sparse_tag_rx == 8'h32) $display("[%0t] RECEPÇÃO: ✓ tag=0x%02h", $time, sparse_tag_rx);
+        else                        $display("[%0t] RECEPÇÃO: ERRO - tag=0x%02h (esperado 0x32)", $time, sparse_tag_rx);
+        receive_result();
+        uart_receive_byte(batch_crc_rx, BYTE_TIME * 10);
+        $display("[%0t] RECEPÇÃO: CRC da resposta=0x%02h", $time, batch_crc_rx);
+        
+        send_batch_sparse(8'd4, 8'd5, 1'b1);
+        uart_receive_byte(sparse_tag_rx, BYTE_TIME * 10);
+        uart_receive_byte(batch_crc_rx, BYTE_TIME * 10);
+        if (sparse_tag_rx == 8'h45 && batch_crc_rx == 8'hFF)
+            $display("[%0t] RECEPÇÃO: ✓ NAK do registro 5", $time);
+        else
+            $display("[%0t] RECEPÇÃO: ERRO - 0x%02h 0x%02h (esperado NAK 0x45 0xFF)", $time, sparse_tag_rx, batch_crc_rx);
+        uart_receive_byte(batch_crc_rx, BYTE_TIME * 10);
+        if (batch_crc_rx == crc8(crc8(8'h00, 8'h45), 8'hFF)) $display("[%0t] RECEPÇÃO: ✓ CRC do NAK", $time);
+        else $display("[%0t] RECEPÇÃO: ERRO - CRC do NAK 0x%02h", $time, batch_crc_rx);
+        
+        tx_monitor_active = 0;
+        $display("[%0t] Teste 13 concluído. Bytes enviados: %0d, recebidos: %0d", $time, bytes_sent, bytes_received);
+        repeat(100) @(posedge clk);
+        
         $display("\n╔════════════════════════════════════════════════════╗");
         $display("║  RESUMO DOS TESTES                                 ║");
         $display("╚════════════════════════════════════════════════════╝");
@@ -805,9 +953,9 @@ module uart_hough_integration_tb;
         $finish;
     end
     
-    // Timeout global (aumentado para 11 testes)
+    // Timeout global (aumentado para 13 testes)
     initial begin
-        #15000000;  // 15ms (suficiente para 11 testes completos)
+        #20000000;  // 20ms (suficiente para 13 testes completos)
         $display("\n╔════════════════════════════════════════════════════╗");
         $display("║  ERRO: TIMEOUT GLOBAL!                            ║");
         $display("╚════════════════════════════════════════════════════╝");
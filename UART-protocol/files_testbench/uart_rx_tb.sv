@@ -9,11 +9,10 @@ module uart_rx_tb;
     logic       o_rx_dv;
     logic       [7:0] o_rx_byte;
 
-    uart_rx #(
-        .CLKS_PER_BIT(10)  // Igual ao testbench principal
-    ) dut (
+    uart_rx dut (
         .i_clk(i_clk),
         .i_rst_n(i_reset_n),
+        .i_clks_per_bit(16'd10),  // Igual ao testbench principal
         .i_rx_serial(i_rx_serial),
         .o_rx_dv(o_rx_dv),
         .o_rx_byte(o_rx_byte)
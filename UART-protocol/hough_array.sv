@@ -0,0 +1,243 @@
+// hough_array.sv
+// Matriz de NUM_ENGINES instâncias de hough_transform com despachante de tiles
+//
+// Cada motor tem sua própria memória de imagem (ping-pong) e acumulador.
+// O despachante escolhe, em round-robin, o próximo motor com banco livre
+// para receber o tile; os resultados saem em ORDEM DE CONCLUSÃO, cada um
+// acompanhado do índice (tag) informado na carga do tile.
+//
+// Interface de carga (um tile por vez):
+//   1. in_ready=1 → pulso em in_begin com in_tag/in_tagged/in_crc
+//   2. in_wr_en/in_wr_addr/in_wr_data escrevem no motor escolhido
+//      (in_wr_theta/in_wr_window: orientação dos 8 pixels e janela de θ
+//      do tile, ver votação orientada em hough_transform)
+//   3. pulso em in_commit (pode coincidir com o último in_wr_en) inicia o motor
+//   Um tile abandonado sem in_commit não consome o banco.
+//
+// Interface de resultado:
+//   res_valid=1 enquanto houver resultado na fila de conclusão; res_sel
+//   escolhe a linha exibida em res_rho/res_theta/res_votes; pulso em
+//   res_ack consome o resultado e libera o motor. res_perf_* são os
+//   contadores de desempenho do motor da cabeça (ver hough_transform) e
+//   res_rx_clks a duração de recepção informada em in_rx_clks no commit.
+
+module hough_array #(
+    parameter NUM_ENGINES = 4,      // Motores Hough em paralelo
+    parameter IMG_SIZE = 16,        // Tile 16x16
+    parameter RHO_BINS = 16,
+    parameter THETA_BINS = 16,
+    parameter MAX_LINES = 4,
+    parameter ORIENTED = 1          // Motores com memória de orientação (comando 0xAF)
+)(
+    input  logic        clk,
+    input  logic        reset_n,
+
+    // Carga de tiles
+    output logic        in_ready,   // '1' se algum motor tem banco livre
+    input  logic        in_begin,   // Pulso: escolhe motor para o próximo tile
+    input  logic [7:0]  in_tag,     // Índice do tile (devolvido no resultado)
+    input  logic        in_tagged,  // '1' se a resposta deve levar o tag
+    input  logic        in_crc,     // '1' se a resposta deve terminar com CRC (lote 0xAE)
+    input  logic        in_wr_en,
+    input  logic [7:0]  in_wr_addr,
+    input  logic [7:0]  in_wr_data,
+    input  logic [31:0] in_wr_theta,
+    input  logic [7:0]  in_wr_window,
+    input  logic        in_commit,  // Pulso: tile completo, inicia o motor
+    input  logic [31:0] in_rx_clks, // Ciclos de recepção do tile (amostrado no commit)
+
+    // Resultados em ordem de conclusão
+    output logic        res_valid,
+    output logic [7:0]  res_tag,
+    output logic        res_tagged,
+    output logic        res_crc,
+    output logic [7:0]  res_num_lines,
+    input  logic [7:0]  res_sel,    // Linha exibida (0..MAX_LINES-1)
+    output logic [7:0]  res_rho,
+    output logic [7:0]  res_theta,
+    output logic [7:0]  res_votes,
+    input  logic        res_ack,
+    output logic [31:0] res_rx_clks,
+    output logic [15:0] res_perf_edges,
+    output logic [15:0] res_perf_vote_clks,
+    output logic [15:0] res_perf_merge_clks,
+
+    output logic        busy        // '1' com qualquer tile/resultado pendente
+);
+
+    localparam EW = (NUM_ENGINES > 1) ? $clog2(NUM_ENGINES) : 1;
+    localparam CQ_DEPTH = 1 << EW;  // Cada motor tem no máximo 1 resultado na fila
+
+    // ========== SINAIS DOS MOTORES ==========
+    logic [NUM_ENGINES-1:0] eng_start, eng_done, eng_busy;
+    logic [NUM_ENGINES-1:0] eng_load_ready, eng_result_valid, eng_result_ack;
+    logic [NUM_ENGINES-1:0] eng_wr_en;
+
+    // Saídas flat de todos os motores: motor e, linha l → [(e*MAX_LINES+l)*8 +: 8]
+    // (ρ: [(e*MAX_LINES+l)*16 +: 16]; nos tiles é o bin, cabe nos 8 bits baixos)
+    logic [NUM_ENGINES*8-1:0]            eng_num_lines;
+    logic [NUM_ENGINES*MAX_LINES*16-1:0] eng_rho;
+    logic [NUM_ENGINES*MAX_LINES*8-1:0]  eng_theta, eng_votes;
+    logic [NUM_ENGINES*16-1:0]           eng_edges, eng_vote_clks, eng_merge_clks;
+
+    // ========== DESPACHANTE ==========
+    logic [EW-1:0] rr_next;     // Próximo motor na ordem round-robin
+    logic [EW-1:0] cur_eng;     // Motor recebendo o tile atual
+    logic [EW-1:0] pick;
+    logic          pick_ok;
+    logic [7:0]    cur_tag;
+    logic          cur_tagged;
+    logic          cur_crc;
+
+    // Primeiro motor com banco livre a partir de rr_next
+    always_comb begin
+        pick = rr_next;
+        pick_ok = 1'b0;
+        for (int i = 0; i < NUM_ENGINES; i++) begin
+            if (!pick_ok && eng_load_ready[(rr_next + i) % NUM_ENGINES]) begin
+                pick = (rr_next + i) % NUM_ENGINES;
+                pick_ok = 1'b1;
+            end
+        end
+    end
+
+    assign in_ready = pick_ok;
+
+    always_comb begin
+        for (int e = 0; e < NUM_ENGINES; e++) begin
+            eng_wr_en[e] = in_wr_en && (cur_eng == e);
+            eng_start[e] = in_commit && (cur_eng == e);
+        end
+    end
+
+    // Tags dos jobs de cada motor, em ordem. O banco é liberado no fim da
+    // votação, então um motor pode ter até TAG_DEPTH jobs sem ack: um
+    // resultado esperando o TX, um job em MERGE/DONE_STATE e os dois bancos
+    // confirmados.
+    localparam TAG_DEPTH = 4;
+    logic [9:0]  tag_q  [0:TAG_DEPTH*NUM_ENGINES-1];  // {crc, tagged, tag}
+    logic [31:0] rx_q   [0:TAG_DEPTH*NUM_ENGINES-1];  // in_rx_clks de cada job
+    logic [1:0]  tag_wp [0:NUM_ENGINES-1];
+    logic [1:0]  tag_rp [0:NUM_ENGINES-1];
+
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            rr_next <= '0;
+            cur_eng <= '0;
+            cur_tag <= 8'd0;
+            cur_tagged <= 1'b0;
+            cur_crc <= 1'b0;
+            for (int e = 0; e < NUM_ENGINES; e++) tag_wp[e] <= 2'd0;
+        end else begin
+            if (in_begin && pick_ok) begin
+                cur_eng <= pick;
+                cur_tag <= in_tag;
+                cur_tagged <= in_tagged;
+                cur_crc <= in_crc;
+                rr_next <= (pick == NUM_ENGINES - 1) ? '0 : pick + 1'b1;
+            end
+
+            if (in_commit) begin
+                tag_q[cur_eng * TAG_DEPTH + tag_wp[cur_eng]] <= {cur_crc, cur_tagged, cur_tag};
+                rx_q[cur_eng * TAG_DEPTH + tag_wp[cur_eng]] <= in_rx_clks;
+                tag_wp[cur_eng] <= tag_wp[cur_eng] + 2'd1;
+            end
+        end
+    end
+
+    // ========== FILA DE CONCLUSÃO ==========
+    // Índices de motor na ordem em que publicaram o resultado. Conclusões
+    // no mesmo ciclo entram em ordem crescente de índice.
+    logic [EW-1:0] cq [0:CQ_DEPTH-1];
+    logic [EW-1:0] cq_rd, cq_wr;
+    logic [EW:0]   cq_count;
+    logic [EW-1:0] head_eng;
+    logic [EW-1:0] cq_wp_n;     // Temporários do ciclo (atribuição bloqueante)
+    logic [EW:0]   cq_n;
+
+    assign head_eng  = cq[cq_rd];
+    assign res_valid = (cq_count != 0);
+
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            cq_rd <= '0;
+            cq_wr <= '0;
+            cq_count <= '0;
+            for (int e = 0; e < NUM_ENGINES; e++) tag_rp[e] <= 2'd0;
+        end else begin
+            cq_wp_n = cq_wr;
+            cq_n = cq_count;
+
+            for (int e = 0; e < NUM_ENGINES; e++) begin
+                if (eng_done[e]) begin
+                    cq[cq_wp_n] <= e;
+                    cq_wp_n = (cq_wp_n == CQ_DEPTH - 1) ? '0 : cq_wp_n + 1'b1;
+                    cq_n = cq_n + 1'b1;
+                end
+            end
+
+            if (res_ack && res_valid) begin
+                tag_rp[head_eng] <= tag_rp[head_eng] + 2'd1;
+                cq_rd <= (cq_rd == CQ_DEPTH - 1) ? '0 : cq_rd + 1'b1;
+                cq_n = cq_n - 1'b1;
+            end
+
+            cq_wr <= cq_wp_n;
+            cq_count <= cq_n;
+        end
+    end
+
+    always_comb begin
+        eng_result_ack = '0;
+        if (res_ack && res_valid) eng_result_ack[head_eng] = 1'b1;
+    end
+
+    // Resultado na cabeça da fila
+    assign {res_crc, res_tagged, res_tag} = tag_q[head_eng * TAG_DEPTH + tag_rp[head_eng]];
+    assign res_num_lines = eng_num_lines[head_eng*8 +: 8];
+    assign res_rho   = eng_rho  [(head_eng*MAX_LINES + res_sel)*16 +: 8];
+    assign res_theta = eng_theta[(head_eng*MAX_LINES + res_sel)*8 +: 8];
+    assign res_votes = eng_votes[(head_eng*MAX_LINES + res_sel)*8 +: 8];
+    assign res_rx_clks = rx_q[head_eng * TAG_DEPTH + tag_rp[head_eng]];
+    assign res_perf_edges      = eng_edges     [head_eng*16 +: 16];
+    assign res_perf_vote_clks  = eng_vote_clks [head_eng*16 +: 16];
+    assign res_perf_merge_clks = eng_merge_clks[head_eng*16 +: 16];
+
+    assign busy = (|eng_busy) || (|eng_result_valid) || res_valid;
+
+    // ========== MOTORES ==========
+    genvar g;
+    generate
+        for (g = 0; g < NUM_ENGINES; g++) begin : engine
+            hough_transform #(
+                .IMG_SIZE(IMG_SIZE),
+                .RHO_BINS(RHO_BINS),
+                .THETA_BINS(THETA_BINS),
+                .MAX_LINES(MAX_LINES),
+                .ORIENTED(ORIENTED)
+            ) hough_inst (
+                .clk(clk),
+                .reset_n(reset_n),
+                .start(eng_start[g]),
+                .done(eng_done[g]),
+                .busy(eng_busy[g]),
+                .load_ready(eng_load_ready[g]),
+                .result_valid(eng_result_valid[g]),
+                .result_ack(eng_result_ack[g]),
+                .wr_en(eng_wr_en[g]),
+                .wr_addr({8'd0, in_wr_addr}),
+                .wr_data(in_wr_data),
+                .wr_theta(in_wr_theta),
+                .wr_window(in_wr_window),
+                .num_lines(eng_num_lines[g*8 +: 8]),
+                .line_rho(eng_rho[g*MAX_LINES*16 +: MAX_LINES*16]),
+                .line_theta(eng_theta[g*MAX_LINES*8 +: MAX_LINES*8]),
+                .line_votes(eng_votes[g*MAX_LINES*8 +: MAX_LINES*8]),
+                .perf_edges(eng_edges[g*16 +: 16]),
+                .perf_vote_clks(eng_vote_clks[g*16 +: 16]),
+                .perf_merge_clks(eng_merge_clks[g*16 +: 16])
+            );
+        end
+    endgenerate
+
+endmodule
@@ -1,78 +1,142 @@
 // hough_transform.sv
-// Transformada de Hough para detecção de linhas em imagem 16x16
+// Transformada de Hough para detecção de linhas em imagem IMG_SIZE x IMG_SIZE
+// (tile 16x16 ou imagem inteira 64x64/128x128)
 // Recebe matriz de bordas (1=borda, 0=fundo) e detecta linhas dominantes
 //
 // Algoritmo:
-// 1. Para cada pixel de borda (x,y):
-//    2. Para cada ângulo θ (0° a 180°, steps de 2°):
+// 1. Para cada pixel de borda (x,y) — bytes zerados são pulados em 1 ciclo:
+//    2. Para TODOS os ângulos θ em paralelo (um banco do acumulador por θ):
 //       3. Calcula ρ = x×cos(θ) + y×sin(θ)
-//       4. Incrementa accumulator[ρ][θ]
-// 5. Encontra picos no acumulador (linhas detectadas)
-// 6. Retorna top-N linhas como [ρ, θ, votes]
+//       4. Incrementa a célula ρ do banco θ e atualiza o top-K do banco
+// 5. Junta os top-K dos bancos no top-K global (1 banco por ciclo)
+// 6. Retorna top-N linhas como [ρ, θ, votes] com votes >= 5
+//
+// Sem passes de limpeza e de busca de picos no caminho crítico:
+//   - o acumulador é zerado em 1 ciclo invalidando as células (acc_valid,
+//     em flip-flops); célula inválida é lida como 0
+//   - cada banco θ mantém seu top-K incrementalmente durante o VOTE. Como
+//     as contagens só crescem (de 1 em 1, saturando), a lista de cada
+//     banco é exatamente o top-K daquele θ, e o top-K global está contido
+//     na união das listas
+// Latência ≈ VOTE (1 ciclo por pixel de borda ou byte sem borda)
+//          + 1 ciclo de esvaziamento do pipeline + THETA_BINS ciclos de junção.
+//
+// ρ com sinal (SIGNED_RHO=1, modo imagem inteira): ρ = x·cosθ + y·sinθ vai
+// de -RHO_MAX a +RHO_MAX com RHO_MAX = ⌈IMG_SIZE·√2⌉, e o acumulador tem
+// 2·RHO_MAX+1 bins de 1 pixel (nenhum ρ é saturado). line_rho sai em
+// pixels, com sinal. Com SIGNED_RHO=0 (tiles) vale o comportamento antigo:
+// ρ saturado em [0, RHO_BINS-1] e line_rho = bin.
+//
+// Os bancos do acumulador são RAMs de porta simples com leitura síncrona
+// (inferem BRAM): cada voto é um read-modify-write em 2 estágios, com
+// encaminhamento da escrita do ciclo anterior para votos seguidos na
+// mesma célula.
+//
+// Memória de imagem ping-pong (2 bancos): enquanto um banco é processado,
+// o outro pode ser carregado com o próximo tile. 'start' confirma o banco
+// em carga como job; o resultado fica estável nas saídas (result_valid)
+// até o consumidor pulsar result_ack, e o próximo job já pode votar nesse
+// intervalo.
+//
+// Contadores de desempenho (perf_*): medidos durante o job e publicados
+// junto com o resultado, estáveis enquanto result_valid. Saturam em 0xFFFF.
+//
+// Votação orientada (ORIENTED=1, tiles): cada pixel pode trazer o bin θ
+// da direção do gradiente (wr_theta, 4 bits por pixel, do Sobel no Pico).
+// Com janela wr_window = k < THETA_BINS/2 o pixel vota só nos bancos θ a
+// até k bins (circulares) da sua orientação, em vez de nos THETA_BINS:
+// 2k+1 votos por borda, menos ruído no acumulador e picos mais limpos.
+// wr_window >= THETA_BINS/2 (0xFF nos comandos sem orientação) vota em
+// todos os θ, exatamente como antes. A janela é do banco (amostrada a cada
+// wr_en), a orientação é do pixel.
 
 module hough_transform #(
     parameter IMG_SIZE = 16,        // Imagem 16x16
     parameter RHO_BINS = 16,        // Bins para ρ (muito reduzido!)
     parameter THETA_BINS = 16,      // Bins para θ (0° a 180°, step ~11°)
-    parameter MAX_LINES = 4         // Número máximo de linhas a detectar
+    parameter MAX_LINES = 4,        // Número máximo de linhas a detectar
+    parameter SIGNED_RHO = 0,       // 1: ρ com sinal, bins de 1 pixel (imagem inteira)
+    parameter ORIENTED = 0          // 1: memória de orientação por pixel (wr_theta/wr_window)
 )(
     input  logic        clk,
     input  logic        reset_n,
     
     // Interface de controle
-    input  logic        start,      // Pulso para iniciar processamento
-    output logic        done,       // Pulso quando termina
-    output logic        busy,       // '1' durante processamento
+    input  logic        start,      // Pulso: confirma o banco em carga como job
+    output logic        done,       // Pulso quando publica um resultado
+    output logic        busy,       // '1' com job em processamento ou pendente
+    output logic        load_ready, // '1' se o banco em carga está livre para escrita
+    output logic        result_valid, // '1' enquanto o resultado não foi consumido
+    input  logic        result_ack, // Pulso: consumidor terminou de ler o resultado
     
     // Matriz de entrada (1 bit por pixel: 1=borda, 0=fundo)
     // Recebida byte a byte: cada byte contém 8 pixels
-    input  logic        wr_en,      // Pulso para escrever byte
-    input  logic [7:0]  wr_addr,    // Endereço do byte (0..31)
+    input  logic        wr_en,      // Pulso para escrever byte (banco em carga)
+    input  logic [15:0] wr_addr,    // Endereço do byte (0..IMG_BYTES-1)
     input  logic [7:0]  wr_data,    // 8 pixels empacotados
+    input  logic [31:0] wr_theta,   // Bin θ dos 8 pixels de wr_data (pixel j em [j*4 +: 4]; só ORIENTED)
+    input  logic [7:0]  wr_window,  // ±bins de θ votados por pixel (>= THETA_BINS/2: todos)
     
-    // Resultado: linhas detectadas (packed arrays para compatibilidade)
-    output logic [7:0]  num_lines,          // Quantidade de linhas detectadas (0..MAX_LINES)
-    output logic [7:0]  line_rho_0,         // ρ da linha 0
-    output logic [7:0]  line_theta_0,       // θ da linha 0
-    output logic [7:0]  line_votes_0,       // votos da linha 0
-    output logic [7:0]  line_rho_1,         // ρ da linha 1
-    output logic [7:0]  line_theta_1,       // θ da linha 1
-    output logic [7:0]  line_votes_1,       // votos da linha 1
-    output logic [7:0]  line_rho_2,         // ρ da linha 2
-    output logic [7:0]  line_theta_2,       // θ da linha 2
-    output logic [7:0]  line_votes_2,       // votos da linha 2
-    output logic [7:0]  line_rho_3,         // ρ da linha 3
-    output logic [7:0]  line_theta_3,       // θ da linha 3
-    output logic [7:0]  line_votes_3        // votos da linha 3
+    // Resultado: linhas detectadas, linha i em [i*8 +: 8] de cada vetor
+    // (line_rho: [i*16 +: 16], complemento de 2)
+    output logic [7:0]              num_lines,   // Quantidade de linhas detectadas (0..MAX_LINES)
+    output logic [MAX_LINES*16-1:0] line_rho,    // ρ de cada linha
+    output logic [MAX_LINES*8-1:0]  line_theta,  // θ (graus) de cada linha
+    output logic [MAX_LINES*8-1:0]  line_votes,  // votos de cada linha
+    
+    // Desempenho do job publicado
+    output logic [15:0] perf_edges,      // Pixels de borda votados
+    output logic [15:0] perf_vote_clks,  // Ciclos em VOTE + VOTE_DRAIN
+    output logic [15:0] perf_merge_clks  // Ciclos em MERGE_PEAKS (busca de picos)
 );
 
-    // Arrays internos para manipulação
-    logic [7:0] line_rho   [0:MAX_LINES-1];
-    logic [7:0] line_theta [0:MAX_LINES-1];
-    logic [7:0] line_votes [0:MAX_LINES-1];
-    
-    // Mapeamento dos arrays internos para portas flat
-    assign line_rho_0   = line_rho[0];
-    assign line_theta_0 = line_theta[0];
-    assign line_votes_0 = line_votes[0];
-    assign line_rho_1   = line_rho[1];
-    assign line_theta_1 = line_theta[1];
-    assign line_votes_1 = line_votes[1];
-    assign line_rho_2   = line_rho[2];
-    assign line_theta_2 = line_theta[2];
-    assign line_votes_2 = line_votes[2];
-    assign line_rho_3   = line_rho[3];
-    assign line_theta_3 = line_theta[3];
-    assign line_votes_3 = line_votes[3];
+    localparam KW = (MAX_LINES > 1) ? $clog2(MAX_LINES) : 1;  // Índice de slot
+    localparam VOTE_THRESHOLD = 5;  // Mínimo de votos para uma linha
+    
+    // Faixa de ρ: |x·cosθ + y·sinθ| ≤ (IMG_SIZE-1)·(181+181)/256 < RHO_MAX
+    localparam RHO_MAX = (IMG_SIZE * 362 + 255) / 256;
+    localparam RHO_OFS = SIGNED_RHO ? RHO_MAX : 0;              // bin = ρ + RHO_OFS
+    localparam ACC_RHO = SIGNED_RHO ? 2 * RHO_MAX + 1 : RHO_BINS; // Bins por banco θ
+    localparam RW      = $clog2(ACC_RHO);                       // Largura do bin
+    localparam VOTE_W  = SIGNED_RHO ? 8 : 6;                    // Contador por célula
+    localparam [VOTE_W-1:0] VOTE_MAX = {VOTE_W{1'b1}};
+    
+    // Resultado em construção do job atual: só vai para line_* em DONE_STATE,
+    // para não sobrescrever um resultado que ainda está sendo transmitido
+    logic [15:0] work_rho  [0:MAX_LINES-1];
+    logic [7:0] work_theta [0:MAX_LINES-1];
+    logic [7:0] work_votes [0:MAX_LINES-1];
+    logic [15:0] work_edges, work_vote_clks, work_merge_clks;
 
-    // ========== MEMÓRIA DA IMAGEM ==========
-    // 16x16 = 256 bits = 32 bytes
-    logic [7:0] image_mem [0:31];  // 32 bytes, cada byte = 8 pixels
+    // ========== MEMÓRIA DA IMAGEM (PING-PONG) ==========
+    // 16x16 = 32 bytes, 64x64 = 512 bytes, 128x128 = 2048 bytes por banco
+    localparam IMG_BYTES = (IMG_SIZE * IMG_SIZE) / 8;
+    logic [7:0] image_mem [0:2*IMG_BYTES-1];  // Banco b ocupa [b*IMG_BYTES ..]
+    
+    logic       fill_bank;        // Banco que recebe wr_en/wr_addr/wr_data
+    logic       comp_bank;        // Próximo banco a ser processado
+    logic [1:0] bank_full;        // Banco confirmado por 'start' e ainda não votado
+    
+    assign load_ready = !bank_full[fill_bank];
+    
+    // Orientação dos pixels: uma palavra de 8 nibbles por byte da imagem
+    // (só existe com ORIENTED; 4 bits por pixel cobrem os 16 θ)
+    localparam THETA_WORDS = ORIENTED ? 2 * IMG_BYTES : 1;
+    logic [31:0] theta_mem [0:THETA_WORDS-1];
+    logic [7:0]  bank_window [0:1];  // Janela de cada banco (wr_window)
     
-    // ========== ACUMULADOR HOUGH ==========
-    // RHO_BINS x THETA_BINS = 16x16 = 256 células
-    // Linearizado para inferência de BRAM
-    (* ram_style = "block" *) logic [5:0] accumulator [0:255];  // 256 células linearizadas
+    // ========== ACUMULADOR HOUGH (BANCOS POR θ) ==========
+    // THETA_BINS bancos de ACC_RHO células (16 x 16 nos tiles, 16 x 183 em
+    // 64x64). Cada banco é uma RAM própria (bloco theta_bank), então um pixel
+    // vota em todos os θ no mesmo ciclo. Os bits de validade ficam em
+    // flip-flops para o zeramento em 1 ciclo.
+    logic [ACC_RHO-1:0]  acc_valid [0:THETA_BINS-1];  // '0' = célula vale 0
+    logic [VOTE_W-1:0]   acc_q     [0:THETA_BINS-1];  // Leitura síncrona dos bancos
+    
+    // Top-K incremental de cada banco θ
+    logic [RW-1:0]        bk_rho   [0:THETA_BINS-1][0:MAX_LINES-1];
+    logic [VOTE_W-1:0]    bk_votes [0:THETA_BINS-1][0:MAX_LINES-1];
+    logic [MAX_LINES-1:0] bk_valid [0:THETA_BINS-1];
     
     // ========== LUT SENO/COSSENO (ROM) ==========
     // Valores pré-calculados em fixed-point (16 bits, escala 256)
@@ -128,67 +192,268 @@ module hough_transform #(
     // ========== FSM ==========
     typedef enum logic [2:0] {
         IDLE,
-        CLEAR_ACC,      // Zera acumulador
-        VOTE,           // Processa pixels e vota no acumulador
-        FIND_PEAKS,     // Encontra picos (linhas)
+        VOTE,           // Processa pixels, vota e atualiza top-K por banco
+        VOTE_DRAIN,     // Último voto sai do estágio B do pipeline
+        MERGE_PEAKS,    // Junta os top-K dos bancos (1 banco por ciclo)
         DONE_STATE
     } state_t;
     
-    state_t state;
+    // Público para o harness do Verilator (ciclos por estado)
+    state_t state /*verilator public*/;
+    
+    // Ocupado com job em andamento ou banco confirmado aguardando processamento
+    assign busy = (state != IDLE) || (bank_full != 2'b00);
+    
+    // Início de job: invalida acumulador e listas no mesmo ciclo
+    logic job_start;
+    assign job_start = (state == IDLE) && bank_full[comp_bank];
     
     // ========== CONTADORES E REGISTRADORES ==========
-    logic [7:0]  pixel_x, pixel_y;      // Coordenadas do pixel atual (0..15)
-    logic [6:0]  theta_idx;             // Índice do ângulo (0..89)
-    logic [15:0] clear_count;           // Contador para limpar acumulador (precisa ir até 5760)
-    logic [3:0]  peak_count;            // Contador de picos encontrados
-    
-    // Registradores temporários para cálculo de ρ
-    logic signed [15:0] rho_scaled;
-    logic [5:0] rho_bin;
-    logic signed [31:0] temp_prod_x, temp_prod_y, temp_sum;  // Temporários para aritmética signed
-    logic signed [15:0] rho_calc;  // Resultado do cálculo combinacional
-    logic [5:0] rho_bin_calc;      // Bin calculado combinacionalmente
-    
-    // Variáveis temporárias para cálculos
-    integer byte_addr, bit_pos;
-    integer clear_r, clear_t;
-    integer acc_addr;  // Endereço linearizado do acumulador
-    logic pixel_bit;   // Bit individual do pixel (para workaround de IVerilog)
-    logic debug_printed;  // Flag para imprimir acumulador apenas 1 vez
-    
-    // ========== CÁLCULO DE RHO (COMBINACIONAL) ==========
+    logic [7:0]  merge_t;               // Banco θ sendo juntado em MERGE_PEAKS
+    logic [7:0]  peak_count;            // Linhas válidas em work_*
+    
+    // Varredura de VOTE: um byte da imagem por vez, um bit de borda por ciclo
+    logic [7:0]  vote_byte;             // Bits do byte atual ainda não votados
+    logic [15:0] vote_addr;             // Índice do byte em vote_byte
+    logic [15:0] next_addr;             // Próximo byte a carregar (IMG_BYTES = fim)
+    
+    // Pixel votado neste ciclo: bit 1 de menor índice de vote_byte
+    logic [2:0]  vote_bit;
+    logic [18:0] vote_idx;
+    logic [15:0] vote_x, vote_y;
+    logic [7:0]  vote_rest;             // vote_byte sem o bit votado
+    logic        acc_vote;              // '1' quando há pixel a votar neste ciclo
+    logic [31:0] vote_theta;            // Orientação dos 8 pixels de vote_byte
+    logic [7:0]  vote_window;           // Janela do job (bank_window do banco votado)
+    logic [3:0]  vote_dir;              // Bin θ do pixel votado neste ciclo
+    logic [3:0]  dir_dist;              // Distância circular θ ↔ vote_dir
+    logic [THETA_BINS-1:0] vote_mask;   // Bancos θ que recebem o voto deste pixel
+    logic [RW-1:0] vote_rho [0:THETA_BINS-1];  // ρ (bin) do pixel em cada θ
+    logic signed [31:0] rho_sum;        // Temporários para aritmética signed
+    logic signed [31:0] rho_bin;
+    
+    // Estágio B do read-modify-write: voto do ciclo anterior, já com a
+    // contagem antiga lida dos bancos (acc_q)
+    logic          p_vote;
+    logic [THETA_BINS-1:0] p_mask;      // vote_mask do voto no estágio B
+    logic [RW-1:0] p_rho [0:THETA_BINS-1];
+    logic [VOTE_W-1:0] vote_old [0:THETA_BINS-1];  // Contagem atual da célula
+    logic [VOTE_W-1:0] vote_new [0:THETA_BINS-1];  // Nova contagem da célula votada
+    
+    // Última escrita do estágio B (encaminhada se o próximo voto cair na
+    // mesma célula: a leitura síncrona ainda não a enxerga)
+    logic              l_vote;
+    logic [THETA_BINS-1:0] l_mask;
+    logic [RW-1:0]     l_rho [0:THETA_BINS-1];
+    logic [VOTE_W-1:0] l_new [0:THETA_BINS-1];
+    
+    // Decisão de atualização do top-K de cada banco
+    logic [THETA_BINS-1:0] bk_hit, bk_free;
+    logic [KW-1:0]         bk_hit_k  [0:THETA_BINS-1];  // Slot que já tem este ρ
+    logic [KW-1:0]         bk_free_k [0:THETA_BINS-1];  // Primeiro slot vazio
+    logic [KW-1:0]         bk_min_k  [0:THETA_BINS-1];  // Slot de menor contagem
+    
+    // Próximo top-K global após juntar o banco merge_t
+    logic [15:0] m_rho  [0:MAX_LINES-1];
+    logic [7:0] m_theta [0:MAX_LINES-1];
+    logic [7:0] m_votes [0:MAX_LINES-1];
+    logic [7:0] m_count;
+    logic [KW-1:0] m_min;
+    
+    // ========== PIXEL ATUAL DE VOTE (COMBINACIONAL) ==========
     always_comb begin
-        // Multiplicações e soma signed
-        temp_prod_x = $signed({24'd0, pixel_x}) * $signed(get_cos_lut(theta_idx));
-        temp_prod_y = $signed({24'd0, pixel_y}) * $signed(get_sin_lut(theta_idx));
-        temp_sum = temp_prod_x + temp_prod_y;
-        rho_calc = temp_sum / $signed(16'd256);
+        vote_bit = 3'd0;
+        for (int b = 7; b >= 0; b--) begin
+            if (vote_byte[b]) vote_bit = b;
+        end
+        // Formato do C: pixel_idx = row * WIDTH + col, byte = idx/8, bit = idx%8
+        vote_idx  = vote_addr * 8 + vote_bit;
+        vote_x    = vote_idx % IMG_SIZE;
+        vote_y    = vote_idx / IMG_SIZE;
+        vote_rest = vote_byte & (vote_byte - 8'd1);
+        acc_vote  = (state == VOTE) && (vote_byte != 8'd0);
         
-        // Saturação
-        if (rho_calc < 0) begin
-            rho_bin_calc = 6'd0;
-        end else if (rho_calc >= 16) begin
-            rho_bin_calc = 6'd15;
+        // Bancos na janela da orientação do pixel (THETA_BINS = 16: a
+        // diferença em 4 bits já é circular)
+        vote_dir = vote_theta[vote_bit*4 +: 4];
+        for (int t = 0; t < THETA_BINS; t++) begin
+            dir_dist = t - vote_dir;
+            vote_mask[t] = !ORIENTED || vote_window >= THETA_BINS / 2 ||
+                           dir_dist <= vote_window[3:0] || dir_dist >= THETA_BINS - vote_window[3:0];
+        end
+    end
+    
+    // ========== CÁLCULO DE RHO PARA TODOS OS θ (COMBINACIONAL) ==========
+    // Um multiplicador-somador por θ (constantes da LUT)
+    always_comb begin
+        for (int t = 0; t < THETA_BINS; t++) begin
+            rho_sum = $signed({16'd0, vote_x}) * $signed(get_cos_lut(t)) +
+                      $signed({16'd0, vote_y}) * $signed(get_sin_lut(t));
+            rho_bin = rho_sum / 256 + RHO_OFS;
+            
+            // Saturação (só atua com SIGNED_RHO=0: a faixa com sinal cobre
+            // todos os ρ possíveis)
+            if (rho_bin < 0) begin
+                vote_rho[t] = '0;
+            end else if (rho_bin >= ACC_RHO) begin
+                vote_rho[t] = ACC_RHO - 1;
+            end else begin
+                vote_rho[t] = rho_bin[RW-1:0];
+            end
+        end
+    end
+    
+    // ========== BANCOS DO ACUMULADOR (RAM, LEITURA SÍNCRONA) ==========
+    // Estágio A: o pixel de VOTE lê a célula ρ de cada banco
+    // Estágio B: escreve a nova contagem na mesma célula (p_rho)
+    genvar gt;
+    generate
+        for (gt = 0; gt < THETA_BINS; gt++) begin : theta_bank
+            logic [VOTE_W-1:0] cells [0:ACC_RHO-1];
+            
+            always_ff @(posedge clk) begin
+                if (acc_vote) acc_q[gt] <= cells[vote_rho[gt]];
+                if (p_vote && p_mask[gt]) cells[p_rho[gt]] <= vote_new[gt];
+            end
+        end
+    endgenerate
+    
+    // ========== NOVA CONTAGEM E DECISÃO DO TOP-K POR BANCO ==========
+    always_comb begin
+        for (int t = 0; t < THETA_BINS; t++) begin
+            // Encaminha a escrita do ciclo anterior (se o banco votou);
+            // célula inválida vale 0
+            if (l_vote && l_mask[t] && l_rho[t] == p_rho[t])
+                vote_old[t] = l_new[t];
+            else if (!acc_valid[t][p_rho[t]])
+                vote_old[t] = '0;
+            else
+                vote_old[t] = acc_q[t];
+            
+            // Contador satura em VOTE_MAX
+            vote_new[t] = (vote_old[t] == VOTE_MAX) ? VOTE_MAX : vote_old[t] + 1'b1;
+            
+            bk_hit[t] = 1'b0;
+            bk_hit_k[t] = '0;
+            bk_free[t] = 1'b0;
+            bk_free_k[t] = '0;
+            bk_min_k[t] = '0;
+            for (int k = 0; k < MAX_LINES; k++) begin
+                if (bk_valid[t][k] && bk_rho[t][k] == p_rho[t]) begin
+                    bk_hit[t] = 1'b1;
+                    bk_hit_k[t] = k;
+                end
+                if (!bk_valid[t][k] && !bk_free[t]) begin
+                    bk_free[t] = 1'b1;
+                    bk_free_k[t] = k;
+                end
+                if (bk_votes[t][k] < bk_votes[t][bk_min_k[t]]) begin
+                    bk_min_k[t] = k;
+                end
+            end
+        end
+    end
+    
+    // ========== PIPELINE DE VOTO, VALIDADE E TOP-K ==========
+    // job_start invalida tudo em 1 ciclo (o pipeline está vazio: o job
+    // anterior passou por VOTE_DRAIN). O estágio B marca a célula como
+    // válida e atualiza a lista do banco: ρ já listado → nova contagem;
+    // slot vazio → insere; senão substitui o menor se a nova contagem
+    // for maior. Bancos fora da janela do pixel (p_mask) não mudam.
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            p_vote <= 1'b0;
+            l_vote <= 1'b0;
         end else begin
-            rho_bin_calc = 6'd0 + rho_calc[5:0];  // Force 6-bit width
+            p_vote <= acc_vote;
+            l_vote <= p_vote;
+        end
+    end
+    
+    always_ff @(posedge clk) begin
+        p_mask <= vote_mask;
+        l_mask <= p_mask;
+        for (int t = 0; t < THETA_BINS; t++) begin
+            p_rho[t] <= vote_rho[t];
+            l_rho[t] <= p_rho[t];
+            l_new[t] <= vote_new[t];
+            
+            if (job_start) begin
+                acc_valid[t] <= '0;
+                bk_valid[t] <= '0;
+            end else if (p_vote && p_mask[t]) begin
+                acc_valid[t][p_rho[t]] <= 1'b1;
+                
+                if (bk_hit[t]) begin
+                    bk_votes[t][bk_hit_k[t]] <= vote_new[t];
+                end else if (bk_free[t]) begin
+                    bk_valid[t][bk_free_k[t]] <= 1'b1;
+                    bk_rho[t][bk_free_k[t]] <= p_rho[t];
+                    bk_votes[t][bk_free_k[t]] <= vote_new[t];
+                end else if (vote_new[t] > bk_votes[t][bk_min_k[t]]) begin
+                    bk_rho[t][bk_min_k[t]] <= p_rho[t];
+                    bk_votes[t][bk_min_k[t]] <= vote_new[t];
+                end
+            end
+        end
+    end
+    
+    // ========== JUNÇÃO DO BANCO merge_t NO TOP-K GLOBAL (COMBINACIONAL) ==========
+    // Candidatos com votes >= VOTE_THRESHOLD entram em ordem de slot: com
+    // lugar livre são anexados, com a lista cheia substituem o menor
+    // (primeiro de menor contagem) se tiverem mais votos.
+    always_comb begin
+        for (int i = 0; i < MAX_LINES; i++) begin
+            m_rho[i] = work_rho[i];
+            m_theta[i] = work_theta[i];
+            m_votes[i] = work_votes[i];
+        end
+        m_count = peak_count;
+        
+        for (int k = 0; k < MAX_LINES; k++) begin
+            if (bk_valid[merge_t][k] && bk_votes[merge_t][k] >= VOTE_THRESHOLD) begin
+                if (m_count < MAX_LINES) begin
+                    m_rho[m_count] = bk_rho[merge_t][k] - RHO_OFS;
+                    m_theta[m_count] = (merge_t * 180) / THETA_BINS;
+                    m_votes[m_count] = bk_votes[merge_t][k];
+                    m_count = m_count + 1'b1;
+                end else begin
+                    m_min = '0;
+                    for (int i = 1; i < MAX_LINES; i++) begin
+                        if (m_votes[i] < m_votes[m_min]) m_min = i;
+                    end
+                    if (bk_votes[merge_t][k] > m_votes[m_min]) begin
+                        m_rho[m_min] = bk_rho[merge_t][k] - RHO_OFS;
+                        m_theta[m_min] = (merge_t * 180) / THETA_BINS;
+                        m_votes[m_min] = bk_votes[merge_t][k];
+                    end
+                end
+            end
         end
     end
     
     // ========== ESCRITA DA IMAGEM ==========
     always_ff @(posedge clk) begin
-        if (wr_en && wr_addr < 32) begin
-            image_mem[wr_addr] <= wr_data;
+        if (wr_en && wr_addr < IMG_BYTES) begin
+            image_mem[fill_bank * IMG_BYTES + wr_addr] <= wr_data;
+            if (ORIENTED) theta_mem[fill_bank * IMG_BYTES + wr_addr] <= wr_theta;
+            bank_window[fill_bank] <= wr_window;
 `ifdef SIMULATION
-            $display("[WR_MEM] Byte %0d = 0x%02h", wr_addr, wr_data);
+            $display("[WR_MEM] Banco %0d Byte %0d = 0x%02h", fill_bank, wr_addr, wr_data);
 `endif
         end
     end
     
     // CORREÇÃO CRÍTICA: Inicialização explícita da memória
     initial begin
-        for (int i = 0; i < 32; i = i + 1) begin
+        for (int i = 0; i < 2*IMG_BYTES; i = i + 1) begin
             image_mem[i] = 8'd0;
         end
+        for (int i = 0; i < THETA_WORDS; i = i + 1) begin
+            theta_mem[i] = 32'd0;
+        end
+        bank_window[0] = 8'hFF;
+        bank_window[1] = 8'hFF;
     end
     
     // ========== MÁQUINA DE ESTADOS PRINCIPAL ==========
@@ -196,53 +461,73 @@ module hough_transform #(
         if (!reset_n) begin
             state <= IDLE;
             done <= 1'b0;
-            busy <= 1'b0;
-            pixel_x <= 8'd0;
-            pixel_y <= 8'd0;
-            theta_idx <= 7'd0;
-            clear_count <= 16'd0;
-            peak_count <= 4'd0;
+            merge_t <= 8'd0;
+            vote_byte <= 8'd0;
+            vote_addr <= 16'd0;
+            next_addr <= 16'd0;
+            vote_theta <= 32'd0;
+            vote_window <= 8'hFF;
+            peak_count <= 8'd0;
             num_lines <= 8'd0;
-            debug_printed <= 1'b0;
+            fill_bank <= 1'b0;
+            comp_bank <= 1'b0;
+            bank_full <= 2'b00;
+            result_valid <= 1'b0;
+            line_rho <= '0;
+            line_theta <= '0;
+            line_votes <= '0;
+            perf_edges <= 16'd0;
+            perf_vote_clks <= 16'd0;
+            perf_merge_clks <= 16'd0;
+            work_edges <= 16'd0;
+            work_vote_clks <= 16'd0;
+            work_merge_clks <= 16'd0;
             
-            // Inicializa arrays de saída
-            line_rho[0] <= 8'd0;
-            line_rho[1] <= 8'd0;
-            line_rho[2] <= 8'd0;
-            line_rho[3] <= 8'd0;
-            line_theta[0] <= 8'd0;
-            line_theta[1] <= 8'd0;
-            line_theta[2] <= 8'd0;
-            line_theta[3] <= 8'd0;
-            line_votes[0] <= 8'd0;
-            line_votes[1] <= 8'd0;
-            line_votes[2] <= 8'd0;
-            line_votes[3] <= 8'd0;
+            for (int i = 0; i < MAX_LINES; i++) begin
+                work_rho[i] <= 16'd0;
+                work_theta[i] <= 8'd0;
+                work_votes[i] <= 8'd0;
+            end
             
         end else begin
             // Default: done é pulso de 1 ciclo
             done <= 1'b0;
             
+            // Confirma o banco em carga como job e passa a carregar o outro.
+            // Nunca colide com a liberação em VOTE: aqui o banco está vazio,
+            // lá o banco está cheio.
+            if (start && !bank_full[fill_bank]) begin
+                bank_full[fill_bank] <= 1'b1;
+                fill_bank <= ~fill_bank;
+            end
+            
+            // Resultado consumido: libera as saídas para o próximo job
+            if (result_ack) begin
+                result_valid <= 1'b0;
+            end
+            
+            // Contadores do job em andamento (zerados em job_start)
+            if (job_start) begin
+                work_edges <= 16'd0;
+                work_vote_clks <= 16'd0;
+                work_merge_clks <= 16'd0;
+            end else begin
+                if (acc_vote && work_edges != 16'hFFFF)
+                    work_edges <= work_edges + 1'b1;
+                if ((state == VOTE || state == VOTE_DRAIN) && work_vote_clks != 16'hFFFF)
+                    work_vote_clks <= work_vote_clks + 1'b1;
+                if (state == MERGE_PEAKS && work_merge_clks != 16'hFFFF)
+                    work_merge_clks <= work_merge_clks + 1'b1;
+            end
+            
             case (state)
                 IDLE: begin
-                    busy <= 1'b0;
-                    if (start) begin
-                        busy <= 1'b1;
-                        clear_count <= 8'd0;
-                        state <= CLEAR_ACC;
-                    end
-                end
-                
-                CLEAR_ACC: begin
-                    // Zera acumulador (precisa de RHO_BINS × THETA_BINS = 16×16 = 256 ciclos)
-                    debug_printed <= 1'b0;  // Reseta flag de debug
-                    if (clear_count < RHO_BINS * THETA_BINS) begin
-                        accumulator[clear_count] <= 6'd0;
-                        clear_count <= clear_count + 1'b1;
-                    end else begin
-                        pixel_x <= 8'd0;
-                        pixel_y <= 8'd0;
-                        theta_idx <= 7'd0;
+                    // job_start: acumulador e listas invalidados neste ciclo
+                    if (bank_full[comp_bank]) begin
+                        vote_byte <= 8'd0;
+                        vote_addr <= 16'd0;
+                        next_addr <= 16'd0;
+                        vote_window <= bank_window[comp_bank];
                         
                         // DEBUG: Imprime imagem desempacotada (APENAS EM SIMULAÇÃO)
                         `ifdef SIMULATION
@@ -250,7 +535,7 @@ module hough_transform #(
                         for (integer debug_y = 0; debug_y < IMG_SIZE; debug_y++) begin
                             for (integer debug_x = 0; debug_x < IMG_SIZE; debug_x++) begin
                                 integer debug_pixel_idx = debug_y * IMG_SIZE + debug_x;
-                                integer debug_byte_addr = debug_pixel_idx / 8;
+                                integer debug_byte_addr = comp_bank * IMG_BYTES + debug_pixel_idx / 8;
                                 integer debug_bit_pos = debug_pixel_idx % 8;
                                 if (image_mem[debug_byte_addr][debug_bit_pos])
                                     $write("█");
@@ -263,9 +548,10 @@ module hough_transform #(
                         
                         // DEBUG: Mostra memória após recepção UART
                         $display("[DEBUG] Conteúdo da memória após UART:");
-                        for (int dbg_i = 0; dbg_i < 16; dbg_i++) begin
+                        for (int dbg_i = 0; dbg_i < IMG_BYTES / 2; dbg_i++) begin
                             $display("  Bytes %2d-%2d: %02h %02h", dbg_i*2, dbg_i*2+1, 
-                                     image_mem[dbg_i*2], image_mem[dbg_i*2+1]);
+                                     image_mem[comp_bank*IMG_BYTES + dbg_i*2],
+                                     image_mem[comp_bank*IMG_BYTES + dbg_i*2+1]);
                         end
                         $display("");
                         `endif
@@ -275,151 +561,72 @@ module hough_transform #(
                 end
                 
                 VOTE: begin
-                    // Processa cada pixel da imagem
-                    // Para cada pixel de borda, vota em todos os θ
-                    
-                    // ========== CORREÇÃO: DESEMPACOTAMENTO CORRETO ==========
-                    // Formato do C: pixel_idx = row * WIDTH + col
-                    //                byte_idx = pixel_idx / 8
-                    //                bit_idx = pixel_idx % 8
-                    // Cada byte contém 8 pixels, LSB first
-                    // Exemplo: byte 0, bit 0 = pixel (0,0)
-                    //          byte 0, bit 1 = pixel (0,1)
-                    //          byte 2, bit 0 = pixel (1,0)
-                    integer pixel_linear_idx;
-                    pixel_linear_idx = pixel_y * IMG_SIZE + pixel_x;
-                    byte_addr = pixel_linear_idx / 8;
-                    bit_pos = pixel_linear_idx % 8;
-                    // =======================================================
-                    
-                    // Verifica se é pixel de borda
-                    // CORREÇÃO CRÍTICA: Usa case para acessar bit (workaround para IVerilog)
-                    case (bit_pos)
-                        0: pixel_bit = image_mem[byte_addr][0];
-                        1: pixel_bit = image_mem[byte_addr][1];
-                        2: pixel_bit = image_mem[byte_addr][2];
-                        3: pixel_bit = image_mem[byte_addr][3];
-                        4: pixel_bit = image_mem[byte_addr][4];
-                        5: pixel_bit = image_mem[byte_addr][5];
-                        6: pixel_bit = image_mem[byte_addr][6];
-                        7: pixel_bit = image_mem[byte_addr][7];
-                        default: pixel_bit = 1'b0;
-                    endcase
-                    
-                    if (pixel_bit) begin
-                        // Usa valores calculados combinacionalmente
-                        // (já calculados no bloco always_comb acima)
-                        rho_scaled <= rho_calc;
-                        rho_bin <= rho_bin_calc;
-                        
-                        // Vota no acumulador
-                        acc_addr = rho_bin_calc * THETA_BINS + theta_idx;
-                        accumulator[acc_addr] <= accumulator[acc_addr] + 1'b1;
-                    end
-                    
-                    // Avança para próximo θ
-                    if (theta_idx < THETA_BINS - 1) begin
-                        theta_idx <= theta_idx + 1'b1;
-                    end else begin
-                        theta_idx <= 7'd0;
-                        
-                        // Avança para próximo pixel
-                        if (pixel_x < IMG_SIZE - 1) begin
-                            pixel_x <= pixel_x + 1'b1;
+                    // Cada ciclo vota o bit de borda de menor índice de
+                    // vote_byte em todos os θ (bloco de escrita dos bancos)
+                    // e, se era o último bit do byte, já carrega o próximo.
+                    // Um byte zerado custa 1 ciclo; um byte com k bordas,
+                    // k ciclos.
+                    if (vote_rest == 8'd0) begin
+                        if (next_addr < IMG_BYTES) begin
+                            vote_byte <= image_mem[comp_bank * IMG_BYTES + next_addr];
+                            if (ORIENTED) vote_theta <= theta_mem[comp_bank * IMG_BYTES + next_addr];
+                            vote_addr <= next_addr;
+                            next_addr <= next_addr + 1'b1;
                         end else begin
-                            pixel_x <= 8'd0;
-                            if (pixel_y < IMG_SIZE - 1) begin
-                                pixel_y <= pixel_y + 1'b1;
-                            end else begin
-                                // Terminou de processar todos os pixels
-                                peak_count <= 4'd0;
-                                pixel_x <= 8'd0;
-                                pixel_y <= 8'd0;
-                                state <= FIND_PEAKS;
-                            end
+                            // Terminou de processar todos os pixels:
+                            // o banco já pode receber o próximo tile
+                            vote_byte <= 8'd0;
+                            bank_full[comp_bank] <= 1'b0;
+                            comp_bank <= ~comp_bank;
+                            peak_count <= 8'd0;
+                            merge_t <= 8'd0;
+                            state <= VOTE_DRAIN;
                         end
+                    end else begin
+                        vote_byte <= vote_rest;
                     end
                 end
                 
-                FIND_PEAKS: begin
-                    // CORREÇÃO: Busca os MAIORES picos em todo o acumulador
-                    // Mantém os TOP-N picos com mais votos
-                    
-                    // Usa pixel_x e pixel_y como índices r e t (reutiliza contadores)
-                    clear_r = pixel_x;  // rho
-                    clear_t = pixel_y;  // theta
-                    acc_addr = clear_r * THETA_BINS + clear_t;
-                    
-                    // ESTRATÉGIA: Mantém os TOP-N picos com MAIS votos
-                    // Comparação direta desenrolada (sem loops) para síntese
-                    if (accumulator[acc_addr] >= 6'd5) begin  // Threshold mínimo
-                        if (peak_count < MAX_LINES) begin
-                            // Ainda há espaço: adiciona direto
-                            line_rho[peak_count] <= clear_r[7:0];
-                            line_theta[peak_count] <= (clear_t * 180) / THETA_BINS;
-                            line_votes[peak_count] <= {2'b0, accumulator[acc_addr]};
-                            peak_count <= peak_count + 1'b1;
-                        end else if (peak_count == MAX_LINES) begin
-                            // Lista cheia: substitui o MENOR se este for maior
-                            // Comparação desenrolada para MAX_LINES=4
-                            if (accumulator[acc_addr] > line_votes[0][5:0] && 
-                                line_votes[0][5:0] <= line_votes[1][5:0] && 
-                                line_votes[0][5:0] <= line_votes[2][5:0] && 
-                                line_votes[0][5:0] <= line_votes[3][5:0]) begin
-                                // Slot 0 tem o menor
-                                line_rho[0] <= clear_r[7:0];
-                                line_theta[0] <= (clear_t * 180) / THETA_BINS;
-                                line_votes[0] <= {2'b0, accumulator[acc_addr]};
-                            end else if (accumulator[acc_addr] > line_votes[1][5:0] && 
-                                         line_votes[1][5:0] <= line_votes[0][5:0] && 
-                                         line_votes[1][5:0] <= line_votes[2][5:0] && 
-                                         line_votes[1][5:0] <= line_votes[3][5:0]) begin
-                                // Slot 1 tem o menor
-                                line_rho[1] <= clear_r[7:0];
-                                line_theta[1] <= (clear_t * 180) / THETA_BINS;
-                                line_votes[1] <= {2'b0, accumulator[acc_addr]};
-                            end else if (accumulator[acc_addr] > line_votes[2][5:0] && 
-                                         line_votes[2][5:0] <= line_votes[0][5:0] && 
-                                         line_votes[2][5:0] <= line_votes[1][5:0] && 
-                                         line_votes[2][5:0] <= line_votes[3][5:0]) begin
-                                // Slot 2 tem o menor
-                                line_rho[2] <= clear_r[7:0];
-                                line_theta[2] <= (clear_t * 180) / THETA_BINS;
-                                line_votes[2] <= {2'b0, accumulator[acc_addr]};
-                            end else if (accumulator[acc_addr] > line_votes[3][5:0] && 
-                                         line_votes[3][5:0] <= line_votes[0][5:0] && 
-                                         line_votes[3][5:0] <= line_votes[1][5:0] && 
-                                         line_votes[3][5:0] <= line_votes[2][5:0]) begin
-                                // Slot 3 tem o menor
-                                line_rho[3] <= clear_r[7:0];
-                                line_theta[3] <= (clear_t * 180) / THETA_BINS;
-                                line_votes[3] <= {2'b0, accumulator[acc_addr]};
-                            end
-                        end
+                VOTE_DRAIN: begin
+                    // Estágio B do último voto escreve neste ciclo; as
+                    // listas já estão completas no próximo
+                    state <= MERGE_PEAKS;
+                end
+                
+                MERGE_PEAKS: begin
+                    for (int i = 0; i < MAX_LINES; i++) begin
+                        work_rho[i] <= m_rho[i];
+                        work_theta[i] <= m_theta[i];
+                        work_votes[i] <= m_votes[i];
                     end
+                    peak_count <= m_count;
                     
-                    // Sempre avança para próxima posição
-                    if (pixel_y < THETA_BINS - 1) begin
-                        pixel_y <= pixel_y + 1'b1;
+                    if (merge_t < THETA_BINS - 1) begin
+                        merge_t <= merge_t + 1'b1;
                     end else begin
-                        pixel_y <= 7'd0;
-                        if (pixel_x < RHO_BINS - 1) begin
-                            pixel_x <= pixel_x + 1'b1;
-                        end else begin
-                            // Terminou de varrer todo o acumulador
-                            num_lines <= peak_count;
 `ifdef SIMULATION
-                            $display("[FIND_PEAKS] Varredura completa. Total de picos: %0d", peak_count);
+                        $display("[MERGE_PEAKS] Junção completa. Total de picos: %0d", m_count);
 `endif
-                            state <= DONE_STATE;
-                        end
+                        state <= DONE_STATE;
                     end
                 end
                 
                 DONE_STATE: begin
-                    done <= 1'b1;
-                    busy <= 1'b0;
-                    state <= IDLE;
+                    // Publica só quando o resultado anterior foi consumido
+                    if (!result_valid || result_ack) begin
+                        for (int i = 0; i < MAX_LINES; i++) begin
+                            line_rho[i*16 +: 16] <= work_rho[i];
+                            line_theta[i*8 +: 8] <= work_theta[i];
+                            line_votes[i*8 +: 8] <= work_votes[i];
+                        end
+                        num_lines <= peak_count;
+                        perf_edges <= work_edges;
+                        perf_vote_clks <= work_vote_clks;
+                        perf_merge_clks <= work_merge_clks;
+                        result_valid <= 1'b1;
+                        done <= 1'b1;
+                        state <= IDLE;
+                    end
                 end
                 
                 default: state <= IDLE;
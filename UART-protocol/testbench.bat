@@ -1,6 +1,6 @@
 @echo off
 
-set files=uart_echo_colorlight_i9.sv uart_top.sv uart_rx.sv uart_tx.sv hough_transform.sv
+set files=uart_echo_colorlight_i9.sv uart_top.sv uart_rx.sv uart_tx.sv hough_array.sv hough_transform.sv
 set testbench=files_testbench/hough_transform_tb.sv
 
 REM Compilar os arquivos e gerar o arquivo testbench.vvp
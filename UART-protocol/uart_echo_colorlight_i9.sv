@@ -2,7 +2,10 @@ module uart_echo_colorlight_i9 #(
     parameter clk_freq = 25_000_000,
     parameter baud_rate = 9600,
     parameter IMG_SIZE = 16,           // Imagem 16x16
-    parameter MAX_LINES = 4            // Máximo de linhas detectadas
+    parameter MAX_LINES = 4,           // Máximo de linhas detectadas
+    parameter NUM_ENGINES = 4,         // Motores Hough em paralelo (hough_array)
+    parameter FRAME_SIZE = 64,         // Imagem inteira do comando 0xAC (64 ou 128)
+    parameter FRAME_MAX_LINES = 8      // Máximo de linhas na imagem inteira
 )(
     input  logic       clk,
     input  logic       reset_n,
@@ -18,38 +21,50 @@ module uart_echo_colorlight_i9 #(
     logic [7:0] tx_byte;
     logic       tx_active, tx_done;
     
-    // Sinais da Transformada de Hough
-    logic        hough_start;
-    logic        hough_done;
+    // Sinais da matriz de motores Hough
+    logic        hough_in_ready;
+    logic        hough_in_begin;
+    logic [7:0]  hough_in_tag;
+    logic        hough_in_tagged;
+    logic        hough_in_crc;
+    logic        hough_start;       // Commit do tile carregado
     logic        hough_busy;
     logic        hough_wr_en;
     logic [7:0]  hough_wr_addr;
     logic [7:0]  hough_wr_data;
+    logic [31:0] hough_wr_theta;    // Orientação dos 8 pixels de hough_wr_data (0xAF)
+    logic [7:0]  hough_wr_window;   // Janela de θ do tile (0xFF: todos os θ)
+    logic        hough_res_valid;
+    logic [7:0]  hough_res_tag;
+    logic        hough_res_tagged;
+    logic        hough_res_crc;     // Resultado de lote (0xAE): termina com CRC
     logic [7:0]  hough_num_lines;
+    logic [7:0]  hough_res_sel;     // Linha exibida em hough_res_*
+    logic [7:0]  hough_res_rho, hough_res_theta, hough_res_votes;
+    logic        hough_result_ack;
+    logic [31:0] hough_res_rx_clks;  // Ciclos de recepção do resultado da cabeça
+    logic [15:0] hough_res_edges, hough_res_vote_clks, hough_res_merge_clks;
+    logic [31:0] rx_job_clks;        // Ciclos desde o primeiro byte do tile/imagem em recepção
     
-    // Sinais flat para as linhas detectadas
-    logic [7:0]  hough_line_rho_0, hough_line_rho_1, hough_line_rho_2, hough_line_rho_3;
-    logic [7:0]  hough_line_theta_0, hough_line_theta_1, hough_line_theta_2, hough_line_theta_3;
-    logic [7:0]  hough_line_votes_0, hough_line_votes_1, hough_line_votes_2, hough_line_votes_3;
+    // Sinais do motor de imagem inteira (ρ com sinal, sem tiles)
+    logic        frame_load_ready;
+    logic        frame_start;
+    logic        frame_busy;
+    logic        frame_done;
+    logic        frame_wr_en;
+    logic [15:0] frame_wr_addr;
+    logic        frame_result_valid;
+    logic        frame_result_ack;
+    logic [7:0]  frame_num_lines;
+    logic [FRAME_MAX_LINES*16-1:0] frame_rho;
+    logic [FRAME_MAX_LINES*8-1:0]  frame_theta, frame_votes;
+    logic [31:0] frame_rx_clks;      // rx_job_clks no commit da imagem
+    logic [15:0] frame_edges, frame_vote_clks, frame_merge_clks;
     
-    // Arrays locais para facilitar acesso
-    logic [7:0]  hough_line_rho   [0:MAX_LINES-1];
-    logic [7:0]  hough_line_theta [0:MAX_LINES-1];
-    logic [7:0]  hough_line_votes [0:MAX_LINES-1];
-    
-    // Mapeamento dos sinais flat para arrays
-    assign hough_line_rho[0]   = hough_line_rho_0;
-    assign hough_line_rho[1]   = hough_line_rho_1;
-    assign hough_line_rho[2]   = hough_line_rho_2;
-    assign hough_line_rho[3]   = hough_line_rho_3;
-    assign hough_line_theta[0] = hough_line_theta_0;
-    assign hough_line_theta[1] = hough_line_theta_1;
-    assign hough_line_theta[2] = hough_line_theta_2;
-    assign hough_line_theta[3] = hough_line_theta_3;
-    assign hough_line_votes[0] = hough_line_votes_0;
-    assign hough_line_votes[1] = hough_line_votes_1;
-    assign hough_line_votes[2] = hough_line_votes_2;
-    assign hough_line_votes[3] = hough_line_votes_3;
+    // Taxa da UART em tempo de execução: começa (e volta, se a negociação
+    // falhar) em baud_rate; o comando 0xA6 troca o divisor
+    localparam BASE_CLKS_PER_BIT = clk_freq / baud_rate;
+    logic [15:0] clks_per_bit;
     
     uart_top #(
         .CLK_FREQ_HZ(clk_freq),
@@ -58,6 +73,7 @@ module uart_echo_colorlight_i9 #(
     ) uart_inst (
         .i_clk(clk),
         .i_rst_n(reset_n),
+        .i_clks_per_bit(clks_per_bit),
         .i_uart_rx(uart_rx),
         .o_uart_tx(uart_tx),
         .i_tx_dv(tx_dv),
@@ -68,8 +84,9 @@ module uart_echo_colorlight_i9 #(
         .o_rx_byte(rx_byte)
     );
     
-    // Instancia Transformada de Hough
-    hough_transform #(
+    // Instancia matriz de motores Hough com despachante round-robin
+    hough_array #(
+        .NUM_ENGINES(NUM_ENGINES),
         .IMG_SIZE(IMG_SIZE),
         .RHO_BINS(16),      // Redução agressiva: 64 → 16 (1 pixel por bin)
         .THETA_BINS(16),    // Redução agressiva: 90 → 16 (~11° por bin)
@@ -77,25 +94,63 @@ module uart_echo_colorlight_i9 #(
     ) hough_inst (
         .clk(clk),
         .reset_n(reset_n),
-        .start(hough_start),
-        .done(hough_done),
-        .busy(hough_busy),
-        .wr_en(hough_wr_en),
-        .wr_addr(hough_wr_addr),
+        .in_ready(hough_in_ready),
+        .in_begin(hough_in_begin),
+        .in_tag(hough_in_tag),
+        .in_tagged(hough_in_tagged),
+        .in_crc(hough_in_crc),
+        .in_wr_en(hough_wr_en),
+        .in_wr_addr(hough_wr_addr),
+        .in_wr_data(hough_wr_data),
+        .in_wr_theta(hough_wr_theta),
+        .in_wr_window(hough_wr_window),
+        .in_commit(hough_start),
+        .in_rx_clks(rx_job_clks),
+        .res_valid(hough_res_valid),
+        .res_tag(hough_res_tag),
+        .res_tagged(hough_res_tagged),
+        .res_crc(hough_res_crc),
+        .res_num_lines(hough_num_lines),
+        .res_sel(hough_res_sel),
+        .res_rho(hough_res_rho),
+        .res_theta(hough_res_theta),
+        .res_votes(hough_res_votes),
+        .res_ack(hough_result_ack),
+        .res_rx_clks(hough_res_rx_clks),
+        .res_perf_edges(hough_res_edges),
+        .res_perf_vote_clks(hough_res_vote_clks),
+        .res_perf_merge_clks(hough_res_merge_clks),
+        .busy(hough_busy)
+    );
+    
+    // Motor de imagem inteira: acumulador com 2·⌈FRAME_SIZE·√2⌉+1 bins de ρ
+    // por θ, em BRAM. Substitui os 16 tiles + junção das linhas no host.
+    hough_transform #(
+        .IMG_SIZE(FRAME_SIZE),
+        .THETA_BINS(16),
+        .MAX_LINES(FRAME_MAX_LINES),
+        .SIGNED_RHO(1)
+    ) frame_inst (
+        .clk(clk),
+        .reset_n(reset_n),
+        .start(frame_start),
+        .done(frame_done),
+        .busy(frame_busy),
+        .load_ready(frame_load_ready),
+        .result_valid(frame_result_valid),
+        .result_ack(frame_result_ack),
+        .wr_en(frame_wr_en),
+        .wr_addr(frame_wr_addr),
         .wr_data(hough_wr_data),
-        .num_lines(hough_num_lines),
-        .line_rho_0(hough_line_rho_0),
-        .line_theta_0(hough_line_theta_0),
-        .line_votes_0(hough_line_votes_0),
-        .line_rho_1(hough_line_rho_1),
-        .line_theta_1(hough_line_theta_1),
-        .line_votes_1(hough_line_votes_1),
-        .line_rho_2(hough_line_rho_2),
-        .line_theta_2(hough_line_theta_2),
-        .line_votes_2(hough_line_votes_2),
-        .line_rho_3(hough_line_rho_3),
-        .line_theta_3(hough_line_theta_3),
-        .line_votes_3(hough_line_votes_3)
+        .wr_theta(32'd0),
+        .wr_window(8'hFF),
+        .num_lines(frame_num_lines),
+        .line_rho(frame_rho),
+        .line_theta(frame_theta),
+        .line_votes(frame_votes),
+        .perf_edges(frame_edges),
+        .perf_vote_clks(frame_vote_clks),
+        .perf_merge_clks(frame_merge_clks)
     );
     
 `ifdef TESTE_TX_MANUAL
@@ -103,6 +158,8 @@ module uart_echo_colorlight_i9 #(
     logic [7:0]  test_char;
     localparam TIMER_500MS = 25_000_000 / 2;
     
+    assign clks_per_bit = BASE_CLKS_PER_BIT;
+    
     always_ff @(posedge clk or negedge reset_n) begin
         if (!reset_n) begin
             timer_counter <= 32'd0;
@@ -129,25 +186,197 @@ module uart_echo_colorlight_i9 #(
     end
     
 `else
-    // ========== FSM PRINCIPAL: RECEBER IMAGEM -> HOUGH -> ENVIAR RESULTADO ==========
+    // ========== PIPELINE: RX (tile N+1) || HOUGH (N motores) || TX ==========
+    // Três processos independentes:
+    //   - RX recebe o próximo tile direto no banco livre de um dos motores
+    //   - a hough_array processa até NUM_ENGINES tiles em paralelo
+    //   - TX serializa os resultados em ordem de conclusão e devolve o ack
+    // O Pico pode manter até 2*NUM_ENGINES tiles em voo (um por banco); um
+    // header que chega sem banco livre é ignorado.
+    //
+    // Comandos de tile:
+    //   0xAA + 32 bytes          → [num_lines][ρ,θ,votes]...
+    //   0xAB + tile_id + 32 bytes → [tile_id][num_lines][ρ,θ,votes]...
+    //   0xAD + tile_id + n + n coords → igual a 0xAB (tile esparso)
+    //   0xAF + tile_id + k + n + n × (coord, θ) → igual a 0xAB (tile orientado)
+    // Com mais de um tile em voo as respostas saem em ordem de conclusão,
+    // então o host deve usar 0xAB/0xAD para associar cada resposta ao seu tile.
+    //
+    // Tile esparso: cada coordenada é um byte x<<4|y (IMG_SIZE=16). O tile é
+    // montado em sparse_bits e despejado no banco (1 byte/ciclo, IMG_BYTES
+    // ciclos) antes do commit; o próximo byte da UART leva ≥ 10*MIN_CLKS_PER_BIT
+    // ciclos, então o despejo nunca perde um byte. O host escolhe por tile a
+    // forma mais curta e nem envia tiles vazios.
+    //
+    // Tile orientado: como o esparso, mas cada coordenada vem seguida do bin
+    // θ (0..15, nibble baixo) da direção do gradiente no pixel, e k limita
+    // os votos de cada pixel aos θ a até k bins da sua orientação (2k+1
+    // bancos em vez de 16; k >= 8 vota em todos). As orientações vão para
+    // sparse_theta e descem ao banco junto com o bitmap, 32 bits por byte,
+    // no mesmo despejo de IMG_BYTES ciclos. Tiles com mais de 255 bordas
+    // não cabem em n: o host manda esses como bitmap (0xAB).
+    //
+    // Lote de tiles com CRC (todos os tiles do frame de uma vez):
+    //   0xAE + seq + n + crc(seq, n), depois n registros
+    //        idx + len + payload + crc(idx, len, payload)
+    //   len = 0xFF: payload é o bitmap de 32 bytes; senão len coordenadas x<<4|y
+    //   Cada registro gera exatamente uma resposta, com tag = {seq[3:0], idx[3:0]}:
+    //        tag + num_lines + [ρ,θ,votes]... + crc(tudo antes)
+    //        tag + 0xFF + crc  → reenviar (CRC errado ou nenhum banco livre)
+    //   Cabeçalho com CRC errado: o lote é ignorado (o host reenvia no prazo).
+    //   CRC-8 polinômio 0x07, valor inicial 0, o mesmo do main.c.
+    //
+    // Imagem inteira (FRAME_SIZE x FRAME_SIZE, mesmo empacotamento):
+    //   0xAC + FRAME_BYTES bytes → [num_lines][ρ_hi,ρ_lo,θ,votes]...
+    //   ρ em pixels, complemento de 2 (16 bits), origem no canto (0,0)
+    //
+    // Troca de taxa (só com o pipeline vazio):
+    //   0xA6 + div_hi + div_lo → 'A' (aceito) ou 'N', ainda na taxa atual
+    //   Após o 'A' o FPGA passa a clk_freq/div e espera 0xA7 na nova taxa,
+    //   que é ecoado para confirmar. Sem 0xA7 em BAUD_CONFIRM_CLKS, volta
+    //   a baud_rate (o Pico faz o mesmo quando não recebe o eco).
+    //
+    // Telemetria do último resultado transmitido (tile ou imagem inteira):
+    //   0xA8 → seq + tag + flags + edges(2) + vote(2) + merge(2) + rx(4) + tx(4) + crc
+    //   Campos big-endian, em ciclos de clk (edges em pixels):
+    //     seq   incrementa a cada resultado transmitido (o host detecta perdas)
+    //     tag   tag do resultado (0 sem tag ou na imagem inteira)
+    //     flags bit 0 = imagem inteira, bit 1 = resposta com tag, bit 2 = lote
+    //     edges pixels de borda votados
+    //     vote  ciclos de VOTE (1 por borda ou byte vazio) + esvaziamento
+    //     merge ciclos da busca de picos (junção dos bancos θ)
+    //     rx    do header (ou índice do registro do lote) ao commit do banco
+    //     tx    do primeiro byte da resposta ao último stop bit
+    //   crc = CRC-8 dos 17 bytes anteriores. Respondido entre resultados,
+    //   como a consulta de estado.
     localparam HEADER_BYTE = 8'hAA;
+    localparam TAGGED_HEADER = 8'hAB;  // Tile com índice devolvido na resposta
+    localparam FRAME_CMD   = 8'hAC;    // Imagem inteira no motor frame_inst
+    localparam SPARSE_CMD  = 8'hAD;    // Tile com índice como lista de coordenadas
+    localparam BATCH_CMD   = 8'hAE;    // Lote de tiles com seq e CRC
+    localparam ORIENT_CMD  = 8'hAF;    // Tile esparso com orientação por pixel
+    localparam BATCH_BITMAP = 8'hFF;   // len do registro: bitmap de IMG_BYTES bytes
+    localparam BATCH_RETRY = 8'hFF;    // num_lines da resposta: reenviar o tile
+    localparam STATUS_CMD  = 8'hA5;    // Consulta de estado enviada pelo Pico
+    localparam BAUD_CMD    = 8'hA6;    // Proposta de novo divisor da UART
+    localparam BAUD_CONFIRM = 8'hA7;   // Sonda de confirmação na nova taxa (ecoada)
+    localparam STATS_CMD   = 8'hA8;    // Telemetria do último resultado transmitido
+    localparam STATS_BYTES = 17;       // Bytes do registro de telemetria (sem o CRC)
+    localparam ACK_BYTE    = 8'h41;    // 'A': nova taxa aceita
+    localparam NAK_BYTE    = 8'h4E;    // 'N': divisor inválido ou pipeline ocupado
+    localparam READY_BYTE  = 8'h52;    // 'R': pipeline vazio, pronto para novo tile
+    localparam BUSY_BYTE   = 8'h42;    // 'B': ainda há tiles/resultados em andamento
     localparam IMG_BYTES = (IMG_SIZE * IMG_SIZE) / 8;  // 16x16 = 256 bits = 32 bytes
+    localparam FRAME_BYTES = (FRAME_SIZE * FRAME_SIZE) / 8;  // 64x64 = 512 bytes
+    
+    // Timeout entre bytes da imagem: se o Pico parar no meio de um tile
+    // (byte perdido, reset do host), descarta o tile e volta a aguardar header
+    // em vez de ficar preso em RECV_IMAGE consumindo o próximo comando.
+    localparam RX_TIMEOUT_CLKS = (clk_freq / baud_rate) * 256;  // 256 bit-times
+    
+    // Divisor mínimo aceito (amostragem do uart_rx) e janela para a sonda
+    // de confirmação chegar na nova taxa
+    localparam MIN_CLKS_PER_BIT = 8;                  // 25 MHz → até 3.125 Mbaud
+    localparam BAUD_CONFIRM_CLKS = clk_freq / 20;     // 50 ms
+    
+    // CRC-8 (polinômio x^8 + x^2 + x + 1), um byte por chamada
+    function automatic logic [7:0] crc8(input logic [7:0] crc, input logic [7:0] data);
+        logic [7:0] c;
+        c = crc ^ data;
+        for (int i = 0; i < 8; i++) c = c[7] ? ((c << 1) ^ 8'h07) : (c << 1);
+        return c;
+    endfunction
     
-    typedef enum logic [2:0] {
+    typedef enum logic [3:0] {
         WAIT_HEADER,        // Aguarda header de sincronização
-        RECV_IMAGE,         // Recebe 32 bytes da imagem
-        PROCESS_HOUGH,      // Executa Transformada de Hough
+        RECV_TAG,           // Recebe o tile_id do comando 0xAB/0xAD/0xAF
+        RECV_WINDOW,        // Recebe a janela k de θ do comando 0xAF
+        RECV_IMAGE,         // Recebe 32 bytes da imagem no banco livre
+        RECV_COUNT,         // Recebe o número de coordenadas (0xAD) ou o len do registro (0xAE)
+        BATCH_SEQ,          // Recebe o número de sequência do lote
+        BATCH_COUNT,        // Recebe o número de registros do lote
+        BATCH_HCRC,         // Confere o CRC do cabeçalho do lote
+        BATCH_IDX,          // Recebe o índice do próximo registro e reserva um banco
+        BATCH_CRC,          // Confere o CRC do registro: confirma o tile ou pede reenvio
+        RECV_COORDS,        // Recebe as coordenadas x<<4|y em sparse_bits (e θ em sparse_theta)
+        SPARSE_FLUSH,       // Escreve sparse_bits no banco livre e confirma o tile
+        RECV_FRAME,         // Recebe FRAME_BYTES bytes no banco livre de frame_inst
+        RECV_BAUD_HI,       // Recebe o byte alto do divisor do comando 0xA6
+        RECV_BAUD_LO        // Recebe o byte baixo do divisor
+    } rx_state_t;
+    
+    typedef enum logic [1:0] {
+        BAUD_IDLE,          // Taxa atual confirmada (ou baud_rate)
+        BAUD_SEND_ACK,      // 'A' sendo enviado na taxa antiga
+        BAUD_WAIT_CONFIRM   // Nova taxa ativa, aguardando 0xA7
+    } baud_state_t;
+    
+    typedef enum logic [3:0] {
+        TX_IDLE,            // Aguarda resultado publicado ou consulta de estado
+        SEND_STATUS,        // Responde READY/BUSY à consulta de estado ou A/N/0xA7 à troca de taxa
+        SEND_TAG,           // Envia tile_id (resultado de comando 0xAB)
         SEND_NUM_LINES,     // Envia número de linhas detectadas
-        SEND_LINE_DATA,     // Envia dados de cada linha (ρ, θ, votes)
+        SEND_LINE_DATA,     // Envia dados de cada linha (ρ, θ, votes; ρ em 2 bytes na imagem inteira)
+        SEND_CRC,           // Envia o CRC do resultado (lote 0xAE)
+        SEND_NAK,           // Envia tag + BATCH_RETRY + CRC de um registro recusado
+        SEND_STATS,         // Envia o registro de telemetria + CRC (0xA8)
         CLEANUP             // Estado de limpeza
-    } state_t;
+    } tx_state_t;
     
-    state_t state;
-    logic [7:0] recv_count;     // Contador de bytes recebidos (0..31)
-    logic [2:0] send_line_idx;  // Índice da linha sendo enviada
+    rx_state_t  rx_state;
+    tx_state_t  tx_state;
+    logic [15:0] recv_count;    // Contador de bytes recebidos (0..31 ou 0..FRAME_BYTES-1)
+    logic [31:0] rx_idle_clks;  // Ciclos desde o último byte recebido em RECV_IMAGE
+    logic       rx_sparse;      // Tile em recepção veio como lista de coordenadas (0xAD)
+    logic [7:0] sparse_left;    // Coordenadas que ainda faltam
+    logic [IMG_SIZE*IMG_SIZE-1:0] sparse_bits;  // Tile esparso expandido (pixel y*IMG_SIZE+x)
+    logic       rx_oriented;    // Tile em recepção é orientado (0xAF)
+    logic [7:0] rx_window;      // Janela k do tile orientado
+    logic       coord_dir;      // Próximo byte de RECV_COORDS é o θ da coordenada coord_idx
+    logic [7:0] coord_idx;      // Pixel y*IMG_SIZE+x da última coordenada
+    logic [4*IMG_SIZE*IMG_SIZE-1:0] sparse_theta;  // θ de cada pixel (pixel i em [i*4 +: 4])
+    logic       rx_batch;       // Comando em recepção é um lote 0xAE
+    logic       rx_drop;        // Registro do lote sem banco livre: não escreve, pede reenvio
+    logic [7:0] rx_crc;         // CRC acumulado do cabeçalho/registro em recepção
+    logic [7:0] batch_seq;
+    logic [7:0] batch_left;     // Registros do lote que ainda faltam
+    logic [7:0] batch_tag;      // Tag do registro em recepção
+    logic       nak_push;       // Pulso RX: registro recusado (tag em batch_tag)
+    logic       nak_pop;        // Pulso TX: NAK da cabeça da fila em envio
+    logic [7:0] nak_q [0:15];   // Tags a recusar (um lote tem no máximo 16 registros)
+    logic [3:0] nak_wp, nak_rp;
+    logic [4:0] nak_count;
+    logic [7:0] nak_tag;        // Tag do NAK em envio
+    logic [7:0] tx_crc;         // CRC dos bytes já enviados do resultado/NAK atual
+    logic       status_req;     // Pulso RX -> TX: consulta de estado recebida
+    logic       status_pending; // Consulta aguardando o TX ficar livre
+    logic [7:0] status_byte;
+    baud_state_t baud_state;
+    logic [31:0] baud_clks;     // Ciclos em BAUD_WAIT_CONFIRM
+    logic [15:0] baud_div;      // Divisor proposto pelo comando 0xA6
+    logic       baud_req;       // Pulso RX: comando 0xA6 completo em baud_div
+    logic       baud_probe;     // Pulso RX: sonda 0xA7 recebida
+    logic       ctrl_req;       // Pulso baud -> TX: enviar ctrl_req_byte
+    logic [7:0] ctrl_req_byte;
+    logic       ctrl_pending;   // Resposta de controle aguardando o TX
+    logic [7:0] ctrl_byte;
+    logic       tx_ctrl;        // SEND_STATUS está enviando uma resposta de controle
+    logic       ctrl_sent;      // Pulso TX: resposta de controle transmitida
+    logic [7:0] send_line_idx;  // Índice da linha sendo enviada
     logic [1:0] send_byte_idx;  // Índice do byte dentro da linha (0=ρ, 1=θ, 2=votes)
+    logic       tx_frame;       // Resultado em envio é do motor de imagem inteira
+    logic       tx_ack;         // Pulso: resultado em envio foi todo transmitido
+    logic [7:0] tx_num_lines;   // num_lines do resultado em envio
+    logic [7:0] tx_line_byte;   // Byte send_byte_idx da linha send_line_idx
+    logic [1:0] tx_last_byte;   // Índice do último byte de cada linha
     logic       prev_tx_done;
     logic       tx_done_rising;
+    logic       stats_req;      // Pulso RX -> TX: consulta de telemetria recebida
+    logic       stats_pending;
+    logic [4:0] stats_idx;      // Byte do registro em envio (STATS_BYTES = CRC)
+    logic [31:0] tx_job_clks;   // Ciclos desde o início da resposta em envio
+    logic [8*STATS_BYTES-1:0] stats_rec;  // Registro do último resultado, byte 0 no topo
+    logic [7:0] stats_seq;
     
     // Detecção de borda ascendente de tx_done
     always_ff @(posedge clk or negedge reset_n) begin
@@ -158,77 +387,632 @@ module uart_echo_colorlight_i9 #(
         end
     end
     assign tx_done_rising = tx_done && !prev_tx_done;
+    
+    // A matriz exibe a linha que o TX está enviando
+    assign hough_res_sel = send_line_idx;
+    
+    // Origem do resultado em envio: matriz de tiles (3 bytes por linha) ou
+    // motor de imagem inteira (4 bytes por linha, ρ de 16 bits)
+    always_comb begin
+        if (tx_frame) begin
+            tx_num_lines = frame_num_lines;
+            tx_last_byte = 2'd3;
+            case (send_byte_idx)
+                2'd0: tx_line_byte = frame_rho[send_line_idx*16 + 8 +: 8];
+                2'd1: tx_line_byte = frame_rho[send_line_idx*16 +: 8];
+                2'd2: tx_line_byte = frame_theta[send_line_idx*8 +: 8];
+                default: tx_line_byte = frame_votes[send_line_idx*8 +: 8];
+            endcase
+        end else begin
+            tx_num_lines = hough_num_lines;
+            tx_last_byte = 2'd2;
+            case (send_byte_idx)
+                2'd0: tx_line_byte = hough_res_rho;
+                2'd1: tx_line_byte = hough_res_theta;
+                2'd2: tx_line_byte = hough_res_votes;
+                default: tx_line_byte = 8'h00;
+            endcase
+        end
+    end
+    
+    // Janela dos bytes escritos no banco: a do tile orientado, senão todos
+    // os θ (0xAA/0xAB/0xAD/0xAE votam como sempre)
+    assign hough_wr_window = rx_oriented ? rx_window : 8'hFF;
+    
+    assign hough_result_ack = tx_ack && !tx_frame;
+    assign frame_result_ack = tx_ack && tx_frame;
 
-    // FSM Principal
+    // ---------- RX: comandos e carga do banco livre ----------
     always_ff @(posedge clk or negedge reset_n) begin
         if (!reset_n) begin
-            state <= WAIT_HEADER;
-            tx_dv <= 1'b0;
-            tx_byte <= 8'h00;
-            recv_count <= 8'd0;
-            send_line_idx <= 3'd0;
-            send_byte_idx <= 2'd0;
+            rx_state <= WAIT_HEADER;
+            recv_count <= 16'd0;
+            rx_idle_clks <= 32'd0;
+            rx_sparse <= 1'b0;
+            sparse_left <= 8'd0;
+            sparse_bits <= '0;
+            rx_oriented <= 1'b0;
+            rx_window <= 8'hFF;
+            coord_dir <= 1'b0;
+            coord_idx <= 8'd0;
+            sparse_theta <= '0;
+            rx_batch <= 1'b0;
+            rx_drop <= 1'b0;
+            rx_crc <= 8'h00;
+            batch_seq <= 8'd0;
+            batch_left <= 8'd0;
+            batch_tag <= 8'd0;
+            nak_push <= 1'b0;
+            status_req <= 1'b0;
+            stats_req <= 1'b0;
+            baud_req <= 1'b0;
+            baud_probe <= 1'b0;
+            baud_div <= 16'd0;
+            hough_in_begin <= 1'b0;
+            hough_in_tag <= 8'd0;
+            hough_in_tagged <= 1'b0;
+            hough_in_crc <= 1'b0;
             hough_start <= 1'b0;
             hough_wr_en <= 1'b0;
             hough_wr_addr <= 8'd0;
             hough_wr_data <= 8'd0;
+            hough_wr_theta <= 32'd0;
+            frame_start <= 1'b0;
+            frame_wr_en <= 1'b0;
+            frame_wr_addr <= 16'd0;
             
         end else begin
             // Defaults
-            tx_dv <= 1'b0;
+            status_req <= 1'b0;
+            stats_req <= 1'b0;
+            baud_req <= 1'b0;
+            baud_probe <= 1'b0;
+            nak_push <= 1'b0;
+            hough_in_begin <= 1'b0;
             hough_start <= 1'b0;
             hough_wr_en <= 1'b0;
+            frame_start <= 1'b0;
+            frame_wr_en <= 1'b0;
 
-            case (state)
+            case (rx_state)
                 WAIT_HEADER: begin
-                    // Aguarda header (0xAA)
-                    hough_wr_en <= 1'b0;
-                    if (rx_dv && rx_byte == HEADER_BYTE) begin
+                    // Aguarda header (0xAA/0xAB/0xAD/0xAF/0xAC) com algum banco livre;
+                    // o lote 0xAE reserva banco registro a registro
+                    if (rx_dv && rx_byte == HEADER_BYTE && hough_in_ready) begin
 `ifdef SIMULATION
                         $display("[HEADER] Detectado header 0xAA, mudando para RECV_IMAGE");
 `endif
-                        recv_count <= 8'd0;
-                        state <= RECV_IMAGE;
+                        hough_in_begin <= 1'b1;
+                        hough_in_tag <= 8'd0;
+                        hough_in_tagged <= 1'b0;
+                        hough_in_crc <= 1'b0;
+                        rx_batch <= 1'b0;
+                        rx_drop <= 1'b0;
+                        rx_oriented <= 1'b0;
+                        recv_count <= 16'd0;
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= RECV_IMAGE;
+                    end else if (rx_dv && rx_byte == TAGGED_HEADER && hough_in_ready) begin
+                        rx_sparse <= 1'b0;
+                        rx_batch <= 1'b0;
+                        rx_drop <= 1'b0;
+                        rx_oriented <= 1'b0;
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= RECV_TAG;
+                    end else if (rx_dv && rx_byte == SPARSE_CMD && hough_in_ready) begin
+                        rx_sparse <= 1'b1;
+                        rx_batch <= 1'b0;
+                        rx_drop <= 1'b0;
+                        rx_oriented <= 1'b0;
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= RECV_TAG;
+                    end else if (rx_dv && rx_byte == ORIENT_CMD && hough_in_ready) begin
+                        rx_sparse <= 1'b1;
+                        rx_batch <= 1'b0;
+                        rx_drop <= 1'b0;
+                        rx_oriented <= 1'b1;
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= RECV_TAG;
+                    end else if (rx_dv && rx_byte == BATCH_CMD) begin
+                        rx_batch <= 1'b1;
+                        rx_oriented <= 1'b0;
+                        rx_crc <= 8'h00;
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= BATCH_SEQ;
+                    end else if (rx_dv && rx_byte == FRAME_CMD && frame_load_ready) begin
+                        recv_count <= 16'd0;
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= RECV_FRAME;
+                    end else if (rx_dv && rx_byte == STATUS_CMD) begin
+                        status_req <= 1'b1;
+                    end else if (rx_dv && rx_byte == STATS_CMD) begin
+                        stats_req <= 1'b1;
+                    end else if (rx_dv && rx_byte == BAUD_CMD) begin
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= RECV_BAUD_HI;
+                    end else if (rx_dv && rx_byte == BAUD_CONFIRM) begin
+                        baud_probe <= 1'b1;
+                    end
+                end
+                
+                RECV_BAUD_HI, RECV_BAUD_LO: begin
+                    if (rx_dv) begin
+                        rx_idle_clks <= 32'd0;
+                        if (rx_state == RECV_BAUD_HI) begin
+                            baud_div[15:8] <= rx_byte;
+                            rx_state <= RECV_BAUD_LO;
+                        end else begin
+                            baud_div[7:0] <= rx_byte;
+                            baud_req <= 1'b1;
+                            rx_state <= WAIT_HEADER;
+                        end
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+                        rx_state <= WAIT_HEADER;
+                    end
+                end
+                
+                RECV_TAG: begin
+                    if (rx_dv) begin
+                        // Escolhe o motor; o tag volta junto com o resultado
+                        hough_in_begin <= 1'b1;
+                        hough_in_tag <= rx_byte;
+                        hough_in_tagged <= 1'b1;
+                        hough_in_crc <= 1'b0;
+                        recv_count <= 16'd0;
+                        rx_idle_clks <= 32'd0;
+                        sparse_bits <= '0;
+                        rx_state <= rx_oriented ? RECV_WINDOW : rx_sparse ? RECV_COUNT : RECV_IMAGE;
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+                        rx_state <= WAIT_HEADER;
+                    end
+                end
+                
+                RECV_WINDOW: begin
+                    if (rx_dv) begin
+                        rx_window <= rx_byte;
+                        rx_idle_clks <= 32'd0;
+                        rx_state <= RECV_COUNT;
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+                        rx_state <= WAIT_HEADER;
+                    end
+                end
+                
+                BATCH_SEQ, BATCH_COUNT, BATCH_HCRC: begin
+                    if (rx_dv) begin
+                        rx_idle_clks <= 32'd0;
+                        rx_crc <= crc8(rx_crc, rx_byte);
+                        if (rx_state == BATCH_SEQ) begin
+                            batch_seq <= rx_byte;
+                            rx_state <= BATCH_COUNT;
+                        end else if (rx_state == BATCH_COUNT) begin
+                            batch_left <= rx_byte;
+                            rx_state <= BATCH_HCRC;
+                        end else begin
+                            // Cabeçalho corrompido: sem n confiável não dá para
+                            // pular os registros, o lote inteiro é ignorado
+                            rx_state <= (rx_byte == rx_crc && batch_left != 8'd0) ? BATCH_IDX : WAIT_HEADER;
+                        end
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+                        rx_state <= WAIT_HEADER;
+                    end
+                end
+                
+                BATCH_IDX: begin
+                    if (rx_dv) begin
+                        batch_tag <= {batch_seq[3:0], rx_byte[3:0]};
+                        rx_crc <= crc8(8'h00, rx_byte);
+                        recv_count <= 16'd0;
+                        rx_idle_clks <= 32'd0;
+                        sparse_bits <= '0;
+                        // Sem banco livre o registro ainda é lido (para achar o
+                        // próximo), mas não é escrito e volta como reenvio
+                        rx_drop <= !hough_in_ready;
+                        if (hough_in_ready) begin
+                            hough_in_begin <= 1'b1;
+                            hough_in_tag <= {batch_seq[3:0], rx_byte[3:0]};
+                            hough_in_tagged <= 1'b1;
+                            hough_in_crc <= 1'b1;
+                        end
+                        rx_state <= RECV_COUNT;
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+                        rx_state <= WAIT_HEADER;
+                    end
+                end
+                
+                BATCH_CRC: begin
+                    if (rx_dv) begin
+                        rx_idle_clks <= 32'd0;
+                        batch_left <= batch_left - 1'b1;
+                        if (rx_byte == rx_crc && !rx_drop && rx_sparse) begin
+                            recv_count <= 16'd0;
+                            rx_state <= SPARSE_FLUSH;
+                        end else begin
+                            if (rx_byte == rx_crc && !rx_drop) begin
+                                hough_start <= 1'b1;  // Bitmap já está no banco
+                            end else begin
+                                nak_push <= 1'b1;     // Banco não confirmado: continua livre
+                            end
+                            rx_state <= (batch_left == 8'd1) ? WAIT_HEADER : BATCH_IDX;
+                        end
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+                        rx_state <= WAIT_HEADER;
+                    end
+                end
+                
+                RECV_COUNT: begin
+                    if (rx_dv) begin
+                        sparse_left <= rx_byte;
+                        coord_dir <= 1'b0;
+                        rx_idle_clks <= 32'd0;
+                        if (!rx_batch) begin
+                            rx_state <= (rx_byte == 8'd0) ? SPARSE_FLUSH : RECV_COORDS;
+                        end else begin
+                            rx_crc <= crc8(rx_crc, rx_byte);
+                            rx_sparse <= (rx_byte != BATCH_BITMAP);
+                            if (rx_byte == BATCH_BITMAP) rx_state <= RECV_IMAGE;
+                            else rx_state <= (rx_byte == 8'd0) ? BATCH_CRC : RECV_COORDS;
+                        end
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+                        rx_state <= WAIT_HEADER;  // Banco não confirmado: continua livre
+                    end
+                end
+                
+                RECV_COORDS: begin
+                    // Coordenada x<<4|y liga o pixel y*IMG_SIZE + x, o mesmo
+                    // bit que o empacotamento do bitmap usa; no tile
+                    // orientado o byte seguinte é o θ desse pixel
+                    if (rx_dv) begin
+                        rx_crc <= crc8(rx_crc, rx_byte);
+                        rx_idle_clks <= 32'd0;
+                        if (coord_dir) begin
+                            sparse_theta[coord_idx * 4 +: 4] <= rx_byte[3:0];
+                            coord_dir <= 1'b0;
+                        end else begin
+                            sparse_bits[rx_byte[3:0] * IMG_SIZE + rx_byte[7:4]] <= 1'b1;
+                            coord_idx <= rx_byte[3:0] * IMG_SIZE + rx_byte[7:4];
+                            coord_dir <= rx_oriented;
+                        end
+                        if (coord_dir || !rx_oriented) begin
+                            sparse_left <= sparse_left - 1'b1;
+                            if (sparse_left == 8'd1) rx_state <= rx_batch ? BATCH_CRC : SPARSE_FLUSH;
+                        end
+                    end else if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                        rx_idle_clks <= rx_idle_clks + 1'b1;
+                    end else begin
+`ifdef SIMULATION
+                        $display("[RX_TIMEOUT] Tile esparso incompleto (%0d coords faltando), descartado", sparse_left);
+`endif
+                        rx_state <= WAIT_HEADER;
+                    end
+                end
+                
+                SPARSE_FLUSH: begin
+                    // Mesma escrita de RECV_IMAGE, um byte por ciclo
+                    hough_wr_en <= 1'b1;
+                    hough_wr_addr <= recv_count[7:0];
+                    hough_wr_data <= sparse_bits[recv_count[7:0]*8 +: 8];
+                    hough_wr_theta <= sparse_theta[recv_count[7:0]*32 +: 32];
+                    if (recv_count < IMG_BYTES - 1) begin
+                        recv_count <= recv_count + 1'b1;
+                    end else begin
+                        hough_start <= 1'b1;
+                        recv_count <= 16'd0;
+                        rx_state <= (rx_batch && batch_left != 8'd0) ? BATCH_IDX : WAIT_HEADER;
                     end
                 end
                 
                 RECV_IMAGE: begin
-                    // Recebe 32 bytes da imagem e armazena no módulo Hough
+                    // Recebe 32 bytes da imagem e armazena no banco livre do Hough
                     if (rx_dv) begin
 `ifdef SIMULATION
                         $display("[UART_RX] rx_dv PULSE! Byte %0d = 0x%02h (recv_count=%0d)", recv_count, rx_byte, recv_count);
 `endif
-                        // Escreve byte na memória do Hough
-                        hough_wr_en <= 1'b1;
-                        hough_wr_addr <= recv_count;
+                        hough_wr_en <= !rx_drop;
+                        hough_wr_addr <= recv_count[7:0];
                         hough_wr_data <= rx_byte;
+                        rx_crc <= crc8(rx_crc, rx_byte);
+                        rx_idle_clks <= 32'd0;
                         
                         if (recv_count < IMG_BYTES - 1) begin
                             recv_count <= recv_count + 1'b1;
+                        end else if (rx_batch) begin
+                            // Registro de lote: só confirma depois do CRC
+                            recv_count <= 16'd0;
+                            rx_state <= BATCH_CRC;
                         end else begin
-                            // Recebeu toda a imagem
-                            hough_wr_en <= 1'b0;
-                            recv_count <= 8'd0;
-                            state <= PROCESS_HOUGH;
+                            // Recebeu toda a imagem: o último byte é escrito no
+                            // mesmo ciclo em que o banco é confirmado como job
+                            hough_start <= 1'b1;
+                            recv_count <= 16'd0;
+                            rx_state <= WAIT_HEADER;
                         end
                     end else begin
-                        hough_wr_en <= 1'b0;
+                        if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                            rx_idle_clks <= rx_idle_clks + 1'b1;
+                        end else begin
+`ifdef SIMULATION
+                            $display("[RX_TIMEOUT] Tile incompleto (%0d bytes), descartado", recv_count);
+`endif
+                            recv_count <= 16'd0;
+                            rx_state <= WAIT_HEADER;
+                        end
                     end
                 end
                 
-                PROCESS_HOUGH: begin
-                    // Inicia processamento da Transformada de Hough
-                    if (!hough_busy) begin
-                        hough_start <= 1'b1;
-                        state <= PROCESS_HOUGH;  // Permanece aqui até done
+                RECV_FRAME: begin
+                    // Recebe a imagem inteira no banco livre de frame_inst;
+                    // mesmo timeout entre bytes dos tiles
+                    if (rx_dv) begin
+                        frame_wr_en <= 1'b1;
+                        frame_wr_addr <= recv_count;
+                        hough_wr_data <= rx_byte;
+                        rx_idle_clks <= 32'd0;
+                        
+                        if (recv_count < FRAME_BYTES - 1) begin
+                            recv_count <= recv_count + 1'b1;
+                        end else begin
+                            frame_start <= 1'b1;
+                            recv_count <= 16'd0;
+                            rx_state <= WAIT_HEADER;
+                        end
+                    end else begin
+                        if (rx_idle_clks < RX_TIMEOUT_CLKS) begin
+                            rx_idle_clks <= rx_idle_clks + 1'b1;
+                        end else begin
+`ifdef SIMULATION
+                            $display("[RX_TIMEOUT] Imagem incompleta (%0d bytes), descartada", recv_count);
+`endif
+                            recv_count <= 16'd0;
+                            rx_state <= WAIT_HEADER;
+                        end
                     end
-                    
-                    // Aguarda conclusão
-                    if (hough_done) begin
-                        hough_start <= 1'b0;  // Limpa start antes de prosseguir
-                        send_line_idx <= 3'd0;
+                end
+                
+                default: rx_state <= WAIT_HEADER;
+            endcase
+        end
+    end
+
+    // ---------- Telemetria: duração da recepção e registro do 0xA8 ----------
+    // rx_job_clks fica em 0 enquanto o RX aguarda um header (ou o índice do
+    // próximo registro do lote) e conta a partir do byte que inicia o
+    // comando; no ciclo do commit ainda vale a duração do tile/imagem.
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            rx_job_clks <= 32'd0;
+            frame_rx_clks <= 32'd0;
+        end else begin
+            if ((rx_state == WAIT_HEADER || rx_state == BATCH_IDX) && !rx_dv)
+                rx_job_clks <= 32'd0;
+            else if (rx_job_clks != 32'hFFFF_FFFF)
+                rx_job_clks <= rx_job_clks + 1'b1;
+            
+            if (frame_start) frame_rx_clks <= rx_job_clks;
+        end
+    end
+    
+    // Registro do resultado cujo último byte acabou de sair (tx_ack): as
+    // saídas do motor ainda mostram esse resultado neste ciclo
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            stats_rec <= '0;
+            stats_seq <= 8'd0;
+        end else if (tx_ack) begin
+            stats_seq <= stats_seq + 1'b1;
+            if (tx_frame)
+                stats_rec <= {stats_seq + 8'd1, 8'd0, 8'h01, frame_edges, frame_vote_clks,
+                              frame_merge_clks, frame_rx_clks, tx_job_clks};
+            else
+                stats_rec <= {stats_seq + 8'd1, hough_res_tag,
+                              {5'd0, hough_res_crc, hough_res_tagged, 1'b0},
+                              hough_res_edges, hough_res_vote_clks, hough_res_merge_clks,
+                              hough_res_rx_clks, tx_job_clks};
+        end
+    end
+
+    // ---------- Negociação da taxa da UART ----------
+    // Troca o divisor só depois que o 'A' saiu inteiro na taxa antiga e
+    // volta a baud_rate se a sonda 0xA7 não chegar na nova taxa
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            baud_state <= BAUD_IDLE;
+            baud_clks <= 32'd0;
+            clks_per_bit <= BASE_CLKS_PER_BIT;
+            ctrl_req <= 1'b0;
+            ctrl_req_byte <= 8'h00;
+        end else begin
+            ctrl_req <= 1'b0;
+            
+            case (baud_state)
+                BAUD_IDLE: begin
+                    if (baud_req) begin
+                        ctrl_req <= 1'b1;
+                        if (baud_div >= MIN_CLKS_PER_BIT && !hough_busy &&
+                            !frame_busy && !frame_result_valid) begin
+                            ctrl_req_byte <= ACK_BYTE;
+                            baud_state <= BAUD_SEND_ACK;
+                        end else begin
+                            ctrl_req_byte <= NAK_BYTE;
+                        end
+                    end else if (baud_probe) begin
+                        // Sonda repetida na taxa já confirmada: ecoa de novo
+                        ctrl_req <= 1'b1;
+                        ctrl_req_byte <= BAUD_CONFIRM;
+                    end
+                end
+                
+                BAUD_SEND_ACK: begin
+                    if (ctrl_sent) begin
+                        clks_per_bit <= baud_div;
+                        baud_clks <= 32'd0;
+                        baud_state <= BAUD_WAIT_CONFIRM;
+                    end
+                end
+                
+                BAUD_WAIT_CONFIRM: begin
+                    if (baud_probe) begin
+                        ctrl_req <= 1'b1;
+                        ctrl_req_byte <= BAUD_CONFIRM;
+                        baud_state <= BAUD_IDLE;
+                    end else if (baud_clks < BAUD_CONFIRM_CLKS) begin
+                        baud_clks <= baud_clks + 1'b1;
+                    end else begin
+`ifdef SIMULATION
+                        $display("[BAUD] Sem confirmação, voltando a %0d baud", baud_rate);
+`endif
+                        clks_per_bit <= BASE_CLKS_PER_BIT;
+                        baud_state <= BAUD_IDLE;
+                    end
+                end
+                
+                default: baud_state <= BAUD_IDLE;
+            endcase
+        end
+    end
+
+    // ---------- Fila de NAKs do lote (RX → TX) ----------
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            nak_wp <= 4'd0;
+            nak_rp <= 4'd0;
+            nak_count <= 5'd0;
+        end else begin
+            if (nak_push && nak_count != 5'd16) begin
+                nak_q[nak_wp] <= batch_tag;
+                nak_wp <= nak_wp + 1'b1;
+            end
+            if (nak_pop) nak_rp <= nak_rp + 1'b1;
+            nak_count <= nak_count + (nak_push && nak_count != 5'd16) - nak_pop;
+        end
+    end
+
+    // ---------- TX: resultados em ordem + resposta de estado ----------
+    always_ff @(posedge clk or negedge reset_n) begin
+        if (!reset_n) begin
+            tx_state <= TX_IDLE;
+            tx_dv <= 1'b0;
+            tx_byte <= 8'h00;
+            status_pending <= 1'b0;
+            status_byte <= READY_BYTE;
+            stats_pending <= 1'b0;
+            stats_idx <= 5'd0;
+            tx_job_clks <= 32'd0;
+            ctrl_pending <= 1'b0;
+            ctrl_byte <= 8'h00;
+            tx_ctrl <= 1'b0;
+            ctrl_sent <= 1'b0;
+            send_line_idx <= 8'd0;
+            send_byte_idx <= 2'd0;
+            tx_frame <= 1'b0;
+            tx_ack <= 1'b0;
+            tx_crc <= 8'h00;
+            nak_pop <= 1'b0;
+            nak_tag <= 8'd0;
+            
+        end else begin
+            // Defaults
+            tx_dv <= 1'b0;
+            tx_ack <= 1'b0;
+            ctrl_sent <= 1'b0;
+            nak_pop <= 1'b0;
+            
+            // Duração da resposta em envio (zerada ao sair de TX_IDLE com um resultado)
+            if (tx_job_clks != 32'hFFFF_FFFF) tx_job_clks <= tx_job_clks + 1'b1;
+            
+            // CRC dos bytes enviados (zerado no início de cada resposta)
+            if (tx_done_rising) tx_crc <= crc8(tx_crc, tx_byte);
+            
+            if (status_req) status_pending <= 1'b1;
+            if (stats_req) stats_pending <= 1'b1;
+            if (ctrl_req) begin
+                ctrl_pending <= 1'b1;
+                ctrl_byte <= ctrl_req_byte;
+            end
+
+            case (tx_state)
+                TX_IDLE: begin
+                    // A consulta de estado só é respondida entre resultados,
+                    // nunca no meio de um
+                    if (ctrl_pending) begin
+                        ctrl_pending <= 1'b0;
+                        status_byte <= ctrl_byte;
+                        tx_ctrl <= 1'b1;
+                        tx_state <= SEND_STATUS;
+                    end else if (status_pending) begin
+                        status_pending <= 1'b0;
+                        status_byte <= (rx_state == WAIT_HEADER && !hough_busy &&
+                                        !frame_busy && !frame_result_valid &&
+                                        nak_count == 5'd0 && baud_state == BAUD_IDLE)
+                                       ? READY_BYTE : BUSY_BYTE;
+                        tx_ctrl <= 1'b0;
+                        tx_state <= SEND_STATUS;
+                    end else if (stats_pending) begin
+                        stats_pending <= 1'b0;
+                        stats_idx <= 5'd0;
+                        tx_crc <= 8'h00;
+                        tx_state <= SEND_STATS;
+                    end else if (nak_count != 5'd0) begin
+                        nak_tag <= nak_q[nak_rp];
+                        nak_pop <= 1'b1;
                         send_byte_idx <= 2'd0;
-                        state <= SEND_NUM_LINES;
+                        tx_crc <= 8'h00;
+                        tx_state <= SEND_NAK;
+                    end else if (hough_res_valid) begin
+                        send_line_idx <= 8'd0;
+                        send_byte_idx <= 2'd0;
+                        tx_frame <= 1'b0;
+                        tx_crc <= 8'h00;
+                        tx_job_clks <= 32'd0;
+                        tx_state <= hough_res_tagged ? SEND_TAG : SEND_NUM_LINES;
+                    end else if (frame_result_valid) begin
+                        send_line_idx <= 8'd0;
+                        send_byte_idx <= 2'd0;
+                        tx_frame <= 1'b1;
+                        tx_job_clks <= 32'd0;
+                        tx_state <= SEND_NUM_LINES;
+                    end
+                end
+                
+                SEND_TAG: begin
+                    if (!tx_active) begin
+                        tx_dv <= 1'b1;
+                        tx_byte <= hough_res_tag;
+                    end else begin
+                        tx_dv <= 1'b0;
+                    end
+                    
+                    if (tx_done_rising) begin
+                        tx_dv <= 1'b0;
+                        tx_state <= SEND_NUM_LINES;
+                    end
+                end
+                
+                SEND_STATUS: begin
+                    if (!tx_active) begin
+                        tx_dv <= 1'b1;
+                        tx_byte <= status_byte;
+                    end else begin
+                        tx_dv <= 1'b0;
+                    end
+                    
+                    if (tx_done_rising) begin
+                        tx_dv <= 1'b0;
+                        ctrl_sent <= tx_ctrl;
+                        tx_state <= CLEANUP;
                     end
                 end
                 
@@ -236,30 +1020,29 @@ module uart_echo_colorlight_i9 #(
                     // Envia número de linhas detectadas
                     if (!tx_active) begin
                         tx_dv <= 1'b1;
-                        tx_byte <= hough_num_lines;
+                        tx_byte <= tx_num_lines;
                     end else begin
                         tx_dv <= 1'b0;  // Zera tx_dv após iniciar transmissão
                     end
                     
                     if (tx_done_rising) begin
                         tx_dv <= 1'b0;  // Garante que está zerado
-                        if (hough_num_lines > 0) begin
-                            state <= SEND_LINE_DATA;
+                        if (tx_num_lines > 0) begin
+                            tx_state <= SEND_LINE_DATA;
+                        end else if (!tx_frame && hough_res_crc) begin
+                            tx_state <= SEND_CRC;
                         end else begin
-                            state <= CLEANUP;
+                            tx_ack <= 1'b1;
+                            tx_state <= CLEANUP;
                         end
                     end
                 end
                 
                 SEND_LINE_DATA: begin
                     // Envia dados de cada linha: [ρ] [θ] [votes]
-                    if (!tx_active && send_line_idx < hough_num_lines[2:0]) begin
-                        case (send_byte_idx)
-                            2'd0: tx_byte <= hough_line_rho[send_line_idx];
-                            2'd1: tx_byte <= hough_line_theta[send_line_idx];
-                            2'd2: tx_byte <= hough_line_votes[send_line_idx];
-                            default: tx_byte <= 8'h00;
-                        endcase
+                    // (imagem inteira: [ρ_hi] [ρ_lo] [θ] [votes])
+                    if (!tx_active && send_line_idx < tx_num_lines) begin
+                        tx_byte <= tx_line_byte;
                         tx_dv <= 1'b1;
                     end else begin
                         tx_dv <= 1'b0;  // Zera tx_dv após iniciar transmissão
@@ -267,25 +1050,91 @@ module uart_echo_colorlight_i9 #(
                     
                     if (tx_done_rising) begin
                         tx_dv <= 1'b0;  // Garante que está zerado
-                        if (send_byte_idx < 2'd2) begin
+                        if (send_byte_idx < tx_last_byte) begin
                             send_byte_idx <= send_byte_idx + 1'b1;
                         end else begin
                             send_byte_idx <= 2'd0;
-                            if (send_line_idx < hough_num_lines[2:0] - 1) begin
+                            if (send_line_idx < tx_num_lines - 1) begin
                                 send_line_idx <= send_line_idx + 1'b1;
+                            end else if (!tx_frame && hough_res_crc) begin
+                                tx_state <= SEND_CRC;
                             end else begin
-                                state <= CLEANUP;
+                                // Resultado inteiro enviado: libera o motor
+                                tx_ack <= 1'b1;
+                                tx_state <= CLEANUP;
                             end
                         end
                     end
                 end
                 
+                SEND_CRC: begin
+                    // tx_crc já inclui o último byte (atualizado no tx_done)
+                    if (!tx_active) begin
+                        tx_dv <= 1'b1;
+                        tx_byte <= tx_crc;
+                    end else begin
+                        tx_dv <= 1'b0;
+                    end
+                    
+                    if (tx_done_rising) begin
+                        tx_dv <= 1'b0;
+                        tx_ack <= 1'b1;
+                        tx_state <= CLEANUP;
+                    end
+                end
+                
+                SEND_NAK: begin
+                    // [tag] [BATCH_RETRY] [crc]
+                    if (!tx_active) begin
+                        tx_dv <= 1'b1;
+                        case (send_byte_idx)
+                            2'd0: tx_byte <= nak_tag;
+                            2'd1: tx_byte <= BATCH_RETRY;
+                            default: tx_byte <= tx_crc;
+                        endcase
+                    end else begin
+                        tx_dv <= 1'b0;
+                    end
+                    
+                    if (tx_done_rising) begin
+                        tx_dv <= 1'b0;
+                        if (send_byte_idx < 2'd2) begin
+                            send_byte_idx <= send_byte_idx + 1'b1;
+                        end else begin
+                            send_byte_idx <= 2'd0;
+                            tx_state <= CLEANUP;
+                        end
+                    end
+                end
+                
+                SEND_STATS: begin
+                    // stats_rec byte a byte (byte 0 no topo) e o CRC no fim
+                    if (!tx_active) begin
+                        tx_dv <= 1'b1;
+                        tx_byte <= (stats_idx < STATS_BYTES)
+                                   ? stats_rec[(STATS_BYTES - 1 - stats_idx)*8 +: 8]
+                                   : tx_crc;
+                    end else begin
+                        tx_dv <= 1'b0;
+                    end
+                    
+                    if (tx_done_rising) begin
+                        tx_dv <= 1'b0;
+                        if (stats_idx < STATS_BYTES) begin
+                            stats_idx <= stats_idx + 1'b1;
+                        end else begin
+                            stats_idx <= 5'd0;
+                            tx_state <= CLEANUP;
+                        end
+                    end
+                end
+                
                 CLEANUP: begin
-                    // Volta ao estado inicial
-                    state <= WAIT_HEADER;
+                    // Um ciclo para a fila de conclusão refletir o ack
+                    tx_state <= TX_IDLE;
                 end
                 
-                default: state <= WAIT_HEADER;
+                default: tx_state <= TX_IDLE;
             endcase
         end
     end
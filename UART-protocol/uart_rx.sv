@@ -2,17 +2,18 @@
 // UART Receiver Module - SystemVerilog
 // Otimizado para comunicação FPGA <-> Raspberry Pi Pico
 //
-// Configuração padrão: 115200 baud, 8N1 (8 bits, No parity, 1 stop bit)
-// Clock: 50 MHz
-// CLKS_PER_BIT = 50_000_000 / 115200 = 434 (aproximadamente)
+// Formato 8N1 (8 bits, No parity, 1 stop bit)
+// Taxa definida em tempo de execução por i_clks_per_bit = CLK_FREQ / baud
+// (ex.: 25 MHz / 9600 = 2604, 25 MHz / 3_125_000 = 8). Só deve mudar com
+// o módulo ocioso; o valor mínimo é 8.
 
 module uart_rx #(
-    parameter CLKS_PER_BIT = 434,  // Para 115200 baud @ 50MHz
     parameter CLK_FREQ_HZ = 50_000_000,
     parameter BAUD_RATE = 115200
 ) (
     input  logic       i_clk,        // Clock do sistema
     input  logic       i_rst_n,      // Reset assíncrono ativo baixo
+    input  logic [15:0] i_clks_per_bit, // Ciclos de clock por bit
     input  logic       i_rx_serial,  // Sinal UART RX (conectar ao Pico TX)
     
     output logic       o_rx_dv,      // Data Valid: pulso quando dado pronto
@@ -36,7 +37,7 @@ module uart_rx #(
     logic rx_filtered;
     
     // Registradores internos
-    logic [$clog2(CLKS_PER_BIT)-1:0] clk_count;
+    logic [15:0] clk_count;
     logic [2:0] bit_index;
     logic [7:0] rx_byte;
     logic rx_line_was_high;  // Flag para garantir transição HIGH->LOW válida
@@ -95,11 +96,11 @@ module uart_rx #(
                 end
                 
                 START_BIT: begin
-                    if (clk_count < CLKS_PER_BIT - 1) begin
+                    if (clk_count < i_clks_per_bit - 1) begin
                         clk_count <= clk_count + 1'b1;
                         
                         // VALIDAÇÃO: Checa se start bit AINDA está em LOW no MEIO
-                        if (clk_count == (CLKS_PER_BIT / 2)) begin
+                        if (clk_count == (i_clks_per_bit >> 1)) begin
                             if (rx_filtered != 1'b0) begin
                                 // Start bit inválido - marca frame como inválido
                                 frame_valid <= 1'b0;
@@ -113,12 +114,13 @@ module uart_rx #(
                 end
                 
                 DATA_BITS: begin
-                    if (clk_count < CLKS_PER_BIT - 1) begin
+                    if (clk_count < i_clks_per_bit - 1) begin
                         clk_count <= clk_count + 1'b1;
                         
                         // AMOSTRA LIGEIRAMENTE ANTES DO MEIO (compensação de delay)
-                        // Em vez de CLKS_PER_BIT/2, usa (CLKS_PER_BIT/2 - 4)
-                        if (clk_count == ((CLKS_PER_BIT / 2) - 4)) begin
+                        // Em vez de i_clks_per_bit/2, usa (i_clks_per_bit/2 - 4)
+                        // (por isso o divisor mínimo é 8)
+                        if (clk_count == ((i_clks_per_bit >> 1) - 4)) begin
                             rx_byte[bit_index] <= rx_filtered;
                         end
                     end else begin
@@ -134,24 +136,19 @@ module uart_rx #(
                 end
                 
                 STOP_BIT: begin
-                    // CORREÇÃO: Limpa o_rx_dv imediatamente após pulso
-                    if (o_rx_dv == 1'b1) begin
-                        o_rx_dv <= 1'b0;
-                    end
-                    
-                    if (clk_count < CLKS_PER_BIT - 1) begin
+                    // Encerra o frame no MEIO do stop bit: a segunda metade é
+                    // linha em HIGH, usada pelo IDLE para armar a detecção do
+                    // próximo start bit. Esperar o stop bit inteiro fazia o
+                    // receptor perder bytes enviados sem intervalo (back-to-back).
+                    if (clk_count < (i_clks_per_bit >> 1)) begin
                         clk_count <= clk_count + 1'b1;
-                        
-                        // VALIDAÇÃO: Checa stop bit no meio do período
-                        if (clk_count == (CLKS_PER_BIT / 2)) begin
-                            // Só aceita se frame_valid E stop bit correto
-                            if (frame_valid && rx_filtered == 1'b1) begin
-                                // Frame completo e válido - PULSO DE 1 CICLO
-                                o_rx_dv   <= 1'b1;
-                                o_rx_byte <= rx_byte;
-                            end
-                        end
                     end else begin
+                        // VALIDAÇÃO: Só aceita se frame_valid E stop bit correto
+                        if (frame_valid && rx_filtered == 1'b1) begin
+                            // Frame completo e válido - PULSO DE 1 CICLO
+                            o_rx_dv   <= 1'b1;
+                            o_rx_byte <= rx_byte;
+                        end
                         clk_count <= '0;
                         state     <= CLEANUP;
                     end
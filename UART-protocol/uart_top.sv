@@ -1,10 +1,11 @@
 module uart_top #(
     parameter CLK_FREQ_HZ = 50_000_000,  // Clock do sistema
-    parameter BAUD_RATE   = 115200        // Taxa de transmissão
+    parameter BAUD_RATE   = 115200        // Taxa inicial (i_clks_per_bit após reset)
 ) (
     // Sinais do sistema
     input  logic       i_clk,          // Clock 50 MHz
     input  logic       i_rst_n,        // Reset assíncrono ativo baixo
+    input  logic [15:0] i_clks_per_bit, // Divisor da taxa (CLK_FREQ_HZ / baud), em tempo de execução
     
     // Interface UART física (conectar ao Raspberry Pi Pico)
     input  logic       i_uart_rx,      // Recebe do Pico TX
@@ -21,15 +22,14 @@ module uart_top #(
     output logic [7:0] o_rx_byte       // Byte recebido
 );
 
-    // Calcula CLKS_PER_BIT
-    localparam int CLKS_PER_BIT = CLK_FREQ_HZ / BAUD_RATE;
-    
     // Instancia transmissor UART
     uart_tx #(
-        .CLKS_PER_BIT(CLKS_PER_BIT)
+        .CLK_FREQ_HZ(CLK_FREQ_HZ),
+        .BAUD_RATE(BAUD_RATE)
     ) uart_tx_inst (
         .i_clk       (i_clk),
         .i_rst_n     (i_rst_n),
+        .i_clks_per_bit(i_clks_per_bit),
         .i_tx_dv     (i_tx_dv),
         .i_tx_byte   (i_tx_byte),
         .o_tx_serial (o_uart_tx),
@@ -39,10 +39,12 @@ module uart_top #(
     
     // Instancia receptor UART
     uart_rx #(
-        .CLKS_PER_BIT(CLKS_PER_BIT)
+        .CLK_FREQ_HZ(CLK_FREQ_HZ),
+        .BAUD_RATE(BAUD_RATE)
     ) uart_rx_inst (
         .i_clk       (i_clk),
         .i_rst_n     (i_rst_n),
+        .i_clks_per_bit(i_clks_per_bit),
         .i_rx_serial (i_uart_rx),
         .o_rx_dv     (o_rx_dv),
         .o_rx_byte   (o_rx_byte)
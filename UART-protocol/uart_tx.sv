@@ -2,17 +2,18 @@
 // UART Transmitter Module - SystemVerilog
 // Otimizado para comunicação FPGA <-> Raspberry Pi Pico
 //
-// Configuração padrão: 115200 baud, 8N1 (8 bits, No parity, 1 stop bit)
-// Clock: 50 MHz
-// CLKS_PER_BIT = 50_000_000 / 115200 = 434 (aproximadamente)
+// Formato 8N1 (8 bits, No parity, 1 stop bit)
+// Taxa definida em tempo de execução por i_clks_per_bit = CLK_FREQ / baud
+// (ex.: 25 MHz / 9600 = 2604, 25 MHz / 3_125_000 = 8). Só deve mudar com
+// o módulo ocioso; o valor mínimo é 8.
 
 module uart_tx #(
-    parameter CLKS_PER_BIT = 434,  // Para 115200 baud @ 50MHz
     parameter CLK_FREQ_HZ = 50_000_000,
     parameter BAUD_RATE = 115200
 ) (
     input  logic       i_clk,        // Clock do sistema
     input  logic       i_rst_n,      // Reset assíncrono ativo baixo
+    input  logic [15:0] i_clks_per_bit, // Ciclos de clock por bit
     input  logic       i_tx_dv,      // Data Valid: pulso para iniciar transmissão
     input  logic [7:0] i_tx_byte,    // Byte a ser transmitido
     
@@ -33,7 +34,7 @@ module uart_tx #(
     state_t state, next_state;
     
     // Registradores internos
-    logic [$clog2(CLKS_PER_BIT)-1:0] clk_count;
+    logic [15:0] clk_count;
     logic [2:0] bit_index;
     logic [7:0] tx_data;
     
@@ -66,7 +67,7 @@ module uart_tx #(
                 START_BIT: begin
                     o_tx_serial <= 1'b0;  // Start bit = 0
                     
-                    if (clk_count < CLKS_PER_BIT - 1) begin
+                    if (clk_count < i_clks_per_bit - 1) begin
                         clk_count <= clk_count + 1'b1;
                     end else begin
                         clk_count <= '0;
@@ -77,7 +78,7 @@ module uart_tx #(
                 DATA_BITS: begin
                     o_tx_serial <= tx_data[bit_index];
                     
-                    if (clk_count < CLKS_PER_BIT - 1) begin
+                    if (clk_count < i_clks_per_bit - 1) begin
                         clk_count <= clk_count + 1'b1;
                     end else begin
                         clk_count <= '0;
@@ -94,7 +95,7 @@ module uart_tx #(
                 STOP_BIT: begin
                     o_tx_serial <= 1'b1;  // Stop bit = 1
                     
-                    if (clk_count < CLKS_PER_BIT - 1) begin
+                    if (clk_count < i_clks_per_bit - 1) begin
                         clk_count <= clk_count + 1'b1;
                     end else begin
                         clk_count   <= '0;
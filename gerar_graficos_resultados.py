@@ -3,8 +3,19 @@ Geração de Gráficos para Resultados do Sistema de Detecção de Linhas
 Projeto: Transformada de Hough em FPGA (64x64 pixels)
 Autor: Marcony Henrique Bento Souza
 Data: 09/11/2025
+
+Uso:
+  python gerar_graficos_resultados.py [log_serial.txt] [--frame N]
+
+Com um log, os dados vêm da telemetria do firmware (bloco entre
+"# TELEMETRIA" e "# FIM" impresso pelo Pico com TELEMETRY 1, ou por
+hough_bench --telemetry): linhas por tile, ρ/θ/votos de cada linha, linhas
+únicas e os ciclos medidos no FPGA. Sem log, usa os números do relatório
+de 09/11/2025.
 """
 
+import argparse
+
 import numpy as np
 import matplotlib.pyplot as plt
 import matplotlib.patches as patches
@@ -28,8 +39,102 @@ import os
 output_dir = "graficos_resultados"
 os.makedirs(output_dir, exist_ok=True)
 
+# =============================================================================
+# DADOS: TELEMETRIA DO FIRMWARE OU NÚMEROS DO RELATÓRIO
+# =============================================================================
+# Linha principal: atravessa um tile inteiro (16 pixels votando no mesmo ρ, θ)
+VOTOS_PRINCIPAL = 16
+
+# Relatório de 09/11/2025 (cruz 64×64, 16 tiles, saída serial copiada à mão)
+DADOS_RELATORIO = {
+    'origem': 'relatório de 09/11/2025',
+    'tile_detections': [
+        [0, 0, 4, 0],  # Row 0 (tiles 1-4)
+        [0, 0, 4, 0],  # Row 1 (tiles 5-8)
+        [4, 4, 4, 4],  # Row 2 (tiles 9-12) - linha horizontal
+        [0, 0, 4, 0],  # Row 3 (tiles 13-16)
+    ],
+    # Ângulos detectados (em graus) e seus votos
+    'angles': [0, 11, 11, 11, 90, 101, 112, 112, 112, 123, 135, 157, 168, 168, 168, 168],
+    'angle_votes': [16, 6, 6, 5, 16, 16, 16, 17, 16, 16, 17, 18, 21, 6, 6, 6],
+    # As 15 linhas filtradas
+    'rho': [32.00, -31.30, -27.97, 35.47, 26.84, 32.00, 17.68, 28.36,
+            23.68, -16.95, -24.65, 0.00, 11.69, 40.57, -21.32],
+    'theta': [0, 168, 168, 11, 123, 90, 112, 101, 112, 157, 168, 135, 112, 11, 168],
+    'votes': [16, 6, 6, 5, 16, 16, 17, 16, 16, 18, 21, 17, 16, 6, 6],
+    'main_lines': [(32.00, 0, 16), (32.00, 90, 16)],  # ρ, θ, votos
+    'raw_lines': 28,
+    'unique_lines': 15,
+    'tiles': None,  # Sem tempos medidos (o gráfico 7 usa os ~800 ms por tile)
+}
+
+
+def carregar_telemetria(path, frame=None):
+    """Registros T/L/F/U de um frame do log (o primeiro frame em tiles, se
+    frame for None) no mesmo formato de DADOS_RELATORIO."""
+    clk_hz = 25_000_000
+    regs = {'T': [], 'L': [], 'F': [], 'U': []}
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for linha in f:
+            linha = linha.strip()
+            if linha.startswith('# TELEMETRIA'):
+                for campo in linha.split()[2:]:
+                    chave, _, valor = campo.partition('=')
+                    if chave == 'clk_hz':
+                        clk_hz = int(valor)
+                continue
+            campos = linha.split(',')
+            if campos[0] in regs and len(campos) > 1:
+                regs[campos[0]].append(campos[1:])
+
+    if not regs['T']:
+        raise SystemExit(f'{path}: nenhum registro de telemetria (T,...)')
+    if frame is None:
+        em_tiles = [int(t[0]) for t in regs['T'] if int(t[1]) >= 0]
+        frame = em_tiles[0] if em_tiles else int(regs['T'][0][0])
+    do_frame = {k: [r for r in v if int(r[0]) == frame] for k, v in regs.items()}
+    if not do_frame['T']:
+        raise SystemExit(f'{path}: frame {frame} não está no log')
+
+    tile_detections = [[0] * 4 for _ in range(4)]
+    tiles = []
+    for t in do_frame['T']:
+        tile, n = int(t[1]), int(t[2])
+        edges, vote, merge, rx, tx, link_us = (int(v) for v in t[3:9])
+        if tile >= 0:
+            tile_detections[tile // 4][tile % 4] = n
+        # Ciclos → µs no clock do FPGA
+        tiles.append({'tile': tile, 'lines': n, 'edges': edges, 'link_us': link_us,
+                      'rx_us': rx * 1e6 / clk_hz, 'vote_us': vote * 1e6 / clk_hz,
+                      'merge_us': merge * 1e6 / clk_hz, 'tx_us': tx * 1e6 / clk_hz})
+
+    linhas = [(float(l[5]), int(l[3]), int(l[4])) for l in do_frame['L']]
+    unicas = [(float(u[1]), int(u[2]), int(u[3])) for u in do_frame['U']]
+    resumo = do_frame['F'][0] if do_frame['F'] else [frame, len(linhas), len(unicas), 0]
+    return {
+        'origem': f'telemetria de {os.path.basename(path)}, frame {frame}',
+        'tile_detections': tile_detections,
+        'angles': [l[1] for l in linhas],
+        'angle_votes': [l[2] for l in linhas],
+        'rho': [l[0] for l in linhas],
+        'theta': [l[1] for l in linhas],
+        'votes': [l[2] for l in linhas],
+        'main_lines': [u for u in unicas if u[2] >= VOTOS_PRINCIPAL],
+        'raw_lines': int(resumo[1]),
+        'unique_lines': int(resumo[2]),
+        'tiles': tiles,
+    }
+
+
+parser = argparse.ArgumentParser(description='Gráficos dos resultados do Hough no FPGA')
+parser.add_argument('log', nargs='?', help='saída serial com o bloco "# TELEMETRIA"')
+parser.add_argument('--frame', type=int, help='frame do log (padrão: o primeiro em tiles)')
+args = parser.parse_args()
+dados = carregar_telemetria(args.log, args.frame) if args.log else DADOS_RELATORIO
+
 print("=" * 70)
 print("GERAÇÃO DE GRÁFICOS - RESULTADOS EXPERIMENTAIS")
+print(f"Dados: {dados['origem']}")
 print("=" * 70)
 
 # =============================================================================
@@ -37,12 +142,7 @@ print("=" * 70)
 # =============================================================================
 print("\n[1/10] Gerando mapa de calor de detecções por tile...")
 
-tile_detections = np.array([
-    [0, 0, 4, 0],  # Row 0 (tiles 1-4)
-    [0, 0, 4, 0],  # Row 1 (tiles 5-8)
-    [4, 4, 4, 4],  # Row 2 (tiles 9-12) - linha horizontal
-    [0, 0, 4, 0]   # Row 3 (tiles 13-16)
-])
+tile_detections = np.array(dados['tile_detections'])
 
 fig, ax = plt.subplots(figsize=(10, 8))
 im = ax.imshow(tile_detections, cmap='YlOrRd', aspect='auto', vmin=0, vmax=4)
@@ -79,8 +179,8 @@ print(f"   ✅ Salvo: {output_dir}/01_mapa_calor_tiles.png")
 print("\n[2/10] Gerando distribuição de ângulos detectados...")
 
 # Dados: ângulos detectados (em graus) e seus votos
-angles_detected = [0, 11, 11, 11, 90, 101, 112, 112, 112, 123, 135, 157, 168, 168, 168, 168]
-votes = [16, 6, 6, 5, 16, 16, 16, 17, 16, 16, 17, 18, 21, 6, 6, 6]
+angles_detected = dados['angles']
+votes = dados['angle_votes']
 
 # Converter para radianos
 angles_rad = np.deg2rad(angles_detected)
@@ -139,17 +239,17 @@ print(f"   ✅ Salvo: {output_dir}/02_distribuicao_angulos_polar.png")
 # =============================================================================
 print("\n[3/10] Gerando espaço de parâmetros Hough...")
 
-# Dados das 15 linhas filtradas
-rho_values = [32.00, -31.30, -27.97, 35.47, 26.84, 32.00, 17.68, 28.36, 
-              23.68, -16.95, -24.65, 0.00, 11.69, 40.57, -21.32]
-theta_values = [0, 168, 168, 11, 123, 90, 112, 101, 112, 157, 168, 135, 112, 11, 168]
-votes_values = [16, 6, 6, 5, 16, 16, 17, 16, 16, 18, 21, 17, 16, 6, 6]
+# Dados das linhas detectadas
+rho_values = dados['rho']
+theta_values = dados['theta']
+votes_values = dados['votes']
 
 # Classificar linhas principais vs ruído
-main_lines = [(32.00, 0, 16), (32.00, 90, 16)]  # ρ, θ, votos
+main_lines = dados['main_lines']  # ρ, θ, votos
+main_keys = {(round(rho, 2), theta) for rho, theta, _ in main_lines}
 noise_lines = [(rho_values[i], theta_values[i], votes_values[i]) 
                for i in range(len(rho_values)) 
-               if not (rho_values[i] == 32.00 and theta_values[i] in [0, 90])]
+               if (round(rho_values[i], 2), theta_values[i]) not in main_keys]
 
 fig, ax = plt.subplots(figsize=(12, 8))
 
@@ -160,7 +260,7 @@ noise_votes = [line[2] for line in noise_lines]
 
 scatter_noise = ax.scatter(noise_theta, noise_rho, s=np.array(noise_votes)*20, 
                           c='gray', alpha=0.5, edgecolors='black', linewidth=1.5,
-                          label='Artefatos (13 linhas)')
+                          label=f'Artefatos ({len(noise_lines)} linhas)')
 
 # Plotar linhas principais
 main_rho = [line[0] for line in main_lines]
@@ -169,7 +269,7 @@ main_votes = [line[2] for line in main_lines]
 
 scatter_main = ax.scatter(main_theta, main_rho, s=np.array(main_votes)*30, 
                          c='red', alpha=1.0, edgecolors='darkred', linewidth=2.5,
-                         marker='*', label='Linhas Principais (2 linhas)', zorder=5)
+                         marker='*', label=f'Linhas Principais ({len(main_lines)} linhas)', zorder=5)
 
 # Adicionar anotações para linhas principais
 for i, (rho, theta, votes) in enumerate(main_lines):
@@ -204,9 +304,8 @@ print("\n[4/10] Gerando distribuição de votos...")
 fig, ax = plt.subplots(figsize=(10, 6))
 
 # Separar votos de linhas principais vs ruído
-main_votes = [16, 16]
-noise_votes = [v for i, v in enumerate(votes_values) 
-               if not (rho_values[i] == 32.00 and theta_values[i] in [0, 90])]
+main_votes = [line[2] for line in main_lines]
+noise_votes = [line[2] for line in noise_lines]
 
 # Criar bins
 bins = [0, 5, 10, 15, 20, 25]
@@ -254,7 +353,7 @@ fig, ax = plt.subplots(figsize=(12, 6))
 
 # Estágios do processo
 stages = ['Detecções\nBrutas', 'Conversão\nGlobal', 'Filtragem\nDuplicatas', 'Resultado\nFinal']
-values = [28, 28, 15, 2]  # 2 = linhas principais
+values = [dados['raw_lines'], dados['raw_lines'], dados['unique_lines'], len(main_lines)]
 colors = ['#ff9999', '#ffcc99', '#99ccff', '#99ff99']
 
 # Desenhar retângulos
@@ -286,7 +385,7 @@ ax.text(0.4, 0.85, 'Converte coordenadas\nlocais → globais',
        ha='center', fontsize=9, style='italic', bbox=dict(boxstyle='round', facecolor='wheat', alpha=0.5))
 ax.text(0.6, 0.85, 'Remove duplicatas\n(|Δρ|<3, |Δθ|<15°)', 
        ha='center', fontsize=9, style='italic', bbox=dict(boxstyle='round', facecolor='wheat', alpha=0.5))
-ax.text(0.8, 0.15, '13 artefatos\nremovidos', 
+ax.text(0.8, 0.15, f'{values[2] - values[3]} artefatos\nremovidos', 
        ha='center', fontsize=9, style='italic', color='red', weight='bold')
 
 # Configurações
@@ -309,7 +408,7 @@ print("\n[6/10] Gerando análise de acurácia...")
 fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(14, 6))
 
 # Gráfico de Pizza - Classificação das Detecções
-sizes = [2, 13]
+sizes = [len(main_lines), dados['unique_lines'] - len(main_lines)]
 labels = ['Linhas Principais\n(Corretas)', 'Artefatos\n(Falsos Positivos)']
 colors_pie = ['#90EE90', '#FFB6C6']
 explode = (0.1, 0)
@@ -323,11 +422,14 @@ for autotext in autotexts:
     autotext.set_fontsize(12)
     autotext.set_weight('bold')
 
-ax1.set_title('Classificação das 15 Linhas Detectadas', fontsize=12, weight='bold', pad=15)
+ax1.set_title(f"Classificação das {dados['unique_lines']} Linhas Detectadas", fontsize=12, weight='bold', pad=15)
 
 # Gráfico de Barras - Métricas de Desempenho
 metrics = ['Precisão\n(Precision)', 'Recall', 'Taxa de\nDetecção']
-values_metrics = [13.3, 100, 100]  # Em porcentagem
+# Precisão das linhas únicas; recall e taxa de detecção pedem o gabarito do
+# padrão (as linhas desenhadas), não vêm da telemetria
+precision = 100.0 * len(main_lines) / max(dados['unique_lines'], 1)
+values_metrics = [precision, 100, 100]  # Em porcentagem
 colors_bars = ['#FFA07A', '#98FB98', '#87CEEB']
 
 bars = ax2.bar(metrics, values_metrics, color=colors_bars, alpha=0.8, 
@@ -361,38 +463,76 @@ print("\n[7/10] Gerando análise de tempo de processamento...")
 
 fig, ax = plt.subplots(figsize=(12, 6))
 
-# Dados simulados (todos ~800ms)
-tiles = list(range(1, 17))
-processing_times = [800] * 16  # ms
-
-# Destacar tiles com detecções
-tiles_with_detection = [3, 7, 9, 10, 11, 12, 15]
-colors_time = ['red' if t in tiles_with_detection else 'lightblue' for t in tiles]
-
-bars = ax.bar(tiles, processing_times, color=colors_time, alpha=0.8, 
-             edgecolor='black', linewidth=1.5)
-
-# Linha de média
-avg_time = np.mean(processing_times)
-ax.axhline(y=avg_time, color='blue', linestyle='--', linewidth=2, 
-          label=f'Média: {avg_time:.0f} ms', alpha=0.7)
-
-# Configurações
-ax.set_xlabel('Número do Tile', fontsize=12, weight='bold')
-ax.set_ylabel('Tempo de Processamento (ms)', fontsize=12, weight='bold')
-ax.set_title('Tempo de Processamento por Tile (Grid 4×4)\nVermelho = Tiles com Detecções', 
-            fontsize=14, weight='bold', pad=15)
-ax.set_xticks(tiles)
-ax.grid(axis='y', alpha=0.3, linestyle='--')
-ax.legend(fontsize=11)
-ax.set_ylim(0, 1000)
-
-# Adicionar tempo total
-total_time = sum(processing_times) / 1000  # segundos
-ax.text(0.98, 0.95, f'Tempo Total: {total_time:.1f}s', 
-       transform=ax.transAxes, fontsize=12, weight='bold',
-       verticalalignment='top', horizontalalignment='right',
-       bbox=dict(boxstyle='round', facecolor='yellow', alpha=0.8))
+if dados['tiles']:
+    # Etapas medidas pelos contadores do FPGA (registro do 0xA8) e o tempo
+    # do link visto pelo Pico; tiles vazios não passam pelo FPGA
+    regs = sorted(dados['tiles'], key=lambda t: t['tile'])
+    labels_t = [str(t['tile'] + 1) if t['tile'] >= 0 else 'imagem' for t in regs]
+    x = np.arange(len(regs))
+    etapas = [('rx_us', 'RX (comando no fio)', '#87CEEB'),
+              ('vote_us', 'VOTE', '#FF6B6B'),
+              ('merge_us', 'Busca de picos', '#FFD93D'),
+              ('tx_us', 'TX (resposta no fio)', '#98FB98')]
+    base = np.zeros(len(regs))
+    for chave, nome, cor in etapas:
+        valores = np.array([t[chave] for t in regs])
+        ax.bar(x, valores, bottom=base, label=nome, color=cor,
+               edgecolor='black', linewidth=1)
+        base += valores
+    ax.plot(x, [t['link_us'] for t in regs], 'ko--', linewidth=1.5,
+            label='Envio → resposta no Pico')
+    for xi, t in zip(x, regs):
+        if t['lines'] > 0:
+            ax.text(xi, base[xi], f"{t['lines']}L", ha='center', va='bottom',
+                    fontsize=9, weight='bold', color='red')
+
+    ax.set_xlabel('Número do Tile', fontsize=12, weight='bold')
+    ax.set_ylabel('Tempo (µs)', fontsize=12, weight='bold')
+    ax.set_title('Tempo por Tile Medido no FPGA (contadores de desempenho)\n'
+                 'nL = linhas detectadas no tile', fontsize=14, weight='bold', pad=15)
+    ax.set_xticks(x)
+    ax.set_xticklabels(labels_t)
+    ax.grid(axis='y', alpha=0.3, linestyle='--')
+    ax.legend(fontsize=10)
+
+    total_fpga = base.sum() / 1000  # ms
+    ax.text(0.98, 0.95, f'Total no FPGA: {total_fpga:.2f} ms',
+           transform=ax.transAxes, fontsize=12, weight='bold',
+           verticalalignment='top', horizontalalignment='right',
+           bbox=dict(boxstyle='round', facecolor='yellow', alpha=0.8))
+else:
+    # Dados simulados (todos ~800ms)
+    tiles = list(range(1, 17))
+    processing_times = [800] * 16  # ms
+
+    # Destacar tiles com detecções
+    tiles_with_detection = [3, 7, 9, 10, 11, 12, 15]
+    colors_time = ['red' if t in tiles_with_detection else 'lightblue' for t in tiles]
+
+    bars = ax.bar(tiles, processing_times, color=colors_time, alpha=0.8, 
+                 edgecolor='black', linewidth=1.5)
+
+    # Linha de média
+    avg_time = np.mean(processing_times)
+    ax.axhline(y=avg_time, color='blue', linestyle='--', linewidth=2, 
+              label=f'Média: {avg_time:.0f} ms', alpha=0.7)
+
+    # Configurações
+    ax.set_xlabel('Número do Tile', fontsize=12, weight='bold')
+    ax.set_ylabel('Tempo de Processamento (ms)', fontsize=12, weight='bold')
+    ax.set_title('Tempo de Processamento por Tile (Grid 4×4)\nVermelho = Tiles com Detecções', 
+                fontsize=14, weight='bold', pad=15)
+    ax.set_xticks(tiles)
+    ax.grid(axis='y', alpha=0.3, linestyle='--')
+    ax.legend(fontsize=11)
+    ax.set_ylim(0, 1000)
+
+    # Adicionar tempo total
+    total_time = sum(processing_times) / 1000  # segundos
+    ax.text(0.98, 0.95, f'Tempo Total: {total_time:.1f}s', 
+           transform=ax.transAxes, fontsize=12, weight='bold',
+           verticalalignment='top', horizontalalignment='right',
+           bbox=dict(boxstyle='round', facecolor='yellow', alpha=0.8))
 
 plt.tight_layout()
 plt.savefig(f'{output_dir}/07_tempo_processamento_tiles.png', dpi=300, bbox_inches='tight')